@@ -864,6 +864,7 @@ class MixxxCore(Feature):
                    "src/engine/engineobject.cpp",
                    "src/engine/enginepregain.cpp",
                    "src/engine/enginemaster.cpp",
+                   "src/engine/offlinerenderer.cpp",
                    "src/engine/enginedelay.cpp",
                    "src/engine/enginevumeter.cpp",
                    "src/engine/enginesidechaincompressor.cpp",
@@ -886,6 +887,7 @@ class MixxxCore(Feature):
                    "src/engine/cachingreader/cachingreader.cpp",
                    "src/engine/cachingreader/cachingreaderchunk.cpp",
                    "src/engine/cachingreader/cachingreaderworker.cpp",
+                   "src/engine/cachingreader/residentsample.cpp",
 
                    "src/analyzer/trackanalysisscheduler.cpp",
                    "src/analyzer/analyzerthread.cpp",
@@ -906,6 +908,7 @@ class MixxxCore(Feature):
 
                    "src/controllers/controller.cpp",
                    "src/controllers/controllerdebug.cpp",
+                   "src/controllers/controlleroutputscheduler.cpp",
                    "src/controllers/controllerenumerator.cpp",
                    "src/controllers/controllerlearningeventfilter.cpp",
                    "src/controllers/controllermanager.cpp",
@@ -1049,6 +1052,7 @@ class MixxxCore(Feature):
                    "src/library/proxytrackmodel.cpp",
                    "src/library/coverart.cpp",
                    "src/library/coverartcache.cpp",
+                   "src/library/coverartthumbnailcache.cpp",
                    "src/library/coverartutils.cpp",
                    "src/library/trackcollectioniterator.cpp",
                    "src/library/trackmodeliterator.cpp",
@@ -1098,6 +1102,7 @@ class MixxxCore(Feature):
                    "src/library/baseexternallibraryfeature.cpp",
                    "src/library/baseexternaltrackmodel.cpp",
                    "src/library/baseexternalplaylistmodel.cpp",
+                   "src/library/externallibrarytablewriter.cpp",
                    "src/library/rhythmbox/rhythmboxfeature.cpp",
 
                    "src/library/banshee/bansheefeature.cpp",
@@ -1182,6 +1187,7 @@ class MixxxCore(Feature):
                    "src/waveform/renderers/qtvsynctestrenderer.cpp",
 
                    "src/waveform/renderers/waveformsignalcolors.cpp",
+                   "src/waveform/renderers/waveformsignalraster.cpp",
 
                    "src/waveform/renderers/waveformrenderersignalbase.cpp",
                    "src/waveform/renderers/waveformmark.cpp",
@@ -100,6 +100,7 @@ class HID(Feature):
 
     def sources(self, build):
         sources = ['src/controllers/hid/hidcontroller.cpp',
+                   'src/controllers/hid/hiddevicelock.cpp',
                    'src/controllers/hid/hidcontrollerpreset.cpp',
                    'src/controllers/hid/hidenumerator.cpp',
                    'src/controllers/hid/hidcontrollerpresetfilehandler.cpp']
@@ -754,6 +755,7 @@ class LiveBroadcasting(Feature):
         depends.Qt.uic(build)('src/preferences/dialog/dlgprefbroadcastdlg.ui')
         return ['src/preferences/dialog/dlgprefbroadcast.cpp',
                 'src/broadcast/broadcastmanager.cpp',
+                'src/engine/sidechain/sharedencoder.cpp',
                 'src/engine/sidechain/shoutconnection.cpp']
 
 
@@ -41,6 +41,8 @@
 
 #define MONITOR_DECAY_EVERY 512 /* in samples */
 
+#define SUBMIT_BLOCK 256 /* in samples, see timecoder_submit() */
+
 #define SQ(x) ((x)*(x))
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(*x))
 
@@ -406,11 +408,14 @@ inline static void update_monitor(struct timecoder *tc, signed int x, signed int
 
     if (++tc->mon_counter % MONITOR_DECAY_EVERY == 0) {
         int p;
+        unsigned char *mon = tc->mon;
 
-        for (p = 0; p < SQ(size); p++) {
-            if (tc->mon[p])
-                tc->mon[p] = tc->mon[p] * 7 / 8;
-        }
+        /* Without a branch and with a local pointer that does not
+         * alias tc, so that the compiler can vectorize this loop; zero
+         * pixels stay zero */
+
+        for (p = 0; p < SQ(size); p++)
+            mon[p] = mon[p] * 7 / 8;
     }
 
     assert(ref > 0);
@@ -581,24 +586,47 @@ void timecoder_cycle_definition(struct timecoder *tc)
 
 void timecoder_submit(struct timecoder *tc, signed short *pcm, size_t npcm)
 {
-    while (npcm--) {
-	signed int left, right, primary, secondary;
+    signed int primary[SUBMIT_BLOCK], secondary[SUBMIT_BLOCK];
+    signed int *left, *right;
+    size_t primary_offset, n, i;
+
+    if (tc->def->flags & SWITCH_PRIMARY) {
+        primary_offset = 0;
+        left = primary;
+        right = secondary;
+    } else {
+        primary_offset = 1;
+        left = secondary;
+        right = primary;
+    }
 
-        left = pcm[0] << 16;
-        right = pcm[1] << 16;
+    while (npcm > 0) {
+        n = npcm < SUBMIT_BLOCK ? npcm : SUBMIT_BLOCK;
 
-        if (tc->def->flags & SWITCH_PRIMARY) {
-            primary = left;
-            secondary = right;
-        } else {
-            primary = right;
-            secondary = left;
+        /* Split the channels and scale them to the full range of a
+         * signed int in a separate pass without branches, so that the
+         * compiler can vectorize it */
+
+        for (i = 0; i < n; i++) {
+            primary[i] = pcm[i * TIMECODER_CHANNELS + primary_offset] * 65536;
+            secondary[i] = pcm[i * TIMECODER_CHANNELS + 1 - primary_offset] * 65536;
         }
 
-	process_sample(tc, primary, secondary);
-        update_monitor(tc, left, right);
+        /* The zero crossings and the pitch depend on the previous
+         * sample, so they are detected sample by sample */
+
+        if (tc->mon) {
+            for (i = 0; i < n; i++) {
+                process_sample(tc, primary[i], secondary[i]);
+                update_monitor(tc, left[i], right[i]);
+            }
+        } else {
+            for (i = 0; i < n; i++)
+                process_sample(tc, primary[i], secondary[i]);
+        }
 
-        pcm += TIMECODER_CHANNELS;
+        pcm += n * TIMECODER_CHANNELS;
+        npcm -= n;
     }
 }
 
@@ -24,7 +24,9 @@ BroadcastManager::BroadcastManager(SettingsManager* pSettingsManager,
                                    SoundManager* pSoundManager)
         : m_pConfig(pSettingsManager->settings()),
           m_pBroadcastSettings(pSettingsManager->broadcastSettings()),
-          m_pNetworkStream(pSoundManager->getNetworkStream()) {
+          m_pNetworkStream(pSoundManager->getNetworkStream()),
+          m_removedDroppedFrames(0),
+          m_removedOverflows(0) {
     const bool persist = true;
     m_pBroadcastEnabled = new ControlPushButton(
             ConfigKey(BROADCAST_PREF_KEY,"enabled"), persist);
@@ -38,6 +40,20 @@ BroadcastManager::BroadcastManager(SettingsManager* pSettingsManager,
     m_pStatusCO->setReadOnly();
     m_pStatusCO->forceSet(STATUSCO_UNCONNECTED);
 
+    // Like [Recording],sidechain_dropped_frames for the FIFOs of the
+    // network stream, summed up for all connections
+    m_pDroppedFramesCO = new ControlObject(
+            ConfigKey(BROADCAST_PREF_KEY, "sidechain_dropped_frames"));
+    m_pDroppedFramesCO->setReadOnly();
+    m_pOverflowsCO = new ControlObject(
+            ConfigKey(BROADCAST_PREF_KEY, "sidechain_overflows"));
+    m_pOverflowsCO->setReadOnly();
+    connect(&m_dropStatsTimer,
+            &QTimer::timeout,
+            this,
+            &BroadcastManager::slotUpdateDropStats);
+    m_dropStatsTimer.start(1000);
+
     // Initialize libshout
     shout_init();
 
@@ -68,6 +84,9 @@ BroadcastManager::~BroadcastManager() {
     // Disable broadcast so when Mixxx starts again it will not connect.
     m_pBroadcastEnabled->set(0);
 
+    m_dropStatsTimer.stop();
+    delete m_pOverflowsCO;
+    delete m_pDroppedFramesCO;
     delete m_pStatusCO;
     delete m_pBroadcastEnabled;
 
@@ -186,6 +205,8 @@ bool BroadcastManager::removeConnection(BroadcastProfilePtr profile) {
         // Disabling the profile tells ShoutOutput's thread to disconnect
         connection->profile()->setEnabled(false);
         m_pNetworkStream->removeOutputWorker(connection);
+        m_removedDroppedFrames += connection->droppedFrames();
+        m_removedOverflows += connection->overflowCount();
 
         kLogger.debug() << "removeConnection: removed connection for profile"
                         << profile->getProfileName();
@@ -257,3 +278,18 @@ void BroadcastManager::slotConnectionStatusChanged(int newState) {
         m_pStatusCO->forceSet(STATUSCO_UNCONNECTED);
     }
 }
+
+void BroadcastManager::slotUpdateDropStats() {
+    qint64 droppedFrames = m_removedDroppedFrames;
+    qint64 overflows = m_removedOverflows;
+    const QVector<NetworkOutputStreamWorkerPtr> workers =
+            m_pNetworkStream->outputWorkers();
+    for (const auto& pWorker : workers) {
+        if (pWorker) {
+            droppedFrames += pWorker->droppedFrames();
+            overflows += pWorker->overflowCount();
+        }
+    }
+    m_pDroppedFramesCO->forceSet(static_cast<double>(droppedFrames));
+    m_pOverflowsCO->forceSet(static_cast<double>(overflows));
+}
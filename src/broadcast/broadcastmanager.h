@@ -2,6 +2,7 @@
 #define BROADCAST_BROADCASTMANAGER_H
 
 #include <QObject>
+#include <QTimer>
 
 #include "preferences/settingsmanager.h"
 #include "preferences/usersettings.h"
@@ -43,6 +44,7 @@ class BroadcastManager : public QObject {
     void slotProfileRemoved(BroadcastProfilePtr profile);
     void slotProfilesChanged();
     void slotConnectionStatusChanged(int newState);
+    void slotUpdateDropStats();
 
   private:
     bool addConnection(BroadcastProfilePtr profile);
@@ -55,6 +57,14 @@ class BroadcastManager : public QObject {
 
     ControlPushButton* m_pBroadcastEnabled;
     ControlObject* m_pStatusCO;
+
+    // The samples that did not fit into the FIFOs of the connections,
+    // including those of connections that have been removed
+    ControlObject* m_pDroppedFramesCO;
+    ControlObject* m_pOverflowsCO;
+    QTimer m_dropStatsTimer;
+    qint64 m_removedDroppedFrames;
+    qint64 m_removedOverflows;
 };
 
 #endif /* BROADCAST_BROADCASTMANAGER_H */
@@ -1,8 +1,88 @@
 #include "control/control.h"
 
+#include <QMetaMethod>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+
 #include "control/controlobject.h"
 #include "util/stat.h"
 
+namespace {
+
+// Set for threads that coalesce their value change notifications
+thread_local bool s_coalesceValueChanges = false;
+
+const QMetaMethod& valueChangedCoalescedSignal() {
+    static const QMetaMethod kSignal =
+            QMetaMethod::fromSignal(&ControlDoublePrivate::valueChangedCoalesced);
+    return kSignal;
+}
+
+typedef QHash<ConfigKey, QWeakPointer<ControlDoublePrivate>> ControlSnapshot;
+
+// Read-copy-update publication of ControlDoublePrivate::s_qCOHash for
+// lock-free lookups. The snapshot is immutable and shares its data with
+// the hash until the hash is modified. Readers only register themselves
+// in the counter of the current epoch. Before a replaced snapshot is
+// deleted the writer advances the epoch twice and waits until the
+// counters of both epochs have dropped to zero, i.e. until all readers
+// that might still access the replaced snapshot have left.
+std::atomic<const ControlSnapshot*> s_pControlSnapshot{nullptr};
+std::atomic<unsigned int> s_controlSnapshotEpoch{0};
+std::atomic<int> s_controlSnapshotReaders[2] = {};
+
+// Lookups that missed the snapshot but succeeded on s_qCOHash since the
+// snapshot has been published. Guarded by s_qCOHashMutex.
+int s_controlSnapshotMisses = 0;
+
+class ControlSnapshotReader final {
+  public:
+    ControlSnapshotReader()
+            : m_readers(s_controlSnapshotReaders[s_controlSnapshotEpoch.load() & 1]) {
+        m_readers.fetch_add(1);
+    }
+    ~ControlSnapshotReader() {
+        m_readers.fetch_sub(1);
+    }
+
+    // Never blocks. The returned control is not retained within the scope
+    // of the reader, because deleting a control locks s_qCOHashMutex that
+    // is held by a writer waiting for the readers.
+    QSharedPointer<ControlDoublePrivate> lookup(const ConfigKey& key) const {
+        const ControlSnapshot* pSnapshot = s_pControlSnapshot.load();
+        if (!pSnapshot) {
+            return nullptr;
+        }
+        const auto it = pSnapshot->constFind(key);
+        if (it == pSnapshot->constEnd()) {
+            return nullptr;
+        }
+        return it.value().toStrongRef();
+    }
+
+  private:
+    std::atomic<int>& m_readers;
+};
+
+// Must be called while holding s_qCOHashMutex.
+void replaceControlSnapshot(const ControlSnapshot* pSnapshot) {
+    const ControlSnapshot* pReplaced = s_pControlSnapshot.exchange(pSnapshot);
+    s_controlSnapshotMisses = 0;
+    if (!pReplaced) {
+        return;
+    }
+    for (int i = 0; i < 2; ++i) {
+        const unsigned int epoch = s_controlSnapshotEpoch.fetch_add(1);
+        while (s_controlSnapshotReaders[epoch & 1].load() > 0) {
+            QThread::yieldCurrentThread();
+        }
+    }
+    delete pReplaced;
+}
+
+} // anonymous namespace
+
 //static
 UserSettingsPointer ControlDoublePrivate::s_pUserConfig;
 
@@ -17,6 +97,12 @@ QHash<ConfigKey, ConfigKey> ControlDoublePrivate::s_qCOAliasHash
 //static
 MMutex ControlDoublePrivate::s_qCOHashMutex;
 
+//static
+std::atomic<ControlDoublePrivate*> ControlDoublePrivate::s_pCoalescedChanges{nullptr};
+
+//static
+MMutex ControlDoublePrivate::s_coalescedChangesMutex;
+
 ControlDoublePrivate::ControlDoublePrivate(
         ConfigKey key,
         ControlObject* pCreatorCO,
@@ -32,7 +118,10 @@ ControlDoublePrivate::ControlDoublePrivate(
           m_trackType(Stat::UNSPECIFIED),
           m_trackFlags(Stat::COUNT | Stat::SUM | Stat::AVERAGE |
                   Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX),
-          m_confirmRequired(false) {
+          m_confirmRequired(false),
+          m_coalescedChangePending(false),
+          m_pCoalescedChangeSender(nullptr),
+          m_pNextCoalescedChange(nullptr) {
     initialize(defaultValue);
 }
 
@@ -59,6 +148,10 @@ void ControlDoublePrivate::initialize(double defaultValue) {
 }
 
 ControlDoublePrivate::~ControlDoublePrivate() {
+    if (m_coalescedChangePending.load()) {
+        removeCoalescedChange();
+    }
+
     s_qCOHashMutex.lock();
     //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
     s_qCOHash.remove(m_key);
@@ -107,12 +200,26 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
         return nullptr;
     }
 
+    // Lock-free lookup of existing controls
+    auto pControl = ControlSnapshotReader().lookup(key);
+    if (pControl) {
+        VERIFY_OR_DEBUG_ASSERT(!pCreatorCO) {
+            qWarning()
+                    << "ControlObject"
+                    << key.group << key.item
+                    << "already created";
+            return nullptr;
+        }
+        return pControl;
+    }
+
     // Scope for MMutexLocker.
     {
         const MMutexLocker locker(&s_qCOHashMutex);
-        const auto it = s_qCOHash.find(key);
-        if (it != s_qCOHash.end()) {
-            auto pControl = it.value().lock();
+        // Non-const access would detach s_qCOHash from the snapshot
+        const auto it = s_qCOHash.constFind(key);
+        if (it != s_qCOHash.constEnd()) {
+            pControl = it.value().lock();
             if (pControl) {
                 // Control object already exists
                 VERIFY_OR_DEBUG_ASSERT(!pCreatorCO) {
@@ -122,16 +229,22 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
                             << "already created";
                     return nullptr;
                 }
+                // The snapshot is outdated. Publishing a new one is deferred
+                // until enough lookups have missed it, because the next
+                // modification of s_qCOHash needs to copy all entries.
+                if (++s_controlSnapshotMisses > s_qCOHash.size() / 8 + 8) {
+                    replaceControlSnapshot(new ControlSnapshot(s_qCOHash));
+                }
                 return pControl;
             } else {
                 // The weak pointer has become invalid and can be cleaned up
-                s_qCOHash.erase(it);
+                s_qCOHash.remove(key);
             }
         }
     }
 
     if (pCreatorCO) {
-        auto pControl = QSharedPointer<ControlDoublePrivate>(
+        pControl = QSharedPointer<ControlDoublePrivate>(
                 new ControlDoublePrivate(key,
                         pCreatorCO,
                         bIgnoreNops,
@@ -181,9 +294,74 @@ QList<QSharedPointer<ControlDoublePrivate>> ControlDoublePrivate::takeAllInstanc
         }
     }
     s_qCOHash.clear();
+    replaceControlSnapshot(nullptr);
     return result;
 }
 
+// static
+void ControlDoublePrivate::setCoalesceValueChanges(bool coalesce) {
+    s_coalesceValueChanges = coalesce;
+}
+
+// static
+void ControlDoublePrivate::pushCoalescedChange(ControlDoublePrivate* pControl) {
+    ControlDoublePrivate* pHead = s_pCoalescedChanges.load(std::memory_order_relaxed);
+    do {
+        pControl->m_pNextCoalescedChange = pHead;
+    } while (!s_pCoalescedChanges.compare_exchange_weak(
+            pHead, pControl, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// static
+int ControlDoublePrivate::drainCoalescedValueChanges() {
+    QVector<QPair<QSharedPointer<ControlDoublePrivate>, QObject*>> changes;
+    {
+        const MMutexLocker locker(&s_coalescedChangesMutex);
+        ControlDoublePrivate* pControl =
+                s_pCoalescedChanges.exchange(nullptr, std::memory_order_acquire);
+        while (pControl) {
+            ControlDoublePrivate* pNext = pControl->m_pNextCoalescedChange;
+            // Controls that are about to be deleted return a null pointer
+            // and wait for the mutex in their destructor.
+            auto pShared = pControl->sharedFromThis();
+            pControl->m_coalescedChangePending.store(false);
+            if (pShared) {
+                changes.append(qMakePair(
+                        std::move(pShared),
+                        pControl->m_pCoalescedChangeSender.load()));
+            }
+            pControl = pNext;
+        }
+    }
+    // The stack contains the most recently changed control first
+    for (auto it = changes.crbegin(); it != changes.crend(); ++it) {
+        const auto& pControl = it->first;
+        emit pControl->valueChangedCoalesced(pControl->get(), it->second);
+    }
+    return changes.size();
+}
+
+void ControlDoublePrivate::removeCoalescedChange() {
+    const MMutexLocker locker(&s_coalescedChangesMutex);
+    if (!m_coalescedChangePending.load()) {
+        // Already drained
+        return;
+    }
+    // Controls are only pushed while they are referenced, i.e. this is
+    // not pushed again concurrently. Take all other controls from the
+    // stack and push them back.
+    ControlDoublePrivate* pControl =
+            s_pCoalescedChanges.exchange(nullptr, std::memory_order_acquire);
+    while (pControl) {
+        ControlDoublePrivate* pNext = pControl->m_pNextCoalescedChange;
+        if (pControl != this) {
+            pushCoalescedChange(pControl);
+        }
+        pControl = pNext;
+    }
+    m_coalescedChangePending.store(false);
+}
+
 void ControlDoublePrivate::deleteCreatorCO() {
     delete m_pCreatorCO.fetchAndStoreOrdered(nullptr);
 }
@@ -220,6 +398,17 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
     m_value.setValue(value);
     emit valueChanged(value, pSender);
 
+    if (!s_coalesceValueChanges) {
+        emit valueChangedCoalesced(value, pSender);
+    } else if (isSignalConnected(valueChangedCoalescedSignal())) {
+        // Only the latest sender is kept, the receivers will get the
+        // latest value when the change is drained.
+        m_pCoalescedChangeSender.store(pSender);
+        if (!m_coalescedChangePending.exchange(true)) {
+            pushCoalescedChange(this);
+        }
+    }
+
     if (m_bTrack) {
         Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
                     static_cast<Stat::ComputeFlags>(m_trackFlags), value);
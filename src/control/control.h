@@ -1,10 +1,12 @@
 #pragma once
 
 #include <QAtomicPointer>
+#include <QEnableSharedFromThis>
 #include <QHash>
 #include <QObject>
 #include <QSharedPointer>
 #include <QString>
+#include <atomic>
 
 #include "control/controlbehavior.h"
 #include "control/controlvalue.h"
@@ -29,7 +31,8 @@ enum class ControlFlag {
 Q_DECLARE_FLAGS(ControlFlags, ControlFlag)
 Q_DECLARE_OPERATORS_FOR_FLAGS(ControlFlags)
 
-class ControlDoublePrivate : public QObject {
+class ControlDoublePrivate : public QObject,
+                             public QEnableSharedFromThis<ControlDoublePrivate> {
     Q_OBJECT
   public:
     ~ControlDoublePrivate() override;
@@ -48,7 +51,9 @@ class ControlDoublePrivate : public QObject {
 
     // Gets the ControlDoublePrivate matching the given ConfigKey. If pCreatorCO
     // is non-NULL, allocates a new ControlDoublePrivate for the ConfigKey if
-    // one does not exist.
+    // one does not exist. Existing controls are usually found without locking.
+    // Callers that access a control repeatedly should nevertheless keep the
+    // returned pointer, e.g. in a ControlProxy, instead of looking it up again.
     static QSharedPointer<ControlDoublePrivate> getControl(
             const ConfigKey& key,
             ControlFlags flags = ControlFlag::None,
@@ -63,6 +68,24 @@ class ControlDoublePrivate : public QObject {
     // Clears all existing instances and returns them as a list.
     static QList<QSharedPointer<ControlDoublePrivate>> takeAllInstances();
 
+    // Defers valueChangedCoalesced() for all values that are set by the
+    // calling thread until drainCoalescedValueChanges() is invoked. This
+    // keeps queued signals, which allocate memory, off the audio thread.
+    //
+    // NOTE: Receivers of valueChangedCoalesced(), i.e. the ControlProxy
+    // objects of the main thread, are thus notified about changes of the
+    // engine only at the GUI frame rate. Intermediate values within a frame
+    // are skipped, the final value is always delivered. Script connections
+    // and the ControlProxy objects of other threads, e.g. of controllers,
+    // receive every change via valueChanged().
+    static void setCoalesceValueChanges(bool coalesce);
+
+    // Emits valueChangedCoalesced() once with the latest value of every
+    // control that has been changed by a coalescing thread since the last
+    // invocation. Invoked once per frame from the main thread. Returns the
+    // number of emitted signals.
+    static int drainCoalescedValueChanges();
+
     static QHash<ConfigKey, ConfigKey> getControlAliases() {
         // Implicitly shared classes can safely be copied across threads
         return s_qCOAliasHash;
@@ -154,8 +177,15 @@ class ControlDoublePrivate : public QObject {
 
   signals:
     // Emitted when the ControlDoublePrivate value changes. pSender is a
-    // pointer to the setter of the value (potentially NULL).
+    // pointer to the setter of the value (potentially NULL). This signal is
+    // also emitted from the audio thread. Queued connections allocate an
+    // event there for every change and are reserved for receivers that must
+    // not miss any change, e.g. controllers.
     void valueChanged(double value, QObject* pSender);
+    // Same as valueChanged() for auto and queued connections. Changes made
+    // by a coalescing thread are not signaled immediately but collected and
+    // emitted later by drainCoalescedValueChanges() with the latest value.
+    void valueChangedCoalesced(double value, QObject* pSender);
     void valueChangeRequest(double value);
 
   private:
@@ -174,6 +204,9 @@ class ControlDoublePrivate : public QObject {
     void initialize(double defaultValue);
     void setInner(double value, QObject* pSender);
 
+    static void pushCoalescedChange(ControlDoublePrivate* pControl);
+    void removeCoalescedChange();
+
     const ConfigKey m_key;
 
     QAtomicPointer<ControlObject> m_pCreatorCO;
@@ -206,6 +239,13 @@ class ControlDoublePrivate : public QObject {
 
     QSharedPointer<ControlNumericBehavior> m_pBehavior;
 
+    // Set while the control is linked into the stack of coalesced changes.
+    std::atomic<bool> m_coalescedChangePending;
+    // The setter of the latest coalesced change.
+    std::atomic<QObject*> m_pCoalescedChangeSender;
+    // The next control in the stack of coalesced changes.
+    ControlDoublePrivate* m_pNextCoalescedChange;
+
     // Hack to implement persistent controls. This is a pointer to the current
     // user configuration object (if one exists). In general, we do not want the
     // user configuration to be a singleton -- objects that need access to it
@@ -214,7 +254,9 @@ class ControlDoublePrivate : public QObject {
     // configuration object would be arduous.
     static UserSettingsPointer s_pUserConfig;
 
-    // Hash of ControlDoublePrivate instantiations.
+    // Hash of ControlDoublePrivate instantiations. getControl() looks up
+    // existing controls in an immutable snapshot of this hash first, which
+    // is republished after enough lookups have missed it.
     static QHash<ConfigKey, QWeakPointer<ControlDoublePrivate>> s_qCOHash;
 
     // Hash of aliases between ConfigKeys. Solely used for looking up the first
@@ -223,4 +265,26 @@ class ControlDoublePrivate : public QObject {
 
     // Mutex guarding access to s_qCOHash and s_qCOAliasHash.
     static MMutex s_qCOHashMutex;
+
+    // Lock-free stack of all controls with a pending coalesced change. It is
+    // pushed by the coalescing threads without locking or allocating memory.
+    static std::atomic<ControlDoublePrivate*> s_pCoalescedChanges;
+
+    // Mutex serializing the threads that take controls from
+    // s_pCoalescedChanges, i.e. drainCoalescedValueChanges() and the
+    // destructor.
+    static MMutex s_coalescedChangesMutex;
+};
+
+// Coalesces the change notifications of all controls that are set by the
+// current thread while in scope, see
+// ControlDoublePrivate::setCoalesceValueChanges().
+class ScopedCoalescedValueChanges final {
+  public:
+    ScopedCoalescedValueChanges() {
+        ControlDoublePrivate::setCoalesceValueChanges(true);
+    }
+    ~ScopedCoalescedValueChanges() {
+        ControlDoublePrivate::setCoalesceValueChanges(false);
+    }
 };
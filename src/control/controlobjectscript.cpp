@@ -9,7 +9,8 @@ ControlObjectScript::ControlObjectScript(const ConfigKey& key, QObject* pParent)
 bool ControlObjectScript::addScriptConnection(const ScriptConnection& conn) {
     if (m_scriptConnections.isEmpty()) {
         // Only connect the slots when they are actually needed
-        // by script connections.
+        // by script connections. Scripts receive every change of the
+        // engine, e.g. short pulses of beat_active, without coalescing.
         connect(m_pControl.data(),
                 &ControlDoublePrivate::valueChanged,
                 this,
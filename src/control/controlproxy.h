@@ -1,6 +1,7 @@
 #ifndef CONTROLPROXY_H
 #define CONTROLPROXY_H
 
+#include <QCoreApplication>
 #include <QObject>
 #include <QSharedPointer>
 #include <QString>
@@ -91,15 +92,30 @@ class ControlProxy : public QObject {
         // (i.e. w/o and intermediate variable) when used with
         // Qt::UniqueConnection. Otherwise it detects a false positive and
         // throws a [-Wclazy-lambda-unique-connection] warning.
+        // Auto and queued connections of proxies in the main thread, i.e.
+        // of widgets, receive coalesced changes from the audio thread at
+        // the frame rate, see ControlDoublePrivate::valueChangedCoalesced().
+        // Proxies in other threads, e.g. of controllers, receive every
+        // change. The thread of the proxy is checked when connecting.
+        const bool coalesced = QCoreApplication::instance() &&
+                thread() == QCoreApplication::instance()->thread();
         switch (requestedConnectionType) {
         case Qt::AutoConnection:
-            connect(m_pControl.data(), &ControlDoublePrivate::valueChanged, this, &ControlProxy::slotValueChangedAuto, copConnection);
+            if (coalesced) {
+                connect(m_pControl.data(), &ControlDoublePrivate::valueChangedCoalesced, this, &ControlProxy::slotValueChangedAuto, copConnection);
+            } else {
+                connect(m_pControl.data(), &ControlDoublePrivate::valueChanged, this, &ControlProxy::slotValueChangedAuto, copConnection);
+            }
             break;
         case Qt::DirectConnection:
             connect(m_pControl.data(), &ControlDoublePrivate::valueChanged, this, &ControlProxy::slotValueChangedDirect, copConnection);
             break;
         case Qt::QueuedConnection:
-            connect(m_pControl.data(), &ControlDoublePrivate::valueChanged, this, &ControlProxy::slotValueChangedQueued, copConnection);
+            if (coalesced) {
+                connect(m_pControl.data(), &ControlDoublePrivate::valueChangedCoalesced, this, &ControlProxy::slotValueChangedQueued, copConnection);
+            } else {
+                connect(m_pControl.data(), &ControlDoublePrivate::valueChanged, this, &ControlProxy::slotValueChangedQueued, copConnection);
+            }
             break;
         default:
             // Should be unreachable, but just to make sure ;-)
@@ -118,6 +134,12 @@ class ControlProxy : public QObject {
         return m_pControl != nullptr;
     }
 
+    // Returns the ControlObject that has created the control without
+    // looking it up by its key.
+    ControlObject* getCreatorCO() const {
+        return m_pControl ? m_pControl->getCreatorCO() : nullptr;
+    }
+
     // Returns the value of the object. Thread safe, non-blocking.
     inline double get() const {
         return m_pControl ? m_pControl->get() : 0.0;
@@ -15,6 +15,11 @@
 
 Controller::Controller()
         : m_pEngine(nullptr),
+          m_pOutputScheduler(new ControllerOutputScheduler(
+                  [this](const QByteArray& message) {
+                      sendScheduledMessage(message);
+                  },
+                  this)),
           m_bIsOutputDevice(false),
           m_bIsInputDevice(false),
           m_bIsOpen(false),
@@ -50,6 +55,8 @@ void Controller::stopEngine() {
     m_pEngine->gracefulShutdown();
     delete m_pEngine;
     m_pEngine = NULL;
+    // Send the final messages of the scripts before the device is closed
+    flushScheduledMessages();
 }
 
 bool Controller::applyPreset(bool initializeScripts) {
@@ -106,6 +113,8 @@ void Controller::send(QList<int> data, unsigned int length) {
     for (unsigned int i = 0; i < length; ++i) {
         msg[i] = data.at(i);
     }
+    // Keep the order of the messages
+    flushScheduledMessages();
     sendBytes(msg);
 }
 
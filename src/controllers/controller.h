@@ -12,6 +12,7 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "controllers/controlleroutputscheduler.h"
 #include "controllers/controllerpreset.h"
 #include "controllers/controllerpresetfilehandler.h"
 #include "controllers/controllerpresetinfo.h"
@@ -71,6 +72,11 @@ class Controller : public QObject, ConstControllerPresetVisitor {
 
     virtual bool matchPreset(const PresetInfo& preset) = 0;
 
+    /// Batches the feedback messages that are sent to the device
+    const ControllerOutputScheduler& outputScheduler() const {
+        return *m_pOutputScheduler;
+    }
+
   signals:
     // Emitted when a new preset is loaded. pPreset is a /clone/ of the loaded
     // preset, not a pointer to the preset itself.
@@ -111,6 +117,25 @@ class Controller : public QObject, ConstControllerPresetVisitor {
     // controller.
     virtual void sendBytes(const QByteArray& data) = 0;
 
+    // Sends the message with the next batch of feedback messages. A pending
+    // message with the same key is replaced, i.e. the key must identify the
+    // state of the device that is updated by the message.
+    void scheduleMessage(quint32 key, const QByteArray& message) {
+        m_pOutputScheduler->schedule(key, message);
+    }
+    // Sends all scheduled messages immediately
+    void flushScheduledMessages() {
+        m_pOutputScheduler->flush();
+    }
+    // Called by the output scheduler to send a scheduled message. Sub-classes
+    // need to reimplement this if the scheduled messages are not raw bytes.
+    virtual void sendScheduledMessage(const QByteArray& message) {
+        sendBytes(message);
+    }
+    void setMaxOutputMessagesPerSecond(int maxMessagesPerSecond) {
+        m_pOutputScheduler->setMaxMessagesPerSecond(maxMessagesPerSecond);
+    }
+
     // To be called in sub-class' open() functions after opening the device but
     // before starting any input polling/processing.
     void startEngine();
@@ -127,6 +152,7 @@ class Controller : public QObject, ConstControllerPresetVisitor {
     }
     inline void setDeviceName(QString deviceName) {
         m_sDeviceName = deviceName;
+        m_pOutputScheduler->setDeviceName(deviceName);
     }
     inline void setDeviceCategory(QString deviceCategory) {
         m_sDeviceCategory = deviceCategory;
@@ -161,6 +187,7 @@ class Controller : public QObject, ConstControllerPresetVisitor {
     // use only.
     virtual ControllerPreset* preset() = 0;
     ControllerEngine* m_pEngine;
+    ControllerOutputScheduler* m_pOutputScheduler;
 
     // Verbose and unique device name suitable for display.
     QString m_sDeviceName;
@@ -181,6 +208,7 @@ class Controller : public QObject, ConstControllerPresetVisitor {
     friend class ControllerManager;
     // For testing
     friend class ControllerPresetValidationTest;
+    friend class ControllerMappingReplay;
 };
 
 // An object of this class gets exposed to the JS engine, so the methods of this class
@@ -29,7 +29,9 @@
 
 // http://developer.qt.nokia.com/wiki/Threads_Events_QObjects
 
-// Poll every 1ms (where possible) for good controller response
+// Poll every 1ms (where possible) for good controller response. Only
+// PortMidi devices are polled, PortMidi has no API to wait for input.
+// HID and USB bulk devices block in reader threads until input arrives.
 #ifdef __LINUX__
 // Many Linux distros ship with the system tick set to 250Hz so 1ms timer
 // reportedly causes CPU hosage. See Bug #990992 rryan 6/2012
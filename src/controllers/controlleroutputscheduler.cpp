@@ -0,0 +1,116 @@
+#include "controllers/controlleroutputscheduler.h"
+
+#include "controllers/controllerdebug.h"
+#include "util/counter.h"
+#include "util/math.h"
+#include "util/time.h"
+
+namespace {
+
+// Roughly the bandwidth of a 5-pin DIN MIDI connection
+constexpr int kDefaultMaxMessagesPerSecond = 1000;
+
+} // anonymous namespace
+
+ControllerOutputScheduler::ControllerOutputScheduler(
+        Sender sender, QObject* pParent)
+        : QObject(pParent),
+          m_sender(std::move(sender)),
+          m_frameTimer(this),
+          m_maxMessagesPerFrame(0),
+          m_sentMessages(0),
+          m_suppressedMessages(0),
+          m_suppressedMessagesInFrame(0) {
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer,
+            &QTimer::timeout,
+            this,
+            &ControllerOutputScheduler::slotSendFrame);
+    setMaxMessagesPerSecond(kDefaultMaxMessagesPerSecond);
+    setDeviceName(QString());
+}
+
+ControllerOutputScheduler::~ControllerOutputScheduler() {
+    // The device might already be closed
+    if (hasPendingMessages()) {
+        controllerDebug("Discarding" << m_pendingKeys.size()
+                                     << "pending controller output messages");
+    }
+}
+
+void ControllerOutputScheduler::setMaxMessagesPerSecond(int maxMessagesPerSecond) {
+    m_maxMessagesPerFrame = math_max(1,
+            maxMessagesPerSecond * kFrameIntervalMillis / 1000);
+}
+
+void ControllerOutputScheduler::setDeviceName(const QString& deviceName) {
+    m_sentCounterTag = QStringLiteral("ControllerOutputScheduler %1 sent")
+                               .arg(deviceName);
+    m_suppressedCounterTag = QStringLiteral("ControllerOutputScheduler %1 suppressed")
+                                     .arg(deviceName);
+}
+
+void ControllerOutputScheduler::schedule(quint32 key, const QByteArray& message) {
+    auto i = m_pendingMessages.find(key);
+    if (i != m_pendingMessages.end()) {
+        // Only the latest value is relevant
+        i.value() = message;
+        ++m_suppressedMessages;
+        ++m_suppressedMessagesInFrame;
+        return;
+    }
+    m_pendingMessages.insert(key, message);
+    m_pendingKeys.enqueue(key);
+    startFrameTimer();
+}
+
+void ControllerOutputScheduler::flush() {
+    m_frameTimer.stop();
+    updateCounters(
+            sendPendingMessages(m_pendingKeys.size()),
+            m_suppressedMessagesInFrame);
+}
+
+void ControllerOutputScheduler::slotSendFrame() {
+    updateCounters(
+            sendPendingMessages(m_maxMessagesPerFrame),
+            m_suppressedMessagesInFrame);
+    if (hasPendingMessages()) {
+        // Rate limited
+        startFrameTimer();
+    }
+}
+
+void ControllerOutputScheduler::startFrameTimer() {
+    if (m_frameTimer.isActive()) {
+        return;
+    }
+    // Align the frames to a fixed grid, independent of when the first
+    // message of a frame has been scheduled
+    const qint64 nowMillis = mixxx::Time::elapsed().toIntegerMillis();
+    m_frameTimer.start(static_cast<int>(
+            kFrameIntervalMillis - nowMillis % kFrameIntervalMillis));
+}
+
+int ControllerOutputScheduler::sendPendingMessages(int maxMessages) {
+    int sentMessages = 0;
+    while (sentMessages < maxMessages && !m_pendingKeys.isEmpty()) {
+        const QByteArray message = m_pendingMessages.take(m_pendingKeys.dequeue());
+        m_sender(message);
+        ++sentMessages;
+    }
+    m_sentMessages += sentMessages;
+    return sentMessages;
+}
+
+void ControllerOutputScheduler::updateCounters(
+        int sentMessages, int suppressedMessages) {
+    if (sentMessages > 0) {
+        Counter(m_sentCounterTag).increment(sentMessages);
+    }
+    if (suppressedMessages > 0) {
+        Counter(m_suppressedCounterTag).increment(suppressedMessages);
+    }
+    m_suppressedMessagesInFrame = 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+#include <functional>
+
+/// Batches the feedback messages that are sent to a controller, e.g. to
+/// LEDs, VU meters or jog ring displays.
+///
+/// Each scheduled message has a key that identifies the state it updates,
+/// e.g. the status and control of a MIDI message or the ID of a HID
+/// report. A pending message is replaced by a newer one with the same key,
+/// i.e. only the latest value is sent. The pending messages are sent in
+/// batches at a fixed frame rate and only up to the rate limit of the
+/// device, the remaining ones stay pending for the next frame.
+class ControllerOutputScheduler : public QObject {
+    Q_OBJECT
+  public:
+    typedef std::function<void(const QByteArray& message)> Sender;
+
+    ControllerOutputScheduler(Sender sender, QObject* pParent = nullptr);
+    ~ControllerOutputScheduler() override;
+
+    /// Limits the messages that are sent per second
+    void setMaxMessagesPerSecond(int maxMessagesPerSecond);
+
+    /// The name is used for the counters in the statistics
+    void setDeviceName(const QString& deviceName);
+
+    /// Queues the message for the next frame and replaces a pending
+    /// message with the same key
+    void schedule(quint32 key, const QByteArray& message);
+
+    /// Sends all pending messages immediately regardless of the rate
+    /// limit, e.g. before sending a message that is not scheduled or
+    /// before closing the device.
+    void flush();
+
+    bool hasPendingMessages() const {
+        return !m_pendingKeys.isEmpty();
+    }
+
+    /// The number of messages that have been sent
+    quint64 sentMessages() const {
+        return m_sentMessages;
+    }
+
+    /// The number of messages that have been replaced by a newer one
+    /// before they were sent
+    quint64 suppressedMessages() const {
+        return m_suppressedMessages;
+    }
+
+    static constexpr int kFrameIntervalMillis = 16; // ~60 Hz
+
+  private slots:
+    void slotSendFrame();
+
+  private:
+    void startFrameTimer();
+    int sendPendingMessages(int maxMessages);
+    void updateCounters(int sentMessages, int suppressedMessages);
+
+    const Sender m_sender;
+    QTimer m_frameTimer;
+    int m_maxMessagesPerFrame;
+    QString m_sentCounterTag;
+    QString m_suppressedCounterTag;
+
+    // The keys in the order in which they have been scheduled first
+    QQueue<quint32> m_pendingKeys;
+    QHash<quint32, QByteArray> m_pendingMessages;
+
+    quint64 m_sentMessages;
+    quint64 m_suppressedMessages;
+    int m_suppressedMessagesInFrame;
+};
@@ -37,6 +37,8 @@ QWidget* MidiOptionsDelegate::createEditor(QWidget* parent,
     choices.append(MIDI_OPTION_SCRIPT);
     choices.append(MIDI_OPTION_14BIT_MSB);
     choices.append(MIDI_OPTION_14BIT_LSB);
+    choices.append(MIDI_OPTION_SCRATCH_TOUCH);
+    choices.append(MIDI_OPTION_SCRATCH_TICK);
 
     for (int i = 0; i < choices.size(); ++i) {
         MidiOption choice = choices.at(i);
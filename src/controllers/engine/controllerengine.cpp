@@ -542,6 +542,13 @@ void ControllerEngine::errorDialogButton(
     }
 }
 
+void ControllerEngine::collectGarbage() {
+    VERIFY_OR_DEBUG_ASSERT(m_pScriptEngine) {
+        return;
+    }
+    m_pScriptEngine->collectGarbage();
+}
+
 ControlObjectScript* ControllerEngine::getControlObjectScript(const QString& group, const QString& name) {
     ConfigKey key = ConfigKey(group, name);
 
@@ -585,8 +592,8 @@ void ControllerEngine::setValue(QString group, QString name, double newValue) {
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), onlyAssertOnControllerDebug());
+        // The cached script control is resolved only once
+        ControlObject* pControl = coScript->getCreatorCO();
         if (pControl && !m_st.ignore(pControl, coScript->getParameterForValue(newValue))) {
             coScript->slotSet(newValue);
         }
@@ -612,8 +619,7 @@ void ControllerEngine::setParameter(QString group, QString name, double newParam
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), onlyAssertOnControllerDebug());
+        ControlObject* pControl = coScript->getCreatorCO();
         if (pControl && !m_st.ignore(pControl, newParameter)) {
             coScript->setParameter(newParameter);
         }
@@ -53,6 +53,24 @@ class ControllerEngine : public QObject {
         m_bTesting = testing;
     };
 
+    /// Runs the garbage collector of the script engine, e.g. to measure
+    /// how long a collection takes
+    void collectGarbage();
+
+    /// Scratching with a controller wheel, for scripts and for the native
+    /// scratch options of MIDI mappings
+    void scratchEnable(
+            int deck,
+            int intervalsPerRev,
+            double rpm,
+            double alpha,
+            double beta,
+            bool ramp = true);
+    /// Accumulates ticks of the controller wheel
+    void scratchTick(int deck, int interval);
+    void scratchDisable(int deck, bool ramp = true);
+    bool isScratching(int deck);
+
   protected:
     double getValue(QString group, QString name);
     void setValue(QString group, QString name, double newValue);
@@ -86,17 +104,6 @@ class ControllerEngine : public QObject {
     /// soft-takeover state without an abrupt jump.
     void softTakeoverIgnoreNextValue(QString group, QString name);
 
-    void scratchEnable(
-            int deck,
-            int intervalsPerRev,
-            double rpm,
-            double alpha,
-            double beta,
-            bool ramp = true);
-    /// Accumulates ticks of the controller wheel
-    void scratchTick(int deck, int interval);
-    void scratchDisable(int deck, bool ramp = true);
-    bool isScratching(int deck);
     void brake(int deck, bool activate, double factor = 1.0, double rate = 1.0);
     void spinback(int deck, bool activate, double factor = 1.8, double rate = -10.0);
     void softStart(int deck, bool activate, double factor = 1.0);
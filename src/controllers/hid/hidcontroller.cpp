@@ -12,9 +12,12 @@
 #include "util/path.h" // for PATH_MAX on Windows
 #include "controllers/hid/hidcontroller.h"
 #include "controllers/defs_controllers.h"
+#include "util/assert.h"
+#include "util/compatibility.h"
 #include "util/trace.h"
 #include "controllers/controllerdebug.h"
 #include "util/time.h"
+#include "util/timer.h"
 
 ControllerJSProxy* HidController::jsProxy() {
     return new HidControllerJSProxy(this);
@@ -23,12 +26,93 @@ ControllerJSProxy* HidController::jsProxy() {
 namespace {
 constexpr int kReportIdSize = 1;
 constexpr int kMaxHidErrorMessageSize = 512;
+// Full speed USB devices poll their interrupt endpoint every 1 ms, but
+// many controllers need several ms to process a report
+constexpr int kMaxOutputReportsPerSecond = 500;
 } // namespace
 
+HidReader::HidReader(hid_device* pHidDevice, HidDeviceLock* pDeviceLock)
+        : QThread(),
+          m_pHidDevice(pHidDevice),
+          m_pDeviceLock(pDeviceLock),
+          m_stop(0),
+          m_iLastPollSize(0),
+          m_iPollingBufferIndex(0) {
+    // This isn't strictly necessary but is good practice.
+    for (int i = 0; i < kNumBuffers; i++) {
+        memset(m_pPollData[i], 0, kBufferSize);
+    }
+}
+
+HidReader::~HidReader() {
+}
+
+void HidReader::stop() {
+    m_stop = 1;
+}
+
+void HidReader::run() {
+    m_stop = 0;
+    while (atomicLoadAcquire(m_stop) == 0) {
+        // Cycle between buffers so the memcmp below does not require deep copying to another buffer.
+        unsigned char* pPreviousBuffer = m_pPollData[m_iPollingBufferIndex];
+        const int currentBufferIndex = (m_iPollingBufferIndex + 1) % kNumBuffers;
+        unsigned char* pCurrentBuffer = m_pPollData[currentBufferIndex];
+
+        int bytesRead;
+        if (m_pDeviceLock) {
+            HidDeviceLock::ReadLocker locked(m_pDeviceLock);
+            bytesRead = readReport(pCurrentBuffer, kBufferSize, kLockedReadTimeoutMillis);
+        } else {
+            bytesRead = readReport(pCurrentBuffer, kBufferSize, kReadTimeoutMillis);
+        }
+        if (bytesRead < 0) {
+            // -1 is the only error value according to hidapi documentation.
+            // The device has most likely been unplugged, don't spin on it.
+            DEBUG_ASSERT(bytesRead == -1);
+            qWarning() << "Unable to read from HID device, stopping the reader";
+            break;
+        } else if (bytesRead == 0) {
+            continue;
+        }
+        const mixxx::Duration timestamp = mixxx::Time::elapsed();
+
+        Trace process("HidReader process packet");
+        // Some controllers such as the Gemini GMX continuously send input packets even if it
+        // is identical to the previous packet. If this loop processed all those redundant
+        // packets, it would be a big performance problem to run JS code for every packet and
+        // would be unnecessary.
+        // This assumes that the redundant packets all use the same report ID. In practice we
+        // have not encountered any controllers that send redundant packets with different report
+        // IDs. If any such devices exist, this may be changed to use a separate buffer to store
+        // the last packet for each report ID.
+        if (bytesRead == m_iLastPollSize &&
+                memcmp(pCurrentBuffer, pPreviousBuffer, bytesRead) == 0) {
+            continue;
+        }
+        m_iLastPollSize = bytesRead;
+        m_iPollingBufferIndex = currentBufferIndex;
+        // Deep copy, the buffer is reused while the data is processed in
+        // the controller thread
+        QByteArray incomingData(reinterpret_cast<char*>(pCurrentBuffer), bytesRead);
+        emit incomingData(incomingData, timestamp);
+    }
+    controllerDebug("Stopped HidReader");
+}
+
+int HidReader::readReport(unsigned char* pData, int maxLength, int timeoutMillis) {
+    // Sleeps until a report arrives or the timeout expires, hidapi waits
+    // for the device file descriptor (hidraw), the read thread of the
+    // backend (libusb, macOS) or the overlapped read (Windows)
+    return hid_read_timeout(m_pHidDevice, pData, maxLength, timeoutMillis);
+}
+
 HidController::HidController(const hid_device_info& deviceInfo)
         : Controller(),
           m_pHidDevice(nullptr),
-          m_iPollingBufferIndex(0) {
+          m_pReader(nullptr) {
+    setMaxOutputMessagesPerSecond(kMaxOutputReportsPerSecond);
+
     // Copy required variables from deviceInfo, which will be freed after
     // this class is initialized by caller.
     hid_vendor_id = deviceInfo.vendor_id;
@@ -219,21 +303,30 @@ int HidController::open() {
         return -1;
     }
 
-    // Set hid controller to non-blocking
-    if (hid_set_nonblocking(m_pHidDevice, 1) != 0) {
-        qWarning() << "Unable to set HID device " << getName() << " to non-blocking";
+    // Only affects hid_read(), the hid_read_timeout() of the reader waits for
+    // the reports up to its timeout in either mode
+    if (hid_set_nonblocking(m_pHidDevice, 0) != 0) {
+        qWarning() << "Unable to set HID device " << getName() << " to blocking";
         return -1;
     }
 
-    // This isn't strictly necessary but is good practice.
-    for (int i = 0; i < kNumBuffers; i++) {
-        memset(m_pPollData[i], 0, kBufferSize);
-    }
-    m_iLastPollSize = 0;
-
     setOpen(true);
     startEngine();
 
+    if (m_pReader != nullptr) {
+        qWarning() << "HidReader already present for" << getName();
+    } else {
+        m_pReader = new HidReader(m_pHidDevice,
+                HidReader::kReadsNeedDeviceLock ? &m_deviceLock : nullptr);
+        m_pReader->setObjectName(QString("HidReader %1").arg(getName()));
+
+        connect(m_pReader, &HidReader::incomingData, this, &HidController::slotIncomingData);
+
+        // Controller input needs to be prioritized since it can affect the
+        // audio directly, like when scratching
+        m_pReader->start(QThread::HighPriority);
+    }
+
     return 0;
 }
 
@@ -245,6 +338,19 @@ int HidController::close() {
 
     qDebug() << "Shutting down HID device" << getName();
 
+    // Stop the reading thread
+    if (m_pReader == nullptr) {
+        qWarning() << "HidReader not present for" << getName()
+                   << "yet the device is open!";
+    } else {
+        disconnect(m_pReader, &HidReader::incomingData, this, &HidController::slotIncomingData);
+        m_pReader->stop();
+        controllerDebug("  Waiting on reader to finish");
+        m_pReader->wait();
+        delete m_pReader;
+        m_pReader = nullptr;
+    }
+
     // Stop controller engine here to ensure it's done before the device is closed
     //  in case it has any final parting messages
     stopEngine();
@@ -256,63 +362,48 @@ int HidController::close() {
     return 0;
 }
 
-bool HidController::poll() {
-    Trace hidRead("HidController poll");
-
-    // This loop risks becoming a high priority endless loop in case processing
-    // the mapping JS code takes longer than the controller polling rate.
-    // This could stall other low priority tasks.
-    // There is no safety net for this because it has not been demonstrated to be
-    // a problem in practice.
-    while (true) {
-        // Cycle between buffers so the memcmp below does not require deep copying to another buffer.
-        unsigned char* pPreviousBuffer = m_pPollData[m_iPollingBufferIndex];
-        const int currentBufferIndex = (m_iPollingBufferIndex + 1) % kNumBuffers;
-        unsigned char* pCurrentBuffer = m_pPollData[currentBufferIndex];
-
-        int bytesRead = hid_read(m_pHidDevice, pCurrentBuffer, kBufferSize);
-        if (bytesRead < 0) {
-            // -1 is the only error value according to hidapi documentation.
-            DEBUG_ASSERT(bytesRead == -1);
-            return false;
-        } else if (bytesRead == 0) {
-            return true;
-        }
-
-        Trace process("HidController process packet");
-        // Some controllers such as the Gemini GMX continuously send input packets even if it
-        // is identical to the previous packet. If this loop processed all those redundant
-        // packets, it would be a big performance problem to run JS code for every packet and
-        // would be unnecessary.
-        // This assumes that the redundant packets all use the same report ID. In practice we
-        // have not encountered any controllers that send redundant packets with different report
-        // IDs. If any such devices exist, this may be changed to use a separate buffer to store
-        // the last packet for each report ID.
-        if (bytesRead == m_iLastPollSize &&
-                memcmp(pCurrentBuffer, pPreviousBuffer, bytesRead) == 0) {
-            continue;
-        }
-        m_iLastPollSize = bytesRead;
-        m_iPollingBufferIndex = currentBufferIndex;
-        auto incomingData = QByteArray::fromRawData(
-                reinterpret_cast<char*>(pCurrentBuffer), bytesRead);
-        receive(incomingData, mixxx::Time::elapsed());
-    }
-}
-
-bool HidController::isPolling() const {
-    return isOpen();
+void HidController::slotIncomingData(QByteArray data, mixxx::Duration timestamp) {
+    receive(data, timestamp);
+    // From reading the report until the mapping has processed it, including
+    // the delay of the queued connection
+    static const QString kLatencyTag = QStringLiteral("HidController input latency");
+    Stat::track(kLatencyTag,
+            Stat::DURATION_NANOSEC,
+            Stat::experimentFlags(kDefaultComputeFlags),
+            (mixxx::Time::elapsed() - timestamp).toIntegerNanos());
 }
 
 void HidController::sendReport(QList<int> data, unsigned int length, unsigned int reportID) {
     Q_UNUSED(length);
     QByteArray temp;
+    temp.reserve(data.size());
     foreach (int datum, data) {
         temp.append(datum);
     }
+    // Keep the order of the reports
+    flushScheduledMessages();
     sendBytesReport(temp, reportID);
 }
 
+void HidController::scheduleReport(const QList<int>& data, unsigned int reportID) {
+    QByteArray temp;
+    temp.reserve(kReportIdSize + data.size());
+    // The report ID is the first byte of the scheduled message
+    temp.append(reportID);
+    for (const int datum : data) {
+        temp.append(datum);
+    }
+    scheduleMessage(reportID, temp);
+}
+
+void HidController::sendScheduledMessage(const QByteArray& message) {
+    VERIFY_OR_DEBUG_ASSERT(message.size() >= kReportIdSize) {
+        return;
+    }
+    sendBytesReport(message.mid(kReportIdSize),
+            static_cast<unsigned char>(message.at(0)));
+}
+
 void HidController::sendBytes(const QByteArray& data) {
     sendBytesReport(data, 0);
 }
@@ -321,6 +412,9 @@ void HidController::sendBytesReport(QByteArray data, unsigned int reportID) {
     // Append the Report ID to the beginning of data[] per the API..
     data.prepend(reportID);
 
+    // Also covers hid_error(), which returns the error of the last call
+    // for the device
+    HidDeviceLock::WriteLocker locked(&m_deviceLock);
     int result = hid_write(m_pHidDevice, (unsigned char*)data.constData(), data.size());
     if (result == -1) {
         if (ControllerDebug::enabled()) {
@@ -340,6 +434,9 @@ void HidController::sendBytesReport(QByteArray data, unsigned int reportID) {
 
 void HidController::sendFeatureReport(
         const QList<int>& dataList, unsigned int reportID) {
+    // Keep the order of the reports
+    flushScheduledMessages();
+
     QByteArray dataArray;
     dataArray.reserve(kReportIdSize + dataList.size());
 
@@ -350,6 +447,7 @@ void HidController::sendFeatureReport(
         dataArray.append(datum);
     }
 
+    HidDeviceLock::WriteLocker locked(&m_deviceLock);
     int result = hid_send_feature_report(m_pHidDevice,
             reinterpret_cast<const unsigned char*>(dataArray.constData()),
             dataArray.size());
@@ -11,12 +11,75 @@
 #include <hidapi.h>
 
 #include <QAtomicInt>
+#include <QThread>
 
 #include "controllers/controller.h"
 #include "controllers/hid/hidcontrollerpreset.h"
+#include "controllers/hid/hiddevicelock.h"
 #include "controllers/hid/hidcontrollerpresetfilehandler.h"
 #include "util/duration.h"
 
+/// Reads the input reports of a HID device in a separate thread. The thread
+/// waits in hid_read_timeout() until the device sends a report, instead of
+/// being woken up every few ms to poll the device.
+///
+/// hidapi can't interrupt a read that waits for the device, so the reader
+/// only wakes up after a timeout to check if it should stop.
+class HidReader : public QThread {
+    Q_OBJECT
+  public:
+    /// The device is locked during each read only if pDeviceLock is set.
+    /// See kReadsNeedDeviceLock.
+    HidReader(hid_device* pHidDevice, HidDeviceLock* pDeviceLock);
+    ~HidReader() override;
+
+    /// Returns immediately, the reader stops within kReadTimeoutMillis
+    void stop();
+
+    /// The reads of the Windows backend of hidapi can't run concurrently
+    /// with writes: Both replace the shared error string of the device on
+    /// failure, e.g. when it is unplugged. The read and write of the libusb,
+    /// hidraw and macOS backends are independent.
+    static constexpr bool kReadsNeedDeviceLock =
+#ifdef __WINDOWS__
+            true;
+#else
+            false;
+#endif
+
+    /// Bounds the time until the reader stops when the device doesn't send
+    /// anything
+    static constexpr int kReadTimeoutMillis = 250;
+    /// While the reader holds the device lock it lets pending writes go
+    /// first after this time, i.e. it is the longest time a write waits for
+    /// the device.
+    static constexpr int kLockedReadTimeoutMillis = 5;
+
+  signals:
+    /// The timestamp is taken when the report has been read
+    void incomingData(QByteArray data, mixxx::Duration timestamp);
+
+  protected:
+    void run() override;
+
+    /// Waits up to timeoutMillis for the next report. Returns the size of
+    /// the report, 0 after the timeout or -1 on error, like
+    /// hid_read_timeout(). Called while the device lock is held, if the
+    /// reader has one.
+    virtual int readReport(unsigned char* pData, int maxLength, int timeoutMillis);
+
+  private:
+    hid_device* const m_pHidDevice;
+    HidDeviceLock* const m_pDeviceLock;
+    QAtomicInt m_stop;
+
+    static constexpr int kNumBuffers = 2;
+    static constexpr int kBufferSize = 255;
+    unsigned char m_pPollData[kNumBuffers][kBufferSize];
+    int m_iLastPollSize;
+    int m_iPollingBufferIndex;
+};
+
 class HidController final : public Controller {
     Q_OBJECT
   public:
@@ -51,14 +114,19 @@ class HidController final : public Controller {
     static QString safeDecodeWideString(const wchar_t* pStr, size_t max_length);
 
   protected:
+    /// Sends the report immediately after all scheduled reports, i.e. in
+    /// the order of the calls.
     void sendReport(QList<int> data, unsigned int length, unsigned int reportID);
+    /// Sends the report with the next batch of feedback messages. Only the
+    /// latest report per report ID is sent.
+    void scheduleReport(const QList<int>& data, unsigned int reportID);
+    void sendScheduledMessage(const QByteArray& message) override;
 
   private slots:
     int open() override;
     int close() override;
 
-    bool poll() override;
-    bool isPolling() const override;
+    void slotIncomingData(QByteArray data, mixxx::Duration timestamp);
 
   private:
     // For devices which only support a single report, reportID must be set to
@@ -90,13 +158,10 @@ class HidController final : public Controller {
 
     QString m_sUID;
     hid_device* m_pHidDevice;
+    // Shared with the reader thread
+    HidDeviceLock m_deviceLock;
     HidControllerPreset m_preset;
-
-    static constexpr int kNumBuffers = 2;
-    static constexpr int kBufferSize = 255;
-    unsigned char m_pPollData[kNumBuffers][kBufferSize];
-    int m_iLastPollSize;
-    int m_iPollingBufferIndex;
+    HidReader* m_pReader;
 
     friend class HidControllerJSProxy;
 };
@@ -117,6 +182,13 @@ class HidControllerJSProxy : public ControllerJSProxy {
         m_pHidController->sendReport(data, length, reportID);
     }
 
+    // Opt-in for frequent state updates, e.g. LEDs that are sent in the
+    // same report: Only the latest report per report ID is sent with the
+    // next batch.
+    Q_INVOKABLE void scheduleReport(const QList<int>& data, unsigned int reportID) {
+        m_pHidController->scheduleReport(data, reportID);
+    }
+
     Q_INVOKABLE void sendFeatureReport(
             const QList<int>& dataList, unsigned int reportID) {
         m_pHidController->sendFeatureReport(dataList, reportID);
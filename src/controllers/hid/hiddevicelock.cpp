@@ -0,0 +1,34 @@
+#include "controllers/hid/hiddevicelock.h"
+
+#include "util/assert.h"
+
+HidDeviceLock::HidDeviceLock()
+        : m_pendingWriters(0) {
+}
+
+void HidDeviceLock::lockForRead() {
+    m_mutex.lock();
+    // A writer that is registered after this check waits for the read. It
+    // can only unregister while it holds the mutex, so the wake-up is not
+    // lost.
+    while (m_pendingWriters.loadAcquire() > 0) {
+        m_noPendingWriters.wait(&m_mutex);
+    }
+}
+
+void HidDeviceLock::unlockRead() {
+    m_mutex.unlock();
+}
+
+void HidDeviceLock::lockForWrite() {
+    m_pendingWriters.ref();
+    m_mutex.lock();
+}
+
+void HidDeviceLock::unlockWrite() {
+    DEBUG_ASSERT(m_pendingWriters.loadAcquire() > 0);
+    if (!m_pendingWriters.deref()) {
+        m_noPendingWriters.wakeAll();
+    }
+    m_mutex.unlock();
+}
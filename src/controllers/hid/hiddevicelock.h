@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+/// Serializes the calls to hidapi for a single device. hidapi is not
+/// thread-safe for the same device, but the HidReader thread waits for
+/// input reports while the controller thread sends output and feature
+/// reports.
+///
+/// Only backends that can't read and write concurrently need the read lock
+/// (see HidReader::kReadsNeedDeviceLock). The reader then holds it during a
+/// read with a short timeout and lets pending writers go first, i.e. a write
+/// waits for at most a single read that is already in progress.
+class HidDeviceLock {
+  public:
+    HidDeviceLock();
+
+    /// Waits until no writer is pending
+    void lockForRead();
+    void unlockRead();
+
+    void lockForWrite();
+    void unlockWrite();
+
+    class ReadLocker {
+      public:
+        explicit ReadLocker(HidDeviceLock* pLock)
+                : m_pLock(pLock) {
+            m_pLock->lockForRead();
+        }
+        ~ReadLocker() {
+            m_pLock->unlockRead();
+        }
+
+      private:
+        HidDeviceLock* const m_pLock;
+    };
+
+    class WriteLocker {
+      public:
+        explicit WriteLocker(HidDeviceLock* pLock)
+                : m_pLock(pLock) {
+            m_pLock->lockForWrite();
+        }
+        ~WriteLocker() {
+            m_pLock->unlockWrite();
+        }
+
+      private:
+        HidDeviceLock* const m_pLock;
+    };
+
+  private:
+    QMutex m_mutex;
+    QWaitCondition m_noPendingWriters;
+    // Writers that wait for the mutex or hold it
+    QAtomicInt m_pendingWriters;
+};
@@ -11,6 +11,7 @@
 #include "controllers/midi/midiutils.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/controllerdebug.h"
+#include "controllers/engine/controllerengine.h"
 #include "control/controlobject.h"
 #include "errordialoghandler.h"
 #include "mixer/playermanager.h"
@@ -41,6 +42,52 @@ void MidiController::visit(const MidiControllerPreset* preset) {
     emit presetLoaded(getPreset());
 }
 
+void MidiController::scheduleShortMsg(unsigned char status,
+        unsigned char byte1,
+        unsigned char byte2) {
+    quint32 key;
+    switch (MidiUtils::opCodeFromStatus(status)) {
+    case MIDI_NOTE_OFF:
+    case MIDI_NOTE_ON:
+        // Both set the state of the same note, e.g. an LED
+        key = ((MIDI_NOTE_ON | MidiUtils::channelFromStatus(status)) << 8) | byte1;
+        break;
+    case MIDI_AFTERTOUCH:
+    case MIDI_CC:
+        key = (status << 8) | byte1;
+        break;
+    case MIDI_CH_AFTERTOUCH:
+    case MIDI_PITCH_BEND:
+        key = status << 8;
+        break;
+    default:
+        // Program changes and system messages are not state updates
+        sendShortMsgInOrder(status, byte1, byte2);
+        return;
+    }
+    QByteArray message(3, 0);
+    message[0] = static_cast<char>(status);
+    message[1] = static_cast<char>(byte1);
+    message[2] = static_cast<char>(byte2);
+    scheduleMessage(key, message);
+}
+
+void MidiController::sendShortMsgInOrder(unsigned char status,
+        unsigned char byte1,
+        unsigned char byte2) {
+    flushScheduledMessages();
+    sendShortMsg(status, byte1, byte2);
+}
+
+void MidiController::sendScheduledMessage(const QByteArray& message) {
+    VERIFY_OR_DEBUG_ASSERT(message.size() == 3) {
+        return;
+    }
+    sendShortMsg(static_cast<unsigned char>(message[0]),
+            static_cast<unsigned char>(message[1]),
+            static_cast<unsigned char>(message[2]));
+}
+
 int MidiController::close() {
     destroyOutputHandlers();
     return 0;
@@ -280,6 +327,11 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
         return;
     }
 
+    if (mapping.options.scratch_touch || mapping.options.scratch_tick) {
+        processScratchMapping(mapping, opCode, value);
+        return;
+    }
+
     // Only pass values on to valid ControlObjects.
     ControlObject* pCO = ControlObject::getControl(mapping.control);
     if (pCO == NULL) {
@@ -334,6 +386,9 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
                 // ControlPotmeterBehavior for more fun of this variety :).
                 newValue = static_cast<double>(iValue) / 128.0;
                 newValue = math_min(newValue, 127.0);
+                if (mapping.options.invert) {
+                    newValue = 127.0 - newValue;
+                }
 
                 // Erase the queued message since we processed it.
                 m_fourteen_bit_queued_mappings.erase(it);
@@ -361,6 +416,9 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
         // ControlPotmeterBehavior for more fun of this variety :).
         newValue = static_cast<double>(iValue) / 128.0;
         newValue = math_min(newValue, 127.0);
+        if (mapping.options.invert) {
+            newValue = 127.0 - newValue;
+        }
     } else {
         double currControlValue = pCO->getMidiParameter();
         newValue = computeValue(mapping.options, currControlValue, value);
@@ -382,6 +440,57 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
     pCO->setValueFromMidi(static_cast<MidiOpCode>(opCode), newValue);
 }
 
+void MidiController::processScratchMapping(const MidiInputMapping& mapping,
+        unsigned char opCode,
+        unsigned char value) {
+    ControllerEngine* pEngine = getEngine();
+    if (pEngine == nullptr) {
+        return;
+    }
+    int deck = 0;
+    if (!PlayerManager::isDeckGroup(mapping.control.group, &deck)) {
+        qWarning() << "MidiController: Scratch mapping for"
+                   << mapping.control.group << "is not a deck";
+        return;
+    }
+
+    if (mapping.options.scratch_touch) {
+        const bool touched = value > 0 && opCode != MIDI_NOTE_OFF;
+        if (touched) {
+            pEngine->scratchEnable(deck,
+                    mapping.scratch.intervalsPerRev,
+                    mapping.scratch.rpm,
+                    mapping.scratch.alpha,
+                    mapping.scratch.beta,
+                    mapping.scratch.ramp);
+        } else {
+            pEngine->scratchDisable(deck, mapping.scratch.ramp);
+        }
+        return;
+    }
+
+    // scratch_tick
+    int interval;
+    if (mapping.options.selectknob) {
+        // 7-bit two's complement
+        interval = value < 64 ? value : value - 128;
+    } else {
+        interval = value - 64;
+    }
+    if (mapping.options.invert) {
+        interval = -interval;
+    }
+    if (pEngine->isScratching(deck)) {
+        pEngine->scratchTick(deck, interval);
+        return;
+    }
+    // Not touched, e.g. nudging with the edge of the jog wheel
+    ControlObject* pCO = ControlObject::getControl(mapping.control);
+    if (pCO != nullptr) {
+        pCO->set(pCO->get() + interval);
+    }
+}
+
 double MidiController::computeValue(
         MidiOptions options, double prevmidivalue, double newmidivalue) {
     double tempval = 0.;
@@ -60,6 +60,22 @@ class MidiController : public Controller {
             unsigned char byte1,
             unsigned char byte2) = 0;
 
+    /// Sends a short message with the next batch of feedback messages.
+    /// Channel voice messages replace a pending message for the same
+    /// note or control, all other messages are sent immediately.
+    void scheduleShortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2);
+
+    /// Sends a short message immediately after all scheduled messages,
+    /// i.e. in the order of the calls. Used for the messages of scripts,
+    /// e.g. NRPN sequences that must neither be coalesced nor reordered.
+    void sendShortMsgInOrder(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2);
+
+    void sendScheduledMessage(const QByteArray& message) override;
+
     /// Alias for send()
     /// The length parameter is here for backwards compatibility for when scripts
     /// were required to specify it.
@@ -97,6 +113,10 @@ class MidiController : public Controller {
     void processInputMapping(const MidiInputMapping& mapping,
                              const QByteArray& data,
                              mixxx::Duration timestamp);
+    /// Handles the scratch_touch and scratch_tick options without a script
+    void processScratchMapping(const MidiInputMapping& mapping,
+            unsigned char opCode,
+            unsigned char value);
 
     double computeValue(MidiOptions options, double _prevmidivalue, double _newmidivalue);
     void createOutputHandlers();
@@ -118,6 +138,7 @@ class MidiController : public Controller {
     // So it can access sendShortMsg()
     friend class MidiOutputHandler;
     friend class MidiControllerTest;
+    friend class ControllerMappingReplay;
     friend class MidiControllerJSProxy;
 };
 
@@ -132,7 +153,15 @@ class MidiControllerJSProxy : public ControllerJSProxy {
     Q_INVOKABLE void sendShortMsg(unsigned char status,
             unsigned char byte1,
             unsigned char byte2) {
-        m_pMidiController->sendShortMsg(status, byte1, byte2);
+        m_pMidiController->sendShortMsgInOrder(status, byte1, byte2);
+    }
+
+    // Opt-in for frequent state updates, e.g. LEDs or VU meters: Only the
+    // latest message per note or control is sent with the next batch.
+    Q_INVOKABLE void scheduleShortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2) {
+        m_pMidiController->scheduleShortMsg(status, byte1, byte2);
     }
 
     Q_INVOKABLE void sendSysexMsg(QList<int> data, unsigned int length = 0) {
@@ -14,6 +14,45 @@
 #define DEFAULT_OUTPUT_ON   0x7F
 #define DEFAULT_OUTPUT_OFF  0x00
 
+namespace {
+
+// Reads the optional attributes of <scratch-touch>, e.g.
+// <scratch-touch intervals-per-rev="512" rpm="33.33" alpha="0.125" beta="0.004" ramp="true"/>
+MidiScratchParameters scratchParametersFromXML(const QDomElement& element) {
+    MidiScratchParameters scratch;
+    bool ok = false;
+    int intervalsPerRev = element.attribute("intervals-per-rev").toInt(&ok);
+    if (ok) {
+        scratch.intervalsPerRev = intervalsPerRev;
+    }
+    double value = element.attribute("rpm").toDouble(&ok);
+    if (ok) {
+        scratch.rpm = value;
+    }
+    value = element.attribute("alpha").toDouble(&ok);
+    if (ok) {
+        scratch.alpha = value;
+    }
+    value = element.attribute("beta").toDouble(&ok);
+    if (ok) {
+        scratch.beta = value;
+    }
+    if (element.hasAttribute("ramp")) {
+        scratch.ramp = element.attribute("ramp").toLower() != "false";
+    }
+    return scratch;
+}
+
+void scratchParametersToXML(QDomElement* pElement, const MidiScratchParameters& scratch) {
+    pElement->setAttribute("intervals-per-rev", scratch.intervalsPerRev);
+    pElement->setAttribute("rpm", scratch.rpm);
+    pElement->setAttribute("alpha", scratch.alpha);
+    pElement->setAttribute("beta", scratch.beta);
+    pElement->setAttribute("ramp", scratch.ramp ? "true" : "false");
+}
+
+} // anonymous namespace
+
 ControllerPresetPointer MidiControllerPresetFileHandler::load(const QDomElement& root,
         const QString& filePath,
         const QDir& systemPresetsPath) {
@@ -64,6 +103,7 @@ ControllerPresetPointer MidiControllerPresetFileHandler::load(const QDomElement&
         QDomElement optionsNode = control.firstChildElement("options").firstChildElement();
 
         MidiOptions options;
+        MidiScratchParameters scratch;
 
         QString strMidiOption;
         while (!optionsNode.isNull()) {
@@ -85,6 +125,11 @@ ControllerPresetPointer MidiControllerPresetFileHandler::load(const QDomElement&
             if (strMidiOption == "script-binding") options.script = true;
             if (strMidiOption == "fourteen-bit-msb") options.fourteen_bit_msb = true;
             if (strMidiOption == "fourteen-bit-lsb") options.fourteen_bit_lsb = true;
+            if (strMidiOption == "scratch-touch") {
+                options.scratch_touch = true;
+                scratch = scratchParametersFromXML(optionsNode);
+            }
+            if (strMidiOption == "scratch-tick") options.scratch_tick = true;
 
             optionsNode = optionsNode.nextSiblingElement();
         }
@@ -94,6 +139,7 @@ ControllerPresetPointer MidiControllerPresetFileHandler::load(const QDomElement&
         mapping.control = ConfigKey(controlGroup, controlKey);
         mapping.description = controlDescription;
         mapping.options = options;
+        mapping.scratch = scratch;
         mapping.key = MidiKey(midiStatusByte, midiControl);
 
         // qDebug() << "New mapping:" << QString::number(mapping.key.key, 16).toUpper()
@@ -336,6 +382,15 @@ QDomElement MidiControllerPresetFileHandler::inputMappingToXML(
             QDomElement singleOption = doc->createElement("fourteen-bit-lsb");
             optionsNode.appendChild(singleOption);
         }
+        if (mapping.options.scratch_touch) {
+            QDomElement singleOption = doc->createElement("scratch-touch");
+            scratchParametersToXML(&singleOption, mapping.scratch);
+            optionsNode.appendChild(singleOption);
+        }
+        if (mapping.options.scratch_tick) {
+            QDomElement singleOption = doc->createElement("scratch-tick");
+            optionsNode.appendChild(singleOption);
+        }
     }
     controlNode.appendChild(optionsNode);
 
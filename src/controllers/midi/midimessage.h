@@ -57,8 +57,11 @@ typedef enum {
     MIDI_OPTION_SCRIPT        = 0x0800,
     MIDI_OPTION_14BIT_MSB     = 0x1000,
     MIDI_OPTION_14BIT_LSB     = 0x2000,
+    MIDI_OPTION_HERC_JOG_FAST = 0x4000,
+    MIDI_OPTION_SCRATCH_TOUCH = 0x8000,
+    MIDI_OPTION_SCRATCH_TICK  = 0x10000,
     // Should mask all bits used.
-    MIDI_OPTION_MASK          = 0xFFFF,
+    MIDI_OPTION_MASK          = 0x1FFFF,
 } MidiOption;
 
 struct MidiOptions {
@@ -92,7 +95,14 @@ struct MidiOptions {
             // the message supplies the LSB of a 14-bit message
             bool fourteen_bit_lsb : 1;
             bool herc_jog_fast    : 1;  // generic Hercules range correction 0x01 -> +5; 0x7f -> -5
-            // 19 more available for future expansion
+            // touching (!=00) and releasing (00) the jog wheel of the deck
+            // in the group enables and disables scratching
+            bool scratch_touch    : 1;
+            // relative jog wheel movement, centered at 64 (or signed with
+            // selectknob), that scratches the deck in the group while it is
+            // touched and is added to the control otherwise
+            bool scratch_tick     : 1;
+            // 15 more available for future expansion
         };
     };
 };
@@ -145,6 +155,35 @@ struct MidiKey {
     };
 };
 
+/// The parameters of the scratch_touch option, see
+/// ControllerEngine::scratchEnable()
+struct MidiScratchParameters {
+    MidiScratchParameters()
+            : intervalsPerRev(128),
+              rpm(33.0 + 1.0 / 3.0),
+              alpha(1.0 / 8.0),
+              beta(1.0 / 8.0 / 32.0),
+              ramp(true) {
+    }
+
+    bool operator==(const MidiScratchParameters& other) const {
+        return intervalsPerRev == other.intervalsPerRev && rpm == other.rpm &&
+                alpha == other.alpha && beta == other.beta && ramp == other.ramp;
+    }
+
+    bool isValid() const {
+        return intervalsPerRev > 0 && rpm > 0.0 &&
+                alpha > 0.0 && alpha <= 1.0 &&
+                beta >= 0.0 && beta <= 1.0;
+    }
+
+    int intervalsPerRev;
+    double rpm;
+    double alpha;
+    double beta;
+    bool ramp;
+};
+
 struct MidiInputMapping {
     MidiInputMapping() {
     }
@@ -172,13 +211,15 @@ struct MidiInputMapping {
 
     bool operator==(const MidiInputMapping& other) const {
         return key == other.key && options == other.options &&
-                control == other.control && description == other.description;
+                control == other.control && description == other.description &&
+                scratch == other.scratch;
     }
 
     MidiKey key;
     MidiOptions options;
     ConfigKey control;
     QString description;
+    MidiScratchParameters scratch;
 };
 typedef QList<MidiInputMapping> MidiInputMappings;
 
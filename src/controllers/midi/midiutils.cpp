@@ -60,6 +60,12 @@ QString MidiUtils::midiOptionToTranslatedString(MidiOption option) {
             return QObject::tr("14-bit (LSB)");
         case MIDI_OPTION_14BIT_MSB:
             return QObject::tr("14-bit (MSB)");
+        case MIDI_OPTION_HERC_JOG_FAST:
+            return QObject::tr("HercJogFast");
+        case MIDI_OPTION_SCRATCH_TOUCH:
+            return QObject::tr("Scratch (Touch)");
+        case MIDI_OPTION_SCRATCH_TICK:
+            return QObject::tr("Scratch (Jog)");
         default:
             return QObject::tr("Unknown (0x%1)")
                     .arg(option, 4, 16, QLatin1Char('0'));
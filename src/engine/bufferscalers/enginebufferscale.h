@@ -55,8 +55,29 @@ class EngineBufferScale : public QObject {
         return m_outputSignal;
     }
 
+    // Allocates and frees the memory that is only needed for playing a
+    // track. Called by EngineBuffer from the GUI thread while the engine
+    // does not process the deck. A scaler without buffers outputs silence.
+    virtual void allocateBuffers() {
+    }
+    virtual void releaseBuffers() {
+    }
+
     // Called from EngineBuffer when seeking, to ensure the buffers are flushed */
     virtual void clear() = 0;
+    // Called from EngineBuffer instead of clear() when seeking during
+    // playback. A scaler that fades from the previous to the new position by
+    // itself flushes its buffers and returns true. Otherwise nothing is done
+    // and EngineBuffer renders an extra buffer at the previous position for
+    // crossfading before calling clear().
+    virtual bool clearWithCrossfade() {
+        return false;
+    }
+    // The delay between the input and the output of the scaler in output
+    // frames
+    virtual double getLatencyFrames() const {
+        return 0.0;
+    }
     // Scale buffer
     // Returns the number of frames that have bean read from the unscaled
     // input buffer The number of frames copied to the output buffer is always
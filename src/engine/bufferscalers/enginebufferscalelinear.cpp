@@ -1,23 +1,134 @@
 #include "engine/bufferscalers/enginebufferscalelinear.h"
 
 #include <QtDebug>
+#include <cstdint>
 
 #include "track/keyutils.h"
 #include "util/assert.h"
 #include "util/math.h"
 #include "util/sample.h"
 
+namespace {
+
+// The read position of the kernels is a fixed-point number of frames with
+// this number of fractional bits, i.e. it can be advanced without
+// accumulating floating-point rounding errors.
+constexpr int kFractionBits = 32;
+constexpr double kFixedPointOne = static_cast<double>(int64_t(1) << kFractionBits);
+constexpr CSAMPLE kFractionToSample = static_cast<CSAMPLE>(1.0 / kFixedPointOne);
+
+// The kernels first gather the taps of a block of frames and then
+// interpolate the whole block at once. Only the interpolation is vectorized,
+// because the taps are not contiguous for arbitrary rates.
+constexpr SINT kKernelBlockFrames = 64;
+
+struct FixedPointPhase {
+    int64_t position;
+    // Added to the position after each frame
+    int64_t step;
+    // Added to the step after each frame, for ramping the rate
+    int64_t stepDelta;
+};
+
+inline CSAMPLE fixedPointFraction(int64_t position) {
+    return static_cast<CSAMPLE>(static_cast<uint32_t>(position)) * kFractionToSample;
+}
+
+// laurent de soras - punked from musicdsp.org (mad props)
+inline float hermite4(float frac_pos, float xm1, float x0, float x1, float x2)
+{
+    const float c = (x1 - xm1) * 0.5f;
+    const float v = x0 - x1;
+    const float w = c + v;
+    const float a = w + v + (x2 - x0) * 0.5f;
+    const float b_neg = w + a;
+    return ((((a * frac_pos) - b_neg) * frac_pos + c) * frac_pos + x0);
+}
+
+// Interpolates stereo frames from pInput at the positions of pPhase. The
+// caller guarantees that the frame after the last position is in pInput.
+void resampleLinear(CSAMPLE* pOutput, const CSAMPLE* pInput,
+        SINT frames, FixedPointPhase* pPhase) {
+    CSAMPLE frac[kKernelBlockFrames];
+    CSAMPLE floorSample[2][kKernelBlockFrames];
+    CSAMPLE ceilSample[2][kKernelBlockFrames];
+    int64_t position = pPhase->position;
+    int64_t step = pPhase->step;
+    const int64_t stepDelta = pPhase->stepDelta;
+    while (frames > 0) {
+        const SINT blockFrames = math_min(frames, kKernelBlockFrames);
+        for (SINT j = 0; j < blockFrames; ++j) {
+            const SINT sample = static_cast<SINT>(position >> kFractionBits) * 2;
+            frac[j] = fixedPointFraction(position);
+            floorSample[0][j] = pInput[sample];
+            floorSample[1][j] = pInput[sample + 1];
+            ceilSample[0][j] = pInput[sample + 2];
+            ceilSample[1][j] = pInput[sample + 3];
+            position += step;
+            step += stepDelta;
+        }
+        // note: LOOP VECTORIZED.
+        for (SINT j = 0; j < blockFrames; ++j) {
+            pOutput[j * 2] = floorSample[0][j] +
+                    frac[j] * (ceilSample[0][j] - floorSample[0][j]);
+            pOutput[j * 2 + 1] = floorSample[1][j] +
+                    frac[j] * (ceilSample[1][j] - floorSample[1][j]);
+        }
+        pOutput += blockFrames * 2;
+        frames -= blockFrames;
+    }
+    pPhase->position = position;
+    pPhase->step = step;
+}
+
+// Like resampleLinear(), but the frames before and two frames after each
+// position need to be in pInput.
+void resampleCubic(CSAMPLE* pOutput, const CSAMPLE* pInput,
+        SINT frames, FixedPointPhase* pPhase) {
+    CSAMPLE frac[kKernelBlockFrames];
+    CSAMPLE taps[4][2][kKernelBlockFrames];
+    int64_t position = pPhase->position;
+    int64_t step = pPhase->step;
+    const int64_t stepDelta = pPhase->stepDelta;
+    while (frames > 0) {
+        const SINT blockFrames = math_min(frames, kKernelBlockFrames);
+        for (SINT j = 0; j < blockFrames; ++j) {
+            const SINT sample = static_cast<SINT>(position >> kFractionBits) * 2 - 2;
+            frac[j] = fixedPointFraction(position);
+            for (int tap = 0; tap < 4; ++tap) {
+                taps[tap][0][j] = pInput[sample + tap * 2];
+                taps[tap][1][j] = pInput[sample + tap * 2 + 1];
+            }
+            position += step;
+            step += stepDelta;
+        }
+        // note: LOOP VECTORIZED.
+        for (SINT j = 0; j < blockFrames; ++j) {
+            pOutput[j * 2] = hermite4(frac[j],
+                    taps[0][0][j], taps[1][0][j], taps[2][0][j], taps[3][0][j]);
+            pOutput[j * 2 + 1] = hermite4(frac[j],
+                    taps[0][1][j], taps[1][1][j], taps[2][1][j], taps[3][1][j]);
+        }
+        pOutput += blockFrames * 2;
+        frames -= blockFrames;
+    }
+    pPhase->position = position;
+    pPhase->step = step;
+}
+
+} // anonymous namespace
+
 EngineBufferScaleLinear::EngineBufferScaleLinear(ReadAheadManager *pReadAheadManager)
     : m_pReadAheadManager(pReadAheadManager),
       m_bufferInt(SampleUtil::alloc(kiLinearScaleReadAheadLength)),
       m_bufferIntSize(0),
+      m_interpolation(Interpolation::Linear),
       m_bClear(false),
       m_dRate(1.0),
       m_dOldRate(1.0),
       m_dCurrentFrame(0.0),
       m_dNextFrame(0.0) {
-    m_floorSampleOld[0] = 0.0;
-    m_floorSampleOld[1] = 0.0;
+    SampleUtil::clear(m_bufferIntHistory, kiLinearScaleHistoryFrames * 2);
     SampleUtil::clear(m_bufferInt, kiLinearScaleReadAheadLength);
 }
 
@@ -39,19 +150,70 @@ void EngineBufferScaleLinear::clear() {
     // Clear out buffer and saved sample data
     m_bufferIntSize = 0;
     m_dNextFrame = 0;
-    m_floorSampleOld[0] = 0;
-    m_floorSampleOld[1] = 0;
+    SampleUtil::clear(m_bufferIntHistory, kiLinearScaleHistoryFrames * 2);
 }
 
-// laurent de soras - punked from musicdsp.org (mad props)
-inline float hermite4(float frac_pos, float xm1, float x0, float x1, float x2)
-{
-    const float c = (x1 - xm1) * 0.5f;
-    const float v = x0 - x1;
-    const float w = c + v;
-    const float a = w + v + (x2 - x0) * 0.5f;
-    const float b_neg = w + a;
-    return ((((a * frac_pos) - b_neg) * frac_pos + c) * frac_pos + x0);
+CSAMPLE EngineBufferScaleLinear::bufferedSample(SINT frame, int channel) const {
+    if (frame >= 0) {
+        return m_bufferInt[getOutputSignal().frames2samples(frame) + channel];
+    }
+    // frame -1 is the last frame of the history
+    SINT historyFrame = math_max<SINT>(kiLinearScaleHistoryFrames + frame, 0);
+    return m_bufferIntHistory[historyFrame * 2 + channel];
+}
+
+void EngineBufferScaleLinear::appendToHistory(
+        const CSAMPLE* pBuffer, SINT numSamples) {
+    const SINT newFrames = math_min<SINT>(
+            numSamples / 2, kiLinearScaleHistoryFrames);
+    if (newFrames <= 0) {
+        return;
+    }
+    const SINT keptSamples = (kiLinearScaleHistoryFrames - newFrames) * 2;
+    for (SINT i = 0; i < keptSamples; ++i) {
+        m_bufferIntHistory[i] = m_bufferIntHistory[i + newFrames * 2];
+    }
+    SampleUtil::copy(&m_bufferIntHistory[keptSamples],
+            &pBuffer[numSamples - newFrames * 2],
+            newFrames * 2);
+}
+
+SINT EngineBufferScaleLinear::scaleBufferedFrames(CSAMPLE* buf, SINT maxFrames,
+        double rate, double rateDelta, SINT tapsAfter) {
+    FixedPointPhase phase;
+    phase.position = static_cast<int64_t>(m_dCurrentFrame * kFixedPointOne);
+    phase.step = math_max<int64_t>(llround(rate * kFixedPointOne), 0);
+    phase.stepDelta = llround(rateDelta * kFixedPointOne);
+    // Rounding must not turn the end of a ramp down to zero into a
+    // backwards movement
+    if (maxFrames > 1 && phase.step + (maxFrames - 1) * phase.stepDelta < 0) {
+        phase.stepDelta = -phase.step / (maxFrames - 1);
+    }
+
+    // Limit the frames to those whose taps are all in the buffer
+    const SINT lastFloor =
+            getOutputSignal().samples2frames(m_bufferIntSize) - 1 - tapsAfter;
+    const int64_t distance =
+            (static_cast<int64_t>(lastFloor + 1) << kFractionBits) - 1 -
+            phase.position;
+    const int64_t maxStep = math_max<int64_t>(phase.step,
+            phase.step + (maxFrames - 1) * phase.stepDelta);
+    SINT frames = maxFrames;
+    if (maxStep > 0) {
+        frames = static_cast<SINT>(math_min<int64_t>(frames, distance / maxStep + 1));
+    }
+    DEBUG_ASSERT(frames > 0);
+
+    if (m_interpolation == Interpolation::Cubic) {
+        resampleCubic(buf, m_bufferInt, frames, &phase);
+    } else {
+        resampleLinear(buf, m_bufferInt, frames, &phase);
+    }
+
+    // The phase has been advanced beyond the last frame
+    m_dCurrentFrame = (phase.position - (phase.step - phase.stepDelta)) / kFixedPointOne;
+    m_dNextFrame = phase.position / kFixedPointOne;
+    return frames;
 }
 
 // Determine if we're changing directions (scratching) and then perform
@@ -81,13 +243,26 @@ double EngineBufferScaleLinear::scaleBuffer(
         m_dRate = 0.0;
         frames_read += do_scale(pOutputBuffer, getOutputSignal().samples2frames(iOutputBufferSize));
 
-        // reset m_floorSampleOld in a way as we were coming from
+        // reset the history in a way as we were coming from
         // the other direction
-        SINT iNextSample = getOutputSignal().frames2samples(static_cast<SINT>(ceil(m_dNextFrame)));
-        if (iNextSample + 1 < m_bufferIntSize) {
-            m_floorSampleOld[0] = m_bufferInt[iNextSample];
-            m_floorSampleOld[1] = m_bufferInt[iNextSample + 1];
+        SINT iNextFrame = static_cast<SINT>(ceil(m_dNextFrame));
+        // Frames beyond the buffer repeat the last one, starting with the
+        // floor sample of the current position.
+        const SINT iCurrentFrameFloor = static_cast<SINT>(floor(m_dCurrentFrame));
+        CSAMPLE history[kiLinearScaleHistoryFrames * 2];
+        CSAMPLE historySample[2] = {
+                bufferedSample(iCurrentFrameFloor, 0),
+                bufferedSample(iCurrentFrameFloor, 1)};
+        for (SINT frame = kiLinearScaleHistoryFrames - 1; frame >= 0; --frame) {
+            if (getOutputSignal().frames2samples(iNextFrame) + 1 < m_bufferIntSize) {
+                historySample[0] = bufferedSample(iNextFrame, 0);
+                historySample[1] = bufferedSample(iNextFrame, 1);
+            }
+            history[frame * 2] = historySample[0];
+            history[frame * 2 + 1] = historySample[1];
+            ++iNextFrame;
         }
+        SampleUtil::copy(m_bufferIntHistory, history, kiLinearScaleHistoryFrames * 2);
 
         // if the buffer has extra samples, do a read so RAMAN ends up back where
         // it should be
@@ -168,10 +343,7 @@ SINT EngineBufferScaleLinear::do_copy(CSAMPLE* buf, SINT buf_size) {
     // blow away the fractional sample position here
     m_bufferIntSize = 0; // force buffer read
     m_dNextFrame = 0;
-    if (read_samples > 1) {
-        m_floorSampleOld[0] = buf[read_samples - 2];
-        m_floorSampleOld[1] = buf[read_samples - 1];
-    }
+    appendToHistory(buf, read_samples);
     return read_samples;
 }
 
@@ -220,13 +392,6 @@ SINT EngineBufferScaleLinear::do_scale(CSAMPLE* buf, SINT buf_size) {
             m_dNextFrame - floor(m_dNextFrame));
 
     int read_failed_count = 0;
-    CSAMPLE floor_sample[2];
-    CSAMPLE ceil_sample[2];
-
-    floor_sample[0] = 0;
-    floor_sample[1] = 0;
-    ceil_sample[0] = 0;
-    ceil_sample[1] = 0;
 
     SINT frames_read = 0;
     SINT i = 0;
@@ -236,6 +401,11 @@ SINT EngineBufferScaleLinear::do_scale(CSAMPLE* buf, SINT buf_size) {
     const double rate_delta_abs =
             rate_old < 0 || rate_new < 0 ? -rate_delta : rate_delta;
 
+    // The frames around the current position that are interpolated
+    const bool cubic = m_interpolation == Interpolation::Cubic;
+    const SINT tapsBefore = cubic ? 1 : 0;
+    const SINT tapsAfter = cubic ? 2 : 1;
+
     // Hot frame loop
     while (i < buf_size) {
         // shift indices
@@ -244,37 +414,37 @@ SINT EngineBufferScaleLinear::do_scale(CSAMPLE* buf, SINT buf_size) {
         // Because our index is a float value, we're going to be interpolating
         // between two samples, a lower (prev) and upper (cur) sample.
         // If the lower sample is off the end of the buffer (values between
-        // -.999 and 0), load it from the saved globals.
-
-        // The first bounds check (< m_bufferIntSize) is probably not needed.
-
+        // -.999 and 0), load it from the history.
         SINT currentFrameFloor = static_cast<SINT>(floor(m_dCurrentFrame));
 
-        if (currentFrameFloor < 0) {
-            // we have advanced to a new buffer in the previous run,
-            // but the floor still points to the old buffer
-            // so take the cached sample, this happens on slow rates
-            floor_sample[0] = m_floorSampleOld[0];
-            floor_sample[1] = m_floorSampleOld[1];
-            ceil_sample[0] = m_bufferInt[0];
-            ceil_sample[1] = m_bufferInt[1];
-        } else if (getOutputSignal().frames2samples(currentFrameFloor) + 3 < m_bufferIntSize) {
-            // take floor_sample form the buffer of the previous run
-            floor_sample[0] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor)];
-            floor_sample[1] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 1];
-            ceil_sample[0] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 2];
-            ceil_sample[1] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 3];
-        } else {
-            // if we don't have the ceil_sample in buffer, load some more
-
-            if (getOutputSignal().frames2samples(currentFrameFloor) + 1 < m_bufferIntSize) {
-                // take floor_sample form the buffer of the previous run
-                floor_sample[0] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor)];
-                floor_sample[1] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 1];
-            }
+        const SINT remainingFrames = getOutputSignal().samples2frames(buf_size - i);
+        if (remainingFrames > 0 &&
+                currentFrameFloor - tapsBefore >= 0 &&
+                getOutputSignal().frames2samples(currentFrameFloor + tapsAfter) + 1 <
+                        m_bufferIntSize) {
+            // All taps are in the buffer, process as many frames as
+            // possible at once.
+            const SINT frames = scaleBufferedFrames(&buf[i],
+                    remainingFrames,
+                    rate_add,
+                    rate_delta_abs,
+                    tapsAfter);
+            rate_add += rate_delta_abs * frames;
+            i += getOutputSignal().frames2samples(frames);
+            continue;
+        }
 
+        if (getOutputSignal().frames2samples(currentFrameFloor + tapsAfter) + 1 >=
+                m_bufferIntSize) {
+            // if we don't have the ceil_sample in buffer, load some more
             do {
-                SINT old_bufsize = m_bufferIntSize;
+                // The frames of the previous buffer remain available
+                // for interpolation
+                appendToHistory(m_bufferInt, m_bufferIntSize);
+                // adapt the m_dCurrentFrame the index of the new buffer
+                m_dCurrentFrame -= getOutputSignal().samples2frames(m_bufferIntSize);
+                currentFrameFloor = static_cast<SINT>(floor(m_dCurrentFrame));
+
                 if (unscaled_frames_needed == 0) {
                     // protection against infinite loop
                     // This may happen due to double precision issues
@@ -299,38 +469,33 @@ SINT EngineBufferScaleLinear::do_scale(CSAMPLE* buf, SINT buf_size) {
 
                 frames_read += getOutputSignal().samples2frames(m_bufferIntSize);
                 unscaled_frames_needed -= getOutputSignal().samples2frames(m_bufferIntSize);
-
-                // adapt the m_dCurrentFrame the index of the new buffer
-                m_dCurrentFrame -= getOutputSignal().samples2frames(old_bufsize);
-                currentFrameFloor = static_cast<SINT>(floor(m_dCurrentFrame));
-            } while (getOutputSignal().frames2samples(currentFrameFloor) + 3 >= m_bufferIntSize);
+            } while (getOutputSignal().frames2samples(currentFrameFloor + tapsAfter) + 1 >=
+                    m_bufferIntSize);
 
             // I guess?
             if (read_failed_count > 1) {
                 break;
             }
-
-            // Now that the buffer is up to date, we can get the value of the sample
-            // at the floor of our position.
-            if (currentFrameFloor >= 0) {
-                // the previous position is in the new buffer
-                floor_sample[0] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor)];
-                floor_sample[1] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 1];
-            }
-            ceil_sample[0] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 2];
-            ceil_sample[1] = m_bufferInt[getOutputSignal().frames2samples(currentFrameFloor) + 3];
         }
 
         // For the current index, what percentage is it
         // between the previous and the next?
         CSAMPLE frac = static_cast<CSAMPLE>(m_dCurrentFrame) - currentFrameFloor;
 
-        // Perform linear interpolation
-        buf[i] = floor_sample[0] + frac * (ceil_sample[0] - floor_sample[0]);
-        buf[i + 1] = floor_sample[1] + frac * (ceil_sample[1] - floor_sample[1]);
-
-        m_floorSampleOld[0] = floor_sample[0];
-        m_floorSampleOld[1] = floor_sample[1];
+        for (int channel = 0; channel < 2; ++channel) {
+            const CSAMPLE floor_sample = bufferedSample(currentFrameFloor, channel);
+            const CSAMPLE ceil_sample = bufferedSample(currentFrameFloor + 1, channel);
+            if (cubic) {
+                buf[i + channel] = hermite4(frac,
+                        bufferedSample(currentFrameFloor - 1, channel),
+                        floor_sample,
+                        ceil_sample,
+                        bufferedSample(currentFrameFloor + 2, channel));
+            } else {
+                // Perform linear interpolation
+                buf[i + channel] = floor_sample + frac * (ceil_sample - floor_sample);
+            }
+        }
 
         // increment the index for the next loop
         m_dNextFrame = m_dCurrentFrame + rate_add;
@@ -6,10 +6,23 @@
 
 /** Number of samples to read ahead */
 const int kiLinearScaleReadAheadLength = 10240;
+/** Number of frames preceding the read ahead buffer that are kept for
+ * interpolating across buffer boundaries */
+const int kiLinearScaleHistoryFrames = 3;
 
 
+// Resamples with a fixed-point read position. Frames whose interpolation
+// taps are all within the read ahead buffer are processed in blocks by a
+// vectorized kernel, only the frames around buffer boundaries take the
+// per-frame path.
 class EngineBufferScaleLinear : public EngineBufferScale  {
   public:
+    enum class Interpolation {
+        Linear,
+        // 4-point Hermite interpolation, about twice the cost of Linear
+        Cubic,
+    };
+
     explicit EngineBufferScaleLinear(
             ReadAheadManager *pReadAheadManager);
     ~EngineBufferScaleLinear() override;
@@ -23,11 +36,25 @@ class EngineBufferScaleLinear : public EngineBufferScale  {
                             double* pTempoRatio,
                              double* pPitchRatio) override;
 
+    void setInterpolation(Interpolation interpolation) {
+        m_interpolation = interpolation;
+    }
+    Interpolation getInterpolation() const {
+        return m_interpolation;
+    }
+
   private:
     void onSampleRateChanged() override {}
 
     SINT do_scale(CSAMPLE* buf, SINT buf_size);
     SINT do_copy(CSAMPLE* buf, SINT buf_size);
+    SINT scaleBufferedFrames(CSAMPLE* buf, SINT maxFrames,
+            double rate, double rateDelta, SINT tapsAfter);
+
+    // Returns a sample of m_bufferInt or, for negative frames, of the frames
+    // that preceded it
+    CSAMPLE bufferedSample(SINT frame, int channel) const;
+    void appendToHistory(const CSAMPLE* pBuffer, SINT numSamples);
 
     // The read-ahead manager that we use to fetch samples
     ReadAheadManager* m_pReadAheadManager;
@@ -36,7 +63,10 @@ class EngineBufferScaleLinear : public EngineBufferScale  {
     CSAMPLE* m_bufferInt;
     SINT m_bufferIntSize;
 
-    CSAMPLE m_floorSampleOld[2];
+    // The last frames before the start of m_bufferInt, oldest first
+    CSAMPLE m_bufferIntHistory[kiLinearScaleHistoryFrames * 2];
+
+    Interpolation m_interpolation;
 
     bool m_bClear;
     double m_dRate;
@@ -3,8 +3,11 @@
 #include <rubberband/RubberBandStretcher.h>
 
 #include <QtDebug>
+#include <atomic>
+#include <cmath>
 
 #include "control/controlobject.h"
+#include "control/controlproxy.h"
 #include "engine/readaheadmanager.h"
 #include "track/keyutils.h"
 #include "util/counter.h"
@@ -19,24 +22,66 @@ namespace {
 // This is the default increment from RubberBand 1.8.1.
 size_t kRubberBandBlockSize = 256;
 
+// m_buffer_back and m_retrieve_buffer
+constexpr qint64 kBufferBytes = 3 * MAX_BUFFER_LEN * sizeof(CSAMPLE);
+
+std::atomic<qint64> s_allocatedBufferBytes(0);
+
 }  // namespace
 
 EngineBufferScaleRubberBand::EngineBufferScaleRubberBand(
         ReadAheadManager* pReadAheadManager)
         : m_pReadAheadManager(pReadAheadManager),
-          m_buffer_back(SampleUtil::alloc(MAX_BUFFER_LEN)),
+          m_fadeOutPending(false),
+          m_pPreroll(new ControlProxy("[Master]", "keylock_preroll", this)),
+          m_pCrossfade(new ControlProxy("[Master]", "keylock_crossfade", this)),
+          m_primePending(false),
+          m_remainingPaddingInOutput(0),
+          m_buffer_back(nullptr),
           m_bBackwards(false) {
+    m_retrieve_buffer[0] = nullptr;
+    m_retrieve_buffer[1] = nullptr;
+}
+
+EngineBufferScaleRubberBand::~EngineBufferScaleRubberBand() {
+    releaseBuffers();
+}
+
+//static
+qint64 EngineBufferScaleRubberBand::allocatedBufferBytes() {
+    return s_allocatedBufferBytes.load();
+}
+
+void EngineBufferScaleRubberBand::allocateBuffers() {
+    if (m_buffer_back) {
+        return;
+    }
+    m_buffer_back = SampleUtil::alloc(MAX_BUFFER_LEN);
     m_retrieve_buffer[0] = SampleUtil::alloc(MAX_BUFFER_LEN);
     m_retrieve_buffer[1] = SampleUtil::alloc(MAX_BUFFER_LEN);
+    s_allocatedBufferBytes += kBufferBytes;
     // Initialize the internal buffers to prevent re-allocations
-    // in the real-time thread.
+    // in the real-time thread. Deferred until the sample rate is
+    // known otherwise.
     onSampleRateChanged();
 }
 
-EngineBufferScaleRubberBand::~EngineBufferScaleRubberBand() {
+void EngineBufferScaleRubberBand::releaseBuffers() {
+    if (!m_buffer_back) {
+        return;
+    }
+    m_pRubberBand.reset();
+    m_pFadingRubberBand.reset();
+    m_fadeOutPending = false;
+    m_primePending = false;
+    m_remainingPaddingInOutput = 0;
     SampleUtil::free(m_buffer_back);
     SampleUtil::free(m_retrieve_buffer[0]);
     SampleUtil::free(m_retrieve_buffer[1]);
+    m_buffer_back = nullptr;
+    m_retrieve_buffer[0] = nullptr;
+    m_retrieve_buffer[1] = nullptr;
+    s_allocatedBufferBytes -= kBufferBytes;
 }
 
 void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
@@ -64,6 +109,14 @@ void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
     // no-op.
     double pitchScale = fabs(base_rate * *pPitchRatio);
 
+    if (!m_pRubberBand) {
+        // Buffers have been released, scaleBuffer() outputs silence
+        m_dBaseRate = base_rate;
+        m_dTempoRatio = speed_abs;
+        m_dPitchRatio = *pPitchRatio;
+        return;
+    }
+
     if (pitchScale > 0) {
         //qDebug() << "EngineBufferScaleRubberBand setPitchScale" << *pitch << pitchScale;
         m_pRubberBand->setPitchScale(pitchScale);
@@ -100,36 +153,177 @@ void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
     m_dPitchRatio = *pPitchRatio;
 }
 
+std::unique_ptr<RubberBandStretcher>
+EngineBufferScaleRubberBand::createStretcher() const {
+    auto pStretcher = std::make_unique<RubberBandStretcher>(
+            getOutputSignal().getSampleRate(),
+            getOutputSignal().getChannelCount(),
+            RubberBandStretcher::OptionProcessRealTime);
+    pStretcher->setMaxProcessSize(kRubberBandBlockSize);
+    // Setting the time ratio to a very high value will cause RubberBand
+    // to preallocate buffers large enough to (almost certainly)
+    // avoid memory reallocations during playback.
+    pStretcher->setTimeRatio(2.0);
+    pStretcher->setTimeRatio(1.0);
+    return pStretcher;
+}
+
 void EngineBufferScaleRubberBand::onSampleRateChanged() {
     // TODO: Resetting the sample rate will cause internal
     // memory allocations that may block the real-time thread.
     // When is this function actually invoked??
-    if (!getOutputSignal().isValid()) {
+    m_fadeOutPending = false;
+    m_primePending = false;
+    m_remainingPaddingInOutput = 0;
+    if (!getOutputSignal().isValid() || !m_buffer_back) {
         m_pRubberBand.reset();
+        m_pFadingRubberBand.reset();
         return;
     }
-    m_pRubberBand = std::make_unique<RubberBandStretcher>(
-            getOutputSignal().getSampleRate(),
-            getOutputSignal().getChannelCount(),
-            RubberBandStretcher::OptionProcessRealTime);
-    m_pRubberBand->setMaxProcessSize(kRubberBandBlockSize);
-    // Setting the time ratio to a very high value will cause RubberBand
-    // to preallocate buffers large enough to (almost certainly)
-    // avoid memory reallocations during playback.
-    m_pRubberBand->setTimeRatio(2.0);
-    m_pRubberBand->setTimeRatio(1.0);
+    m_pRubberBand = createStretcher();
+    // Allocated upfront, because the stretchers are swapped in the
+    // real-time thread when seeking.
+    m_pFadingRubberBand = createStretcher();
 }
 
 void EngineBufferScaleRubberBand::clear() {
-    VERIFY_OR_DEBUG_ASSERT(m_pRubberBand) {
+    if (!m_pRubberBand) {
         return;
     }
+    if (m_fadeOutPending) {
+        m_pFadingRubberBand->reset();
+        m_fadeOutPending = false;
+    }
+    resetStretcher();
+}
+
+bool EngineBufferScaleRubberBand::clearWithCrossfade() {
+    if (!m_pRubberBand) {
+        return false;
+    }
+    if (!m_pCrossfade->toBool() || m_fadeOutPending) {
+        // Only a single fade at a time, e.g. when seeking repeatedly
+        // within a single callback.
+        return false;
+    }
+    m_pRubberBand.swap(m_pFadingRubberBand);
+    m_pRubberBand->setTimeRatio(m_pFadingRubberBand->getTimeRatio());
+    m_pRubberBand->setPitchScale(m_pFadingRubberBand->getPitchScale());
+    resetStretcher();
+    m_fadeOutPending = true;
+    return true;
+}
+
+double EngineBufferScaleRubberBand::getLatencyFrames() const {
+    if (!m_pRubberBand) {
+        return 0.0;
+    }
+    return m_pRubberBand->getLatency();
+}
+
+void EngineBufferScaleRubberBand::resetStretcher() {
     m_pRubberBand->reset();
+    m_remainingPaddingInOutput = 0;
+    // The preroll is read on the next call of scaleBuffer(), i.e. after
+    // EngineBuffer has updated the read position of the ReadAheadManager.
+    m_primePending = m_pPreroll->toBool();
+}
+
+void EngineBufferScaleRubberBand::primeStretcher() {
+    m_primePending = false;
+    const SINT latency = static_cast<SINT>(m_pRubberBand->getLatency());
+    if (latency <= 0) {
+        return;
+    }
+    // The input that is needed to fill the delay of the stretcher. After
+    // dropping the latency the output is aligned with the start of the
+    // preroll, i.e. the stretched preroll needs to be dropped as well.
+    SINT paddingFrames = static_cast<SINT>(
+            std::ceil(latency * m_pRubberBand->getPitchScale()));
+    paddingFrames = math_min(paddingFrames,
+            getOutputSignal().samples2frames(MAX_BUFFER_LEN));
+    // Silence if the preroll is not cached, e.g. at the start of the
+    // track. This keeps the output aligned anyway.
+    m_pReadAheadManager->getPrerollSamples(
+            m_bBackwards ? -1.0 : 1.0,
+            m_buffer_back,
+            getOutputSignal().frames2samples(paddingFrames));
+    SINT offset = 0;
+    while (offset < paddingFrames) {
+        const SINT blockFrames = math_min(
+                static_cast<SINT>(kRubberBandBlockSize),
+                paddingFrames - offset);
+        deinterleaveAndProcess(
+                m_buffer_back + getOutputSignal().frames2samples(offset),
+                blockFrames,
+                false);
+        offset += blockFrames;
+    }
+    m_remainingPaddingInOutput = latency +
+            static_cast<SINT>(std::round(
+                    paddingFrames * m_pRubberBand->getTimeRatio()));
+}
+
+void EngineBufferScaleRubberBand::fadeOutStretcher(
+        CSAMPLE* pOutputBuffer, SINT frames) {
+    m_fadeOutPending = false;
+    // Flush the audio that is still pending from the previous position
+    m_pFadingRubberBand->process(
+            (const float* const*)m_retrieve_buffer, 0, true);
+    SINT fadeFrames = 0;
+    while (fadeFrames < frames) {
+        const SINT available = m_pFadingRubberBand->available();
+        if (available <= 0) {
+            break;
+        }
+        const SINT received_frames = m_pFadingRubberBand->retrieve(
+                (float* const*)m_retrieve_buffer,
+                math_min(available, frames - fadeFrames));
+        if (received_frames <= 0) {
+            break;
+        }
+        SampleUtil::interleaveBuffer(
+                m_buffer_back + getOutputSignal().frames2samples(fadeFrames),
+                m_retrieve_buffer[0],
+                m_retrieve_buffer[1],
+                received_frames);
+        fadeFrames += received_frames;
+    }
+    m_pFadingRubberBand->reset();
+
+    if (fadeFrames > 0) {
+        // Fades in the new position over the length of the remaining audio
+        // of the previous position
+        SampleUtil::linearCrossfadeBuffersIn(pOutputBuffer,
+                m_buffer_back,
+                getOutputSignal().frames2samples(fadeFrames));
+    } else {
+        SampleUtil::applyRampingGain(pOutputBuffer,
+                0.0,
+                1.0,
+                getOutputSignal().frames2samples(frames));
+    }
 }
 
 SINT EngineBufferScaleRubberBand::retrieveAndDeinterleave(
         CSAMPLE* pBuffer,
         SINT frames) {
+    // Drop the output that corresponds to the preroll
+    while (m_remainingPaddingInOutput > 0) {
+        const SINT available = m_pRubberBand->available();
+        if (available <= 0) {
+            return 0;
+        }
+        const SINT dropped_frames = m_pRubberBand->retrieve(
+                (float* const*)m_retrieve_buffer,
+                math_min(math_min(available, m_remainingPaddingInOutput),
+                        getOutputSignal().samples2frames(MAX_BUFFER_LEN)));
+        if (dropped_frames <= 0) {
+            return 0;
+        }
+        m_remainingPaddingInOutput -= dropped_frames;
+    }
+
     SINT frames_available = m_pRubberBand->available();
     SINT frames_to_read = math_min(frames_available, frames);
     SINT received_frames = m_pRubberBand->retrieve(
@@ -155,13 +349,25 @@ void EngineBufferScaleRubberBand::deinterleaveAndProcess(
 double EngineBufferScaleRubberBand::scaleBuffer(
         CSAMPLE* pOutputBuffer,
         SINT iOutputBufferSize) {
+    if (!m_pRubberBand) {
+        SampleUtil::clear(pOutputBuffer, iOutputBufferSize);
+        return 0.0;
+    }
     if (m_dBaseRate == 0.0 || m_dTempoRatio == 0.0) {
         SampleUtil::clear(pOutputBuffer, iOutputBufferSize);
+        if (m_fadeOutPending) {
+            m_pFadingRubberBand->reset();
+            m_fadeOutPending = false;
+        }
         // No actual samples/frames have been read from the
         // unscaled input buffer!
         return 0.0;
     }
 
+    if (m_primePending) {
+        primeStretcher();
+    }
+
     SINT total_received_frames = 0;
     SINT total_read_frames = 0;
 
@@ -185,6 +391,7 @@ double EngineBufferScaleRubberBand::scaleBuffer(
             // If we break out early then we have flushed RubberBand and need to
             // reset it.
             m_pRubberBand->reset();
+            m_remainingPaddingInOutput = 0;
             break;
         }
 
@@ -234,6 +441,11 @@ double EngineBufferScaleRubberBand::scaleBuffer(
         counter.increment();
     }
 
+    if (m_fadeOutPending) {
+        fadeOutStretcher(pOutputBuffer,
+                getOutputSignal().samples2frames(iOutputBufferSize));
+    }
+
     // framesRead is interpreted as the total number of virtual sample frames
     // consumed to produce the scaled buffer. Due to this, we do not take into
     // account directionality or starting point.
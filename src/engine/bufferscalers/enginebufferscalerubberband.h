@@ -8,9 +8,23 @@ namespace RubberBand {
 class RubberBandStretcher;
 }  // namespace RubberBand
 
+class ControlProxy;
 class ReadAheadManager;
 
 // Uses librubberband to scale audio.  This class is not thread safe.
+//
+// After a seek the stretcher needs to be refilled before it produces any
+// output. Two options reduce the resulting gap:
+// * [Master],keylock_preroll primes the stretcher with the cached audio
+//   that precedes the new position and drops the corresponding output,
+//   i.e. the first output frame is aligned with the new position.
+// * [Master],keylock_crossfade uses a second stretcher for the new position
+//   while the audio still pending in the previous one is faded out. This
+//   replaces the extra buffer EngineBuffer would otherwise render at the
+//   previous position.
+//
+// The stretchers and the buffers are only allocated while a track is loaded
+// (see allocateBuffers).
 class EngineBufferScaleRubberBand : public EngineBufferScale {
     Q_OBJECT
   public:
@@ -28,11 +42,26 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
 
     // Flush buffer.
     void clear() override;
+    bool clearWithCrossfade() override;
+
+    double getLatencyFrames() const override;
+
+    void allocateBuffers() override;
+    void releaseBuffers() override;
+
+    // The memory that is currently allocated for the buffers of all
+    // instances, excluding the internal buffers of the stretchers
+    static qint64 allocatedBufferBytes();
 
   private:
     // Reset RubberBand library with new audio signal
     void onSampleRateChanged() override;
 
+    std::unique_ptr<RubberBand::RubberBandStretcher> createStretcher() const;
+    void resetStretcher();
+    void primeStretcher();
+    void fadeOutStretcher(CSAMPLE* pOutputBuffer, SINT frames);
+
     void deinterleaveAndProcess(const CSAMPLE* pBuffer, SINT frames, bool flush);
     SINT retrieveAndDeinterleave(CSAMPLE* pBuffer, SINT frames);
 
@@ -40,6 +69,15 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
     ReadAheadManager* m_pReadAheadManager;
 
     std::unique_ptr<RubberBand::RubberBandStretcher> m_pRubberBand;
+    // The stretcher that is faded out after a seek and otherwise idle
+    std::unique_ptr<RubberBand::RubberBandStretcher> m_pFadingRubberBand;
+    bool m_fadeOutPending;
+
+    ControlProxy* m_pPreroll;
+    ControlProxy* m_pCrossfade;
+    bool m_primePending;
+    // Output frames of the start padding that still need to be dropped
+    SINT m_remainingPaddingInOutput;
 
     CSAMPLE* m_retrieve_buffer[2];
     CSAMPLE* m_buffer_back;
@@ -107,6 +107,15 @@ void EngineBufferScaleST::onSampleRateChanged() {
     m_pSoundTouch->setTempo(m_dTempoRatio);
 }
 
+double EngineBufferScaleST::getLatencyFrames() const {
+    const double rate = m_dBaseRate * m_dTempoRatio;
+    if (rate <= 0.0) {
+        return 0.0;
+    }
+    // SoundTouch reports the initial latency in input frames
+    return m_pSoundTouch->getSetting(SETTING_INITIAL_LATENCY) / rate;
+}
+
 void EngineBufferScaleST::clear() {
     m_pSoundTouch->clear();
 
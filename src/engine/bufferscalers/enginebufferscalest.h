@@ -30,6 +30,8 @@ class EngineBufferScaleST : public EngineBufferScale {
     // Flush buffer.
     void clear() override;
 
+    double getLatencyFrames() const override;
+
   private:
     void onSampleRateChanged() override;
 
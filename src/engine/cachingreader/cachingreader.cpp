@@ -1,5 +1,6 @@
 #include <QtDebug>
 #include <QFileInfo>
+#include <atomic>
 
 #include "engine/cachingreader/cachingreader.h"
 #include "control/controlobject.h"
@@ -38,6 +39,13 @@ const SINT kDefaultHintFrames = 1024;
 // massive drop outs are expected to occur Mixxx should run reliably!
 const SINT kNumberOfCachedChunksInMemory = 80;
 
+std::atomic<qint64> s_allocatedCacheBytes(0);
+
+const ConfigKey kResidentMaxSecondsConfigKey("[Sampler]", "ResidentMaxSeconds");
+
+// 30 s of stereo samples at 44.1 kHz consume about 10 MB
+constexpr double kDefaultResidentMaxSeconds = 30.0;
+
 } // anonymous namespace
 
 CachingReader::CachingReader(QString group,
@@ -60,22 +68,10 @@ CachingReader::CachingReader(QString group,
           m_state(STATE_IDLE),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
+          m_pResidentSample(nullptr),
+          m_residentSamples(false),
           m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusUpdateFIFO) {
     m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
-    // Divide up the allocated raw memory buffer into total_chunks
-    // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
-        CachingReaderChunkForOwner* c =
-                new CachingReaderChunkForOwner(
-                        mixxx::SampleBuffer::WritableSlice(
-                                m_sampleBuffer,
-                                CachingReaderChunk::kSamples * i,
-                                CachingReaderChunk::kSamples));
-        m_chunks.push_back(c);
-        m_freeChunks.push_back(c);
-    }
 
     // Forward signals from worker
     connect(&m_worker, &CachingReaderWorker::trackLoading,
@@ -87,13 +83,71 @@ CachingReader::CachingReader(QString group,
     connect(&m_worker, &CachingReaderWorker::trackLoadFailed,
             this, &CachingReader::trackLoadFailed,
             Qt::DirectConnection);
-
-    m_worker.start(QThread::HighPriority);
 }
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
     qDeleteAll(m_chunks);
+    s_allocatedCacheBytes -= m_sampleBuffer.size() * sizeof(CSAMPLE);
+}
+
+//static
+qint64 CachingReader::allocatedCacheBytes() {
+    return s_allocatedCacheBytes.load();
+}
+
+void CachingReader::allocateCache() {
+    DEBUG_ASSERT(m_chunks.isEmpty());
+    mixxx::SampleBuffer(
+            CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory)
+            .swap(m_sampleBuffer);
+    s_allocatedCacheBytes += m_sampleBuffer.size() * sizeof(CSAMPLE);
+    // Divide up the allocated raw memory buffer into total_chunks
+    // chunks. Initialize each chunk to hold nothing and add it to the free
+    // list.
+    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
+        CachingReaderChunkForOwner* c =
+                new CachingReaderChunkForOwner(
+                        mixxx::SampleBuffer::WritableSlice(
+                                m_sampleBuffer,
+                                CachingReaderChunk::kSamples * i,
+                                CachingReaderChunk::kSamples));
+        m_chunks.push_back(c);
+        m_freeChunks.push_back(c);
+    }
+}
+
+// Invoked from the UI thread!!
+CachingReader::CacheRelease CachingReader::releaseCache() {
+    if (m_chunks.isEmpty()) {
+        return CacheRelease::Released;
+    }
+    if (m_state.testAndSetOrdered(STATE_IDLE, STATE_CACHE_RELEASING)) {
+        // The engine might still access the chunks
+        return CacheRelease::Pending;
+    }
+    switch (m_state.loadAcquire()) {
+    case STATE_TRACK_UNLOADING:
+        // The engine has not yet processed the TRACK_UNLOADED update
+    case STATE_CACHE_RELEASING:
+        return CacheRelease::Pending;
+    case STATE_CACHE_RELEASED:
+        break;
+    default:
+        return CacheRelease::InUse;
+    }
+
+    // The engine does not touch the chunks until the next track is
+    // loaded by newTrack() from this thread.
+    DEBUG_ASSERT(!m_mruCachingReaderChunk);
+    DEBUG_ASSERT(!m_lruCachingReaderChunk);
+    DEBUG_ASSERT(m_allocatedCachingReaderChunks.isEmpty());
+    m_freeChunks.clear();
+    qDeleteAll(m_chunks);
+    m_chunks.clear();
+    s_allocatedCacheBytes -= m_sampleBuffer.size() * sizeof(CSAMPLE);
+    mixxx::SampleBuffer().swap(m_sampleBuffer);
+    return CacheRelease::Released;
 }
 
 void CachingReader::freeChunkFromList(CachingReaderChunkForOwner* pChunk) {
@@ -204,8 +258,26 @@ CachingReaderChunkForOwner* CachingReader::lookupChunkAndFreshen(SINT chunkIndex
 
 // Invoked from the UI thread!!
 void CachingReader::newTrack(TrackPointer pTrack) {
+    double residentMaxSeconds = 0.0;
+    if (m_residentSamples && pTrack) {
+        residentMaxSeconds = m_pConfig->getValue(
+                kResidentMaxSecondsConfigKey, kDefaultResidentMaxSeconds);
+        // Resident samples are read without any chunks. If the duration
+        // from the metadata is slightly off the track is decoded
+        // completely anyway.
+        const double duration = pTrack->getDuration();
+        if (duration > 0.0 && duration <= residentMaxSeconds) {
+            residentMaxSeconds = CachingReaderWorker::kResidentRequired;
+        }
+    }
+    if (pTrack && m_chunks.isEmpty() &&
+            residentMaxSeconds != CachingReaderWorker::kResidentRequired) {
+        // The engine does not access the chunks before the state
+        // has been changed below.
+        allocateCache();
+    }
     auto newState = pTrack ? STATE_TRACK_LOADING : STATE_TRACK_UNLOADING;
-    auto oldState = m_state.fetchAndStoreAcquire(newState);
+    auto oldState = m_state.fetchAndStoreOrdered(newState);
 
     // TODO():
     // BaseTrackPlayerImpl::slotLoadTrack() distributes the new track via
@@ -218,10 +290,22 @@ void CachingReader::newTrack(TrackPointer pTrack) {
         kLogger.warning()
                 << "Loading a new track while loading a track may lead to inconsistent states";
     }
-    m_worker.newTrack(std::move(pTrack));
+    m_worker.newTrack(std::move(pTrack), residentMaxSeconds);
 }
 
 void CachingReader::process() {
+    processStatusUpdates();
+    if (atomicLoadAcquire(m_state) == STATE_CACHE_RELEASING && isIdle()) {
+        // All results of pending read requests have been written by the
+        // worker at this point. Return them to the free list before
+        // handing over the chunks to the GUI thread.
+        processStatusUpdates();
+        freeAllChunks();
+        m_state.testAndSetRelease(STATE_CACHE_RELEASING, STATE_CACHE_RELEASED);
+    }
+}
+
+void CachingReader::processStatusUpdates() {
     ReaderStatusUpdate update;
     while (m_readerStatusUpdateFIFO.read(&update, 1) == 1) {
         auto pChunk = update.takeFromWorker();
@@ -233,7 +317,8 @@ void CachingReader::process() {
                     update.status == CHUNK_READ_EOF ||
                     update.status == CHUNK_READ_INVALID ||
                     update.status == CHUNK_READ_DISCARDED);
-            if (atomicLoadAcquire(m_state) == STATE_TRACK_LOADING) {
+            if (atomicLoadAcquire(m_state) == STATE_TRACK_LOADING ||
+                    atomicLoadAcquire(m_state) == STATE_CACHE_RELEASING) {
                 // Discard all results from pending read requests for the
                 // previous track before the next track has been loaded.
                 freeChunk(pChunk);
@@ -264,18 +349,31 @@ void CachingReader::process() {
                 // In case of two consecutive load events, we receive two consecutive
                 // TRACK_LOADED without a chunk in between, assert this here.
                 DEBUG_ASSERT(atomicLoadRelaxed(m_state) == STATE_TRACK_LOADING ||
+                        atomicLoadRelaxed(m_state) == STATE_TRACK_UNLOADING ||
                         (atomicLoadRelaxed(m_state) == STATE_TRACK_LOADED &&
                                 !m_mruCachingReaderChunk && !m_lruCachingReaderChunk));
                 // now purge also the recently used chunk list from the old track.
                 if (m_mruCachingReaderChunk || m_lruCachingReaderChunk) {
-                    DEBUG_ASSERT(atomicLoadRelaxed(m_state) == STATE_TRACK_LOADING);
+                    DEBUG_ASSERT(atomicLoadRelaxed(m_state) != STATE_TRACK_LOADED);
                     freeAllChunks();
                 }
                 // Reset the readable frame index range
                 m_readableFrameIndexRange = update.readableFrameIndexRange();
-                m_state.storeRelease(STATE_TRACK_LOADED);
+                m_worker.trackUpdateProcessed();
+                if (m_state.testAndSetRelease(STATE_TRACK_LOADING, STATE_TRACK_LOADED) ||
+                        atomicLoadAcquire(m_state) == STATE_TRACK_LOADED) {
+                    m_pResidentSample = update.getResidentSample();
+                } else {
+                    // The track has been unloaded in the meantime and the
+                    // worker might already have freed its resident sample.
+                    // The TRACK_UNLOADED update follows.
+                    DEBUG_ASSERT(atomicLoadRelaxed(m_state) == STATE_TRACK_UNLOADING);
+                    m_pResidentSample = nullptr;
+                }
             } else {
                 DEBUG_ASSERT(update.status == TRACK_UNLOADED);
+                m_pResidentSample = nullptr;
+                m_worker.trackUpdateProcessed();
                 // This message could be processed later when a new
                 // track is already loading! In this case the TRACK_LOADED will
                 // be the very next status update.
@@ -331,6 +429,10 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
     // the first chunk and to update m_readableFrameIndexRange
     process();
 
+    if (m_pResidentSample) {
+        return readResidentSample(sample, numSamples, reverse, buffer);
+    }
+
     auto remainingFrameIndexRange =
             mixxx::IndexRange::forward(
                     CachingReaderChunk::samples2frames(sample),
@@ -504,12 +606,65 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
     return result;
 }
 
+CachingReader::ReadResult CachingReader::readResidentSample(
+        SINT sample,
+        SINT numSamples,
+        bool reverse,
+        CSAMPLE* buffer) {
+    DEBUG_ASSERT(m_pResidentSample);
+    const auto frameIndexRange =
+            mixxx::IndexRange::forward(
+                    CachingReaderChunk::samples2frames(sample),
+                    CachingReaderChunk::samples2frames(numSamples));
+    const auto readableFrameIndexRange =
+            intersect(frameIndexRange, m_pResidentSample->frameIndexRange());
+    if (readableFrameIndexRange.empty()) {
+        SampleUtil::clear(buffer, numSamples);
+        return ReadResult::PARTIALLY_AVAILABLE;
+    }
+
+    // Silence before (preroll) and after the end of the track
+    const SINT leadingSamples = CachingReaderChunk::frames2samples(
+            readableFrameIndexRange.start() - frameIndexRange.start());
+    const SINT readableSamples = CachingReaderChunk::frames2samples(
+            readableFrameIndexRange.length());
+    const SINT trailingSamples = numSamples - leadingSamples - readableSamples;
+    DEBUG_ASSERT(trailingSamples >= 0);
+    const CSAMPLE* pSampleFrames =
+            m_pResidentSample->sampleFrames(readableFrameIndexRange.start());
+    if (reverse) {
+        // The first frame is written to the end of the buffer
+        SampleUtil::clear(&buffer[numSamples - leadingSamples], leadingSamples);
+        SampleUtil::copyReverse(
+                &buffer[trailingSamples],
+                pSampleFrames,
+                readableSamples);
+        SampleUtil::clear(buffer, trailingSamples);
+    } else {
+        SampleUtil::clear(buffer, leadingSamples);
+        SampleUtil::copy(
+                &buffer[leadingSamples],
+                pSampleFrames,
+                readableSamples);
+        SampleUtil::clear(&buffer[leadingSamples + readableSamples], trailingSamples);
+    }
+    if (leadingSamples > 0 || trailingSamples > 0) {
+        return ReadResult::PARTIALLY_AVAILABLE;
+    }
+    return ReadResult::AVAILABLE;
+}
+
 void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
     // If no file is loaded, skip.
     if (atomicLoadRelaxed(m_state) != STATE_TRACK_LOADED) {
         return;
     }
 
+    // Resident samples are read without any chunks
+    if (m_pResidentSample) {
+        return;
+    }
+
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
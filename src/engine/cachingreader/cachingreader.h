@@ -70,6 +70,9 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// The memory of the cache is only allocated when the first track is loaded
+// and can be released again while no track is loaded (see releaseCache).
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -104,13 +107,57 @@ class CachingReader : public QObject {
 
     // Request that the CachingReader load a new track. These requests are
     // processed in the work thread, so the reader must be woken up via wake()
-    // for this to take effect.
+    // for this to take effect. Allocates the cache if needed, i.e. unless
+    // the track is known to fit into a resident sample.
+    // Unloading with a null track must not run concurrently with read(),
+    // because the worker frees the resident sample of the previous track
+    // without waiting for the engine.
     void newTrack(TrackPointer pTrack);
 
+    // Short tracks are decoded completely while loading and the engine
+    // reads them without any cache misses (see ResidentSample). The
+    // maximum duration is configured by [Sampler],ResidentMaxSeconds.
+    // Takes effect with the next call of newTrack() from the same thread.
+    void setResidentSamples(bool enabled) {
+        m_residentSamples = enabled;
+    }
+
+    enum class CacheRelease {
+        // The cache has been freed or has never been allocated
+        Released,
+        // Waiting for the engine to complete the unloading and to return
+        // all chunks, try again later
+        Pending,
+        // A track is loaded or loading
+        InUse,
+    };
+
+    // Frees the memory of the cache while no track is loaded. Must be
+    // called from the same thread as newTrack(), i.e. the GUI thread.
+    CacheRelease releaseCache();
+
+    // The memory that is currently allocated by the caches of all readers
+    static qint64 allocatedCacheBytes();
+
+    // Returns true if all chunk read requests have been processed by the
+    // worker. Used for rendering faster than real time, when the engine
+    // waits for the worker between callbacks instead of reading silence.
+    bool isIdle() const {
+        // The FIFO must be checked first, because the worker is marked
+        // busy before taking requests from it
+        return m_chunkReadRequestFIFO.readAvailable() == 0 &&
+                !m_worker.isBusy();
+    }
+
     void setScheduler(EngineWorkerScheduler* pScheduler) {
         m_worker.setScheduler(pScheduler);
     }
 
+    // Playing decks are served before idle decks and samplers
+    void setPriority(EngineWorker::Priority priority) {
+        m_worker.setPriority(priority);
+    }
+
   signals:
     // Emitted once a new track is loaded and ready to be read from.
     void trackLoading();
@@ -144,6 +191,15 @@ class CachingReader : public QObject {
     // Returns all allocated chunks to the free list
     void freeAllChunks();
 
+    void allocateCache();
+    void processStatusUpdates();
+
+    ReadResult readResidentSample(
+            SINT sample,
+            SINT numSamples,
+            bool reverse,
+            CSAMPLE* buffer);
+
     // Gets a chunk from the free list. Returns nullptr if none available.
     CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex);
 
@@ -155,6 +211,12 @@ class CachingReader : public QObject {
         STATE_TRACK_LOADING,
         STATE_TRACK_UNLOADING,
         STATE_TRACK_LOADED,
+        // Requested by releaseCache() while idle. The engine returns all
+        // chunks to the free list once the worker is idle.
+        STATE_CACHE_RELEASING,
+        // The engine no longer accesses the chunks, they are freed by the
+        // next call of releaseCache().
+        STATE_CACHE_RELEASED,
     };
     QAtomicInt m_state;
 
@@ -173,11 +235,19 @@ class CachingReader : public QObject {
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
     CachingReaderChunkForOwner* m_lruCachingReaderChunk;
 
-    // The raw memory buffer which is divided up into chunks.
+    // The raw memory buffer which is divided up into chunks. Empty until
+    // the first track is loaded.
     mixxx::SampleBuffer m_sampleBuffer;
 
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // The completely decoded track if the worker has loaded it as a
+    // resident sample. Owned by the worker and only accessed by the engine.
+    const ResidentSample* m_pResidentSample;
+
+    // Only accessed from the thread that calls newTrack()
+    bool m_residentSamples;
+
     CachingReaderWorker m_worker;
 };
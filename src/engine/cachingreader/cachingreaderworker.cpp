@@ -3,6 +3,7 @@
 #include <QFileInfo>
 #include <QMutexLocker>
 #include <QtDebug>
+#include <algorithm>
 
 #include "control/controlobject.h"
 #include "sources/soundsourceproxy.h"
@@ -15,6 +16,10 @@ namespace {
 
 mixxx::Logger kLogger("CachingReaderWorker");
 
+// Limits the time a single worker occupies a thread of the pool, i.e. the
+// latency of other decks that are waiting for their chunks.
+constexpr int kMaxReadRequestsPerRun = 4;
+
 } // anonymous namespace
 
 CachingReaderWorker::CachingReaderWorker(
@@ -26,6 +31,10 @@ CachingReaderWorker::CachingReaderWorker(
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
           m_newTrackAvailable(false),
+          m_newTrackResidentMaxSeconds(0.0),
+          m_writtenTrackUpdates(0),
+          m_processedTrackUpdates(0),
+          m_hasRetiredResidentSamples(false),
           m_stop(0) {
 }
 
@@ -75,45 +84,102 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
 }
 
 // WARNING: Always called from a different thread (GUI)
-void CachingReaderWorker::newTrack(TrackPointer pTrack) {
+void CachingReaderWorker::newTrack(TrackPointer pTrack, double residentMaxSeconds) {
     {
         QMutexLocker locker(&m_newTrackMutex);
         m_pNewTrack = pTrack;
+        m_newTrackResidentMaxSeconds = residentMaxSeconds;
         m_newTrackAvailable = true;
     }
     workReady();
 }
 
-void CachingReaderWorker::run() {
-    unsigned static id = 0; //the id of this thread, for debugging purposes
-    QThread::currentThread()->setObjectName(QString("CachingReaderWorker %1").arg(++id));
+// WARNING: Called from the engine callback
+void CachingReaderWorker::trackUpdateProcessed() {
+    m_processedTrackUpdates.fetch_add(1, std::memory_order_release);
+    if (m_hasRetiredResidentSamples.load(std::memory_order_acquire)) {
+        // Free them in the worker thread
+        workReady();
+    }
+}
+
+void CachingReaderWorker::writeTrackUpdate(
+        const ReaderStatusUpdate& update,
+        std::shared_ptr<const ResidentSample> pResidentSample) {
+    DEBUG_ASSERT(update.status == TRACK_LOADED || update.status == TRACK_UNLOADED);
+    DEBUG_ASSERT(update.getResidentSample() == pResidentSample.get());
+    ++m_writtenTrackUpdates;
+    if (m_pResidentSample) {
+        // The engine might read from the previous sample until it
+        // has processed this update
+        m_retiredResidentSamples.emplace_back(
+                m_writtenTrackUpdates, std::move(m_pResidentSample));
+        m_hasRetiredResidentSamples.store(true, std::memory_order_release);
+    }
+    m_pResidentSample = std::move(pResidentSample);
+    m_pReaderStatusFIFO->writeBlocking(&update, 1);
+}
 
+void CachingReaderWorker::freeRetiredResidentSamples() {
+    if (m_retiredResidentSamples.empty()) {
+        return;
+    }
+    const int processedTrackUpdates =
+            m_processedTrackUpdates.load(std::memory_order_acquire);
+    m_retiredResidentSamples.erase(
+            std::remove_if(
+                    m_retiredResidentSamples.begin(),
+                    m_retiredResidentSamples.end(),
+                    [processedTrackUpdates](const auto& retired) {
+                        return retired.first <= processedTrackUpdates;
+                    }),
+            m_retiredResidentSamples.end());
+    m_hasRetiredResidentSamples.store(
+            !m_retiredResidentSamples.empty(), std::memory_order_release);
+}
+
+void CachingReaderWorker::run() {
+    if (atomicLoadAcquire(m_stop)) {
+        return;
+    }
     Event::start(m_tag);
-    while (!atomicLoadAcquire(m_stop)) {
+    freeRetiredResidentSamples();
+    // The reserved thread of the pool only reads chunks. Loading is
+    // deferred to another thread.
+    const bool loadDeferred = m_newTrackAvailable && isRunningOnReservedThread();
+    if (m_newTrackAvailable && !loadDeferred) {
+        TrackPointer pLoadTrack;
+        double residentMaxSeconds;
+        { // locking scope
+            QMutexLocker locker(&m_newTrackMutex);
+            pLoadTrack = m_pNewTrack;
+            residentMaxSeconds = m_newTrackResidentMaxSeconds;
+            m_pNewTrack.reset();
+            m_newTrackAvailable = false;
+        } // implicitly unlocks the mutex
+        loadTrack(pLoadTrack, residentMaxSeconds);
+    }
+    for (int i = 0; i < kMaxReadRequestsPerRun; ++i) {
         // Request is initialized by reading from FIFO
         CachingReaderChunkReadRequest request;
-        if (m_newTrackAvailable) {
-            TrackPointer pLoadTrack;
-            { // locking scope
-                QMutexLocker locker(&m_newTrackMutex);
-                pLoadTrack = m_pNewTrack;
-                m_pNewTrack.reset();
-                m_newTrackAvailable = false;
-            } // implicitly unlocks the mutex
-            loadTrack(pLoadTrack);
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-            // Read the requested chunk and send the result
-            const ReaderStatusUpdate update(processReadRequest(request));
-            m_pReaderStatusFIFO->writeBlocking(&update, 1);
-        } else {
-            Event::end(m_tag);
-            m_semaRun.acquire();
-            Event::start(m_tag);
+        if (atomicLoadAcquire(m_stop) ||
+                m_pChunkReadRequestFIFO->read(&request, 1) != 1) {
+            break;
         }
+        // Read the requested chunk and send the result
+        const ReaderStatusUpdate update(processReadRequest(request));
+        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+    }
+    Event::end(m_tag);
+    if (!atomicLoadAcquire(m_stop) &&
+            (loadDeferred || m_pChunkReadRequestFIFO->readAvailable() > 0)) {
+        // Give the other workers a chance before continuing
+        workReady();
     }
 }
 
-void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
+void CachingReaderWorker::loadTrack(
+        const TrackPointer& pTrack, double residentMaxSeconds) {
     // Discard all pending read requests
     CachingReaderChunkReadRequest request;
     while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
@@ -126,8 +192,12 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 
     if (!pTrack) {
         // If no new track is available then we are done
-        const auto update = ReaderStatusUpdate::trackUnloaded();
-        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        writeTrackUpdate(ReaderStatusUpdate::trackUnloaded());
+        // The engine no longer reads from any resident sample after
+        // unloading, see CachingReader::newTrack(). Ejected samplers
+        // are not processed by the engine and would keep them forever.
+        m_retiredResidentSamples.clear();
+        m_hasRetiredResidentSamples.store(false, std::memory_order_release);
         return;
     }
 
@@ -140,8 +210,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
                 << m_group
                 << "File not found"
                 << trackLocation;
-        const auto update = ReaderStatusUpdate::trackUnloaded();
-        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        writeTrackUpdate(ReaderStatusUpdate::trackUnloaded());
         emit trackLoadFailed(pTrack,
                 tr("The file '%1' could not be found.")
                         .arg(QDir::toNativeSeparators(trackLocation)));
@@ -156,8 +225,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
                 << m_group
                 << "Failed to open file"
                 << trackLocation;
-        const auto update = ReaderStatusUpdate::trackUnloaded();
-        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        writeTrackUpdate(ReaderStatusUpdate::trackUnloaded());
         emit trackLoadFailed(pTrack,
                 tr("The file '%1' could not be loaded.")
                         .arg(QDir::toNativeSeparators(trackLocation)));
@@ -173,8 +241,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
                 << m_group
                 << "Failed to open empty file"
                 << trackLocation;
-        const auto update = ReaderStatusUpdate::trackUnloaded();
-        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        writeTrackUpdate(ReaderStatusUpdate::trackUnloaded());
         emit trackLoadFailed(pTrack,
                 tr("The file '%1' is empty and could not be loaded.")
                         .arg(QDir::toNativeSeparators(trackLocation)));
@@ -189,23 +256,55 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
     }
 
-    const auto update =
-            ReaderStatusUpdate::trackLoaded(
-                    m_pAudioSource->frameIndexRange());
-    m_pReaderStatusFIFO->writeBlocking(&update, 1);
-
-    // Emit that the track is loaded.
+    const int sampleRate = m_pAudioSource->getSignalInfo().getSampleRate();
     const SINT sampleCount =
             CachingReaderChunk::frames2samples(
                     m_pAudioSource->frameLength());
+
+    // Short tracks are decoded completely before they are reported as
+    // loaded. The engine reads them without requesting any chunks.
+    std::shared_ptr<const ResidentSample> pResidentSample;
+    if (m_pAudioSource->frameLength() <=
+            residentMaxSeconds * sampleRate) {
+        pResidentSample = ResidentSample::loadShared(
+                trackLocation,
+                m_pAudioSource,
+                mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+    }
+    if (pResidentSample) {
+        const auto update =
+                ReaderStatusUpdate::trackLoaded(
+                        pResidentSample->frameIndexRange(),
+                        pResidentSample.get());
+        // The file is no longer needed
+        m_pAudioSource.reset();
+        writeTrackUpdate(update, std::move(pResidentSample));
+    } else if (residentMaxSeconds == kResidentRequired) {
+        // Without a cache the track cannot be read in chunks
+        m_pAudioSource.reset(); // Close open file handles
+        kLogger.warning()
+                << m_group
+                << "Failed to decode file"
+                << trackLocation;
+        writeTrackUpdate(ReaderStatusUpdate::trackUnloaded());
+        emit trackLoadFailed(pTrack,
+                tr("The file '%1' could not be decoded.")
+                        .arg(QDir::toNativeSeparators(trackLocation)));
+        return;
+    } else {
+        writeTrackUpdate(
+                ReaderStatusUpdate::trackLoaded(
+                        m_pAudioSource->frameIndexRange()));
+    }
+
+    // Emit that the track is loaded.
     emit trackLoaded(
             pTrack,
-            m_pAudioSource->getSignalInfo().getSampleRate(),
+            sampleRate,
             sampleCount);
 }
 
 void CachingReaderWorker::quitWait() {
     m_stop = 1;
-    m_semaRun.release();
-    wait();
+    stopScheduling();
 }
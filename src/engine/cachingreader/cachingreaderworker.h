@@ -2,12 +2,16 @@
 #define ENGINE_CACHINGREADERWORKER_H
 
 #include <QMutex>
-#include <QSemaphore>
 #include <QString>
-#include <QThread>
 #include <QtDebug>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "engine/cachingreader/cachingreaderchunk.h"
+#include "engine/cachingreader/residentsample.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
 #include "track/track_decl.h"
@@ -37,6 +41,7 @@ enum ReaderStatus {
 typedef struct ReaderStatusUpdate {
   private:
     CachingReaderChunk* chunk;
+    const ResidentSample* residentSample;
     SINT readableFrameIndexRangeStart;
     SINT readableFrameIndexRangeEnd;
 
@@ -49,6 +54,7 @@ typedef struct ReaderStatusUpdate {
             const mixxx::IndexRange& readableFrameIndexRangeArg) {
         status = statusArg;
         chunk = chunkArg;
+        residentSample = nullptr;
         readableFrameIndexRangeStart = readableFrameIndexRangeArg.start();
         readableFrameIndexRangeEnd = readableFrameIndexRangeArg.end();
     }
@@ -60,11 +66,15 @@ typedef struct ReaderStatusUpdate {
         return update;
     }
 
+    // The resident sample (if any) is owned by the worker and must stay
+    // alive until the engine has processed the next track update.
     static ReaderStatusUpdate trackLoaded(
-            const mixxx::IndexRange& readableFrameIndexRange) {
+            const mixxx::IndexRange& readableFrameIndexRange,
+            const ResidentSample* residentSample = nullptr) {
         DEBUG_ASSERT(!readableFrameIndexRange.empty());
         ReaderStatusUpdate update;
         update.init(TRACK_LOADED, nullptr, readableFrameIndexRange);
+        update.residentSample = residentSample;
         return update;
     }
 
@@ -90,6 +100,10 @@ typedef struct ReaderStatusUpdate {
                 readableFrameIndexRangeStart,
                 readableFrameIndexRangeEnd);
     }
+
+    const ResidentSample* getResidentSample() const {
+        return residentSample;
+    }
 } ReaderStatusUpdate;
 
 class CachingReaderWorker : public EngineWorker {
@@ -102,13 +116,33 @@ class CachingReaderWorker : public EngineWorker {
             FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
     ~CachingReaderWorker() override = default;
 
+    // Tracks are decoded completely regardless of their length and fail
+    // to load otherwise. Used when the reader has not allocated a cache.
+    static constexpr double kResidentRequired =
+            std::numeric_limits<double>::infinity();
+
     // Request to load a new track. wake() must be called afterwards.
-    void newTrack(TrackPointer pTrack);
+    // Tracks that are not longer than residentMaxSeconds are decoded
+    // completely into a ResidentSample, 0 disables this.
+    void newTrack(TrackPointer pTrack, double residentMaxSeconds = 0.0);
+
+    // Invoked by the engine after each TRACK_LOADED or TRACK_UNLOADED
+    // update has been processed. Resident samples of previous tracks are
+    // only freed after the engine no longer references them.
+    void trackUpdateProcessed();
 
     // Run upkeep operations like loading tracks and reading from file. Run by a
-    // thread pool via the EngineWorkerScheduler.
+    // thread pool via the EngineWorkerScheduler. Processes at most
+    // kMaxReadRequestsPerRun chunk read requests and requeues itself if
+    // more are pending.
     void run() override;
 
+    // Loading a track opens and possibly decodes the file
+    bool hasLongRunningWork() const override {
+        return m_newTrackAvailable.load();
+    }
+
+    // Stops the worker and waits until it is no longer running
     void quitWait();
 
   signals:
@@ -129,11 +163,19 @@ class CachingReaderWorker : public EngineWorker {
     // Queue of Tracks to load, and the corresponding lock. Must acquire the
     // lock to touch.
     QMutex m_newTrackMutex;
-    bool m_newTrackAvailable;
+    std::atomic<bool> m_newTrackAvailable;
     TrackPointer m_pNewTrack;
+    double m_newTrackResidentMaxSeconds;
 
     // Internal method to load a track. Emits trackLoaded when finished.
-    void loadTrack(const TrackPointer& pTrack);
+    void loadTrack(const TrackPointer& pTrack, double residentMaxSeconds);
+
+    // Writes a TRACK_LOADED or TRACK_UNLOADED update and retires the
+    // resident sample of the previous track
+    void writeTrackUpdate(
+            const ReaderStatusUpdate& update,
+            std::shared_ptr<const ResidentSample> pResidentSample = nullptr);
+    void freeRetiredResidentSamples();
 
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
@@ -145,6 +187,17 @@ class CachingReaderWorker : public EngineWorker {
     // before conversion to a stereo signal.
     mixxx::SampleBuffer m_tempReadBuffer;
 
+    // The resident sample of the loaded track, if any
+    std::shared_ptr<const ResidentSample> m_pResidentSample;
+    // Resident samples of previous tracks that might still be referenced
+    // by the engine, together with the number of the track update that
+    // replaced them.
+    std::vector<std::pair<int, std::shared_ptr<const ResidentSample>>>
+            m_retiredResidentSamples;
+    int m_writtenTrackUpdates;
+    std::atomic<int> m_processedTrackUpdates;
+    std::atomic<bool> m_hasRetiredResidentSamples;
+
     QAtomicInt m_stop;
 };
 
@@ -0,0 +1,135 @@
+#include "engine/cachingreader/residentsample.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <atomic>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+mixxx::Logger kLogger("ResidentSample");
+
+std::atomic<qint64> s_allocatedBytes(0);
+
+// All samples that are currently loaded by at least one player, indexed
+// by the location of the file
+QMutex s_residentSamplesMutex;
+QHash<QString, std::weak_ptr<const ResidentSample>> s_residentSamples;
+
+} // anonymous namespace
+
+//static
+qint64 ResidentSample::allocatedBytes() {
+    return s_allocatedBytes.load();
+}
+
+//static
+std::shared_ptr<const ResidentSample> ResidentSample::loadShared(
+        const QString& location,
+        const mixxx::AudioSourcePointer& pAudioSource,
+        mixxx::SampleBuffer::WritableSlice tempReadBuffer) {
+    DEBUG_ASSERT(pAudioSource);
+    const QDateTime fileLastModified = QFileInfo(location).lastModified();
+    {
+        QMutexLocker locker(&s_residentSamplesMutex);
+        auto pResidentSample = s_residentSamples.value(location).lock();
+        if (pResidentSample &&
+                pResidentSample->m_fileLastModified == fileLastModified) {
+            return pResidentSample;
+        }
+    }
+
+    // Decode outside of the lock. Players that load the same file at
+    // the same time might both decode it, the first one wins below.
+    const auto sourceFrameIndexRange = pAudioSource->frameIndexRange();
+    mixxx::SampleBuffer sampleBuffer(
+            CachingReaderChunk::frames2samples(sourceFrameIndexRange.length()));
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource,
+            std::move(tempReadBuffer));
+    SINT frameIndex = sourceFrameIndexRange.start();
+    while (frameIndex < sourceFrameIndexRange.end()) {
+        const auto blockFrameIndexRange = mixxx::IndexRange::forward(
+                frameIndex,
+                math_min(CachingReaderChunk::kFrames,
+                        sourceFrameIndexRange.end() - frameIndex));
+        const auto readableFrameIndexRange =
+                audioSourceProxy
+                        .readSampleFrames(mixxx::WritableSampleFrames(
+                                blockFrameIndexRange,
+                                mixxx::SampleBuffer::WritableSlice(
+                                        sampleBuffer,
+                                        CachingReaderChunk::frames2samples(
+                                                frameIndex -
+                                                sourceFrameIndexRange.start()),
+                                        CachingReaderChunk::frames2samples(
+                                                blockFrameIndexRange.length()))))
+                        .frameIndexRange();
+        // Only the contiguous range of frames from the start is kept
+        if (readableFrameIndexRange.empty() ||
+                readableFrameIndexRange.start() != frameIndex) {
+            break;
+        }
+        frameIndex = readableFrameIndexRange.end();
+        if (readableFrameIndexRange != blockFrameIndexRange) {
+            break;
+        }
+    }
+    const auto frameIndexRange = mixxx::IndexRange::between(
+            sourceFrameIndexRange.start(), frameIndex);
+    if (frameIndexRange.empty()) {
+        kLogger.warning()
+                << "Failed to decode"
+                << location;
+        return nullptr;
+    }
+    if (frameIndexRange != sourceFrameIndexRange) {
+        kLogger.warning()
+                << "Failed to decode all frames of"
+                << location
+                << ": expected =" << sourceFrameIndexRange
+                << ", actual =" << frameIndexRange;
+    }
+
+    std::shared_ptr<const ResidentSample> pResidentSample(new ResidentSample(
+            fileLastModified,
+            std::move(sampleBuffer),
+            frameIndexRange));
+    QMutexLocker locker(&s_residentSamplesMutex);
+    auto pOtherResidentSample = s_residentSamples.value(location).lock();
+    if (pOtherResidentSample &&
+            pOtherResidentSample->m_fileLastModified == fileLastModified) {
+        return pOtherResidentSample;
+    }
+    // Purge the entries of samples that are no longer loaded
+    auto i = s_residentSamples.begin();
+    while (i != s_residentSamples.end()) {
+        if (i.value().expired()) {
+            i = s_residentSamples.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    s_residentSamples.insert(location, pResidentSample);
+    return pResidentSample;
+}
+
+ResidentSample::ResidentSample(
+        const QDateTime& fileLastModified,
+        mixxx::SampleBuffer&& sampleBuffer,
+        mixxx::IndexRange frameIndexRange)
+        : m_fileLastModified(fileLastModified),
+          m_sampleBuffer(std::move(sampleBuffer)),
+          m_frameIndexRange(frameIndexRange) {
+    s_allocatedBytes += m_sampleBuffer.size() * sizeof(CSAMPLE);
+}
+
+ResidentSample::~ResidentSample() {
+    s_allocatedBytes -= m_sampleBuffer.size() * sizeof(CSAMPLE);
+}
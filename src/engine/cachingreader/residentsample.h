@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QDateTime>
+#include <QString>
+#include <memory>
+
+#include "engine/engine.h"
+#include "sources/audiosource.h"
+
+// The completely decoded stereo sample frames of a short track that stay
+// in memory while it is loaded into a player. The engine reads directly
+// from this buffer without any cache misses (see CachingReader).
+//
+// The samples are immutable after decoding. Players that load the same
+// file share a single instance, which is freed when the last player
+// unloads it.
+class ResidentSample {
+  public:
+    // Returns the resident sample of the file if it is already loaded by
+    // another player, or decodes all frames of the audio source otherwise.
+    // Returns nullptr if not a single frame could be decoded.
+    static std::shared_ptr<const ResidentSample> loadShared(
+            const QString& location,
+            const mixxx::AudioSourcePointer& pAudioSource,
+            mixxx::SampleBuffer::WritableSlice tempReadBuffer);
+
+    // The memory that is currently allocated by all resident samples
+    static qint64 allocatedBytes();
+
+    ResidentSample(const ResidentSample&) = delete;
+    ResidentSample(ResidentSample&&) = delete;
+    ~ResidentSample();
+
+    // The decoded frames, might be shorter than the frame index range
+    // of the audio source in case of decoding errors.
+    const mixxx::IndexRange& frameIndexRange() const {
+        return m_frameIndexRange;
+    }
+
+    // Returns the samples of the given frame which must be contained
+    // in frameIndexRange()
+    const CSAMPLE* sampleFrames(SINT frameIndex) const {
+        DEBUG_ASSERT(m_frameIndexRange.containsIndex(frameIndex));
+        return m_sampleBuffer.data(
+                mixxx::kEngineChannelCount *
+                (frameIndex - m_frameIndexRange.start()));
+    }
+
+  private:
+    ResidentSample(
+            const QDateTime& fileLastModified,
+            mixxx::SampleBuffer&& sampleBuffer,
+            mixxx::IndexRange frameIndexRange);
+
+    const QDateTime m_fileLastModified;
+    const mixxx::SampleBuffer m_sampleBuffer;
+    const mixxx::IndexRange m_frameIndexRange;
+};
@@ -71,6 +71,9 @@ class EngineChannel : public EngineObject {
     virtual void process(CSAMPLE* pOut, const int iBufferSize) = 0;
     virtual void collectFeatures(GroupFeatureState* pGroupFeatures) const = 0;
     virtual void postProcess(const int iBuffersize) = 0;
+    // Invoked by the engine instead of process() for inactive channels
+    virtual void processInactive() {
+    }
 
     // TODO(XXX) This hack needs to be removed.
     virtual EngineBuffer* getEngineBuffer() {
@@ -96,6 +96,10 @@ void EngineDeck::postProcess(const int iBufferSize) {
     m_pBuffer->postProcess(iBufferSize);
 }
 
+void EngineDeck::processInactive() {
+    m_pBuffer->processInactive();
+}
+
 EngineBuffer* EngineDeck::getEngineBuffer() {
     return m_pBuffer;
 }
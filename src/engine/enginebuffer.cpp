@@ -12,6 +12,7 @@
 #include "engine/bufferscalers/enginebufferscalerubberband.h"
 #include "engine/bufferscalers/enginebufferscalest.h"
 #include "engine/cachingreader/cachingreader.h"
+#include "engine/cachingreader/residentsample.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/controls/bpmcontrol.h"
 #include "engine/controls/clockcontrol.h"
@@ -35,6 +36,7 @@
 #include "util/defs.h"
 #include "util/logger.h"
 #include "util/math.h"
+#include "util/performancetimer.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "waveform/visualplayposition.h"
@@ -51,6 +53,11 @@ const double kLinearScalerElipsis = 1.00058; // 2^(0.01/12): changes < 1 cent al
 
 const SINT kSamplesPerFrame = 2; // Engine buffer uses Stereo frames only
 
+// Empty players, e.g. most of the samplers, release their buffers after
+// this delay. Keeps the buffers when the next track is loaded right away.
+constexpr int kReleaseTrackBuffersDelayMillis = 30000;
+constexpr int kReleaseTrackBuffersRetryMillis = 100;
+
 } // anonymous namespace
 
 EngineBuffer::EngineBuffer(const QString& group,
@@ -93,7 +100,10 @@ EngineBuffer::EngineBuffer(const QString& group,
           m_iSampleRate(0),
           m_pCrossfadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_bCrossfadeReady(false),
-          m_iLastBufferSize(0) {
+          m_iLastBufferSize(0),
+          m_framesSinceKeylockUsageUpdate(0),
+          m_releaseTrackBuffersDelayMillis(kReleaseTrackBuffersDelayMillis),
+          m_bTrackBuffersAllocated(false) {
     // zero out crossfade buffer
     SampleUtil::clear(m_pCrossfadeBuffer, MAX_BUFFER_LEN);
 
@@ -166,10 +176,18 @@ EngineBuffer::EngineBuffer(const QString& group,
     m_pKeylockEngine = new ControlProxy("[Master]", "keylock_engine", this);
     m_pKeylockEngine->connectValueChanged(this, &EngineBuffer::slotKeylockEngineChanged,
                                           Qt::DirectConnection);
+    m_pResamplerQuality = new ControlProxy("[Master]", "resampler_quality", this);
 
     m_pTrackSamples = new ControlObject(ConfigKey(m_group, "track_samples"));
     m_pTrackSampleRate = new ControlObject(ConfigKey(m_group, "track_samplerate"));
 
+    // The delay of the keylock scaler in ms and the share of the real time
+    // it takes, i.e. 1.0 would use up the whole callback.
+    m_pKeylockLatency = new ControlObject(ConfigKey(m_group, "keylock_latency"));
+    m_pKeylockLatency->setReadOnly();
+    m_pKeylockUsage = new ControlObject(ConfigKey(m_group, "keylock_usage"));
+    m_pKeylockUsage->setReadOnly();
+
     m_pKeylock = new ControlPushButton(ConfigKey(m_group, "keylock"), true);
     m_pKeylock->setButtonMode(ControlPushButton::TOGGLE);
 
@@ -266,6 +284,12 @@ EngineBuffer::EngineBuffer(const QString& group,
     m_pScale->clear();
     m_bScalerChanged = true;
 
+    m_releaseTrackBuffersTimer.setSingleShot(true);
+    connect(&m_releaseTrackBuffersTimer,
+            &QTimer::timeout,
+            this,
+            &EngineBuffer::slotReleaseTrackBuffers);
+
     m_pPassthroughEnabled = new ControlProxy(group, "passthrough", this);
     m_pPassthroughEnabled->connectValueChanged(this, &EngineBuffer::slotPassthroughChanged,
                                                Qt::DirectConnection);
@@ -307,6 +331,8 @@ EngineBuffer::~EngineBuffer() {
     delete m_pTrackLoaded;
     delete m_pTrackSamples;
     delete m_pTrackSampleRate;
+    delete m_pKeylockLatency;
+    delete m_pKeylockUsage;
 
     delete m_pScaleLinear;
     delete m_pScaleST;
@@ -320,6 +346,54 @@ EngineBuffer::~EngineBuffer() {
     qDeleteAll(m_engineControls);
 }
 
+//static
+qint64 EngineBuffer::allocatedTrackBufferBytes() {
+    return CachingReader::allocatedCacheBytes() +
+            ResidentSample::allocatedBytes() +
+            EngineBufferScaleRubberBand::allocatedBufferBytes();
+}
+
+void EngineBuffer::allocateTrackBuffers() {
+    m_releaseTrackBuffersTimer.stop();
+    if (m_bTrackBuffersAllocated) {
+        return;
+    }
+    // The engine only touches the scalers while holding the pause lock.
+    // The reader cache is allocated by CachingReader::newTrack().
+    QMutexLocker locker(&m_pause);
+    m_pScaleLinear->allocateBuffers();
+    m_pScaleST->allocateBuffers();
+    m_pScaleRB->allocateBuffers();
+    m_bTrackBuffersAllocated = true;
+}
+
+void EngineBuffer::slotReleaseTrackBuffers() {
+    switch (m_pReader->releaseCache()) {
+    case CachingReader::CacheRelease::Released:
+        break;
+    case CachingReader::CacheRelease::Pending:
+        // Wait for the engine to return the chunks
+        m_releaseTrackBuffersTimer.start(kReleaseTrackBuffersRetryMillis);
+        return;
+    case CachingReader::CacheRelease::InUse:
+        if (isTrackLoaded() || atomicLoadRelaxed(m_iTrackLoading) != 0) {
+            // A new track has been loaded in the meantime
+            return;
+        }
+        // The reader has not yet caught up with the eject
+        m_releaseTrackBuffersTimer.start(kReleaseTrackBuffersRetryMillis);
+        return;
+    }
+    if (!m_bTrackBuffersAllocated) {
+        return;
+    }
+    QMutexLocker locker(&m_pause);
+    m_pScaleLinear->releaseBuffers();
+    m_pScaleST->releaseBuffers();
+    m_pScaleRB->releaseBuffers();
+    m_bTrackBuffersAllocated = false;
+}
+
 void EngineBuffer::bindWorkers(EngineWorkerScheduler* pWorkerScheduler) {
     m_pReader->setScheduler(pWorkerScheduler);
 }
@@ -441,6 +515,29 @@ void EngineBuffer::requestClonePosition(EngineChannel* pChannel) {
     atomicStoreRelaxed(m_pChannelToCloneFrom, pChannel);
 }
 
+void EngineBuffer::updateKeylockIndicators(const int iBufferSize) {
+    if (m_iSampleRate <= 0) {
+        return;
+    }
+    m_framesSinceKeylockUsageUpdate += iBufferSize / kSamplesPerFrame;
+    // Updated about 30 times per second like the audio latency usage of
+    // the sound devices.
+    if (m_framesSinceKeylockUsageUpdate < m_iSampleRate / 30) {
+        return;
+    }
+    const double realTimeSeconds =
+            static_cast<double>(m_framesSinceKeylockUsageUpdate) / m_iSampleRate;
+    m_pKeylockUsage->forceSet(m_timeInKeylock.toDoubleSeconds() / realTimeSeconds);
+    if (m_pScale == m_pScaleKeylock) {
+        m_pKeylockLatency->forceSet(
+                1000.0 * m_pScale->getLatencyFrames() / m_iSampleRate);
+    } else {
+        m_pKeylockLatency->forceSet(0.0);
+    }
+    m_timeInKeylock = mixxx::Duration();
+    m_framesSinceKeylockUsageUpdate = 0;
+}
+
 void EngineBuffer::readToCrossfadeBuffer(const int iBufferSize) {
     if (!m_bCrossfadeReady) {
         // Read buffer, as if there where no parameter change
@@ -465,14 +562,19 @@ void EngineBuffer::setNewPlaypos(double newpos) {
 
     m_filepos_play = newpos;
 
-    if (m_rate_old != 0.0) {
-        // Before seeking, read extra buffer for crossfading
-        // this also sets m_pReadAheadManager to newpos
-        readToCrossfadeBuffer(m_iLastBufferSize);
-    } else {
+    if (m_rate_old != 0.0 && m_pScale->clearWithCrossfade()) {
+        // The scaler fades out the audio of the previous position by itself
         m_pReadAheadManager->notifySeek(m_filepos_play);
+    } else {
+        if (m_rate_old != 0.0) {
+            // Before seeking, read extra buffer for crossfading
+            // this also sets m_pReadAheadManager to newpos
+            readToCrossfadeBuffer(m_iLastBufferSize);
+        } else {
+            m_pReadAheadManager->notifySeek(m_filepos_play);
+        }
+        m_pScale->clear();
     }
-    m_pScale->clear();
 
     // Ensures that the playpos slider gets updated in next process call
     m_iSamplesSinceLastIndicatorUpdate = 1000000;
@@ -516,6 +618,7 @@ void EngineBuffer::slotTrackLoading() {
 }
 
 void EngineBuffer::loadFakeTrack(TrackPointer pTrack, bool bPlay) {
+    allocateTrackBuffers();
     if (bPlay) {
         m_playButton->set((double)bPlay);
     }
@@ -586,10 +689,22 @@ void EngineBuffer::ejectTrack() {
     m_playposSlider->set(0);
     m_pCueControl->resetIndicators();
 
+    // Close open file handles by unloading the current track. The engine
+    // must not read from the reader meanwhile, because the worker frees
+    // a resident sample immediately.
+    m_pReader->newTrack(TrackPointer());
+
     m_pause.unlock();
 
-    // Close open file handles by unloading the current track
-    m_pReader->newTrack(TrackPointer());
+    // Keep the buffers for a while in case the next track is loaded soon.
+    // This might be invoked from the worker thread that does not own the
+    // timer.
+    // The interval is passed explicitly, because retrying the release
+    // restarts the timer with a shorter interval.
+    QMetaObject::invokeMethod(&m_releaseTrackBuffersTimer,
+            "start",
+            Qt::QueuedConnection,
+            Q_ARG(int, m_releaseTrackBuffersDelayMillis));
 
     if (pOldTrack) {
         notifyTrackLoaded(TrackPointer(), pOldTrack);
@@ -1002,8 +1117,15 @@ void EngineBuffer::processTrackLocked(
     // If the buffer is not paused, then scale the audio.
     if (!bCurBufferPaused) {
         // Perform scaling of Reader buffer into buffer.
+        const bool bKeylockActive = m_pScale == m_pScaleKeylock;
+        if (bKeylockActive) {
+            m_keylockTimer.start();
+        }
         double framesRead =
                 m_pScale->scaleBuffer(pOutput, iBufferSize);
+        if (bKeylockActive) {
+            m_timeInKeylock += m_keylockTimer.elapsed();
+        }
 
         // TODO(XXX): The result framesRead might not be an integer value.
         // Converting to samples here does not make sense. All positional
@@ -1047,6 +1169,9 @@ void EngineBuffer::processTrackLocked(
             SampleUtil::clear(pOutput, iBufferSize);
         }
     }
+    // Also while paused, otherwise the indicators would keep the values
+    // of the last buffer that has been played.
+    updateKeylockIndicators(iBufferSize);
 
     for (const auto& pControl: qAsConst(m_engineControls)) {
         pControl->setCurrentSample(m_filepos_play, m_trackSamplesOld, m_trackSampleRateOld);
@@ -1080,6 +1205,12 @@ void EngineBuffer::processTrackLocked(
     hintReader(rate);
 }
 
+void EngineBuffer::processInactive() {
+    // Process the TRACK_UNLOADED update of the reader and return its
+    // chunks if the cache is about to be released
+    m_pReader->process();
+}
+
 void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     // Bail if we receive a buffer size with incomplete sample frames. Assert in debug builds.
     VERIFY_OR_DEBUG_ASSERT((iBufferSize % kSamplesPerFrame) == 0) {
@@ -1098,16 +1229,20 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
 
     m_iSampleRate = static_cast<int>(m_pSampleRate->get());
 
-    // If the sample rate has changed, force Rubberband to reset so that
-    // it doesn't reallocate when the user engages keylock during playback.
-    // We do this even if rubberband is not active.
-    const auto sampleRate = mixxx::audio::SampleRate(m_iSampleRate);
-    m_pScaleLinear->setSampleRate(sampleRate);
-    m_pScaleST->setSampleRate(sampleRate);
-    m_pScaleRB->setSampleRate(sampleRate);
-
     bool bTrackLoading = atomicLoadRelaxed(m_iTrackLoading) != 0;
     if (!bTrackLoading && m_pause.tryLock()) {
+        // If the sample rate has changed, force Rubberband to reset so that
+        // it doesn't reallocate when the user engages keylock during playback.
+        // We do this even if rubberband is not active. The scalers are only
+        // touched while holding the pause lock, because their buffers are
+        // allocated and released by the GUI thread.
+        const auto sampleRate = mixxx::audio::SampleRate(m_iSampleRate);
+        m_pScaleLinear->setSampleRate(sampleRate);
+        m_pScaleST->setSampleRate(sampleRate);
+        m_pScaleRB->setSampleRate(sampleRate);
+        m_pScaleLinear->setInterpolation(m_pResamplerQuality->toBool()
+                        ? EngineBufferScaleLinear::Interpolation::Cubic
+                        : EngineBufferScaleLinear::Interpolation::Linear);
         processTrackLocked(pOutput, iBufferSize, m_iSampleRate);
         // release the pauselock
         m_pause.unlock();
@@ -1348,6 +1483,11 @@ void EngineBuffer::updateIndicators(double speed, int iBufferSize) {
 }
 
 void EngineBuffer::hintReader(const double dRate) {
+    // The reader pool serves playing decks before the idle ones
+    m_pReader->setPriority(dRate != 0.0
+                    ? EngineWorker::Priority::High
+                    : EngineWorker::Priority::Low);
+
     m_hintList.clear();
     m_pReadAheadManager->hintReader(dRate, &m_hintList);
 
@@ -1376,6 +1516,7 @@ void EngineBuffer::loadTrack(TrackPointer pTrack, bool play) {
         // Signal to the reader to load the track. The reader will respond with
         // trackLoading and then either with trackLoaded or trackLoadFailed signals.
         m_bPlayAfterLoading = play;
+        allocateTrackBuffers();
         m_pReader->newTrack(pTrack);
     } else {
         // Loading a null track means "eject"
@@ -22,6 +22,7 @@
 
 #include <QAtomicInt>
 #include <QMutex>
+#include <QTimer>
 
 #include "control/controlvalue.h"
 #include "engine/cachingreader/cachingreader.h"
@@ -29,6 +30,8 @@
 #include "engine/sync/syncable.h"
 #include "preferences/usersettings.h"
 #include "track/track_decl.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
 #include "util/rotary.h"
 #include "util/types.h"
 
@@ -144,6 +147,9 @@ class EngineBuffer : public EngineObject {
     void process(CSAMPLE* pOut, const int iBufferSize);
     void processSlip(int iBufferSize);
     void postProcess(const int iBufferSize);
+    // Invoked instead of process() while the deck is inactive, e.g. after
+    // the track has been ejected. Completes the unloading of the reader.
+    void processInactive();
 
     /// Return true iff a seek is currently queued but not yet processed
     /// If no seek was queued, the seek position is set to -1
@@ -152,6 +158,18 @@ class EngineBuffer : public EngineObject {
     bool isTrackLoaded() const;
     TrackPointer getLoadedTrack() const;
 
+    /// Return true if the reader has processed all requested chunks, see
+    /// CachingReader::isIdle()
+    bool isReaderIdle() const {
+        return m_pReader->isIdle();
+    }
+
+    /// Decode short tracks completely while loading, see
+    /// CachingReader::setResidentSamples()
+    void setResidentSamples(bool enabled) {
+        m_pReader->setResidentSamples(enabled);
+    }
+
     double getExactPlayPos() const;
     double getVisualPlayPos() const;
     double getTrackSamples() const;
@@ -184,6 +202,19 @@ class EngineBuffer : public EngineObject {
     // has completed.
     void loadTrack(TrackPointer pTrack, bool play);
 
+    // The memory that is allocated by all EngineBuffers for playing tracks,
+    // i.e. the reader caches, resident samples and the buffers of the
+    // keylock scalers. The memory that RubberBand allocates internally for
+    // its stretchers is not included, because its API does not expose it.
+    // The stretchers are released together with the buffers.
+    static qint64 allocatedTrackBufferBytes();
+
+    // The time the buffers are kept after ejecting a track, in case the
+    // next track is loaded soon. Only for testing.
+    void setReleaseTrackBuffersDelay(int millis) {
+        m_releaseTrackBuffersDelayMillis = millis;
+    }
+
   public slots:
     void slotControlPlayRequest(double);
     void slotControlPlayFromStart(double);
@@ -211,6 +242,7 @@ class EngineBuffer : public EngineObject {
     // Fired when passthrough mode is enabled or disabled.
     void slotPassthroughChanged(double v);
     void slotUpdatedTrackBeats();
+    void slotReleaseTrackBuffers();
 
   private:
     // Add an engine control to the EngineBuffer
@@ -220,6 +252,9 @@ class EngineBuffer : public EngineObject {
     void enableIndependentPitchTempoScaling(bool bEnable,
                                             const int iBufferSize);
 
+    // Must be called from the GUI thread before loading a track
+    void allocateTrackBuffers();
+
     void updateIndicators(double rate, int iBufferSize);
 
     void hintReader(const double rate);
@@ -235,6 +270,7 @@ class EngineBuffer : public EngineObject {
     // for transitioning from one scaler to another, or reseeking a scaler
     // to prevent pops.
     void readToCrossfadeBuffer(const int iBufferSize);
+    void updateKeylockIndicators(const int iBufferSize);
 
     // Copy the play position from the given buffer
     void seekCloneBuffer(EngineBuffer* pOtherBuffer);
@@ -354,6 +390,7 @@ class EngineBuffer : public EngineObject {
     ControlPotmeter* m_playposSlider;
     ControlProxy* m_pSampleRate;
     ControlProxy* m_pKeylockEngine;
+    ControlProxy* m_pResamplerQuality;
     ControlPushButton* m_pKeylock;
 
     // This ControlProxys is created as parent to this and deleted by
@@ -422,6 +459,19 @@ class EngineBuffer : public EngineObject {
     bool m_bCrossfadeReady;
     int m_iLastBufferSize;
 
+    ControlObject* m_pKeylockLatency;
+    ControlObject* m_pKeylockUsage;
+    PerformanceTimer m_keylockTimer;
+    mixxx::Duration m_timeInKeylock;
+    SINT m_framesSinceKeylockUsageUpdate;
+
+    // The reader cache and the buffers of the scalers are allocated when
+    // loading a track and released after the grace period when ejected.
+    // Only accessed from the GUI thread.
+    QTimer m_releaseTrackBuffersTimer;
+    int m_releaseTrackBuffersDelayMillis;
+    bool m_bTrackBuffersAllocated;
+
     QSharedPointer<VisualPlayPosition> m_visualPlayPos;
 };
 
@@ -177,6 +177,19 @@ EngineMaster::EngineMaster(
                                          true, false, true);
     m_pKeylockEngine->set(pConfig->getValueString(
             ConfigKey(group, "keylock_engine")).toDouble());
+    // Options of the RubberBand keylock engine for seeking during playback,
+    // see EngineBufferScaleRubberBand
+    m_pKeylockPreroll = new ControlPushButton(
+            ConfigKey(group, "keylock_preroll"), true);
+    m_pKeylockPreroll->setButtonMode(ControlPushButton::TOGGLE);
+    m_pKeylockCrossfade = new ControlPushButton(
+            ConfigKey(group, "keylock_crossfade"), true);
+    m_pKeylockCrossfade->setButtonMode(ControlPushButton::TOGGLE);
+    // Linear (0) or cubic (1) interpolation when keylock is off,
+    // see EngineBufferScaleLinear
+    m_pResamplerQuality = new ControlPushButton(
+            ConfigKey(group, "resampler_quality"), true);
+    m_pResamplerQuality->setButtonMode(ControlPushButton::TOGGLE);
 
     // TODO: Make this read only and make EngineMaster decide whether
     // processing the master mix is necessary.
@@ -197,6 +210,9 @@ EngineMaster::EngineMaster(
 EngineMaster::~EngineMaster() {
     //qDebug() << "in ~EngineMaster()";
     delete m_pKeylockEngine;
+    delete m_pKeylockPreroll;
+    delete m_pKeylockCrossfade;
+    delete m_pResamplerQuality;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -292,7 +308,11 @@ void EngineMaster::processChannels(int iBufferSize) {
         EngineChannel* pChannel = pChannelInfo->m_pChannel;
 
         // Skip inactive channels.
-        if (!pChannel || !pChannel->isActive()) {
+        if (!pChannel) {
+            continue;
+        }
+        if (!pChannel->isActive()) {
+            pChannel->processInactive();
             continue;
         }
 
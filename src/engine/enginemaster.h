@@ -340,6 +340,9 @@ class EngineMaster : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    ControlPushButton* m_pKeylockPreroll;
+    ControlPushButton* m_pKeylockCrossfade;
+    ControlPushButton* m_pResamplerQuality;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
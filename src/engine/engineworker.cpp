@@ -2,19 +2,31 @@
 // Created 6/2/2010 by RJ Ryan (rryan@mit.edu)
 
 #include "engine/engineworker.h"
+
+#include <QThread>
+
 #include "engine/engineworkerscheduler.h"
 
 EngineWorker::EngineWorker()
-    : m_pScheduler(nullptr) {
-    m_notReady.test_and_set();
+        : m_pScheduler(nullptr),
+          m_state(State::Idle),
+          m_priority(Priority::Low) {
 }
 
 EngineWorker::~EngineWorker() {
+    // Derived classes must have stopped the scheduling, otherwise run()
+    // might still be executing on a pool thread.
+    DEBUG_ASSERT(m_pScheduler == nullptr);
 }
 
 void EngineWorker::run() {
 }
 
+bool EngineWorker::isRunningOnReservedThread() const {
+    return m_pScheduler &&
+            m_pScheduler->isReservedThread(QThread::currentThread());
+}
+
 void EngineWorker::setScheduler(EngineWorkerScheduler* pScheduler) {
     DEBUG_ASSERT(m_pScheduler == nullptr);
     m_pScheduler = pScheduler;
@@ -22,15 +34,51 @@ void EngineWorker::setScheduler(EngineWorkerScheduler* pScheduler) {
 }
 
 void EngineWorker::workReady() {
-    m_notReady.clear();
     VERIFY_OR_DEBUG_ASSERT(m_pScheduler) {
-        return;     
+        return;
+    }
+    State state = m_state.load();
+    while (true) {
+        State nextState;
+        switch (state) {
+        case State::Idle:
+            nextState = State::Ready;
+            break;
+        case State::Running:
+            nextState = State::RunningReady;
+            break;
+        default:
+            // Already scheduled or removed
+            return;
+        }
+        if (m_state.compare_exchange_weak(state, nextState)) {
+            break;
+        }
     }
     m_pScheduler->workerReady();
 }
 
-void EngineWorker::wakeIfReady() {
-    if (!m_notReady.test_and_set()) {
-        m_semaRun.release();
+bool EngineWorker::tryClaim() {
+    State state = State::Ready;
+    return m_state.compare_exchange_strong(state, State::Running);
+}
+
+void EngineWorker::finishRun() {
+    State state = State::Running;
+    if (m_state.compare_exchange_strong(state, State::Idle)) {
+        return;
+    }
+    // workReady() has been called in the meantime. The scheduler has
+    // already been notified and the next scan of the pool will pick up
+    // the worker again.
+    DEBUG_ASSERT(state == State::RunningReady);
+    m_state.store(State::Ready);
+}
+
+void EngineWorker::stopScheduling() {
+    if (m_pScheduler) {
+        m_pScheduler->removeWorker(this);
+        DEBUG_ASSERT(m_pScheduler == nullptr);
     }
+    m_state.store(State::Removed);
 }
@@ -4,36 +4,90 @@
 #ifndef ENGINEWORKER_H
 #define ENGINEWORKER_H
 
-#include <atomic>
 #include <QObject>
-#include <QSemaphore>
-#include <QThread>
+#include <atomic>
 
 // EngineWorker is an interface for running background processing work when the
 // audio callback is not active. While the audio callback is active, an
-// EngineWorker can emit its workReady signal, and an EngineWorkerManager will
-// schedule it for running after the audio callback has completed.
+// EngineWorker can call workReady(), and the EngineWorkerScheduler will run it
+// on one of the threads of its pool after the audio callback has completed.
+//
+// A worker does not own a thread. Its run() method is invoked by the pool
+// whenever work is pending and must return after a bounded amount of work.
+// If more work is left it calls workReady() again to be requeued, which gives
+// the other workers a chance to run in between.
 
 class EngineWorkerScheduler;
 
-class EngineWorker : public QThread {
+class EngineWorker : public QObject {
     Q_OBJECT
   public:
+    // Ready workers with a higher priority are run first, e.g. the readers
+    // of playing decks before those of idle samplers.
+    enum class Priority {
+        Low,
+        High,
+    };
+
     EngineWorker();
-    virtual ~EngineWorker();
+    ~EngineWorker() override;
 
     virtual void run();
 
     void setScheduler(EngineWorkerScheduler* pScheduler);
+
+    // Lock-free and safe to call from any thread, including the engine
+    // callback. The worker runs at most once at a time, a call while it
+    // is running schedules another run afterwards.
     void workReady();
-    void wakeIfReady();
+
+    // Returns true while the worker is scheduled or running
+    bool isBusy() const {
+        return m_state.load() != State::Idle;
+    }
+
+    Priority priority() const {
+        return m_priority.load(std::memory_order_relaxed);
+    }
+    void setPriority(Priority priority) {
+        m_priority.store(priority, std::memory_order_relaxed);
+    }
+
+    // Returns true if the next run will take much longer than a few chunk
+    // reads, e.g. for opening a file. Safe to call from any thread.
+    virtual bool hasLongRunningWork() const {
+        return false;
+    }
 
   protected:
-    QSemaphore m_semaRun;
+    // Returns true while run() is invoked by the thread that the scheduler
+    // reserves for high priority work. Long-running work must be deferred
+    // by calling workReady() again, it will be picked up by another thread.
+    bool isRunningOnReservedThread() const;
+
+    // Removes the worker from the scheduler and waits until it is no longer
+    // running. Must be called by the destructor of derived classes, before
+    // any state accessed by run() is destroyed.
+    void stopScheduling();
 
   private:
+    friend class EngineWorkerScheduler;
+
+    enum class State {
+        Idle,
+        Ready,
+        Running,
+        RunningReady, // workReady() has been called while running
+        Removed,
+    };
+
+    // Invoked by the scheduler on its pool threads
+    bool tryClaim();
+    void finishRun();
+
     EngineWorkerScheduler* m_pScheduler;
-    std::atomic_flag m_notReady;
+    std::atomic<State> m_state;
+    std::atomic<Priority> m_priority;
 };
 
 #endif /* ENGINEWORKER_H */
@@ -1,61 +1,184 @@
 // engineworkerscheduler.cpp
 // Created 6/2/2010 by RJ Ryan (rryan@mit.edu)
 
+#include "engine/engineworkerscheduler.h"
+
 #include <QtDebug>
 
 #include "engine/engineworker.h"
-#include "engine/engineworkerscheduler.h"
-#include "util/event.h"
+#include "util/math.h"
 
-EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent)
-        : m_bWakeScheduler(false),
+EngineWorkerScheduler::WorkerThread::WorkerThread(
+        EngineWorkerScheduler* pScheduler, int index)
+        : m_scanSequence(0),
+          m_pScheduler(pScheduler) {
+    setObjectName(QString("EngineWorker %1").arg(index + 1));
+}
+
+void EngineWorkerScheduler::WorkerThread::run() {
+    m_pScheduler->runThread(this);
+}
+
+EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent, int threadCount)
+        : QObject(pParent),
+          m_slotCount(0),
+          m_nextSlot(0),
+          m_bWakeScheduler(false),
           m_bQuit(false) {
-    Q_UNUSED(pParent);
+    for (auto& slot : m_slots) {
+        slot.store(nullptr);
+    }
+    if (threadCount <= 0) {
+        threadCount = math_clamp(QThread::idealThreadCount(), 1, kMaxDefaultThreadCount);
+    }
+    m_threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        m_threads.push_back(std::make_unique<WorkerThread>(this, i));
+    }
 }
 
 EngineWorkerScheduler::~EngineWorkerScheduler() {
-    m_bQuit = true;
-    m_waitCondition.wakeAll();
-    wait();
+    m_bQuit.store(true);
+    m_semaWake.release(threadCount());
+    for (const auto& pThread : m_threads) {
+        pThread->wait();
+    }
+    // The workers might outlive the scheduler
+    QMutexLocker locker(&m_registrationMutex);
+    for (int i = 0; i < m_slotCount.load(); ++i) {
+        EngineWorker* pWorker = m_slots[i].load();
+        if (pWorker) {
+            pWorker->m_pScheduler = nullptr;
+        }
+    }
+}
+
+void EngineWorkerScheduler::start(QThread::Priority priority) {
+    for (const auto& pThread : m_threads) {
+        pThread->start(priority);
+    }
 }
 
 void EngineWorkerScheduler::workerReady() {
-    m_bWakeScheduler = true;
+    m_bWakeScheduler.store(true);
 }
 
 void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
     DEBUG_ASSERT(pWorker);
-    QMutexLocker locker(&m_mutex);
-    m_workers.push_back(pWorker);
+    QMutexLocker locker(&m_registrationMutex);
+    const int slotCount = m_slotCount.load();
+    for (int i = 0; i < slotCount; ++i) {
+        if (!m_slots[i].load()) {
+            m_slots[i].store(pWorker);
+            return;
+        }
+    }
+    VERIFY_OR_DEBUG_ASSERT(slotCount < MAX_ENGINE_WORKERS) {
+        qWarning() << "EngineWorkerScheduler: Too many workers";
+        return;
+    }
+    m_slots[slotCount].store(pWorker);
+    m_slotCount.store(slotCount + 1);
 }
 
-void EngineWorkerScheduler::runWorkers() {
-    // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
-        m_waitCondition.wakeAll();
-    }
-}
-
-void EngineWorkerScheduler::run() {
-    static const QString tag("EngineWorkerScheduler");
-    while (!m_bQuit) {
-        Event::start(tag);
-        {
-            QMutexLocker lock(&m_mutex);
-            for(const auto& pWorker: m_workers) {
-                pWorker->wakeIfReady();
+void EngineWorkerScheduler::removeWorker(EngineWorker* pWorker) {
+    DEBUG_ASSERT(pWorker);
+    QMutexLocker locker(&m_registrationMutex);
+    for (int i = 0; i < m_slotCount.load(); ++i) {
+        if (m_slots[i].load() == pWorker) {
+            m_slots[i].store(nullptr);
+            break;
+        }
+    }
+
+    // Pool threads that are currently scanning might still have seen
+    // the worker in its slot. Wait until they are done.
+    for (const auto& pThread : m_threads) {
+        const quint64 scanSequence = pThread->m_scanSequence.load();
+        if (scanSequence % 2 == 1) {
+            while (pThread->m_scanSequence.load() == scanSequence) {
+                QThread::yieldCurrentThread();
             }
         }
-        Event::end(tag);
-        {
-            QMutexLocker lock(&m_mutex);
-            if (!m_bQuit) {
-                // Wait for next runWorkers() call
-                m_waitCondition.wait(&m_mutex); // unlock mutex and wait
+    }
+
+    // Wait for a pending run
+    auto state = pWorker->m_state.load();
+    while (true) {
+        if (state == EngineWorker::State::Running ||
+                state == EngineWorker::State::RunningReady) {
+            QThread::yieldCurrentThread();
+            state = pWorker->m_state.load();
+            continue;
+        }
+        if (pWorker->m_state.compare_exchange_weak(
+                    state, EngineWorker::State::Removed)) {
+            break;
+        }
+    }
+    pWorker->m_pScheduler = nullptr;
+}
+
+void EngineWorkerScheduler::runWorkers() {
+    // Wake the pool threads if a worker has become ready since the last
+    // call. The semaphore is only released for threads that are not
+    // already awake and will scan the slots anyway.
+    if (m_bWakeScheduler.exchange(false)) {
+        const int wakeCount = threadCount() - m_semaWake.available();
+        if (wakeCount > 0) {
+            m_semaWake.release(wakeCount);
+        }
+    }
+}
+
+EngineWorker* EngineWorkerScheduler::claimWorker(WorkerThread* pThread) {
+    // Mark the scan as in progress for removeWorker()
+    pThread->m_scanSequence.fetch_add(1);
+    EngineWorker* pClaimedWorker = nullptr;
+    const int slotCount = m_slotCount.load();
+    // Continue after the last claimed worker, otherwise a worker that
+    // requeues itself would starve the workers with the same priority
+    // in the following slots.
+    const int firstSlot = m_nextSlot.load(std::memory_order_relaxed);
+    const bool reserved = isReservedThread(pThread);
+    for (auto priority : {EngineWorker::Priority::High, EngineWorker::Priority::Low}) {
+        if (reserved && priority != EngineWorker::Priority::High) {
+            break;
+        }
+        for (int n = 0; n < slotCount; ++n) {
+            const int i = (firstSlot + n) % slotCount;
+            EngineWorker* pWorker = m_slots[i].load();
+            if (!pWorker || pWorker->priority() != priority ||
+                    (reserved && pWorker->hasLongRunningWork()) ||
+                    !pWorker->tryClaim()) {
+                continue;
+            }
+            if (m_slots[i].load() != pWorker) {
+                // Removed concurrently, undo the claim
+                pWorker->finishRun();
+                continue;
             }
+            pClaimedWorker = pWorker;
+            m_nextSlot.store(i + 1, std::memory_order_relaxed);
+            break;
+        }
+        if (pClaimedWorker) {
+            break;
+        }
+    }
+    pThread->m_scanSequence.fetch_add(1);
+    return pClaimedWorker;
+}
+
+void EngineWorkerScheduler::runThread(WorkerThread* pThread) {
+    while (!m_bQuit.load()) {
+        EngineWorker* pWorker = claimWorker(pThread);
+        if (!pWorker) {
+            // Sleep until the next runWorkers() call
+            m_semaWake.acquire();
+            continue;
         }
+        pWorker->run();
+        pWorker->finishRun();
     }
 }
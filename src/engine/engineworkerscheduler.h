@@ -2,40 +2,95 @@
 #define ENGINEWORKERSCHEDULER_H
 
 #include <QMutex>
-#include <QThreadPool>
-#include <QWaitCondition>
+#include <QObject>
+#include <QSemaphore>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
 
-#include "util/fifo.h"
-
-// The max engine workers that can be expected to run within a callback
-// (e.g. the max that we will schedule). Must be a power of 2.
-#define MAX_ENGINE_WORKERS 32
+// The max number of engine workers that can be registered, i.e. one reader
+// for each deck, sampler and preview deck.
+#define MAX_ENGINE_WORKERS 256
 
 class EngineWorker;
 
-class EngineWorkerScheduler : public QThread {
+// Runs the ready EngineWorkers on a small, fixed pool of threads.
+//
+// Workers are registered in a fixed array of slots. The pool threads scan
+// the slots and claim any ready worker with an atomic state transition,
+// preferring workers with a high priority. The engine callback only sets an
+// atomic flag and wakes sleeping pool threads through a semaphore, no mutex
+// is shared between the callback and the pool.
+//
+// With more than one thread the first thread is reserved for high priority
+// workers without long-running work, i.e. the chunk reads of playing decks
+// never wait for track loads that occupy all other threads.
+class EngineWorkerScheduler : public QObject {
     Q_OBJECT
   public:
-    EngineWorkerScheduler(QObject* pParent=NULL);
-    virtual ~EngineWorkerScheduler();
+    // The number of threads defaults to the number of cores, but at most
+    // kMaxDefaultThreadCount. Reading is mostly bound by disk I/O and
+    // decoding is fast compared to the playback of a chunk.
+    static constexpr int kMaxDefaultThreadCount = 4;
+
+    explicit EngineWorkerScheduler(QObject* pParent = nullptr, int threadCount = 0);
+    ~EngineWorkerScheduler() override;
+
+    // Starts the pool threads
+    void start(QThread::Priority priority = QThread::InheritPriority);
 
     void addWorker(EngineWorker* pWorker);
+    // Blocks until the worker is no longer running. Afterwards it will
+    // not be run again.
+    void removeWorker(EngineWorker* pWorker);
+
+    // Wakes the pool if any worker has become ready since the last call.
+    // Called by the engine callback after processing.
     void runWorkers();
     void workerReady();
 
-  protected:
-    void run();
+    int threadCount() const {
+        return static_cast<int>(m_threads.size());
+    }
+
+    bool isReservedThread(const QThread* pThread) const {
+        return m_threads.size() > 1 && pThread == m_threads.front().get();
+    }
 
   private:
-    // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    class WorkerThread : public QThread {
+      public:
+        WorkerThread(EngineWorkerScheduler* pScheduler, int index);
+
+        // Odd while the thread is scanning the slots for a ready worker
+        std::atomic<quint64> m_scanSequence;
+
+      protected:
+        void run() override;
+
+      private:
+        EngineWorkerScheduler* const m_pScheduler;
+    };
+
+    void runThread(WorkerThread* pThread);
+    EngineWorker* claimWorker(WorkerThread* pThread);
+
+    std::array<std::atomic<EngineWorker*>, MAX_ENGINE_WORKERS> m_slots;
+    // Only modified by addWorker() and removeWorker() that are serialized
+    // by m_registrationMutex. The pool threads never lock it.
+    std::atomic<int> m_slotCount;
+    QMutex m_registrationMutex;
+    // The slot where the next scan starts
+    std::atomic<int> m_nextSlot;
 
-    std::vector<EngineWorker*> m_workers;
+    std::vector<std::unique_ptr<WorkerThread>> m_threads;
 
-    QWaitCondition m_waitCondition;
-    QMutex m_mutex;
-    volatile bool m_bQuit;
+    // Set by workerReady() and cleared by runWorkers()
+    std::atomic<bool> m_bWakeScheduler;
+    QSemaphore m_semaWake;
+    std::atomic<bool> m_bQuit;
 };
 
 #endif /* ENGINEWORKERSCHEDULER_H */
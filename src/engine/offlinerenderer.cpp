@@ -0,0 +1,557 @@
+#include "engine/offlinerenderer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRegExp>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "effects/builtin/builtinbackend.h"
+#include "effects/effectsmanager.h"
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "engine/channels/enginedeck.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginemaster.h"
+#include "mixer/deck.h"
+#include "mixer/playerinfo.h"
+#include "mixer/sampler.h"
+#include "recording/defs_recording.h"
+#include "soundio/soundmanagerutil.h"
+#include "sources/soundsourceproxy.h"
+#include "track/track.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+#include "waveform/guitick.h"
+#include "waveform/visualsmanager.h"
+
+namespace {
+
+const mixxx::Logger kLogger("OfflineRenderer");
+
+const QString kMasterGroup = QStringLiteral("[Master]");
+
+constexpr int kMaxDeckCount = 64;
+constexpr int kMaxSamplerCount = 64;
+constexpr int kMinFramesPerBuffer = 32;
+constexpr int kMaxFramesPerBuffer = 16384;
+
+// Upper bound for loading a single track before giving up
+constexpr qint64 kTrackLoadTimeoutMillis = 30000;
+
+// Upper bound for reading the chunks requested while processing a
+// single buffer before giving up
+constexpr qint64 kReaderTimeoutMillis = 30000;
+
+// Keeps the event loop of the main thread responsive without
+// spending too much time outside of the engine
+constexpr int kBuffersPerEventLoopIteration = 16;
+
+class FileEncoderCallback : public EncoderCallback {
+  public:
+    explicit FileEncoderCallback(const QString& filePath)
+            : m_file(filePath) {
+    }
+
+    bool open() {
+        return m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    QString errorString() const {
+        return m_file.errorString();
+    }
+
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override {
+        if (headerLen > 0) {
+            m_file.write(reinterpret_cast<const char*>(header), headerLen);
+        }
+        m_file.write(reinterpret_cast<const char*>(body), bodyLen);
+    }
+    int tell() override {
+        return static_cast<int>(m_file.pos());
+    }
+    void seek(int pos) override {
+        m_file.seek(pos);
+    }
+    int filelen() override {
+        return static_cast<int>(m_file.size());
+    }
+
+  private:
+    QFile m_file;
+};
+
+QString encodingForFile(const QString& filePath) {
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == QLatin1String("wav")) {
+        return ENCODING_WAVE;
+    } else if (suffix == QLatin1String("aif") || suffix == QLatin1String("aiff")) {
+        return ENCODING_AIFF;
+    } else if (suffix == QLatin1String("flac")) {
+        return ENCODING_FLAC;
+    } else if (suffix == QLatin1String("ogg")) {
+        return ENCODING_OGG;
+    } else if (suffix == QLatin1String("mp3")) {
+        return ENCODING_MP3;
+    } else if (suffix == QLatin1String("opus")) {
+        return ENCODING_OPUS;
+    }
+    return QString();
+}
+
+bool parseConfigKey(
+        const QString& group,
+        const QString& item,
+        ConfigKey* pKey) {
+    *pKey = ConfigKey(group, item);
+    return pKey->isValid() &&
+            group.startsWith(QChar('[')) &&
+            group.endsWith(QChar(']'));
+}
+
+// The engine and all players that are needed for rendering. Mirrors
+// the setup of MixxxMainWindow without any sound devices.
+class RenderEngine {
+  public:
+    RenderEngine(UserSettingsPointer pConfig,
+            int deckCount,
+            int samplerCount,
+            int sampleRate)
+            : m_pChannelHandleFactory(std::make_shared<ChannelHandleFactory>()),
+              m_numDecks(ConfigKey(kMasterGroup, "num_decks")),
+              m_numSamplers(ConfigKey(kMasterGroup, "num_samplers")) {
+        m_pEffectsManager = std::make_unique<EffectsManager>(
+                nullptr, pConfig, m_pChannelHandleFactory);
+        m_pEngine = std::make_unique<EngineMaster>(
+                pConfig,
+                kMasterGroup,
+                m_pEffectsManager.get(),
+                m_pChannelHandleFactory,
+                false);
+        m_pEffectsManager->addEffectsBackend(
+                new BuiltInBackend(m_pEffectsManager.get()));
+        m_pEffectsManager->setup();
+        ControlObject::set(ConfigKey(kMasterGroup, "samplerate"), sampleRate);
+
+        m_pGuiTick = std::make_unique<GuiTick>();
+        m_pVisualsManager = std::make_unique<VisualsManager>();
+        for (int i = 1; i <= deckCount; ++i) {
+            const QString group = QString("[Channel%1]").arg(i);
+            m_players.push_back(std::make_unique<Deck>(
+                    nullptr,
+                    pConfig,
+                    m_pEngine.get(),
+                    m_pEffectsManager.get(),
+                    m_pVisualsManager.get(),
+                    EngineChannel::CENTER,
+                    m_pEngine->registerChannelGroup(group)));
+            ControlObject::set(ConfigKey(group, "master"), 1.0);
+            m_numDecks.set(m_numDecks.get() + 1);
+        }
+        for (int i = 1; i <= samplerCount; ++i) {
+            const QString group = QString("[Sampler%1]").arg(i);
+            m_players.push_back(std::make_unique<Sampler>(
+                    nullptr,
+                    pConfig,
+                    m_pEngine.get(),
+                    m_pEffectsManager.get(),
+                    m_pVisualsManager.get(),
+                    EngineChannel::CENTER,
+                    m_pEngine->registerChannelGroup(group)));
+            m_numSamplers.set(m_numSamplers.get() + 1);
+        }
+        PlayerInfo::create();
+        m_pEffectsManager->loadEffectChains();
+
+        m_pEngine->onOutputConnected(AudioOutput(AudioOutput::MASTER, 0, 2));
+    }
+
+    ~RenderEngine() {
+        // Same order as in MixxxMainWindow::finalize()
+        m_players.clear();
+        PlayerInfo::destroy();
+        m_pEngine.reset();
+        m_pEffectsManager.reset();
+        m_pGuiTick.reset();
+        m_pVisualsManager.reset();
+    }
+
+    EngineMaster* engine() const {
+        return m_pEngine.get();
+    }
+
+    BaseTrackPlayerImpl* player(const QString& group) const {
+        for (const auto& pPlayer : m_players) {
+            if (pPlayer->getGroup() == group) {
+                return pPlayer.get();
+            }
+        }
+        return nullptr;
+    }
+
+    // Blocks until the readers of all players have fetched every chunk
+    // that has been requested while processing the last buffer. Returns
+    // the group of the first player whose reader did not become idle
+    // within kReaderTimeoutMillis or an empty string on success.
+    QString waitForReaders() const {
+        PerformanceTimer timer;
+        timer.start();
+        for (const auto& pPlayer : m_players) {
+            const EngineBuffer* pEngineBuffer =
+                    pPlayer->getEngineDeck()->getEngineBuffer();
+            while (!pEngineBuffer->isReaderIdle()) {
+                if (timer.elapsed().toIntegerMillis() > kReaderTimeoutMillis) {
+                    return pPlayer->getGroup();
+                }
+                QThread::yieldCurrentThread();
+            }
+        }
+        return QString();
+    }
+
+  private:
+    ChannelHandleFactoryPointer m_pChannelHandleFactory;
+    ControlObject m_numDecks;
+    ControlObject m_numSamplers;
+    std::unique_ptr<EffectsManager> m_pEffectsManager;
+    std::unique_ptr<EngineMaster> m_pEngine;
+    std::unique_ptr<GuiTick> m_pGuiTick;
+    std::unique_ptr<VisualsManager> m_pVisualsManager;
+    std::vector<std::unique_ptr<BaseTrackPlayerImpl>> m_players;
+};
+
+} // anonymous namespace
+
+//static
+bool OfflineRenderer::parseScript(
+        QTextStream* pStream,
+        Script* pScript,
+        QString* pErrorMessage) {
+    *pScript = Script();
+    bool hasEnd = false;
+    int lineNumber = 0;
+    auto fail = [pErrorMessage, &lineNumber](const QString& message) {
+        *pErrorMessage = QString("Line %1: %2").arg(lineNumber).arg(message);
+        return false;
+    };
+
+    while (!pStream->atEnd()) {
+        const QString line = pStream->readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith(QChar('#'))) {
+            continue;
+        }
+        const QStringList tokens = line.split(QRegExp("\\s+"));
+        bool ok = false;
+
+        // Directives
+        if (tokens.first() == QLatin1String("decks") ||
+                tokens.first() == QLatin1String("samplers") ||
+                tokens.first() == QLatin1String("samplerate") ||
+                tokens.first() == QLatin1String("buffer")) {
+            if (!pScript->events.isEmpty()) {
+                return fail("Directives must precede all events");
+            }
+            if (tokens.size() != 2) {
+                return fail("Expected a single value");
+            }
+            const int value = tokens.at(1).toInt(&ok);
+            if (tokens.first() == QLatin1String("decks")) {
+                if (!ok || value < 1 || value > kMaxDeckCount) {
+                    return fail("Invalid number of decks " + tokens.at(1));
+                }
+                pScript->deckCount = value;
+            } else if (tokens.first() == QLatin1String("samplers")) {
+                if (!ok || value < 0 || value > kMaxSamplerCount) {
+                    return fail("Invalid number of samplers " + tokens.at(1));
+                }
+                pScript->samplerCount = value;
+            } else if (tokens.first() == QLatin1String("samplerate")) {
+                if (!ok || value < 8000 || value > 192000) {
+                    return fail("Invalid sample rate " + tokens.at(1));
+                }
+                pScript->sampleRate = value;
+            } else {
+                if (!ok || value < kMinFramesPerBuffer || value > kMaxFramesPerBuffer) {
+                    return fail("Invalid buffer size " + tokens.at(1));
+                }
+                pScript->framesPerBuffer = value;
+            }
+            continue;
+        }
+
+        // Events
+        if (hasEnd) {
+            return fail("No events are allowed after end");
+        }
+        if (tokens.size() < 2) {
+            return fail("Expected <seconds> <event> ...");
+        }
+        Event event;
+        event.time = tokens.at(0).toDouble(&ok);
+        if (!ok || event.time < 0) {
+            return fail("Invalid time " + tokens.at(0));
+        }
+        event.value = 0;
+        const QString& type = tokens.at(1);
+        if (type == QLatin1String("load")) {
+            if (tokens.size() < 4) {
+                return fail("Expected <seconds> load <group> <file>");
+            }
+            event.type = Event::Type::Load;
+            event.key = ConfigKey(tokens.at(2), QString());
+            // The file path is the remainder of the line and may contain spaces
+            const int groupPos = line.indexOf(tokens.at(2), line.indexOf(type) + type.size());
+            event.filePath = line.mid(groupPos + tokens.at(2).size()).trimmed();
+        } else if (type == QLatin1String("set")) {
+            if (tokens.size() != 5) {
+                return fail("Expected <seconds> set <group> <item> <value>");
+            }
+            event.type = Event::Type::Set;
+            if (!parseConfigKey(tokens.at(2), tokens.at(3), &event.key)) {
+                return fail("Invalid control " + tokens.at(2) + " " + tokens.at(3));
+            }
+            event.value = tokens.at(4).toDouble(&ok);
+            if (!ok) {
+                return fail("Invalid value " + tokens.at(4));
+            }
+        } else if (type == QLatin1String("bpm")) {
+            if (tokens.size() != 4) {
+                return fail("Expected <seconds> bpm <group> <value>");
+            }
+            event.type = Event::Type::Bpm;
+            event.key = ConfigKey(tokens.at(2), QString());
+            event.value = tokens.at(3).toDouble(&ok);
+            if (!ok || event.value <= 0) {
+                return fail("Invalid bpm " + tokens.at(3));
+            }
+        } else if (type == QLatin1String("end")) {
+            if (tokens.size() != 2) {
+                return fail("Unexpected arguments after end");
+            }
+            event.type = Event::Type::End;
+            hasEnd = true;
+        } else {
+            return fail("Unknown event " + type);
+        }
+        pScript->events.append(event);
+    }
+
+    if (!hasEnd) {
+        ++lineNumber;
+        return fail("Missing end event");
+    }
+    // Events with the same time are applied in the order of the script
+    std::stable_sort(pScript->events.begin(),
+            pScript->events.end(),
+            [](const Event& lhs, const Event& rhs) {
+                return lhs.time < rhs.time;
+            });
+    // Nothing after the end will ever be applied
+    while (pScript->events.last().type != Event::Type::End) {
+        pScript->events.removeLast();
+    }
+    return true;
+}
+
+//static
+bool OfflineRenderer::readScript(
+        const QString& filePath,
+        Script* pScript,
+        QString* pErrorMessage) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *pErrorMessage = QString("Failed to open script %1: %2")
+                                 .arg(filePath, file.errorString());
+        return false;
+    }
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    if (!parseScript(&stream, pScript, pErrorMessage)) {
+        pErrorMessage->prepend(filePath + QChar(' '));
+        return false;
+    }
+    return true;
+}
+
+OfflineRenderer::OfflineRenderer(UserSettingsPointer pConfig)
+        : m_pConfig(pConfig),
+          m_processedBuffers(0),
+          m_buffersPerSecond(0),
+          m_trackBufferBytes(0) {
+}
+
+bool OfflineRenderer::render(
+        const Script& script,
+        const QString& outputFilePath,
+        QString* pErrorMessage) {
+    m_processedBuffers = 0;
+    m_buffersPerSecond = 0;
+    m_trackBufferBytes = 0;
+    m_callbackDurations.clear();
+
+    // Without an output file the master output is discarded
+    std::unique_ptr<FileEncoderCallback> pOutput;
+    EncoderPointer pEncoder;
+    if (!outputFilePath.isEmpty()) {
+        const QString encoding = encodingForFile(outputFilePath);
+        if (encoding.isEmpty()) {
+            *pErrorMessage = "Unsupported output file type " + outputFilePath;
+            return false;
+        }
+        pOutput = std::make_unique<FileEncoderCallback>(outputFilePath);
+        if (!pOutput->open()) {
+            *pErrorMessage = QString("Failed to open output file %1: %2")
+                                     .arg(outputFilePath, pOutput->errorString());
+            return false;
+        }
+        pEncoder = EncoderFactory::getFactory().createRecordingEncoder(
+                EncoderFactory::getFactory().getFormatFor(encoding),
+                m_pConfig,
+                pOutput.get());
+        QString encoderError;
+        if (!pEncoder || pEncoder->initEncoder(script.sampleRate, encoderError) < 0) {
+            *pErrorMessage = QString("Failed to initialize %1 encoder %2")
+                                     .arg(encoding, encoderError);
+            return false;
+        }
+    }
+
+    RenderEngine renderEngine(m_pConfig,
+            script.deckCount,
+            script.samplerCount,
+            script.sampleRate);
+    EngineMaster* pEngine = renderEngine.engine();
+
+    const int samplesPerBuffer = script.framesPerBuffer * 2;
+    const double secondsPerBuffer =
+            static_cast<double>(script.framesPerBuffer) / script.sampleRate;
+
+    // The tracks that have been loaded by the script
+    QMap<QString, TrackPointer> tracks;
+
+    PerformanceTimer timer;
+    timer.start();
+    PerformanceTimer callbackTimer;
+    int nextEvent = 0;
+    bool finished = false;
+    while (!finished) {
+        const double bufferTime = m_processedBuffers * secondsPerBuffer;
+        QList<EngineBuffer*> pendingLoads;
+        while (nextEvent < script.events.size() &&
+                script.events.at(nextEvent).time <= bufferTime) {
+            const Event& event = script.events.at(nextEvent++);
+            switch (event.type) {
+            case Event::Type::Load: {
+                BaseTrackPlayerImpl* pPlayer = renderEngine.player(event.key.group);
+                if (!pPlayer) {
+                    *pErrorMessage = "Unknown player " + event.key.group;
+                    return false;
+                }
+                if (!QFileInfo::exists(event.filePath)) {
+                    *pErrorMessage = "File not found " + event.filePath;
+                    return false;
+                }
+                TrackPointer pTrack = Track::newTemporary(event.filePath);
+                SoundSourceProxy(pTrack).updateTrackFromSource();
+                pPlayer->slotLoadTrack(pTrack, false);
+                pendingLoads.append(pPlayer->getEngineDeck()->getEngineBuffer());
+                tracks.insert(event.key.group, pTrack);
+                break;
+            }
+            case Event::Type::Bpm: {
+                const TrackPointer pTrack = tracks.value(event.key.group);
+                if (!pTrack) {
+                    *pErrorMessage = "No track loaded on " + event.key.group;
+                    return false;
+                }
+                pTrack->setBpm(event.value);
+                break;
+            }
+            case Event::Type::Set: {
+                ControlObject* pControl = ControlObject::getControl(
+                        event.key, ControlFlag::AllowMissingOrInvalid);
+                if (!pControl) {
+                    *pErrorMessage = "Unknown control " + event.key.group +
+                            QChar(' ') + event.key.item;
+                    return false;
+                }
+                pControl->set(event.value);
+                break;
+            }
+            case Event::Type::End:
+                finished = true;
+                break;
+            }
+        }
+        if (finished) {
+            break;
+        }
+
+        callbackTimer.start();
+        pEngine->process(samplesPerBuffer);
+        m_callbackDurations.push_back(callbackTimer.elapsed());
+        if (pEncoder) {
+            pEncoder->encodeBuffer(pEngine->getMasterBuffer(), samplesPerBuffer);
+        }
+        ++m_processedBuffers;
+
+        // The track is loaded by the reader worker that has been
+        // woken up while processing the buffer.
+        for (const EngineBuffer* pEngineBuffer : pendingLoads) {
+            PerformanceTimer loadTimer;
+            loadTimer.start();
+            while (!pEngineBuffer->isTrackLoaded()) {
+                if (loadTimer.elapsed().toIntegerMillis() > kTrackLoadTimeoutMillis) {
+                    *pErrorMessage = "Timed out loading a track on " +
+                            pEngineBuffer->getGroup();
+                    return false;
+                }
+                QCoreApplication::processEvents();
+                QThread::msleep(1);
+            }
+        }
+        const QString stalledGroup = renderEngine.waitForReaders();
+        if (!stalledGroup.isEmpty()) {
+            *pErrorMessage = "Timed out reading the track on " + stalledGroup;
+            return false;
+        }
+
+        if (m_processedBuffers % kBuffersPerEventLoopIteration == 0) {
+            QCoreApplication::processEvents();
+        }
+    }
+    if (pEncoder) {
+        pEncoder->flush();
+    }
+    m_trackBufferBytes = EngineBuffer::allocatedTrackBufferBytes();
+
+    const double elapsedSeconds = timer.elapsed().toDoubleSeconds();
+    if (elapsedSeconds > 0) {
+        m_buffersPerSecond = m_processedBuffers / elapsedSeconds;
+    }
+    kLogger.info()
+            << "Rendered"
+            << m_processedBuffers * secondsPerBuffer
+            << "s of audio in"
+            << elapsedSeconds
+            << "s:"
+            << m_processedBuffers
+            << "buffers with"
+            << script.framesPerBuffer
+            << "frames,"
+            << m_buffersPerSecond
+            << "buffers/s,"
+            << m_buffersPerSecond * secondsPerBuffer
+            << "x realtime";
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <vector>
+
+#include "preferences/configobject.h"
+#include "preferences/usersettings.h"
+#include "util/duration.h"
+
+class QTextStream;
+
+/// Renders the master output of the engine into a file as fast as possible,
+/// i.e. without any sound device and without a GUI.
+///
+/// The engine is driven by a script of timed control events:
+///
+///   # Comment
+///   decks 2
+///   samplers 8
+///   samplerate 44100
+///   buffer 1024
+///   0.0  load [Channel1] /path/to/track.mp3
+///   0.0  bpm [Channel1] 124
+///   0.0  set [Channel1] play 1
+///   10.5 set [Channel1] hotcue_1_activate 1
+///   12.0 set [Master] crossfader 0.5
+///   60.0 end
+///
+/// The bpm event creates a constant beat grid for the track that has been
+/// loaded by the script, e.g. for files that have not been analyzed.
+/// Tracks can be loaded into decks and samplers. Times are given in seconds
+/// of rendered audio. Events are applied at the start of the first buffer
+/// that begins at or after their time, in the order they appear in the
+/// script. The engine waits for pending track
+/// loads and chunk reads after each buffer, which makes the output
+/// deterministic and independent of the speed of the machine.
+class OfflineRenderer {
+  public:
+    struct Event {
+        enum class Type {
+            Load,
+            Bpm,
+            Set,
+            End,
+        };
+
+        double time;
+        Type type;
+        ConfigKey key; // Set: control, Load/Bpm: only the group
+        double value;
+        QString filePath;
+    };
+
+    struct Script {
+        Script()
+                : deckCount(2),
+                  samplerCount(0),
+                  sampleRate(44100),
+                  framesPerBuffer(1024) {
+        }
+
+        int deckCount;
+        int samplerCount;
+        int sampleRate;
+        int framesPerBuffer;
+        QList<Event> events; // sorted by time
+    };
+
+    static bool parseScript(
+            QTextStream* pStream,
+            Script* pScript,
+            QString* pErrorMessage);
+    static bool readScript(
+            const QString& filePath,
+            Script* pScript,
+            QString* pErrorMessage);
+
+    explicit OfflineRenderer(UserSettingsPointer pConfig);
+
+    /// Renders the script into the given file. The encoder is selected by
+    /// the file extension (wav, aiff, flac, ogg, mp3, opus). The output
+    /// is discarded if the file path is empty.
+    bool render(
+            const Script& script,
+            const QString& outputFilePath,
+            QString* pErrorMessage);
+
+    /// Statistics of the last call to render()
+    int processedBuffers() const {
+        return m_processedBuffers;
+    }
+    double buffersPerSecond() const {
+        return m_buffersPerSecond;
+    }
+    /// The memory allocated for playing tracks by all players at the end,
+    /// see EngineBuffer::allocatedTrackBufferBytes()
+    qint64 trackBufferBytes() const {
+        return m_trackBufferBytes;
+    }
+    /// The time spent in EngineMaster::process() for each buffer
+    const std::vector<mixxx::Duration>& callbackDurations() const {
+        return m_callbackDurations;
+    }
+
+  private:
+    const UserSettingsPointer m_pConfig;
+    int m_processedBuffers;
+    double m_buffersPerSecond;
+    qint64 m_trackBufferBytes;
+    std::vector<mixxx::Duration> m_callbackDurations;
+};
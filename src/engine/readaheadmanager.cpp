@@ -167,6 +167,33 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
     return samples_from_reader;
 }
 
+void ReadAheadManager::getPrerollSamples(double dRate, CSAMPLE* pOutput,
+        SINT requested_samples) {
+    VERIFY_OR_DEBUG_ASSERT(even(requested_samples)) {
+        requested_samples--;
+    }
+    if (!m_pReader) {
+        // ReadAheadManagerMock
+        SampleUtil::clear(pOutput, requested_samples);
+        return;
+    }
+    bool in_reverse = dRate < 0;
+    SINT start_sample = SampleUtil::roundPlayPosToFrameStart(
+            m_currentPosition, kNumChannels);
+    // In reverse the samples are copied backwards from the end of the
+    // range, i.e. the preroll is located behind the current position.
+    if (in_reverse) {
+        start_sample += requested_samples;
+    } else {
+        start_sample -= requested_samples;
+    }
+    const auto readResult = m_pReader->read(
+            start_sample, requested_samples, in_reverse, pOutput);
+    if (readResult == CachingReader::ReadResult::UNAVAILABLE) {
+        SampleUtil::clear(pOutput, requested_samples);
+    }
+}
+
 void ReadAheadManager::addRateControl(RateControl* pRateControl) {
     m_pRateControl = pRateControl;
 }
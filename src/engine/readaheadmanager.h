@@ -37,6 +37,12 @@ class ReadAheadManager {
     /// samples read is less than the requested number of samples.
     virtual SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples);
 
+    /// Fills buffer with the samples that precede the current read-ahead
+    /// position in the playback direction given by dRate, e.g. for priming
+    /// a time stretcher after a seek. Neither the position nor the read log
+    /// are modified. Samples that are not cached are filled with silence.
+    virtual void getPrerollSamples(double dRate, CSAMPLE* buffer, SINT requested_samples);
+
     /// Used to add a new EngineControls that ReadAheadManager will use to decide
     /// which samples to return.
     void addLoopingControl();
@@ -15,68 +15,213 @@
 ***************************************************************************/
 
 // This class provides a way to do audio processing that does not need
-// to be executed in real-time. For example, broadcast encoding
-// and recording encoding can be done here. This class uses double-buffering
-// to increase the amount of time the CPU has to do whatever work needs to
-// be done, and that work is executed in a separate thread. (Threading
-// allows the next buffer to be filled while processing a buffer that's is
-// already full.)
+// to be executed in real-time. For example, recording encoding can be done
+// here. Each worker has its own ring buffer and thread. This increases the
+// amount of time the CPU has to do whatever work needs to be done, while
+// the next buffer is filled by the engine, and isolates the workers from
+// each other: if one of them stalls, e.g. on a slow disk, only its own
+// buffer overflows.
 
 #include "engine/sidechain/enginesidechain.h"
 
-#include <QtDebug>
+#include <QMutex>
 #include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtDebug>
+#include <memory>
 
-#include "engine/sidechain/sidechainworker.h"
+#include "control/controlobject.h"
 #include "engine/engine.h"
+#include "engine/sidechain/sidechainworker.h"
 #include "util/counter.h"
 #include "util/event.h"
+#include "util/fifo.h"
+#include "util/math.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
-#define SIDECHAIN_BUFFER_SIZE 65536
+namespace {
+
+// 0.74 s @ 44.1 kHz
+constexpr int kDefaultBufferFrames =
+        EngineSideChain::SIDECHAIN_BUFFER_SIZE / mixxx::kEngineChannelCount;
+// Must hold at least the largest buffer of the engine
+constexpr int kMinBufferFrames = 8192;
+
+} // anonymous namespace
+
+class EngineSideChain::WorkerThread : public QThread {
+  public:
+    WorkerThread(SideChainWorker* pWorker,
+            const QString& group,
+            int bufferFrames)
+            : m_pWorker(pWorker),
+              m_group(group),
+              m_sampleFifo(bufferFrames * mixxx::kEngineChannelCount),
+              m_bufferSize(m_sampleFifo.writeAvailable()),
+              // Wake up the worker early enough to leave it some headroom
+              m_wakeThreshold(m_bufferSize / 4),
+              m_pWorkBuffer(SampleUtil::alloc(m_bufferSize)),
+              m_bStopThread(false),
+              m_bOverflowing(false),
+              m_droppedFrames(0),
+              m_overflows(0),
+              m_droppedFramesControl(ConfigKey(group, "sidechain_dropped_frames")),
+              m_overflowsControl(ConfigKey(group, "sidechain_overflows")) {
+        m_droppedFramesControl.setReadOnly();
+        m_overflowsControl.setReadOnly();
+        // We use HighPriority to prevent starvation by lower-priority processes (Qt
+        // main thread, analysis, etc.). This used to be LowPriority but that is not
+        // a suitable choice since we do semi-realtime tasks
+        // in the sidechain thread. To get reliable timing, it's important
+        // that this work be prioritized over the GUI and non-realtime tasks. See
+        // discussion on Bug #1270583 and Bug #1194543.
+        start(QThread::HighPriority);
+    }
+
+    ~WorkerThread() override {
+        m_waitLock.lock();
+        m_bStopThread = true;
+        m_waitForSamples.wakeAll();
+        m_waitLock.unlock();
+
+        // Wait until the thread has processed the remaining samples.
+        wait();
+
+        m_pWorker->shutdown();
+        m_pWorker.reset();
+        SampleUtil::free(m_pWorkBuffer);
+    }
+
+    // Called from the engine thread, wait-free
+    void writeSamples(const CSAMPLE* pBuffer, int iSamples) {
+        if (m_sampleFifo.writeAvailable() < iSamples) {
+            // The worker does not keep up. Skip the whole buffer instead of
+            // writing a part of it, the worker continues after the gap once
+            // it has caught up.
+            m_droppedFrames.fetch_add(
+                    iSamples / mixxx::kEngineChannelCount,
+                    std::memory_order_relaxed);
+            if (!m_bOverflowing) {
+                m_bOverflowing = true;
+                m_overflows.fetch_add(1, std::memory_order_relaxed);
+                Counter("EngineSideChain::writeSamples buffer overrun").increment();
+            }
+        } else {
+            m_bOverflowing = false;
+            m_sampleFifo.write(pBuffer, iSamples);
+        }
+
+        if (m_sampleFifo.readAvailable() >= m_wakeThreshold) {
+            // Signal to the worker that samples are available.
+            Trace wakeup("EngineSideChain::writeSamples wake up");
+            m_waitForSamples.wakeAll();
+        }
+    }
+
+  private:
+    void run() override {
+        // the id of this thread, for debugging purposes //XXX copypasta (should
+        // factor this out somehow), -kousu 2/2009
+        unsigned static id = 0;
+        QThread::currentThread()->setObjectName(
+                QString("EngineSideChain %1 %2").arg(m_group).arg(++id));
+        static const QString tag("EngineSideChain");
+        Event::start(tag);
+        while (true) {
+            // Sleep until samples are available.
+            m_waitLock.lock();
+            const bool stop = m_bStopThread;
+            if (!stop && m_sampleFifo.readAvailable() < m_wakeThreshold) {
+                Event::end(tag);
+                m_waitForSamples.wait(&m_waitLock);
+                Event::start(tag);
+            }
+            m_waitLock.unlock();
+
+            int samples_read;
+            while ((samples_read = m_sampleFifo.read(m_pWorkBuffer, m_bufferSize))) {
+                Trace process("EngineSideChain::process");
+                m_pWorker->process(m_pWorkBuffer, samples_read);
+            }
+            publishCounters();
+
+            // Exit after the remaining samples have been processed.
+            if (stop) {
+                return;
+            }
+        }
+    }
+
+    void publishCounters() {
+        m_droppedFramesControl.forceSet(static_cast<double>(
+                m_droppedFrames.load(std::memory_order_relaxed)));
+        m_overflowsControl.forceSet(static_cast<double>(
+                m_overflows.load(std::memory_order_relaxed)));
+    }
+
+    std::unique_ptr<SideChainWorker> m_pWorker;
+    const QString m_group;
+
+    FIFO<CSAMPLE> m_sampleFifo;
+    const int m_bufferSize;
+    const int m_wakeThreshold;
+    CSAMPLE* const m_pWorkBuffer;
+
+    // Provides thread safety around the wait condition below.
+    QMutex m_waitLock;
+    // Allows sleeping until we have samples to process.
+    QWaitCondition m_waitForSamples;
+    // Indicates that the thread should exit, guarded by m_waitLock.
+    bool m_bStopThread;
+
+    // Only accessed by the engine thread
+    bool m_bOverflowing;
+    // Written by the engine thread, published by the worker thread
+    std::atomic<qint64> m_droppedFrames;
+    std::atomic<qint64> m_overflows;
+    ControlObject m_droppedFramesControl;
+    ControlObject m_overflowsControl;
+};
 
 EngineSideChain::EngineSideChain(
         UserSettingsPointer pConfig,
         CSAMPLE* sidechainMix)
         : m_pConfig(pConfig),
-          m_bStopThread(false),
-          m_sampleFifo(SIDECHAIN_BUFFER_SIZE),
-          m_pWorkBuffer(SampleUtil::alloc(SIDECHAIN_BUFFER_SIZE)),
-          m_pSidechainMix(sidechainMix) {
-    // We use HighPriority to prevent starvation by lower-priority processes (Qt
-    // main thread, analysis, etc.). This used to be LowPriority but that is not
-    // a suitable choice since we do semi-realtime tasks
-    // in the sidechain thread. To get reliable timing, it's important
-    // that this work be prioritized over the GUI and non-realtime tasks. See
-    // discussion on Bug #1270583 and Bug #1194543.
-    start(QThread::HighPriority);
+          m_pSidechainMix(sidechainMix),
+          m_workers{},
+          m_workerCount(0) {
 }
 
 EngineSideChain::~EngineSideChain() {
-    m_waitLock.lock();
-    m_bStopThread = true;
-    m_waitForSamples.wakeAll();
-    m_waitLock.unlock();
-
-    // Wait until the thread has finished.
-    wait();
-
     MMutexLocker locker(&m_workerLock);
-    while (!m_workers.empty()) {
-        SideChainWorker* pWorker = m_workers.takeLast();
-        pWorker->shutdown();
-        delete pWorker;
+    int workerCount = m_workerCount.load();
+    m_workerCount.store(0);
+    while (workerCount > 0) {
+        delete m_workers[--workerCount];
     }
-    locker.unlock();
-
-    SampleUtil::free(m_pWorkBuffer);
 }
 
-void EngineSideChain::addSideChainWorker(SideChainWorker* pWorker) {
+void EngineSideChain::addSideChainWorker(
+        SideChainWorker* pWorker,
+        const QString& group) {
     MMutexLocker locker(&m_workerLock);
-    m_workers.append(pWorker);
+    const int workerCount = m_workerCount.load();
+    VERIFY_OR_DEBUG_ASSERT(workerCount < kMaxWorkers) {
+        qWarning() << "EngineSideChain: Too many workers, ignoring" << group;
+        pWorker->shutdown();
+        delete pWorker;
+        return;
+    }
+    const int bufferFrames = math_max(
+            m_pConfig->getValue(ConfigKey(group, "SideChainBufferFrames"),
+                    kDefaultBufferFrames),
+            kMinBufferFrames);
+    m_workers[workerCount] = new WorkerThread(pWorker, group, bufferFrames);
+    // Publish the worker to the engine thread
+    m_workerCount.store(workerCount + 1, std::memory_order_release);
 }
 
 void EngineSideChain::receiveBuffer(AudioInput input,
@@ -93,51 +238,9 @@ void EngineSideChain::receiveBuffer(AudioInput input,
 
 void EngineSideChain::writeSamples(const CSAMPLE* pBuffer, int iFrames) {
     Trace sidechain("EngineSideChain::writeSamples");
-    // TODO: remove assumption of stereo buffer
-    const int kChannels = 2;
-    const int iSamples = iFrames * kChannels;
-    int samples_written = m_sampleFifo.write(pBuffer, iSamples);
-
-    if (samples_written != iSamples) {
-        Counter("EngineSideChain::writeSamples buffer overrun").increment();
-    }
-
-    if (m_sampleFifo.writeAvailable() < SIDECHAIN_BUFFER_SIZE / 5) {
-        // Signal to the sidechain that samples are available.
-        Trace wakeup("EngineSideChain::writeSamples wake up");
-        m_waitForSamples.wakeAll();
-    }
-}
-
-void EngineSideChain::run() {
-    // the id of this thread, for debugging purposes //XXX copypasta (should
-    // factor this out somehow), -kousu 2/2009
-    unsigned static id = 0;
-    QThread::currentThread()->setObjectName(QString("EngineSideChain %1").arg(++id));
-    static const QString tag("EngineSideChain");
-    Event::start(tag);
-    while (!m_bStopThread) {
-        // Sleep until samples are available.
-        m_waitLock.lock();
-
-        Event::end(tag);
-        m_waitForSamples.wait(&m_waitLock);
-        m_waitLock.unlock();
-        Event::start(tag);
-
-        int samples_read;
-        while ((samples_read = m_sampleFifo.read(m_pWorkBuffer,
-                                                 SIDECHAIN_BUFFER_SIZE))) {
-            Trace process("EngineSideChain::process");
-            MMutexLocker locker(&m_workerLock);
-            foreach (SideChainWorker* pWorker, m_workers) {
-                pWorker->process(m_pWorkBuffer, samples_read);
-            }
-        }
-
-        // Check to see if we're supposed to exit/stop this thread.
-        if (m_bStopThread) {
-            return;
-        }
+    const int iSamples = iFrames * mixxx::kEngineChannelCount;
+    const int workerCount = m_workerCount.load(std::memory_order_acquire);
+    for (int i = 0; i < workerCount; ++i) {
+        m_workers[i]->writeSamples(pBuffer, iSamples);
     }
 }
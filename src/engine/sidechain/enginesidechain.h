@@ -17,20 +17,21 @@
 #ifndef ENGINESIDECHAIN_H
 #define ENGINESIDECHAIN_H
 
-#include <QThread>
-#include <QMutex>
-#include <QWaitCondition>
-#include <QList>
+#include <QString>
+#include <array>
+#include <atomic>
 
 #include "preferences/usersettings.h"
 #include "engine/sidechain/sidechainworker.h"
 #include "soundio/soundmanagerutil.h"
-#include "util/fifo.h"
 #include "util/mutex.h"
 #include "util/types.h"
 
-class EngineSideChain : public QThread, public AudioDestination {
-    Q_OBJECT
+// Distributes the sidechain mix to the registered workers (e.g. the
+// recording). Each worker has its own ring buffer and processes the samples
+// on its own thread, i.e. a worker that stalls only drops its own samples
+// and does not delay any other worker.
+class EngineSideChain : public AudioDestination {
   public:
     EngineSideChain(UserSettingsPointer pConfig, CSAMPLE* sidechainMix);
     ~EngineSideChain() override;
@@ -46,30 +47,26 @@ class EngineSideChain : public QThread, public AudioDestination {
                        const CSAMPLE* pBuffer,
                        unsigned int iFrames) override;
 
-    // Thread-safe, blocking.
-    void addSideChainWorker(SideChainWorker* pWorker);
+    // Thread-safe, blocking. Takes ownership of the worker. The depth of
+    // its ring buffer is read from [group],SideChainBufferFrames. The
+    // samples it had to drop because its buffer was full are published
+    // in [group],sidechain_dropped_frames and [group],sidechain_overflows.
+    void addSideChainWorker(SideChainWorker* pWorker, const QString& group);
 
     static const int SIDECHAIN_BUFFER_SIZE = 65536;
+    static constexpr int kMaxWorkers = 8;
 
   private:
-    void run() override;
+    class WorkerThread;
 
     UserSettingsPointer m_pConfig;
-    // Indicates that the thread should exit.
-    volatile bool m_bStopThread;
-
-    FIFO<CSAMPLE> m_sampleFifo;
-    CSAMPLE* m_pWorkBuffer;
     CSAMPLE* m_pSidechainMix;
 
-    // Provides thread safety around the wait condition below.
-    QMutex m_waitLock;
-    // Allows sleeping until we have samples to process.
-    QWaitCondition m_waitForSamples;
-
-    // Sidechain workers registered with EngineSideChain.
+    // Serializes adding workers. The engine thread reads the workers
+    // wait-free up to m_workerCount.
     MMutex m_workerLock;
-    QList<SideChainWorker*> m_workers GUARDED_BY(m_workerLock);
+    std::array<WorkerThread*, kMaxWorkers> m_workers;
+    std::atomic<int> m_workerCount;
 };
 
 #endif
@@ -15,8 +15,10 @@ NetworkOutputStreamWorker::NetworkOutputStreamWorker()
       m_functionCode(0),
       m_runCount(0),
       m_streamStartTimeUs(-1),
+      m_streamStartNetworkFrame(0),
       m_streamFramesWritten(0),
       m_writeOverflowCount(0),
+      m_droppedFrames(0),
       m_outputDrift(false) {
 }
 
@@ -36,6 +38,8 @@ void NetworkOutputStreamWorker::startStream(double samplerate, int numOutputChan
     m_numOutputChannels = numOutputChannels;
 
     m_streamStartTimeUs = EngineNetworkStream::getNetworkTimeUs();
+    m_streamStartNetworkFrame = static_cast<qint64>(
+            static_cast<double>(m_streamStartTimeUs) * m_sampleRate / 1000000.0);
     m_streamFramesWritten = 0;
 }
 
@@ -70,8 +74,13 @@ qint64 NetworkOutputStreamWorker::framesWritten() {
     return m_streamFramesWritten;
 }
 
+qint64 NetworkOutputStreamWorker::networkFramesWritten() {
+    return m_streamStartNetworkFrame + m_streamFramesWritten;
+}
+
 void NetworkOutputStreamWorker::resetOverflowCount() {
     m_writeOverflowCount = 0;
+    m_droppedFrames = 0;
 }
 
 void NetworkOutputStreamWorker::incOverflowCount() {
@@ -82,6 +91,14 @@ int NetworkOutputStreamWorker::overflowCount() {
     return m_writeOverflowCount;
 }
 
+void NetworkOutputStreamWorker::addDroppedFrames(qint64 frames) {
+    m_droppedFrames += frames;
+}
+
+qint64 NetworkOutputStreamWorker::droppedFrames() {
+    return m_droppedFrames;
+}
+
 void NetworkOutputStreamWorker::setOutputDrift(bool drift) {
     m_outputDrift = drift;
 }
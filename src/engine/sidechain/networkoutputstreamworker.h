@@ -2,6 +2,7 @@
 #define NETWORKOUTPUTSTREAMWORKER_H
 
 #include <QSharedPointer>
+#include <atomic>
 
 #include "util/types.h"
 #include "util/fifo.h"
@@ -64,10 +65,19 @@ class NetworkOutputStreamWorker {
     void resetFramesWritten();
     void addFramesWritten(qint64 frames);
     qint64 framesWritten();
-
+    // The position of the next frame that is written, counted in frames
+    // of the network clock since its epoch. It is the same for all workers
+    // of a stream, unlike framesWritten() which starts with each worker.
+    // May be called from the thread of the worker.
+    qint64 networkFramesWritten();
+
+    // The writes that did not fit into the FIFO of the worker and the
+    // frames that have been lost by them. May be called from any thread.
     void resetOverflowCount();
     void incOverflowCount();
     int overflowCount();
+    void addDroppedFrames(qint64 frames);
+    qint64 droppedFrames();
 
     void setOutputDrift(bool drift);
     bool outputDrift();
@@ -92,8 +102,10 @@ private:
     int m_runCount;
 
     qint64 m_streamStartTimeUs;
-    qint64 m_streamFramesWritten;
-    int m_writeOverflowCount;
+    std::atomic<qint64> m_streamStartNetworkFrame;
+    std::atomic<qint64> m_streamFramesWritten;
+    std::atomic<int> m_writeOverflowCount;
+    std::atomic<qint64> m_droppedFrames;
     bool m_outputDrift;
 };
 
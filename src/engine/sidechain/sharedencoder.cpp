@@ -0,0 +1,251 @@
+#include "engine/sidechain/sharedencoder.h"
+
+#include <QHash>
+#include <QMutexLocker>
+#include <cstring>
+
+#include "engine/engine.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SharedEncoder");
+
+// All encoders that are currently used by at least one connection,
+// indexed by their settings
+QMutex s_sharedEncodersMutex;
+QHash<QString, std::weak_ptr<SharedEncoder>> s_sharedEncoders;
+
+// Ogg header pages have a granule position of 0, while audio pages have a
+// positive one
+bool isOggHeaderPage(const unsigned char* header, int headerLen) {
+    constexpr int kGranulePositionOffset = 6;
+    constexpr int kGranulePositionSize = 8;
+    if (headerLen < kGranulePositionOffset + kGranulePositionSize ||
+            std::memcmp(header, "OggS", 4) != 0) {
+        return false;
+    }
+    for (int i = 0; i < kGranulePositionSize; ++i) {
+        if (header[kGranulePositionOffset + i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+SharedEncoder::Subscription::Subscription(std::shared_ptr<SharedEncoder> pEncoder)
+        : m_pEncoder(std::move(pEncoder)),
+          m_queuedBytes(0),
+          m_maxQueuedBytes(kMaxQueuedBytes) {
+}
+
+SharedEncoder::Subscription::~Subscription() {
+    m_pEncoder->removeSubscription(this);
+}
+
+void SharedEncoder::Subscription::encodeBuffer(
+        const CSAMPLE* pBuffer, int iBufferSize, qint64 streamFrame) {
+    m_pEncoder->encodeBuffer(pBuffer, iBufferSize, streamFrame);
+}
+
+bool SharedEncoder::Subscription::takePacket(QByteArray* pPacket) {
+    QMutexLocker locker(&m_pEncoder->m_mutex);
+    if (m_packets.isEmpty()) {
+        return false;
+    }
+    *pPacket = m_packets.dequeue();
+    m_queuedBytes -= pPacket->size();
+    return true;
+}
+
+bool SharedEncoder::Subscription::takePackets(QByteArray* pBatch, int maxBytes) {
+    QMutexLocker locker(&m_pEncoder->m_mutex);
+    if (m_packets.isEmpty()) {
+        return false;
+    }
+    // Implicitly shared, no copy if it is the only packet
+    *pBatch = m_packets.dequeue();
+    while (pBatch->size() < maxBytes && !m_packets.isEmpty()) {
+        pBatch->append(m_packets.dequeue());
+    }
+    m_queuedBytes -= pBatch->size();
+    return true;
+}
+
+int SharedEncoder::Subscription::queuedBytes() const {
+    QMutexLocker locker(&m_pEncoder->m_mutex);
+    return m_queuedBytes;
+}
+
+void SharedEncoder::Subscription::setMaxQueuedBytes(int maxQueuedBytes) {
+    QMutexLocker locker(&m_pEncoder->m_mutex);
+    m_maxQueuedBytes = maxQueuedBytes;
+}
+
+int SharedEncoder::Subscription::subscriberCount() const {
+    QMutexLocker locker(&m_pEncoder->m_mutex);
+    return m_pEncoder->m_subscriptions.size();
+}
+
+//static
+QString SharedEncoder::settingsKey(
+        const EncoderSettingsPointer& pSettings,
+        int sampleRate) {
+    return QString("%1 %2 %3 %4")
+            .arg(pSettings->getFormat(),
+                    QString::number(pSettings->getQuality()),
+                    QString::number(static_cast<int>(pSettings->getChannelMode())),
+                    QString::number(sampleRate));
+}
+
+//static
+std::unique_ptr<SharedEncoder::Subscription> SharedEncoder::subscribe(
+        const EncoderSettingsPointer& pSettings,
+        int sampleRate,
+        QString* pErrorMessage) {
+    const QString key = settingsKey(pSettings, sampleRate);
+    QMutexLocker locker(&s_sharedEncodersMutex);
+    std::shared_ptr<SharedEncoder> pSharedEncoder = s_sharedEncoders.value(key).lock();
+    if (!pSharedEncoder) {
+        pSharedEncoder = std::shared_ptr<SharedEncoder>(
+                new SharedEncoder(key, sampleRate));
+        pSharedEncoder->m_pEncoder = EncoderFactory::getFactory().createEncoder(
+                pSettings, pSharedEncoder.get());
+        QString errorMessage;
+        if (!pSharedEncoder->m_pEncoder ||
+                pSharedEncoder->m_pEncoder->initEncoder(sampleRate, errorMessage) < 0) {
+            kLogger.warning()
+                    << "Failed to initialize encoder"
+                    << key
+                    << errorMessage;
+            if (pErrorMessage) {
+                *pErrorMessage = errorMessage;
+            }
+            return nullptr;
+        }
+        // Purge the entries of encoders that are no longer used
+        auto i = s_sharedEncoders.begin();
+        while (i != s_sharedEncoders.end()) {
+            if (i.value().expired()) {
+                i = s_sharedEncoders.erase(i);
+            } else {
+                ++i;
+            }
+        }
+        s_sharedEncoders.insert(key, pSharedEncoder);
+        kLogger.debug() << "Created encoder" << key;
+    }
+    auto pSubscription = std::unique_ptr<Subscription>(
+            new Subscription(pSharedEncoder));
+    pSharedEncoder->addSubscription(pSubscription.get());
+    return pSubscription;
+}
+
+SharedEncoder::SharedEncoder(QString key, int sampleRate)
+        : m_key(std::move(key)),
+          m_sampleRate(sampleRate),
+          m_streamFrameValid(false),
+          m_encodedStreamFrame(0),
+          m_encodedSamples(0),
+          m_cpuLoad(0.0),
+          m_encodedFrames(0),
+          m_streamStarted(false) {
+}
+
+SharedEncoder::~SharedEncoder() {
+    DEBUG_ASSERT(m_subscriptions.isEmpty());
+    // Deleting the encoder flushes it and calls write()
+    m_pEncoder.reset();
+    kLogger.debug() << "Deleted encoder" << m_key;
+}
+
+void SharedEncoder::addSubscription(Subscription* pSubscription) {
+    QMutexLocker locker(&m_mutex);
+    m_subscriptions.append(pSubscription);
+    for (const auto& header : qAsConst(m_streamHeaders)) {
+        pSubscription->m_packets.enqueue(header);
+        pSubscription->m_queuedBytes += header.size();
+    }
+}
+
+void SharedEncoder::removeSubscription(Subscription* pSubscription) {
+    QMutexLocker locker(&m_mutex);
+    m_subscriptions.removeOne(pSubscription);
+}
+
+void SharedEncoder::encodeBuffer(
+        const CSAMPLE* pBuffer,
+        int iBufferSize,
+        qint64 streamFrame) {
+    QMutexLocker locker(&m_encoderMutex);
+    const qint64 endStreamFrame =
+            streamFrame + iBufferSize / mixxx::kEngineChannelCount;
+    if (m_streamFrameValid && streamFrame < m_encodedStreamFrame) {
+        if (endStreamFrame <= m_encodedStreamFrame) {
+            // Encoded from the samples of another connection
+            return;
+        }
+        // Only encode the part that follows the samples of the
+        // connection that has encoded until now
+        const int encodedSamples = static_cast<int>(
+                (m_encodedStreamFrame - streamFrame) * mixxx::kEngineChannelCount);
+        pBuffer += encodedSamples;
+        iBufferSize -= encodedSamples;
+    }
+    m_streamFrameValid = true;
+    m_encodedStreamFrame = endStreamFrame;
+
+    PerformanceTimer timer;
+    timer.start();
+    m_pEncoder->encodeBuffer(pBuffer, iBufferSize);
+    m_encodeDuration += timer.elapsed();
+    m_encodedFrames.fetch_add(
+            iBufferSize / mixxx::kEngineChannelCount, std::memory_order_relaxed);
+
+    m_encodedSamples += iBufferSize;
+    const SINT samplesPerSecond = m_sampleRate * mixxx::kEngineChannelCount;
+    if (m_encodedSamples >= samplesPerSecond) {
+        m_cpuLoad.store(
+                m_encodeDuration.toDoubleSeconds() * samplesPerSecond / m_encodedSamples,
+                std::memory_order_relaxed);
+        m_encodeDuration = mixxx::Duration::empty();
+        m_encodedSamples = 0;
+    }
+}
+
+void SharedEncoder::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    QByteArray packet;
+    packet.reserve(headerLen + bodyLen);
+    if (headerLen > 0) {
+        packet.append(reinterpret_cast<const char*>(header), headerLen);
+    }
+    packet.append(reinterpret_cast<const char*>(body), bodyLen);
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_streamStarted) {
+        if (headerLen > 0 && isOggHeaderPage(header, headerLen)) {
+            m_streamHeaders.append(packet);
+        } else {
+            m_streamStarted = true;
+        }
+    }
+    for (auto* pSubscription : qAsConst(m_subscriptions)) {
+        if (pSubscription->m_queuedBytes > pSubscription->m_maxQueuedBytes) {
+            kLogger.warning()
+                    << "Discarding"
+                    << pSubscription->m_queuedBytes
+                    << "bytes of a connection that does not send";
+            pSubscription->m_packets.clear();
+            pSubscription->m_queuedBytes = 0;
+        }
+        // Implicitly shared, no deep copy
+        pSubscription->m_packets.enqueue(packet);
+        pSubscription->m_queuedBytes += packet.size();
+    }
+}
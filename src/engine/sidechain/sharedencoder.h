@@ -0,0 +1,149 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "encoder/encodersettings.h"
+#include "util/duration.h"
+#include "util/types.h"
+
+// Encodes the master mix only once for all broadcast connections that use
+// identical encoder settings and distributes the encoded packets to each
+// of them. The packets are implicitly shared byte arrays, i.e. queuing a
+// packet for another connection does not copy the encoded data.
+//
+// Each connection feeds the samples it receives into its Subscription,
+// together with their position in the network stream. All connections
+// carry the same signal, so each part of the stream is only encoded from
+// the first subscription that provides it and discarded for all others.
+// If that connection stops feeding samples, e.g. while it reconnects, the
+// next one continues seamlessly with the samples it has buffered.
+//
+// Recordings are not shared, because the file encoders embed the track
+// metadata and rewrite their headers at the end of each file.
+class SharedEncoder : public EncoderCallback {
+  public:
+    class Subscription {
+      public:
+        ~Subscription();
+
+        // Encodes the samples unless they have already been encoded from
+        // another subscription. streamFrame is the position of the first
+        // frame, see NetworkOutputStreamWorker::networkFramesWritten().
+        void encodeBuffer(const CSAMPLE* pBuffer, int iBufferSize, qint64 streamFrame);
+
+        // Takes the next encoded packet that needs to be sent. Returns
+        // false if no packet is pending.
+        bool takePacket(QByteArray* pPacket);
+
+        // Takes the next encoded packets in their order and coalesces them
+        // into a single batch, until it holds at least maxBytes. Returns
+        // false if no packet is pending.
+        bool takePackets(QByteArray* pBatch, int maxBytes);
+
+        // The size of all packets that are pending to be sent
+        int queuedBytes() const;
+
+        // Pending packets are discarded if they exceed this size, i.e. if
+        // the connection does not send them. Defaults to kMaxQueuedBytes.
+        void setMaxQueuedBytes(int maxQueuedBytes);
+
+        // The time spent in the encoder per time of encoded audio,
+        // measured over the last second
+        double cpuLoad() const {
+            return m_pEncoder->m_cpuLoad.load(std::memory_order_relaxed);
+        }
+
+        // The number of connections that share the encoder
+        int subscriberCount() const;
+
+        // The number of frames that have been encoded from all
+        // subscriptions
+        qint64 encodedFrames() const {
+            return m_pEncoder->m_encodedFrames.load(std::memory_order_relaxed);
+        }
+
+      private:
+        friend class SharedEncoder;
+        explicit Subscription(std::shared_ptr<SharedEncoder> pEncoder);
+
+        const std::shared_ptr<SharedEncoder> m_pEncoder;
+        // Guarded by the mutex of the encoder
+        QQueue<QByteArray> m_packets;
+        int m_queuedBytes;
+        int m_maxQueuedBytes;
+    };
+
+    // 20 s mp3 @ 192 kbit/s
+    static constexpr int kMaxQueuedBytes = 2 * 491520;
+
+    // Subscribes to the encoder with the given settings and sample rate. The
+    // encoder is created if no other connection uses the same settings.
+    // Returns nullptr if the encoder could not be initialized.
+    static std::unique_ptr<Subscription> subscribe(
+            const EncoderSettingsPointer& pSettings,
+            int sampleRate,
+            QString* pErrorMessage);
+
+    ~SharedEncoder() override;
+
+    // EncoderCallback, invoked by the encoder while encoding
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    // These are not used for streaming, but the interface requires them
+    int tell() override {
+        return -1;
+    }
+    void seek(int pos) override {
+        Q_UNUSED(pos);
+    }
+    int filelen() override {
+        return 0;
+    }
+
+  private:
+    SharedEncoder(QString key, int sampleRate);
+
+    static QString settingsKey(
+            const EncoderSettingsPointer& pSettings,
+            int sampleRate);
+
+    void encodeBuffer(
+            const CSAMPLE* pBuffer,
+            int iBufferSize,
+            qint64 streamFrame);
+    void addSubscription(Subscription* pSubscription);
+    void removeSubscription(Subscription* pSubscription);
+
+    const QString m_key;
+    const int m_sampleRate;
+    EncoderPointer m_pEncoder;
+
+    // Serializes the calls of the encoder
+    QMutex m_encoderMutex;
+    // Only accessed while m_encoderMutex is locked
+    bool m_streamFrameValid;
+    // The position in the stream after the last encoded frame
+    qint64 m_encodedStreamFrame;
+    mixxx::Duration m_encodeDuration;
+    SINT m_encodedSamples;
+    std::atomic<double> m_cpuLoad;
+    std::atomic<qint64> m_encodedFrames;
+
+    // Guards the subscriptions and their packet queues
+    mutable QMutex m_mutex;
+    QList<Subscription*> m_subscriptions;
+    // The Ogg header pages that start the stream. They are sent to each
+    // subscription before the first audio page, even if it joins later.
+    QList<QByteArray> m_streamHeaders;
+    bool m_streamStarted;
+};
@@ -20,10 +20,10 @@
 
 #include "broadcast/defs_broadcast.h"
 #include "control/controlpushbutton.h"
-#include "encoder/encoder.h"
 #include "encoder/encoderbroadcastsettings.h"
 #ifdef __OPUS__
 #include "encoder/encoderopus.h"
+#include "engine/engine.h"
 #endif
 #include "mixer/playerinfo.h"
 #include "preferences/usersettings.h"
@@ -37,6 +37,8 @@ namespace {
 
 const int kConnectRetries = 30;
 const int kMaxNetworkCache = 491520;  // 10 s mp3 @ 192 kbit/s
+// Retry interval for sending a backlog
+const int kSendRetryMillis = 20;
 // Shoutcast default receive buffer 1048576 and autodumpsourcetime 30 s
 // http://wiki.shoutcast.com/wiki/SHOUTcast_DNAS_Server_2
 const int kMaxShoutFailures = 3;
@@ -56,7 +58,7 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_iShoutFailures(0),
           m_pConfig(pConfig),
           m_pProfile(profile),
-          m_encoder(nullptr),
+          m_streamFrame(0),
           m_pMasterSamplerate(new ControlProxy("[Master]", "samplerate", this)),
           m_pBroadcastEnabled(new ControlProxy(BROADCAST_PREF_KEY, "enabled", this)),
           m_custom_metadata(false),
@@ -69,6 +71,8 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_protocol_is_shoutcast(false),
           m_ogg_dynamic_update(false),
           m_threadWaiting(false),
+          m_socketQueuedBytes(0),
+          m_encoderQueuedBytes(0),
           m_retryCount(0),
           m_reconnectFirstDelay(0.0),
           m_reconnectPeriod(5.0),
@@ -185,10 +189,9 @@ void ShoutConnection::updateFromPreferences() {
 
     setState(NETWORKSTREAMWORKER_STATE_BUSY);
 
-    // Delete m_encoder if it has been initialized (with maybe) different bitrate.
-    // delete m_encoder calls write() check if it will be exit early
+    // Unsubscribe from the encoder, the settings may have changed
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    m_pEncoderSubscription.reset();
 
     m_format_is_mp3 = false;
     m_format_is_ov = false;
@@ -441,24 +444,20 @@ void ShoutConnection::updateFromPreferences() {
         return;
     }
 
-    // Initialize m_encoder
+    // Subscribe to the encoder, which is shared with all other connections
+    // that use the same encoder settings
     EncoderSettingsPointer pBroadcastSettings =
             std::make_shared<EncoderBroadcastSettings>(m_pProfile);
-    m_encoder = EncoderFactory::getFactory().createEncoder(
-                    pBroadcastSettings, this);
-
     QString errorMsg;
     // TODO(XXX): Use mixxx::audio::SampleRate instead of int in initEncoder
-    if (m_encoder->initEncoder(static_cast<int>(masterSamplerate), errorMsg) < 0) {
+    m_pEncoderSubscription = SharedEncoder::subscribe(
+            pBroadcastSettings, static_cast<int>(masterSamplerate), &errorMsg);
+    if (!m_pEncoderSubscription) {
         // e.g., if lame is not found
-        // init m_encoder itself will display a message box
+        // the encoder itself will display a message box
         kLogger.warning() << "**** Encoder init failed";
         kLogger.warning() << errorMsg;
 
-        // delete m_encoder calls write() make sure it will be exit early
-        DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-        m_encoder.reset();
-
         setState(NETWORKSTREAMWORKER_STATE_ERROR);
         m_lastErrorStr = "Encoder error";
 
@@ -482,7 +481,7 @@ bool ShoutConnection::processConnect() {
     // Make sure that we call updateFromPreferences always
     updateFromPreferences();
 
-    if (!m_encoder) {
+    if (!m_pEncoderSubscription) {
         // updateFromPreferences failed
         setStatus(BroadcastProfile::STATUS_FAILURE);
         kLogger.warning() << "ShoutOutput::processConnect() returning false";
@@ -578,6 +577,8 @@ bool ShoutConnection::processConnect() {
             if(m_pOutputFifo->readAvailable()) {
             	m_pOutputFifo->flushReadData(m_pOutputFifo->readAvailable());
             }
+            // All frames that are written from now on are read
+            m_streamFrame = networkFramesWritten();
             m_threadWaiting = true;
 
             setStatus(BroadcastProfile::STATUS_CONNECTED);
@@ -600,9 +601,9 @@ bool ShoutConnection::processConnect() {
 
     // no connection, clean up
     shout_close(m_pShout);
-    // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    m_pEncoderSubscription.reset();
+    m_pProfile->setEncoderStats(0.0, 0);
     if (m_pProfile->getEnabled()) {
         setStatus(BroadcastProfile::STATUS_FAILURE);
     } else {
@@ -625,68 +626,81 @@ bool ShoutConnection::processDisconnect() {
         emit broadcastDisconnected();
         disconnected = true;
     }
-    // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    m_pEncoderSubscription.reset();
+    m_socketQueuedBytes.fetchAndStoreRelaxed(0);
+    m_encoderQueuedBytes.fetchAndStoreRelaxed(0);
+    m_pProfile->setEncoderStats(0.0, 0);
     return disconnected;
 }
 
-void ShoutConnection::write(const unsigned char* header, const unsigned char* body,
-                            int headerLen, int bodyLen) {
+void ShoutConnection::sendPendingPackets() {
     setFunctionCode(7);
-	if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED) {
-        // This happens when the decoder calls flush() and the connection is
-        // already down
+    if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED ||
+            !m_pEncoderSubscription) {
         return;
     }
 
-    // Send header if there is one
-    if (headerLen > 0) {
-        if(!writeSingle(header, headerLen)) {
-            return;
-        }
+    // Continue with the data that could not be sent before
+    if (shout_queuelen(m_pShout) > 0 && !writeSingle(nullptr, 0)) {
+        return;
     }
 
-    if(!writeSingle(body, bodyLen)) {
-        return;
+    // Back-pressure: The packets stay in the queue of the encoder while
+    // the socket does not accept more data
+    while (shout_queuelen(m_pShout) < kSendHighWaterBytes) {
+        // Coalesce the small packets of the encoder into larger writes
+        QByteArray batch;
+        if (!m_pEncoderSubscription->takePackets(&batch, kSendBatchBytes)) {
+            break;
+        }
+        if (!writeSingle(reinterpret_cast<const unsigned char*>(
+                                 batch.constData()),
+                    batch.size())) {
+            return;
+        }
     }
 
-    ssize_t queuelen = shout_queuelen(m_pShout);
-    if (queuelen > 0) {
-        kLogger.debug() << "shout_queuelen" << queuelen;
-        if (queuelen > kMaxNetworkCache) {
+    const int socketQueuedBytes = static_cast<int>(shout_queuelen(m_pShout));
+    const int encoderQueuedBytes = m_pEncoderSubscription->queuedBytes();
+    m_socketQueuedBytes.fetchAndStoreRelaxed(socketQueuedBytes);
+    m_encoderQueuedBytes.fetchAndStoreRelaxed(encoderQueuedBytes);
+    const int pendingBytes = socketQueuedBytes + encoderQueuedBytes;
+    if (pendingBytes > 0) {
+        kLogger.debug() << "pending bytes" << pendingBytes;
+        if (pendingBytes > kMaxNetworkCache) {
             m_lastErrorStr = tr("Network cache overflow");
             tryReconnect();
         }
     }
 }
-// These are not used for streaming, but the interface requires them
-int ShoutConnection::tell() {
-    if (!m_pShout) {
-        return -1;
+
+bool ShoutConnection::hasPendingPackets() {
+    if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED ||
+            !m_pEncoderSubscription) {
+        return false;
     }
-    return -1;
-}
-// These are not used for streaming, but the interface requires them
-void ShoutConnection::seek(int pos) {
-    Q_UNUSED(pos)
-    return;
+    return shout_queuelen(m_pShout) > 0 ||
+            m_pEncoderSubscription->queuedBytes() > 0;
 }
-// These are not used for streaming, but the interface requires them
-int ShoutConnection::filelen() {
-    return 0;
+
+void ShoutConnection::updateEncoderStats() {
+    if (!m_pEncoderSubscription) {
+        // Failed to reconnect while sending
+        return;
+    }
+    m_pProfile->setEncoderStats(
+            m_pEncoderSubscription->cpuLoad(),
+            m_pEncoderSubscription->subscriberCount());
 }
 
 bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
     setFunctionCode(8);
     int ret = shout_send_raw(m_pShout, data, len);
     if (ret == SHOUTERR_BUSY) {
-        // in case of busy, frames are queued
-        // try to flush queue after a short sleep
-        kLogger.warning() << "writeSingle() SHOUTERR_BUSY, trying again";
-        usleep(10000); // wait 10 ms until "busy" is over. TODO() tweak for an optimum.
-        // if this fails, the queue is transmitted after the next regular shout_send_raw()
-        (void)shout_send_raw(m_pShout, nullptr, 0);
+        // The socket is non-blocking. libshout has queued the data that
+        // could not be sent yet, it is sent by the next call.
+        kLogger.debug() << "writeSingle() SHOUTERR_BUSY";
     } else if (ret < SHOUTERR_SUCCESS) {
         m_lastErrorStr = shout_get_error(m_pShout);
         kLogger.warning()
@@ -704,6 +718,10 @@ bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
 
 void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     setFunctionCode(4);
+    // The samples are consumed in any case
+    const qint64 streamFrame = m_streamFrame;
+    m_streamFrame += iBufferSize / mixxx::kEngineChannelCount;
+
     if(!m_pProfile->getEnabled())
         return;
 
@@ -714,10 +732,13 @@ void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
         return;
 
     // If we are connected, encode the samples.
-    if (iBufferSize > 0 && m_encoder) {
+    if (iBufferSize > 0 && m_pEncoderSubscription) {
         setFunctionCode(6);
-        m_encoder->encodeBuffer(pBuffer, iBufferSize);
-        // the encoded frames are received by the write() callback.
+        // Only one of the connections that share the encoder encodes
+        // the samples, the packets are queued for all of them.
+        m_pEncoderSubscription->encodeBuffer(pBuffer, iBufferSize, streamFrame);
+        sendPendingPackets();
+        updateEncoderStats();
     }
 
     // Check if track metadata has changed and if so, update.
@@ -1003,7 +1024,10 @@ void ShoutConnection::run() {
 
         setFunctionCode(1);
         incRunCount();
-        if(!m_readSema.tryAcquire(1, 1000)) {
+        // Continue sending a backlog without waiting for new samples
+        if (!m_readSema.tryAcquire(1,
+                    hasPendingPackets() ? kSendRetryMillis : 1000)) {
+            sendPendingPackets();
             continue;
         }
 
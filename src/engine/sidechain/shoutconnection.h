@@ -18,12 +18,12 @@
 
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
-#include "encoder/encoder.h"
-#include "encoder/encodercallback.h"
+#include "engine/sidechain/sharedencoder.h"
 #include "errordialoghandler.h"
 #include "preferences/broadcastprofile.h"
 #include "preferences/usersettings.h"
 #include "track/track_decl.h"
+#include "util/compatibility.h"
 #include "util/fifo.h"
 
 // Forward declare libshout structures to prevent leaking shout.h definitions
@@ -34,9 +34,15 @@ struct _util_dict;
 typedef struct _util_dict shout_metadata_t;
 
 class ShoutConnection
-        : public QThread, public EncoderCallback, public NetworkOutputStreamWorker {
+        : public QThread, public NetworkOutputStreamWorker {
     Q_OBJECT
   public:
+    // Small encoder packets are sent together up to this size
+    static constexpr int kSendBatchBytes = 16384;
+    // No more data is passed to libshout while it has not sent this
+    // many bytes yet
+    static constexpr int kSendHighWaterBytes = 65536;
+
     ShoutConnection(BroadcastProfilePtr profile, UserSettingsPointer pConfig);
     ~ShoutConnection() override;
 
@@ -47,17 +53,6 @@ class ShoutConnection
     void shutdown() override {
     }
 
-    // Called by the encoder in method 'encodebuffer()' to flush the stream to
-    // the server.
-    void write(const unsigned char* header, const unsigned char* body,
-               int headerLen, int bodyLen) override;
-    // gets stream position
-    int tell() override;
-    // sets stream position
-    void seek(int pos) override;
-    // gets stream length
-    int filelen() override;
-
     /** connects to server **/
     bool serverConnect();
     bool isConnected();
@@ -80,6 +75,15 @@ class ShoutConnection
         return m_pProfile->connectionStatus();
     }
 
+    // The bytes that were waiting to be sent after the last attempt,
+    // queued by libshout and by the shared encoder. Thread-safe.
+    int socketQueuedBytes() const {
+        return atomicLoadRelaxed(m_socketQueuedBytes);
+    }
+    int encoderQueuedBytes() const {
+        return atomicLoadRelaxed(m_encoderQueuedBytes);
+    }
+
   signals:
     void broadcastDisconnected();
     void broadcastConnected();
@@ -103,8 +107,12 @@ class ShoutConnection
     void errorDialog(QString text, QString detailedError);
     void infoDialog(QString text, QString detailedError);
 
-    void serverWrite(unsigned char *header, unsigned char *body,
-               int headerLen, int bodyLen);
+    // Sends the pending packets of the shared encoder to the server
+    // without blocking
+    void sendPendingPackets();
+    bool hasPendingPackets();
+    // Publishes the load of the encoder to the broadcast preferences
+    void updateEncoderStats();
 
 #ifndef __WINDOWS__
     void ignoreSigpipe();
@@ -128,7 +136,11 @@ class ShoutConnection
     long m_iShoutFailures;
     UserSettingsPointer m_pConfig;
     BroadcastProfilePtr m_pProfile;
-    EncoderPointer m_encoder;
+    // Connections with identical encoder settings share the encoder
+    std::unique_ptr<SharedEncoder::Subscription> m_pEncoderSubscription;
+    // The position of the next samples in the network stream, which the
+    // shared encoder needs to align the connections
+    qint64 m_streamFrame;
     ControlProxy* m_pMasterSamplerate;
     ControlProxy* m_pBroadcastEnabled;
     // static metadata according to prefereneces
@@ -149,6 +161,8 @@ class ShoutConnection
     bool m_protocol_is_shoutcast;
     bool m_ogg_dynamic_update;
     QAtomicInt m_threadWaiting;
+    QAtomicInt m_socketQueuedBytes;
+    QAtomicInt m_encoderQueuedBytes;
     QSemaphore m_readSema;
     QSharedPointer<FIFO<CSAMPLE>> m_pOutputFifo;
 
@@ -140,7 +140,7 @@ const TrackPointer& BaseTrackCache::getRecentTrack(TrackId trackId) const {
     if (m_recentTrackId != trackId) {
         if (trackId.isValid()) {
             TrackPointer trackPtr =
-                    GlobalTrackCacheLocker().lookupTrackById(trackId);
+                    GlobalTrackCache::lookupTrackById(trackId);
             replaceRecentTrack(
                     std::move(trackId),
                     std::move(trackPtr));
@@ -165,6 +165,23 @@ CoverInfo::LoadedImage CoverInfo::loadImage(
     return loadedImage;
 }
 
+QString CoverInfo::imageFilePath() const {
+    if (type == CoverInfo::METADATA) {
+        return trackLocation;
+    }
+    if (type != CoverInfo::FILE) {
+        return QString();
+    }
+    const QFileInfo coverFile(coverLocation);
+    if (coverFile.isAbsolute()) {
+        return coverFile.filePath();
+    }
+    if (trackLocation.isEmpty()) {
+        return QString();
+    }
+    return QFileInfo(TrackFile(trackLocation).directory(), coverLocation).filePath();
+}
+
 bool CoverInfo::refreshImageDigest(
         const QImage& loadedImage,
         const SecurityTokenPointer& pTrackLocationToken) {
@@ -166,6 +166,7 @@ class CoverInfo : public CoverInfoRelative {
 
       private:
         friend class CoverArt;
+        friend class CoverArtCache;
         friend class CoverInfo;
         LoadedImage(Result result)
                 : result(result) {
@@ -174,6 +175,11 @@ class CoverInfo : public CoverInfoRelative {
     LoadedImage loadImage(
             const SecurityTokenPointer& pTrackLocationToken = SecurityTokenPointer()) const;
 
+    /// The absolute path of the file that contains the image, i.e.
+    /// the track location if the image is embedded in the metadata.
+    /// Empty if not available.
+    QString imageFilePath() const;
+
     /// Verify the image digest and update it if necessary.
     /// If the corresponding image has already been loaded it
     /// could be provided as a parameter to avoid reloading
@@ -7,6 +7,7 @@
 
 #include "library/coverartutils.h"
 #include "track/track.h"
+#include "util/math.h"
 #include "util/compatibility.h"
 #include "util/logger.h"
 #include "util/thread_affinity.h"
@@ -29,6 +30,13 @@ QString pixmapCacheKey(mixxx::cache_key_t hash, int width) {
             .arg(QString::number(hash), QString::number(width));
 }
 
+// Decoding and scaling large images is CPU bound. Limit the number
+// of concurrent workers to keep the GUI responsive.
+constexpr int kMaxLoadThreadCount = 4;
+
+// Upper bound for the size of all persistent thumbnails
+constexpr qint64 kThumbnailCacheMaxBytes = 256 * 1024 * 1024;
+
 // The transformation mode when scaling images
 const Qt::TransformationMode kTransformationMode = Qt::SmoothTransformation;
 
@@ -39,8 +47,26 @@ inline QImage resizeImageWidth(const QImage& image, int width) {
 
 } // anonymous namespace
 
-CoverArtCache::CoverArtCache() {
+CoverArtCache::CoverArtCache(
+        const QString& thumbnailCacheDir) {
     QPixmapCache::setCacheLimit(kPixmapCacheLimit);
+    m_loadPool.setMaxThreadCount(
+            math_clamp(QThread::idealThreadCount(), 1, kMaxLoadThreadCount));
+    if (!thumbnailCacheDir.isEmpty()) {
+        m_pThumbnailCache = std::make_shared<const CoverArtThumbnailCache>(
+                QDir(thumbnailCacheDir));
+        // Limit the disk usage in the background
+        auto pThumbnailCache = m_pThumbnailCache;
+        QtConcurrent::run(&m_loadPool, [pThumbnailCache] {
+            pThumbnailCache->purge(kThumbnailCacheMaxBytes);
+        });
+    }
+}
+
+CoverArtCache::~CoverArtCache() {
+    // Pending requests hold a pointer to this instance
+    m_loadPool.clear();
+    m_loadPool.waitForDone();
 }
 
 //static
@@ -102,7 +128,12 @@ QPixmap CoverArtCache::tryLoadCover(
     // keep a list of trackIds for which a future is currently running
     // to avoid loading the same picture again while we are loading it
     QPair<const QObject*, mixxx::cache_key_t> requestId = qMakePair(pRequestor, requestedCacheKey);
-    if (m_runningRequests.contains(requestId)) {
+    const auto runningRequest = m_runningRequests.find(requestId);
+    if (runningRequest != m_runningRequests.end()) {
+        if (loading == Loading::Default) {
+            // Upgrade a running prefetch request
+            runningRequest.value() = true;
+        }
         return QPixmap();
     }
 
@@ -139,16 +170,25 @@ QPixmap CoverArtCache::tryLoadCover(
                 << "requestCover starting future for"
                 << coverInfo;
     }
-    m_runningRequests.insert(requestId);
+    m_runningRequests.insert(requestId, loading == Loading::Default);
     // The watcher will be deleted in coverLoaded()
     QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
     QFuture<FutureResult> future = QtConcurrent::run(
-            &CoverArtCache::loadCover,
-            pRequestor,
-            pTrack,
-            coverInfo,
-            desiredWidth,
-            loading == Loading::Default);
+            &m_loadPool,
+            [pRequestor,
+                    pTrack,
+                    coverInfo,
+                    desiredWidth,
+                    signalWhenDone = loading == Loading::Default,
+                    pThumbnailCache = m_pThumbnailCache] {
+                return CoverArtCache::loadCover(
+                        pRequestor,
+                        pTrack,
+                        coverInfo,
+                        desiredWidth,
+                        signalWhenDone,
+                        pThumbnailCache);
+            });
     connect(watcher,
             &QFutureWatcher<FutureResult>::finished,
             this,
@@ -163,7 +203,8 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
         TrackPointer pTrack,
         CoverInfo coverInfo,
         int desiredWidth,
-        bool signalWhenDone) {
+        bool signalWhenDone,
+        CoverArtThumbnailCachePointer pThumbnailCache) {
     if (kLogger.traceEnabled()) {
         kLogger.trace()
                 << "loadCover"
@@ -180,11 +221,37 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
             signalWhenDone);
     DEBUG_ASSERT(!res.coverInfoUpdated);
 
+    // Loading a thumbnail skips the verification of the image digest.
+    // Thumbnails of modified images are detected by their modification
+    // time and replaced below.
+    if (pThumbnailCache &&
+            CoverArtThumbnailCache::isCacheable(coverInfo, desiredWidth)) {
+        auto thumbnail = pThumbnailCache->load(coverInfo, desiredWidth);
+        if (!thumbnail.isNull()) {
+            auto loadedImage = CoverInfo::LoadedImage(
+                    CoverInfo::LoadedImage::Result::Ok);
+            loadedImage.image = std::move(thumbnail);
+            loadedImage.filePath = pThumbnailCache->filePath(coverInfo, desiredWidth);
+            res.coverArt = CoverArt(
+                    std::move(coverInfo),
+                    std::move(loadedImage),
+                    desiredWidth);
+            return res;
+        }
+    }
+
     auto loadedImage = coverInfo.loadImage(
             pTrack ? pTrack->getSecurityToken() : SecurityTokenPointer());
     if (!loadedImage.image.isNull()) {
         // Refresh hash before resizing the original image!
         res.coverInfoUpdated = coverInfo.refreshImageDigest(loadedImage.image);
+        if (!res.coverInfoUpdated && pThumbnailCache && desiredWidth > 0) {
+            // Thumbnails are keyed by the digest, which must not be
+            // stale when storing the thumbnail of a modified image
+            const QByteArray imageDigest = coverInfo.imageDigest();
+            coverInfo.setImage(loadedImage.image);
+            res.coverInfoUpdated = coverInfo.imageDigest() != imageDigest;
+        }
         if (pTrack && res.coverInfoUpdated) {
             kLogger.info()
                     << "Updating cover info of track"
@@ -197,6 +264,9 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
             // Adjust the cover size according to the request
             // or downsize the image for efficiency.
             loadedImage.image = resizeImageWidth(loadedImage.image, desiredWidth);
+            if (pThumbnailCache) {
+                pThumbnailCache->save(coverInfo, loadedImage.image);
+            }
         }
     }
 
@@ -265,9 +335,12 @@ void CoverArtCache::coverLoaded() {
         }
     }
 
-    m_runningRequests.remove(qMakePair(res.pRequestor, res.requestedCacheKey));
+    // The request might have been upgraded while running
+    const bool signalWhenDone = m_runningRequests.take(
+                                        qMakePair(res.pRequestor, res.requestedCacheKey)) ||
+            res.signalWhenDone;
 
-    if (res.signalWhenDone) {
+    if (signalWhenDone) {
         emit coverFound(
                 res.pRequestor,
                 std::move(res.coverArt),
@@ -1,12 +1,14 @@
 #pragma once
 
+#include <QHash>
 #include <QObject>
 #include <QPair>
 #include <QPixmap>
-#include <QSet>
+#include <QThreadPool>
 #include <QtDebug>
 
 #include "library/coverart.h"
+#include "library/coverartthumbnailcache.h"
 #include "track/track_decl.h"
 #include "util/singleton.h"
 
@@ -52,6 +54,22 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
                 loading);
     }
 
+    /// Loads the cover in the background without signaling the
+    /// requestor when done, e.g. for rows adjacent to the visible
+    /// area of a table view. A subsequent regular request of the
+    /// same requestor for the same cover will be signaled.
+    void prefetchCover(
+            const QObject* pRequestor,
+            const CoverInfo& info,
+            int desiredWidth) {
+        tryLoadCover(
+                pRequestor,
+                TrackPointer(),
+                info,
+                desiredWidth,
+                Loading::NoSignal);
+    }
+
     // Only public for testing
     struct FutureResult {
         FutureResult()
@@ -79,12 +97,15 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     };
     // Load cover from path indicated in coverInfo. WARNING: This is run in a
     // worker thread.
+    // Resized covers are loaded from and stored in the thumbnail cache
+    // if available.
     static FutureResult loadCover(
             const QObject* pRequestor,
             TrackPointer pTrack,
             CoverInfo coverInfo,
             int desiredWidth,
-            bool emitSignals);
+            bool emitSignals,
+            CoverArtThumbnailCachePointer pThumbnailCache = nullptr);
 
   private slots:
     // Called when loadCover is complete in the main thread.
@@ -99,8 +120,11 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
             bool coverInfoUpdated);
 
   protected:
-    CoverArtCache();
-    ~CoverArtCache() override = default;
+    // Thumbnails are only stored persistently if a directory
+    // has been provided.
+    explicit CoverArtCache(
+            const QString& thumbnailCacheDir = QString());
+    ~CoverArtCache() override;
     friend class Singleton<CoverArtCache>;
 
   private:
@@ -116,7 +140,16 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
             int desiredWidth,
             Loading loading);
 
-    QSet<QPair<const QObject*, mixxx::cache_key_t>> m_runningRequests;
+    // Bounded pool for loading and scaling images, separate from
+    // the global thread pool to not starve other concurrent tasks
+    // while scrolling through the library.
+    QThreadPool m_loadPool;
+
+    CoverArtThumbnailCachePointer m_pThumbnailCache;
+
+    // The running requests mapped onto a flag that indicates if the
+    // requestor needs to be signaled when done.
+    QHash<QPair<const QObject*, mixxx::cache_key_t>, bool> m_runningRequests;
 };
 
 inline
@@ -13,6 +13,10 @@ namespace {
 
 const mixxx::Logger kLogger("CoverArtDelegate");
 
+// The number of rows above and below a cache miss for which
+// cover images are loaded in advance while scrolling.
+constexpr int kPrefetchRows = 8;
+
 inline TrackModel* asTrackModel(
         QTableView* pTableView) {
     auto* pTrackModel =
@@ -103,6 +107,23 @@ TrackPointer CoverArtDelegate::loadTrackByLocation(
             TrackRef::fromFileInfo(trackLocation));
 }
 
+void CoverArtDelegate::prefetchAdjacentRows(
+        const QModelIndex& index,
+        int desiredWidth) const {
+    for (int offset = 1; offset <= kPrefetchRows; ++offset) {
+        for (const int row : {index.row() + offset, index.row() - offset}) {
+            const QModelIndex adjacentIndex = index.sibling(row, index.column());
+            if (!adjacentIndex.isValid()) {
+                continue;
+            }
+            const CoverInfo coverInfo = m_pTrackModel->getCoverInfo(adjacentIndex);
+            if (coverInfo.hasImage()) {
+                m_pCache->prefetchCover(this, coverInfo, desiredWidth);
+            }
+        }
+    }
+}
+
 void CoverArtDelegate::paintItem(
         QPainter* painter,
         const QStyleOptionViewItem& option,
@@ -135,6 +156,9 @@ void CoverArtDelegate::paintItem(
                 // If we asked for a non-cache image and got a null pixmap,
                 // then our request was queued.
                 m_pendingCacheRows.insert(coverInfo.cacheKey(), index.row());
+                prefetchAdjacentRows(
+                        index,
+                        static_cast<int>(option.rect.width() * scaleFactor));
             }
         } else {
             // Cache hit
@@ -63,6 +63,12 @@ class CoverArtDelegate : public TableItemDelegate {
     TrackPointer loadTrackByLocation(
             const QString& trackLocation) const;
 
+    // Loads the covers of the rows around a cache miss in the
+    // background, anticipating that the user continues scrolling.
+    void prefetchAdjacentRows(
+            const QModelIndex& index,
+            int desiredWidth) const;
+
     CoverArtCache* const m_pCache;
     bool m_inhibitLazyLoading;
 
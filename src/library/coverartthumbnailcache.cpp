@@ -0,0 +1,125 @@
+#include "library/coverartthumbnailcache.h"
+
+#include <QDirIterator>
+#include <QSaveFile>
+
+#include "library/coverart.h"
+#include "util/assert.h"
+#include "util/file.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CoverArtThumbnailCache");
+
+// Thumbnails are distributed among subdirectories that are named
+// after the first characters of the digest to avoid a single
+// directory with thousands of entries.
+constexpr int kSubdirNameLength = 2;
+
+const QString kFileSuffix = QStringLiteral(".png");
+
+// Lossless, but with a moderate compression level to keep
+// encoding in the worker threads fast.
+constexpr int kPngQuality = 50;
+
+} // anonymous namespace
+
+CoverArtThumbnailCache::CoverArtThumbnailCache(
+        QDir rootDir)
+        : m_rootDir(std::move(rootDir)) {
+    if (!m_rootDir.exists() && !m_rootDir.mkpath(m_rootDir.absolutePath())) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << m_rootDir.absolutePath();
+    }
+}
+
+//static
+bool CoverArtThumbnailCache::isCacheable(
+        const CoverInfoRelative& coverInfo,
+        int width) {
+    return width > 0 && !coverInfo.imageDigest().isEmpty();
+}
+
+QString CoverArtThumbnailCache::filePath(
+        const CoverInfoRelative& coverInfo,
+        int width) const {
+    DEBUG_ASSERT(isCacheable(coverInfo, width));
+    const QString digest = QString::fromLatin1(coverInfo.imageDigest().toHex());
+    return m_rootDir.absoluteFilePath(
+            digest.left(kSubdirNameLength) +
+            QChar('/') +
+            digest +
+            QChar('_') +
+            QString::number(width) +
+            kFileSuffix);
+}
+
+QImage CoverArtThumbnailCache::load(
+        const CoverInfo& coverInfo,
+        int width) const {
+    if (!isCacheable(coverInfo, width)) {
+        return QImage();
+    }
+    const QString path = filePath(coverInfo, width);
+    const QFileInfo thumbnailFile(path);
+    if (!thumbnailFile.exists()) {
+        return QImage();
+    }
+    // The digest might not yet reflect a modification of the image
+    const QFileInfo imageFile(coverInfo.imageFilePath());
+    if (!imageFile.exists() ||
+            imageFile.lastModified() > thumbnailFile.lastModified()) {
+        return QImage();
+    }
+    QImage thumbnail(path);
+    if (thumbnail.isNull() || thumbnail.width() != width) {
+        kLogger.warning()
+                << "Discarding invalid thumbnail"
+                << path;
+        QFile::remove(path);
+        return QImage();
+    }
+    return thumbnail;
+}
+
+bool CoverArtThumbnailCache::save(
+        const CoverInfoRelative& coverInfo,
+        const QImage& thumbnail) const {
+    if (thumbnail.isNull() || !isCacheable(coverInfo, thumbnail.width())) {
+        return false;
+    }
+    const QString path = filePath(coverInfo, thumbnail.width());
+    const QFileInfo fileInfo(path);
+    if (!fileInfo.dir().exists() && !m_rootDir.mkpath(fileInfo.absolutePath())) {
+        return false;
+    }
+    // Concurrent writers of the same entry will produce identical
+    // content and the last one wins.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+            !thumbnail.save(&file, "PNG", kPngQuality) ||
+            !file.commit()) {
+        kLogger.warning()
+                << "Failed to save thumbnail"
+                << path
+                << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+int CoverArtThumbnailCache::purge(
+        qint64 maxTotalBytes) const {
+    const int numDeleted = mixxx::purgeLeastRecentlyModifiedFiles(
+            m_rootDir,
+            QStringList{QChar('*') + kFileSuffix},
+            maxTotalBytes,
+            QDirIterator::Subdirectories);
+    kLogger.info()
+            << "Purged"
+            << numDeleted
+            << "thumbnails";
+    return numDeleted;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QDir>
+#include <QImage>
+#include <memory>
+
+class CoverInfo;
+class CoverInfoRelative;
+
+/// Persistent store of downscaled cover art images.
+///
+/// Thumbnails are stored as individual image files below a directory,
+/// keyed by the digest of the original cover image and the width they
+/// have been scaled to. The digest of a track is only refreshed when the
+/// original image is loaded. Entries that are older than the file that
+/// contains the original image are therefore not returned. They are
+/// replaced after the original image has been loaded and its digest has
+/// been verified.
+///
+/// All member functions are const and only access the file system,
+/// i.e. a single instance can safely be shared between worker threads.
+class CoverArtThumbnailCache {
+  public:
+    explicit CoverArtThumbnailCache(
+            QDir rootDir);
+
+    const QDir& rootDir() const {
+        return m_rootDir;
+    }
+
+    /// Returns true if thumbnails for this cover can be stored,
+    /// i.e. if an image digest is available. Legacy hashes are
+    /// too weak to be used as a persistent key.
+    static bool isCacheable(
+            const CoverInfoRelative& coverInfo,
+            int width);
+
+    /// Returns a null image on a cache miss or if the entry is older
+    /// than the file that contains the original image.
+    QImage load(
+            const CoverInfo& coverInfo,
+            int width) const;
+
+    /// Atomically stores the thumbnail. Existing entries are replaced.
+    bool save(
+            const CoverInfoRelative& coverInfo,
+            const QImage& thumbnail) const;
+
+    /// The file path of the corresponding entry, no matter
+    /// if it exists or not.
+    QString filePath(
+            const CoverInfoRelative& coverInfo,
+            int width) const;
+
+    /// Deletes the least recently modified entries until the total
+    /// size of all entries does not exceed the given limit. Returns
+    /// the number of deleted entries.
+    int purge(
+            qint64 maxTotalBytes) const;
+
+  private:
+    const QDir m_rootDir;
+};
+
+typedef std::shared_ptr<const CoverArtThumbnailCache> CoverArtThumbnailCachePointer;
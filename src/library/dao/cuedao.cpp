@@ -62,6 +62,28 @@ CuePointer cueFromRow(const QSqlRecord& row) {
     return pCue;
 }
 
+// Appends the cue to the list of cues of a single track. Hot cues
+// with a number that is already occupied replace the existing hot cue.
+void appendCue(
+        QList<CuePointer>* pCues,
+        QMap<int, CuePointer>* pHotCuesByNumber,
+        CuePointer pCue) {
+    int hotCueNumber = pCue->getHotCue();
+    if (hotCueNumber != Cue::kNoHotCue) {
+        const auto pDuplicateCue = pHotCuesByNumber->take(hotCueNumber);
+        if (pDuplicateCue) {
+            kLogger.warning()
+                    << "Dropping hot cue"
+                    << pDuplicateCue->getId()
+                    << "with duplicate number"
+                    << hotCueNumber;
+            pCues->removeOne(pDuplicateCue);
+        }
+        pHotCuesByNumber->insert(hotCueNumber, pCue);
+    }
+    pCues->push_back(std::move(pCue));
+}
+
 } // namespace
 
 QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
@@ -87,24 +109,53 @@ QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
         VERIFY_OR_DEBUG_ASSERT(pCue) {
             continue;
         }
-        int hotCueNumber = pCue->getHotCue();
-        if (hotCueNumber != Cue::kNoHotCue) {
-            const auto pDuplicateCue = hotCuesByNumber.take(hotCueNumber);
-            if (pDuplicateCue) {
-                kLogger.warning()
-                        << "Dropping hot cue"
-                        << pDuplicateCue->getId()
-                        << "with duplicate number"
-                        << hotCueNumber;
-                cues.removeOne(pDuplicateCue);
-            }
-            hotCuesByNumber.insert(hotCueNumber, pCue);
-        }
-        cues.push_back(pCue);
+        appendCue(&cues, &hotCuesByNumber, std::move(pCue));
     }
     return cues;
 }
 
+QHash<TrackId, QList<CuePointer>> CueDAO::getCuesForTracks(
+        const QList<TrackId>& trackIds) const {
+    QHash<TrackId, QList<CuePointer>> cuesByTrack;
+    if (trackIds.isEmpty()) {
+        return cuesByTrack;
+    }
+
+    QStringList idList;
+    idList.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        idList << trackId.toString();
+    }
+    FwdSqlQuery query(
+            m_database,
+            QStringLiteral("SELECT * FROM " CUE_TABLE " WHERE track_id IN (%1)")
+                    .arg(idList.join(",")));
+    DEBUG_ASSERT(
+            query.isPrepared() &&
+            !query.hasError());
+    VERIFY_OR_DEBUG_ASSERT(query.execPrepared()) {
+        kLogger.warning()
+                << "Failed to load cues of"
+                << trackIds.size()
+                << "tracks";
+        return cuesByTrack;
+    }
+    QHash<TrackId, QMap<int, CuePointer>> hotCuesByTrack;
+    while (query.next()) {
+        const QSqlRecord record = query.record();
+        CuePointer pCue = cueFromRow(record);
+        VERIFY_OR_DEBUG_ASSERT(pCue) {
+            continue;
+        }
+        const TrackId trackId(record.value(record.indexOf("track_id")));
+        appendCue(
+                &cuesByTrack[trackId],
+                &hotCuesByTrack[trackId],
+                std::move(pCue));
+    }
+    return cuesByTrack;
+}
+
 bool CueDAO::deleteCuesForTrack(TrackId trackId) const {
     qDebug() << "CueDAO::deleteCuesForTrack" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
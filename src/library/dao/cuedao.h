@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include <QSqlDatabase>
 
 #include "library/dao/dao.h"
@@ -15,6 +16,10 @@ class CueDAO : public DAO {
     ~CueDAO() override = default;
 
     QList<CuePointer> getCuesForTrack(TrackId trackId) const;
+    /// Loads the cues of multiple tracks with a single query. Tracks
+    /// without any cues are not contained in the result.
+    QHash<TrackId, QList<CuePointer>> getCuesForTracks(
+            const QList<TrackId>& trackIds) const;
 
     void saveTrackCues(TrackId trackId, const QList<CuePointer>& cueList) const;
     bool deleteCuesForTrack(TrackId trackId) const;
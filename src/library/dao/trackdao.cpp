@@ -837,6 +837,54 @@ TrackPointer TrackDAO::addTracksAddFile(const TrackFile& trackFile, bool unremov
     return pTrack;
 }
 
+TrackPointer TrackDAO::addTracksAddPreparsedTrack(
+        const TrackPointer& pPreparsedTrack,
+        bool unremove) {
+    DEBUG_ASSERT(pPreparsedTrack);
+    DEBUG_ASSERT(!pPreparsedTrack->getId().isValid());
+    const auto trackFile = pPreparsedTrack->getFileInfo();
+
+    // Keep the GlobalTrackCache locked until the preparsed track
+    // has been stored in the database. Otherwise a second track
+    // object for the same file could be created and cached in
+    // the meantime.
+    GlobalTrackCacheLocker cacheLocker;
+    if (cacheLocker.lookupTrackByRef(TrackRef::fromFileInfo(trackFile))) {
+        // The file has been loaded after it has been parsed. The
+        // cached track object takes precedence over the preparsed
+        // metadata.
+        cacheLocker.unlockCache();
+        return addTracksAddFile(trackFile, unremove);
+    }
+
+    if (!pPreparsedTrack->isMetadataSynchronized()) {
+        qWarning() << "TrackDAO::addTracksAddPreparsedTrack:"
+                << "Failed to parse track metadata from file"
+                << pPreparsedTrack->getLocation();
+        // Continue with adding the track to the library, no matter
+        // if parsing the metadata from file succeeded or failed.
+    }
+
+    const TrackId newTrackId = addTracksAddTrack(pPreparsedTrack, unremove);
+    if (!newTrackId.isValid()) {
+        qWarning() << "TrackDAO::addTracksAddPreparsedTrack:"
+                << "Failed to add track to database"
+                << trackFile;
+        return TrackPointer();
+    }
+    DEBUG_ASSERT(pPreparsedTrack->getId() == newTrackId);
+    if (!m_tracksAddedSet.contains(newTrackId)) {
+        // The file has been added to the database after it has been
+        // parsed. The stored track takes precedence over the preparsed
+        // metadata and is loaded through the GlobalTrackCache.
+        cacheLocker.unlockCache();
+        return getTrackById(newTrackId);
+    }
+    // Only newly inserted tracks must be marked as clean!
+    pPreparsedTrack->markClean();
+    return pPreparsedTrack;
+}
+
 bool TrackDAO::hideTracks(
         const QList<TrackId>& trackIds) const {
     QStringList idList;
@@ -1247,17 +1295,148 @@ struct ColumnPopulator {
     TrackPopulatorFn populator;
 };
 
-}  // namespace
-
 #define ARRAYLENGTH(x) (sizeof(x) / sizeof(*x))
 
+const ColumnPopulator kTrackColumns[] = {
+        // Location must be first.
+        {"track_locations.location", nullptr},
+        {"artist", setTrackArtist},
+        {"title", setTrackTitle},
+        {"album", setTrackAlbum},
+        {"album_artist", setTrackAlbumArtist},
+        {"year", setTrackYear},
+        {"genre", setTrackGenre},
+        {"composer", setTrackComposer},
+        {"grouping", setTrackGrouping},
+        {"tracknumber", setTrackNumber},
+        {"tracktotal", setTrackTotal},
+        {"filetype", setTrackFiletype},
+        {"rating", setTrackRating},
+        {"color", setTrackColor},
+        {"comment", setTrackComment},
+        {"url", setTrackUrl},
+        {"cuepoint", setTrackCuePoint},
+        {"replaygain", setTrackReplayGainRatio},
+        {"replaygain_peak", setTrackReplayGainPeak},
+        {"timesplayed", setTrackTimesPlayed},
+        {"played", setTrackPlayed},
+        {"datetime_added", setTrackDateAdded},
+        {"header_parsed", setTrackMetadataSynchronized},
+
+        // Audio properties are set together at once. Do not change the
+        // ordering of these columns or put other columns in between them!
+        {"channels", setTrackAudioProperties},
+        {"samplerate", nullptr},
+        {"bitrate", nullptr},
+        {"duration", nullptr},
+
+        // Beat detection columns are handled by setTrackBeats. Do not change
+        // the ordering of these columns or put other columns in between them!
+        {"bpm", setTrackBeats},
+        {"beats_version", nullptr},
+        {"beats_sub_version", nullptr},
+        {"beats", nullptr},
+        {"bpm_lock", nullptr},
+
+        // Beat detection columns are handled by setTrackKey. Do not change the
+        // ordering of these columns or put other columns in between them!
+        {"key", setTrackKey},
+        {"keys_version", nullptr},
+        {"keys_sub_version", nullptr},
+        {"keys", nullptr},
+
+        // Cover art columns are handled by setTrackCoverInfo. Do not change the
+        // ordering of these columns or put other columns in between them!
+        {"coverart_source", setTrackCoverInfo},
+        {"coverart_type", nullptr},
+        {"coverart_location", nullptr},
+        {"coverart_color", nullptr},
+        {"coverart_digest", nullptr},
+        {"coverart_hash", nullptr},
+};
+
+const int kTrackColumnsCount = ARRAYLENGTH(kTrackColumns);
+
+// Comma-separated list of all columns in kTrackColumns
+const QString& trackColumnsString() {
+    static const QString columnsStr = [] {
+        QString columnsStr;
+        int columnsSize = 0;
+        for (int i = 0; i < kTrackColumnsCount; ++i) {
+            columnsSize += qstrlen(kTrackColumns[i].name) + 1;
+        }
+        columnsStr.reserve(columnsSize);
+        for (int i = 0; i < kTrackColumnsCount; ++i) {
+            if (i > 0) {
+                columnsStr.append(QChar(','));
+            }
+            columnsStr.append(kTrackColumns[i].name);
+        }
+        return columnsStr;
+    }();
+    return columnsStr;
+}
+
+// Limits the number of ids in a single "IN (...)" clause
+// to stay well below the SQLite limits for the statement
+// size.
+constexpr int kMaxTrackIdsPerQuery = 1000;
+
+// Resolves a track that has been selected from the database in the
+// GlobalTrackCache. The cache might already contain the track due to
+// race conditions. In this case the cached track is returned and
+// *pMiss is set to false. Otherwise a new, empty track object that
+// needs to be populated by the caller is returned and *pMiss is set
+// to true. Conflicting tracks that reference the same file as some
+// other cached track are rejected and a nullptr is returned.
+TrackPointer resolveTrackInCache(
+        TrackId trackId,
+        const QString& trackLocation,
+        bool* pMiss) {
+    DEBUG_ASSERT(pMiss);
+    *pMiss = false;
+    GlobalTrackCacheResolver cacheResolver(TrackFile(trackLocation), trackId);
+    TrackPointer pTrack = cacheResolver.getTrack();
+    if (cacheResolver.getLookupResult() == GlobalTrackCacheLookupResult::Hit) {
+        // Due to race conditions the track might have been reloaded
+        // from the database in the meantime. In this case we abort
+        // the operation and simply return the already cached Track
+        // object which is up-to-date.
+        DEBUG_ASSERT(pTrack);
+        return pTrack;
+    }
+    if (cacheResolver.getLookupResult() ==
+            GlobalTrackCacheLookupResult::ConflictCanonicalLocation) {
+        // Reject requests that would otherwise cause a caching caching conflict
+        // by accessing the same, physical file from multiple tracks concurrently.
+        DEBUG_ASSERT(!pTrack);
+        DEBUG_ASSERT(cacheResolver.getTrackRef().hasId());
+        DEBUG_ASSERT(cacheResolver.getTrackRef().hasCanonicalLocation());
+        kLogger.warning()
+                << "Failed to load track with id"
+                << trackId
+                << "that is referencing the same file"
+                << cacheResolver.getTrackRef().getCanonicalLocation()
+                << "as the cached track with id"
+                << cacheResolver.getTrackRef().getId();
+        return pTrack;
+    }
+    DEBUG_ASSERT(cacheResolver.getLookupResult() == GlobalTrackCacheLookupResult::Miss);
+    DEBUG_ASSERT(pTrack);
+    *pMiss = true;
+    return pTrack;
+}
+
+}  // namespace
+
 TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
     if (!trackId.isValid()) {
         return TrackPointer();
     }
 
-    // The GlobalTrackCache is only locked while executing the following line.
-    TrackPointer pTrack = GlobalTrackCacheLocker().lookupTrackById(trackId);
+    // Only a single shard of the GlobalTrackCache is locked while
+    // executing the following line.
+    TrackPointer pTrack = GlobalTrackCache::lookupTrackById(trackId);
     if (pTrack) {
         return pTrack;
     }
@@ -1269,82 +1448,10 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
     ScopedTimer t("TrackDAO::getTrackById");
     QSqlQuery query(m_database);
 
-    ColumnPopulator columns[] = {
-            // Location must be first.
-            {"track_locations.location", nullptr},
-            {"artist", setTrackArtist},
-            {"title", setTrackTitle},
-            {"album", setTrackAlbum},
-            {"album_artist", setTrackAlbumArtist},
-            {"year", setTrackYear},
-            {"genre", setTrackGenre},
-            {"composer", setTrackComposer},
-            {"grouping", setTrackGrouping},
-            {"tracknumber", setTrackNumber},
-            {"tracktotal", setTrackTotal},
-            {"filetype", setTrackFiletype},
-            {"rating", setTrackRating},
-            {"color", setTrackColor},
-            {"comment", setTrackComment},
-            {"url", setTrackUrl},
-            {"cuepoint", setTrackCuePoint},
-            {"replaygain", setTrackReplayGainRatio},
-            {"replaygain_peak", setTrackReplayGainPeak},
-            {"timesplayed", setTrackTimesPlayed},
-            {"played", setTrackPlayed},
-            {"datetime_added", setTrackDateAdded},
-            {"header_parsed", setTrackMetadataSynchronized},
-
-            // Audio properties are set together at once. Do not change the
-            // ordering of these columns or put other columns in between them!
-            {"channels", setTrackAudioProperties},
-            {"samplerate", nullptr},
-            {"bitrate", nullptr},
-            {"duration", nullptr},
-
-            // Beat detection columns are handled by setTrackBeats. Do not change
-            // the ordering of these columns or put other columns in between them!
-            {"bpm", setTrackBeats},
-            {"beats_version", nullptr},
-            {"beats_sub_version", nullptr},
-            {"beats", nullptr},
-            {"bpm_lock", nullptr},
-
-            // Beat detection columns are handled by setTrackKey. Do not change the
-            // ordering of these columns or put other columns in between them!
-            {"key", setTrackKey},
-            {"keys_version", nullptr},
-            {"keys_sub_version", nullptr},
-            {"keys", nullptr},
-
-            // Cover art columns are handled by setTrackCoverInfo. Do not change the
-            // ordering of these columns or put other columns in between them!
-            {"coverart_source", setTrackCoverInfo},
-            {"coverart_type", nullptr},
-            {"coverart_location", nullptr},
-            {"coverart_color", nullptr},
-            {"coverart_digest", nullptr},
-            {"coverart_hash", nullptr},
-    };
-
-    QString columnsStr;
-    int columnsSize = 0;
-    const int columnsCount = ARRAYLENGTH(columns);
-    for (int i = 0; i < columnsCount; ++i) {
-        columnsSize += qstrlen(columns[i].name) + 1;
-    }
-    columnsStr.reserve(columnsSize);
-    for (int i = 0; i < columnsCount; ++i) {
-        if (i > 0) {
-            columnsStr.append(QChar(','));
-        }
-        columnsStr.append(columns[i].name);
-    }
-
     query.prepare(QString(
             "SELECT %1 FROM Library "
             "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE library.id = %2").arg(columnsStr, trackId.toString()));
+            "WHERE library.id = %2").arg(trackColumnsString(), trackId.toString()));
 
     VERIFY_OR_DEBUG_ASSERT(query.exec()) {
         LOG_FAILED_QUERY(query)
@@ -1356,45 +1463,143 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
         return TrackPointer();
     }
 
-    QSqlRecord queryRecord = query.record();
-    int recordCount = queryRecord.count();
-    VERIFY_OR_DEBUG_ASSERT(recordCount == columnsCount) {
-        recordCount = math_min(recordCount, columnsCount);
-    }
+    const QSqlRecord queryRecord = query.record();
 
     // Location is the first column.
     const QString trackLocation(queryRecord.value(0).toString());
 
-    GlobalTrackCacheResolver cacheResolver(TrackFile(trackLocation), trackId);
-    pTrack = cacheResolver.getTrack();
-    if (cacheResolver.getLookupResult() == GlobalTrackCacheLookupResult::Hit) {
-        // Due to race conditions the track might have been reloaded
-        // from the database in the meantime. In this case we abort
-        // the operation and simply return the already cached Track
-        // object which is up-to-date.
-        DEBUG_ASSERT(pTrack);
+    // The cache will immediately be unlocked after resolving the
+    // track to reduce lock contention!
+    bool miss = false;
+    pTrack = resolveTrackInCache(trackId, trackLocation, &miss);
+    if (!miss) {
         return pTrack;
     }
-    if (cacheResolver.getLookupResult() ==
-            GlobalTrackCacheLookupResult::ConflictCanonicalLocation) {
-        // Reject requests that would otherwise cause a caching caching conflict
-        // by accessing the same, physical file from multiple tracks concurrently.
-        DEBUG_ASSERT(!pTrack);
-        DEBUG_ASSERT(cacheResolver.getTrackRef().hasId());
-        DEBUG_ASSERT(cacheResolver.getTrackRef().hasCanonicalLocation());
-        kLogger.warning()
-                << "Failed to load track with id"
-                << trackId
-                << "that is referencing the same file"
-                << cacheResolver.getTrackRef().getCanonicalLocation()
-                << "as the cached track with id"
-                << cacheResolver.getTrackRef().getId();
-        return pTrack;
+
+    populateTrackFromRecord(
+            pTrack,
+            queryRecord,
+            m_cueDao.getCuesForTrack(trackId));
+
+    return pTrack;
+}
+
+QList<TrackPointer> TrackDAO::getTracksByIds(
+        const QList<TrackId>& trackIds) const {
+    QList<TrackPointer> tracks;
+    tracks.reserve(trackIds.size());
+
+    // Cached tracks are looked up without locking the whole
+    // GlobalTrackCache.
+    QList<TrackId> missingTrackIds;
+    {
+        // Ids might occur multiple times in the requested list
+        QSet<TrackId> uniqueMissingTrackIds;
+        for (const auto& trackId : trackIds) {
+            TrackPointer pTrack;
+            if (trackId.isValid()) {
+                pTrack = GlobalTrackCache::lookupTrackById(trackId);
+                if (!pTrack && !uniqueMissingTrackIds.contains(trackId)) {
+                    uniqueMissingTrackIds.insert(trackId);
+                    missingTrackIds.append(trackId);
+                }
+            }
+            tracks.append(std::move(pTrack));
+        }
+    }
+    if (missingTrackIds.isEmpty()) {
+        return tracks;
     }
-    DEBUG_ASSERT(cacheResolver.getLookupResult() == GlobalTrackCacheLookupResult::Miss);
-    // The cache will immediately be unlocked to reduce lock contention!
-    cacheResolver.unlockCache();
 
+    ScopedTimer t("TrackDAO::getTracksByIds");
+
+    QHash<TrackId, TrackPointer> loadedTracks;
+    loadedTracks.reserve(missingTrackIds.size());
+    for (int offset = 0; offset < missingTrackIds.size(); offset += kMaxTrackIdsPerQuery) {
+        const auto chunkTrackIds = missingTrackIds.mid(offset, kMaxTrackIdsPerQuery);
+        QStringList idList;
+        idList.reserve(chunkTrackIds.size());
+        for (const auto& trackId : chunkTrackIds) {
+            idList << trackId.toString();
+        }
+
+        // The id of each track is appended after all populated columns
+        QSqlQuery query(m_database);
+        query.prepare(QString(
+                "SELECT %1,library.id FROM Library "
+                "INNER JOIN track_locations ON library.location = track_locations.id "
+                "WHERE library.id IN (%2)").arg(trackColumnsString(), idList.join(",")));
+        VERIFY_OR_DEBUG_ASSERT(query.exec()) {
+            LOG_FAILED_QUERY(query)
+                    << "getTracksByIds:"
+                    << chunkTrackIds.size()
+                    << "tracks";
+            continue;
+        }
+        QList<QSqlRecord> queryRecords;
+        queryRecords.reserve(chunkTrackIds.size());
+        while (query.next()) {
+            queryRecords.append(query.record());
+        }
+
+        // Resolve all selected tracks while holding the lock on the
+        // GlobalTrackCache only once. The resolvers for the individual
+        // tracks lock the recursive mutex again, but without contention.
+        QList<QPair<QSqlRecord, TrackPointer>> resolvedTracks;
+        resolvedTracks.reserve(queryRecords.size());
+        {
+            GlobalTrackCacheLocker cacheLocker;
+            for (const auto& queryRecord : qAsConst(queryRecords)) {
+                const TrackId trackId(queryRecord.value(kTrackColumnsCount));
+                // Location is the first column.
+                const QString trackLocation(queryRecord.value(0).toString());
+                bool miss = false;
+                auto pTrack = resolveTrackInCache(trackId, trackLocation, &miss);
+                if (!pTrack) {
+                    continue;
+                }
+                loadedTracks.insert(trackId, pTrack);
+                if (miss) {
+                    resolvedTracks.append(qMakePair(queryRecord, std::move(pTrack)));
+                }
+            }
+        }
+        if (resolvedTracks.isEmpty()) {
+            continue;
+        }
+
+        // Populate all new tracks outside of the GlobalTrackCache lock
+        // with the cues that are loaded by a single query.
+        QList<TrackId> resolvedTrackIds;
+        resolvedTrackIds.reserve(resolvedTracks.size());
+        for (const auto& resolvedTrack : qAsConst(resolvedTracks)) {
+            resolvedTrackIds.append(resolvedTrack.second->getId());
+        }
+        auto cuesByTrack = m_cueDao.getCuesForTracks(resolvedTrackIds);
+        for (const auto& resolvedTrack : qAsConst(resolvedTracks)) {
+            const auto& pTrack = resolvedTrack.second;
+            populateTrackFromRecord(
+                    pTrack,
+                    resolvedTrack.first,
+                    cuesByTrack.take(pTrack->getId()));
+        }
+    }
+
+    for (int i = 0; i < trackIds.size(); ++i) {
+        if (!tracks[i] && trackIds[i].isValid()) {
+            tracks[i] = loadedTracks.value(trackIds[i]);
+            if (!tracks[i]) {
+                qDebug() << "Track with id =" << trackIds[i] << "not found";
+            }
+        }
+    }
+    return tracks;
+}
+
+void TrackDAO::populateTrackFromRecord(
+        const TrackPointer& pTrack,
+        const QSqlRecord& queryRecord,
+        const QList<CuePointer>& cues) const {
     // NOTE(uklotzde, 2018-02-06):
     // pTrack has only the id set and is otherwise empty. It is registered
     // in the cache with both the id and the canonical location of the file.
@@ -1404,11 +1609,21 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
     // is acceptable as a tradeoff for reduced lock contention. Otherwise the
     // global cache would need to be locked until the query and the population
     // of the properties has finished.
+    const TrackId trackId = pTrack->getId();
+
+    // Additional columns might follow after the populated columns
+    int recordCount = queryRecord.count();
+    VERIFY_OR_DEBUG_ASSERT(recordCount >= kTrackColumnsCount) {
+        kLogger.warning()
+                << "Missing columns in database record of track"
+                << trackId;
+    }
+    recordCount = math_min(recordCount, kTrackColumnsCount);
 
     // For every column run its populator to fill the track in with the data.
     bool shouldDirty = false;
     for (int i = 0; i < recordCount; ++i) {
-        TrackPopulatorFn populator = columns[i].populator;
+        TrackPopulatorFn populator = kTrackColumns[i].populator;
         if (populator != nullptr) {
             // If any populator says the track should be dirty then we dirty it.
             if ((*populator)(queryRecord, i, pTrack)) {
@@ -1418,7 +1633,7 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
     }
 
     // Populate track cues from the cues table.
-    pTrack->setCuePoints(m_cueDao.getCuesForTrack(trackId));
+    pTrack->setCuePoints(cues);
 
     // Normally we will set the track as clean but sometimes when loading from
     // the database we need to perform upkeep that ought to be written back to
@@ -1468,8 +1683,6 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
     } else {
         emit trackClean(trackId);
     }
-
-    return pTrack;
 }
 
 TrackId TrackDAO::getTrackIdByRef(
@@ -1478,8 +1691,7 @@ TrackId TrackDAO::getTrackIdByRef(
         return trackRef.getId();
     }
     {
-        GlobalTrackCacheLocker cacheLocker;
-        const auto pTrack = cacheLocker.lookupTrackByRef(trackRef);
+        const auto pTrack = GlobalTrackCache::lookupTrackByRef(trackRef);
         if (pTrack) {
             return pTrack->getId();
         }
@@ -1493,8 +1705,7 @@ TrackPointer TrackDAO::getTrackByRef(
         return TrackPointer();
     }
     {
-        GlobalTrackCacheLocker cacheLocker;
-        auto pTrack = cacheLocker.lookupTrackByRef(trackRef);
+        auto pTrack = GlobalTrackCache::lookupTrackByRef(trackRef);
         if (pTrack) {
             return pTrack;
         }
@@ -15,7 +15,9 @@
 #include "util/class.h"
 #include "util/memory.h"
 
+class QSqlRecord;
 class SqlTransaction;
+class CuePointer;
 class PlaylistDAO;
 class AnalysisDao;
 class CueDAO;
@@ -99,6 +101,17 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
             const QString& location) const;
     TrackPointer getTrackById(
             TrackId trackId) const;
+    // Loads multiple tracks at once with a single query per table. The
+    // returned list contains the tracks in the same order as the given
+    // ids, tracks that could not be loaded are represented by a nullptr.
+    QList<TrackPointer> getTracksByIds(
+            const QList<TrackId>& trackIds) const;
+    // Populates a new track object that has just been added to the
+    // GlobalTrackCache from a database record.
+    void populateTrackFromRecord(
+            const TrackPointer& pTrack,
+            const QSqlRecord& queryRecord,
+            const QList<CuePointer>& cues) const;
 
     // Loads a track from the database (by id if available, otherwise by location)
     // or adds it if not found in case the location is known. The (optional) out
@@ -116,6 +129,13 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     TrackPointer addTracksAddFile(
             const TrackFile& trackFile,
             bool unremove);
+    // Adds a temporary track object that has already been populated
+    // from the file by SoundSourceProxy, i.e. without accessing the
+    // file again. Falls back to addTracksAddFile() if the file is
+    // currently referenced by a cached track object.
+    TrackPointer addTracksAddPreparsedTrack(
+            const TrackPointer& pPreparsedTrack,
+            bool unremove);
     void addTracksFinish(bool rollback = false);
 
     bool updateTrack(Track* pTrack) const;
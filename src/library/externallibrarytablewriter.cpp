@@ -0,0 +1,332 @@
+#include "library/externallibrarytablewriter.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSqlQuery>
+#include <memory>
+
+#include "library/queryutil.h"
+#include "util/assert.h"
+#include "util/db/sqltransaction.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ExternalLibraryTableWriter");
+
+// The default limit of SQLite for host parameters in a single statement
+constexpr int kMaxBindValuesPerStatement = 999;
+constexpr int kMaxRowsPerStatement = 256;
+
+constexpr int kItemsPerChunk = 512;
+constexpr int kMaxQueuedChunks = 16;
+
+constexpr int kStatementItem = -1;
+
+QString insertStatement(
+        const QString& tableName,
+        const QStringList& columnNames,
+        int rowCount) {
+    QStringList placeholders;
+    for (int i = 0; i < columnNames.size(); ++i) {
+        placeholders << QStringLiteral("?");
+    }
+    const QString row = QChar('(') + placeholders.join(QChar(',')) + QChar(')');
+    QStringList rows;
+    rows.reserve(rowCount);
+    for (int i = 0; i < rowCount; ++i) {
+        rows << row;
+    }
+    return QStringLiteral("INSERT INTO %1 (%2) VALUES %3")
+            .arg(tableName,
+                    columnNames.join(QChar(',')),
+                    rows.join(QChar(',')));
+}
+
+// Collects the rows of a single table and inserts them with a prepared
+// multi-row statement. If a batch fails, e.g. due to a single duplicate
+// row, its rows are inserted one by one to keep all other rows and to
+// log the failing ones.
+class BatchInsert final {
+  public:
+    BatchInsert(
+            const QSqlDatabase& database,
+            const QString& tableName,
+            const QStringList& columnNames)
+            : m_database(database),
+              m_tableName(tableName),
+              m_columnNames(columnNames),
+              m_rowsPerStatement(math_max(1,
+                      math_min(kMaxRowsPerStatement,
+                              kMaxBindValuesPerStatement /
+                                      math_max(1, columnNames.size())))),
+              m_batchQuery(database),
+              m_rowQuery(database) {
+        m_pendingRows.reserve(m_rowsPerStatement);
+        if (!m_batchQuery.prepare(insertStatement(
+                    m_tableName, m_columnNames, m_rowsPerStatement))) {
+            LOG_FAILED_QUERY(m_batchQuery);
+        }
+        if (!m_rowQuery.prepare(insertStatement(
+                    m_tableName, m_columnNames, 1))) {
+            LOG_FAILED_QUERY(m_rowQuery);
+        }
+    }
+
+    void append(QVariantList values) {
+        DEBUG_ASSERT(values.size() == m_columnNames.size());
+        m_pendingRows.push_back(std::move(values));
+        if (static_cast<int>(m_pendingRows.size()) >= m_rowsPerStatement) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (m_pendingRows.empty()) {
+            return;
+        }
+        bool success;
+        if (static_cast<int>(m_pendingRows.size()) == m_rowsPerStatement) {
+            success = execBatch(&m_batchQuery);
+        } else {
+            // The remainder is only inserted once at the end
+            QSqlQuery query(m_database);
+            success = query.prepare(insertStatement(
+                              m_tableName, m_columnNames, m_pendingRows.size())) &&
+                    execBatch(&query);
+        }
+        if (!success) {
+            kLogger.debug()
+                    << "Inserting"
+                    << m_pendingRows.size()
+                    << "rows into"
+                    << m_tableName
+                    << "one by one";
+            for (const auto& row : m_pendingRows) {
+                bindRow(&m_rowQuery, 0, row);
+                if (!m_rowQuery.exec()) {
+                    LOG_FAILED_QUERY(m_rowQuery);
+                }
+            }
+        }
+        m_pendingRows.clear();
+    }
+
+  private:
+    static int bindRow(
+            QSqlQuery* pQuery,
+            int position,
+            const QVariantList& row) {
+        for (const auto& value : row) {
+            pQuery->bindValue(position++, value);
+        }
+        return position;
+    }
+
+    bool execBatch(QSqlQuery* pQuery) {
+        int position = 0;
+        for (const auto& row : m_pendingRows) {
+            position = bindRow(pQuery, position, row);
+        }
+        return pQuery->exec();
+    }
+
+    const QSqlDatabase m_database;
+    const QString m_tableName;
+    const QStringList m_columnNames;
+    const int m_rowsPerStatement;
+    QSqlQuery m_batchQuery;
+    QSqlQuery m_rowQuery;
+    std::vector<QVariantList> m_pendingRows;
+};
+
+mixxx::DbConnection::Params connectionParams(
+        const QSqlDatabase& database) {
+    mixxx::DbConnection::Params params;
+    params.type = database.driverName();
+    params.connectOptions = database.connectOptions();
+    params.hostName = database.hostName();
+    params.filePath = database.databaseName();
+    params.userName = database.userName();
+    params.password = database.password();
+    return params;
+}
+
+} // anonymous namespace
+
+ExternalLibraryTableWriter::ExternalLibraryTableWriter(
+        const QSqlDatabase& database,
+        const QString& connectionName)
+        : m_connectionParams(connectionParams(database)),
+          m_connectionName(connectionName),
+          m_finishing(false),
+          m_succeeded(false) {
+    m_pendingChunk.reserve(kItemsPerChunk);
+}
+
+ExternalLibraryTableWriter::~ExternalLibraryTableWriter() {
+    if (isRunning()) {
+        finish();
+    }
+}
+
+int ExternalLibraryTableWriter::addTable(
+        const QString& tableName,
+        const QStringList& columnNames) {
+    DEBUG_ASSERT(!isRunning());
+    m_tables.push_back(Table{tableName, columnNames});
+    return static_cast<int>(m_tables.size()) - 1;
+}
+
+void ExternalLibraryTableWriter::insertRow(
+        int tableIndex,
+        QVariantList values) {
+    DEBUG_ASSERT(tableIndex >= 0);
+    DEBUG_ASSERT(tableIndex < static_cast<int>(m_tables.size()));
+    queueItem(Item{tableIndex, QString(), std::move(values)});
+}
+
+void ExternalLibraryTableWriter::executeStatement(
+        const QString& statement,
+        QVariantList bindValues) {
+    queueItem(Item{kStatementItem, statement, std::move(bindValues)});
+}
+
+void ExternalLibraryTableWriter::queueItem(Item item) {
+    m_pendingChunk.push_back(std::move(item));
+    if (static_cast<int>(m_pendingChunk.size()) >= kItemsPerChunk) {
+        flushPendingChunk();
+    }
+}
+
+void ExternalLibraryTableWriter::flushPendingChunk() {
+    if (m_pendingChunk.empty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    while (static_cast<int>(m_queue.size()) >= kMaxQueuedChunks) {
+        m_queueNotFull.wait(&m_mutex);
+    }
+    m_queue.push_back(std::move(m_pendingChunk));
+    m_queueNotEmpty.wakeOne();
+    locker.unlock();
+    m_pendingChunk = Chunk();
+    m_pendingChunk.reserve(kItemsPerChunk);
+}
+
+bool ExternalLibraryTableWriter::takeChunk(Chunk* pChunk) {
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.empty()) {
+        if (m_finishing) {
+            return false;
+        }
+        m_queueNotEmpty.wait(&m_mutex);
+    }
+    *pChunk = std::move(m_queue.front());
+    m_queue.pop_front();
+    m_queueNotFull.wakeOne();
+    return true;
+}
+
+bool ExternalLibraryTableWriter::finish() {
+    flushPendingChunk();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finishing = true;
+        m_queueNotEmpty.wakeAll();
+    }
+    wait();
+    return m_succeeded;
+}
+
+void ExternalLibraryTableWriter::run() {
+    {
+        // A QSqlDatabase must only be used by the thread that created it.
+        // Cloning the database of the parser thread would access it from
+        // this thread.
+        QSqlDatabase database = QSqlDatabase::addDatabase(
+                m_connectionParams.type, m_connectionName);
+        database.setConnectOptions(m_connectionParams.connectOptions);
+        database.setHostName(m_connectionParams.hostName);
+        database.setDatabaseName(m_connectionParams.filePath);
+        database.setUserName(m_connectionParams.userName);
+        database.setPassword(m_connectionParams.password);
+        if (database.open()) {
+            m_succeeded = writeTables(database);
+            database.close();
+        } else {
+            kLogger.warning()
+                    << "Failed to open database connection"
+                    << m_connectionName
+                    << database.lastError();
+            m_succeeded = false;
+            // Keep the parser from blocking on a full queue
+            Chunk chunk;
+            while (takeChunk(&chunk)) {
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool ExternalLibraryTableWriter::writeTables(QSqlDatabase database) {
+    SqlTransaction transaction(database);
+    if (!transaction) {
+        kLogger.warning()
+                << "Failed to start transaction on"
+                << m_connectionName;
+    }
+
+    std::vector<std::unique_ptr<BatchInsert>> batchInserts;
+    batchInserts.reserve(m_tables.size());
+    for (const auto& table : m_tables) {
+        QSqlQuery query(database);
+        if (!query.exec(QStringLiteral("DELETE FROM %1").arg(table.name))) {
+            LOG_FAILED_QUERY(query);
+        }
+        batchInserts.push_back(std::make_unique<BatchInsert>(
+                database, table.name, table.columnNames));
+    }
+
+    Chunk chunk;
+    while (takeChunk(&chunk)) {
+        for (auto& item : chunk) {
+            if (item.tableIndex == kStatementItem) {
+                for (const auto& pBatchInsert : batchInserts) {
+                    pBatchInsert->flush();
+                }
+                QSqlQuery query(database);
+                query.prepare(item.statement);
+                for (int i = 0; i < item.values.size(); ++i) {
+                    query.bindValue(i, item.values.at(i));
+                }
+                if (!query.exec()) {
+                    LOG_FAILED_QUERY(query);
+                }
+            } else {
+                batchInserts[item.tableIndex]->append(std::move(item.values));
+            }
+        }
+    }
+    for (const auto& pBatchInsert : batchInserts) {
+        pBatchInsert->flush();
+    }
+    batchInserts.clear();
+
+    return transaction && transaction.commit();
+}
+
+//static
+QString ExternalLibraryTableWriter::digestSourceFiles(
+        const QStringList& filePaths) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto& filePath : filePaths) {
+        hash.addData(filePath.toUtf8());
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadOnly)) {
+            hash.addData(&file);
+        }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QThread>
+#include <QVariantList>
+#include <QWaitCondition>
+#include <deque>
+#include <vector>
+
+#include "util/db/dbconnection.h"
+
+/// Writes the contents of an external library (iTunes, Traktor, Rhythmbox)
+/// into the corresponding tables of the Mixxx database.
+///
+/// Rows are collected in chunks and handed over to a separate writer
+/// thread through a bounded queue, i.e. the parser only blocks if the
+/// database falls behind. The writer thread uses its own database
+/// connection and inserts the rows with multi-row INSERT statements that
+/// are prepared only once. All registered tables are cleared and refilled
+/// within a single transaction.
+class ExternalLibraryTableWriter : public QThread {
+  public:
+    /// Must be called from the thread that uses the database. Only its
+    /// connection parameters are copied, the writer thread opens a new
+    /// connection with them.
+    ExternalLibraryTableWriter(
+            const QSqlDatabase& database,
+            const QString& connectionName);
+    ~ExternalLibraryTableWriter() override;
+
+    /// Registers a table that is cleared when the writer starts. Returns
+    /// the index that must be passed to insertRow(). All tables need to
+    /// be added before calling start().
+    int addTable(
+            const QString& tableName,
+            const QStringList& columnNames);
+
+    /// Queues a row with a value for each column of the table.
+    void insertRow(
+            int tableIndex,
+            QVariantList values);
+
+    /// Queues a statement that is executed after all preceding rows
+    /// have been inserted.
+    void executeStatement(
+            const QString& statement,
+            QVariantList bindValues = QVariantList());
+
+    /// Flushes all pending rows, commits the transaction and waits for
+    /// the writer thread. Returns false if the database could not be
+    /// accessed or the transaction has not been committed. Failed inserts
+    /// of single rows are only logged.
+    bool finish();
+
+    /// Calculates a digest of the given files for detecting if an
+    /// external library has changed since the last import.
+    static QString digestSourceFiles(
+            const QStringList& filePaths);
+
+  protected:
+    void run() override;
+
+  private:
+    struct Table {
+        QString name;
+        QStringList columnNames;
+    };
+
+    struct Item {
+        int tableIndex; // kStatementItem for statements
+        QString statement;
+        QVariantList values;
+    };
+    typedef std::vector<Item> Chunk;
+
+    void queueItem(Item item);
+    void flushPendingChunk();
+    bool takeChunk(Chunk* pChunk);
+    bool writeTables(QSqlDatabase database);
+
+    const mixxx::DbConnection::Params m_connectionParams;
+    const QString m_connectionName;
+
+    std::vector<Table> m_tables;
+
+    // Only accessed by the parser thread
+    Chunk m_pendingChunk;
+
+    QMutex m_mutex;
+    QWaitCondition m_queueNotEmpty;
+    QWaitCondition m_queueNotFull;
+    std::deque<Chunk> m_queue;
+    bool m_finishing;
+
+    bool m_succeeded;
+};
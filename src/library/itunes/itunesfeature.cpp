@@ -14,22 +14,20 @@
 #include "library/dao/settingsdao.h"
 #include "library/baseexternaltrackmodel.h"
 #include "library/baseexternalplaylistmodel.h"
+#include "library/externallibrarytablewriter.h"
 #include "library/queryutil.h"
 #include "library/library.h"
 #include "library/trackcollectionmanager.h"
+#include "util/assert.h"
 #include "util/lcs.h"
 #include "util/sandbox.h"
 #include "widget/wlibrarysidebar.h"
 
-#ifdef __SQLITE3__
-#include <sqlite3.h>
-#else // __SQLITE3__
-#define SQLITE_CONSTRAINT  19 // Abort due to constraint violation
-#endif // __SQLITE3__
-
 namespace {
 
 const QString ITDB_PATH_KEY = "mixxx.itunesfeature.itdbpath";
+// Digest of the last iTunes library that has been imported completely
+const QString ITDB_DIGEST_KEY = "mixxx.itunesfeature.itdbdigest";
 
 const QString kDict = "dict";
 const QString kKey = "key";
@@ -51,6 +49,39 @@ const QString kRating = "Rating";
 const QString kTrackType = "Track Type";
 const QString kRemote = "Remote";
 
+// The indices of the tables registered by addImportTables()
+enum ImportTable {
+    kPlaylistTracksTable = 0,
+    kLibraryTable = 1,
+    kPlaylistsTable = 2,
+};
+
+void addImportTables(ExternalLibraryTableWriter* pWriter) {
+    int tableIndex = pWriter->addTable("itunes_playlist_tracks",
+            QStringList{"playlist_id", "track_id", "position"});
+    DEBUG_ASSERT(tableIndex == kPlaylistTracksTable);
+    tableIndex = pWriter->addTable("itunes_library",
+            QStringList{"id",
+                    "artist",
+                    "title",
+                    "album",
+                    "album_artist",
+                    "year",
+                    "genre",
+                    "grouping",
+                    "comment",
+                    "tracknumber",
+                    "bpm",
+                    "bitrate",
+                    "duration",
+                    "location",
+                    "rating"});
+    DEBUG_ASSERT(tableIndex == kLibraryTable);
+    tableIndex = pWriter->addTable("itunes_playlists",
+            QStringList{"id", "name"});
+    DEBUG_ASSERT(tableIndex == kPlaylistsTable);
+}
+
 QString localhost_token() {
 #if defined(__WINDOWS__)
     return "//localhost/";
@@ -163,14 +194,6 @@ void ITunesFeature::activate() {
 void ITunesFeature::activate(bool forceReload) {
     //qDebug("ITunesFeature::activate()");
     if (!m_isActivated || forceReload) {
-
-        //Delete all table entries of iTunes feature
-        ScopedTransaction transaction(m_database);
-        clearTable("itunes_playlist_tracks");
-        clearTable("itunes_library");
-        clearTable("itunes_playlists");
-        transaction.commit();
-
         emit showTrackModel(m_pITunesTrackModel);
 
         SettingsDAO settings(m_pTrackCollection->database());
@@ -244,7 +267,7 @@ void ITunesFeature::onRightClick(const QPoint& globalPos) {
     if (chosen == &useDefault) {
         SettingsDAO settings(m_database);
         settings.setValue(ITDB_PATH_KEY, QString());
-        activate(true); // clears tables before parsing
+        activate(true); // reimports the library if it has changed
     } else if (chosen == &chooseNew) {
         SettingsDAO settings(m_database);
         QString dbfile = QFileDialog::getOpenFileName(
@@ -262,7 +285,7 @@ void ITunesFeature::onRightClick(const QPoint& globalPos) {
         Sandbox::createSecurityToken(dbFileInfo);
 
         settings.setValue(ITDB_PATH_KEY, dbfile);
-        activate(true); // clears tables before parsing
+        activate(true); // reimports the library if it has changed
     }
 }
 
@@ -375,7 +398,15 @@ TreeItem* ITunesFeature::importLibrary() {
 
     qDebug() << "ITunesFeature::importLibrary() ";
 
-    ScopedTransaction transaction(m_database);
+    SettingsDAO settings(m_database);
+    const QString digest =
+            ExternalLibraryTableWriter::digestSourceFiles(QStringList{m_dbfile});
+    if (settings.getValue(ITDB_DIGEST_KEY) == digest) {
+        qDebug() << "iTunes music collection is unchanged, skipping import";
+        return loadPlaylists();
+    }
+    // Invalidate the digest until the new import has been committed
+    settings.setValue(ITDB_DIGEST_KEY, QString());
 
     // By default set m_mixxxItunesRoot and m_dbItunesRoot to strip out
     // file://localhost/ from the URL. When we load the user's iTunes XML
@@ -392,6 +423,11 @@ TreeItem* ITunesFeature::importLibrary() {
         return NULL;
     }
 
+    // The tables are cleared and written by a separate thread while parsing
+    ExternalLibraryTableWriter writer(m_database, "ITUNES_WRITER");
+    addImportTables(&writer);
+    writer.start(QThread::LowPriority);
+
     QXmlStreamReader xml(&itunes_file);
     TreeItem* playlist_root = NULL;
     while (!xml.atEnd() && !m_cancelImport) {
@@ -405,10 +441,10 @@ TreeItem* ITunesFeature::importLibrary() {
                         guessMusicLibraryMountpoint(xml);
                     }
                 } else if (key == "Tracks") {
-                    parseTracks(xml);
+                    parseTracks(xml, &writer);
                     if (playlist_root != NULL)
                         delete playlist_root;
-                    playlist_root = parsePlaylists(xml);
+                    playlist_root = parsePlaylists(xml, &writer);
                     isTracksParsed = true;
                 }
             }
@@ -420,20 +456,15 @@ TreeItem* ITunesFeature::importLibrary() {
     if (isMusicFolderLocatedAfterTracks) {
         qDebug() << "Updating iTunes real path from " << m_dbItunesRoot << " to " << m_mixxxItunesRoot;
         // In some iTunes files "Music Folder" XML node is located at the end of file. So, we need to
-        QSqlQuery query(m_database);
-        query.prepare("UPDATE itunes_library SET location = replace( location, :itunes_path, :mixxx_path )");
-        query.bindValue(":itunes_path", m_dbItunesRoot.replace(localhost_token(), ""));
-        query.bindValue(":mixxx_path", m_mixxxItunesRoot);
-        bool success = query.exec();
-
-        if (!success) {
-            LOG_FAILED_QUERY(query);
-        }
+        writer.executeStatement(
+                "UPDATE itunes_library SET location = replace( location, ?, ? )",
+                QVariantList{m_dbItunesRoot.replace(localhost_token(), ""),
+                        m_mixxxItunesRoot});
     }
 
     // Even if an error occurred, commit the transaction. The file may have been
     // half-parsed.
-    transaction.commit();
+    const bool committed = writer.finish();
 
     if (xml.hasError()) {
         // do error handling
@@ -445,21 +476,30 @@ TreeItem* ITunesFeature::importLibrary() {
             delete playlist_root;
         }
         playlist_root = NULL;
+    } else if (committed && !m_cancelImport) {
+        settings.setValue(ITDB_DIGEST_KEY, digest);
     }
     return playlist_root;
 }
 
-void ITunesFeature::parseTracks(QXmlStreamReader& xml) {
+TreeItem* ITunesFeature::loadPlaylists() {
+    // The playlists have been numbered in the order of their appearance
+    // in the iTunes library
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT name FROM itunes_playlists ORDER BY id")) {
+        LOG_FAILED_QUERY(query);
+        return NULL;
+    }
+    std::unique_ptr<TreeItem> pRootItem = TreeItem::newRoot(this);
+    while (query.next()) {
+        pRootItem->appendChild(query.value(0).toString());
+    }
+    return pRootItem.release();
+}
+
+void ITunesFeature::parseTracks(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter) {
     bool in_container_dictionary = false;
     bool in_track_dictionary = false;
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO itunes_library (id, artist, title, album, album_artist, year, genre, grouping, comment, tracknumber,"
-                  "bpm, bitrate,"
-                  "duration, location,"
-                  "rating ) "
-                  "VALUES (:id, :artist, :title, :album, :album_artist, :year, :genre, :grouping, :comment, :tracknumber,"
-                  ":bpm, :bitrate,"
-                  ":duration, :location," ":rating )");
 
     qDebug() << "Parse iTunes music collection";
 
@@ -476,7 +516,7 @@ void ITunesFeature::parseTracks(QXmlStreamReader& xml) {
                     // We are in a <dict> tag that holds track information
                     in_track_dictionary = true;
                     // Parse track here
-                    parseTrack(xml, query);
+                    parseTrack(xml, pWriter);
                 }
             }
         }
@@ -493,7 +533,7 @@ void ITunesFeature::parseTracks(QXmlStreamReader& xml) {
     }
 }
 
-void ITunesFeature::parseTrack(QXmlStreamReader& xml, QSqlQuery& query) {
+void ITunesFeature::parseTrack(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter) {
     //qDebug() << "----------------TRACK-----------------";
     int id = -1;
     QString title;
@@ -616,49 +656,37 @@ void ITunesFeature::parseTrack(QXmlStreamReader& xml, QSqlQuery& query) {
 
     // If we reach the end of <dict>
     // Save parsed track to database
-    query.bindValue(":id", id);
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":album_artist", album_artist);
-    query.bindValue(":genre", genre);
-    query.bindValue(":grouping", grouping);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-
-    if (!success) {
-        LOG_FAILED_QUERY(query);
-        return;
-    }
+    pWriter->insertRow(kLibraryTable,
+            QVariantList{id,
+                    artist,
+                    title,
+                    album,
+                    album_artist,
+                    year,
+                    genre,
+                    grouping,
+                    comment,
+                    tracknumber,
+                    bpm,
+                    bitrate,
+                    playtime,
+                    location,
+                    rating});
 }
 
-TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader& xml) {
+TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter) {
     qDebug() << "Parse iTunes playlists";
     std::unique_ptr<TreeItem> pRootItem = TreeItem::newRoot(this);
-    QSqlQuery query_insert_to_playlists(m_database);
-    query_insert_to_playlists.prepare("INSERT INTO itunes_playlists (id, name) "
-                                      "VALUES (:id, :name)");
-
-    QSqlQuery query_insert_to_playlist_tracks(m_database);
-    query_insert_to_playlist_tracks.prepare(
-        "INSERT INTO itunes_playlist_tracks (playlist_id, track_id, position) "
-        "VALUES (:playlist_id, :track_id, :position)");
+    // Names of all imported playlists for resolving duplicates
+    QSet<QString> playlistNames;
 
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
         //We process and iterate the <dict> tags holding playlist summary information here
         if (xml.isStartElement() && xml.name() == kDict) {
             parsePlaylist(xml,
-                          query_insert_to_playlists,
-                          query_insert_to_playlist_tracks,
+                          pWriter,
+                          &playlistNames,
                           pRootItem.get());
             continue;
         }
@@ -681,12 +709,13 @@ bool ITunesFeature::readNextStartElement(QXmlStreamReader& xml) {
     return false;
 }
 
-void ITunesFeature::parsePlaylist(QXmlStreamReader& xml, QSqlQuery& query_insert_to_playlists,
-                                  QSqlQuery& query_insert_to_playlist_tracks, TreeItem* root) {
+void ITunesFeature::parsePlaylist(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter,
+                                  QSet<QString>* pPlaylistNames, TreeItem* root) {
     //qDebug() << "Parse Playlist";
 
     QString playlistname;
     int playlist_id = -1;
+    int db_playlist_id = -1;
     int playlist_position = -1;
     int track_reference = -1;
     //indicates that we haven't found the <
@@ -732,28 +761,22 @@ void ITunesFeature::parsePlaylist(QXmlStreamReader& xml, QSqlQuery& query_insert
 
                     //if the playlist is prebuild don't hit the database
                     if (isSystemPlaylist) continue;
-                    query_insert_to_playlists.bindValue(":id", playlist_id);
-                    query_insert_to_playlists.bindValue(":name", playlistname);
-
-                    bool success = query_insert_to_playlists.exec();
-                    if (!success) {
-                        if (query_insert_to_playlists.lastError().nativeErrorCode() == QString::number(SQLITE_CONSTRAINT)) {
-                            // We assume a duplicate Playlist name
-                            playlistname += QString(" #%1").arg(playlist_id);
-                            query_insert_to_playlists.bindValue(":name", playlistname );
-
-                            bool success = query_insert_to_playlists.exec();
-                            if (!success) {
-                                // unexpected error
-                                LOG_FAILED_QUERY(query_insert_to_playlists);
-                                break;
-                            }
-                        } else {
-                            // unexpected error
-                            LOG_FAILED_QUERY(query_insert_to_playlists);
-                            return;
+                    if (pPlaylistNames->contains(playlistname)) {
+                        // Playlist names must be unique
+                        playlistname += QString(" #%1").arg(playlist_id);
+                        if (pPlaylistNames->contains(playlistname)) {
+                            qDebug() << "Skipping duplicate iTunes playlist" << playlistname;
+                            // Skip the entries like those of a system playlist
+                            isSystemPlaylist = true;
+                            continue;
                         }
                     }
+                    pPlaylistNames->insert(playlistname);
+                    // Number the playlists in the order of their appearance
+                    // to restore the sidebar from the database, see loadPlaylists()
+                    db_playlist_id = pPlaylistNames->size();
+                    pWriter->insertRow(kPlaylistsTable,
+                            QVariantList{db_playlist_id, playlistname});
                     //append the playlist to the child model
                     root->appendChild(playlistname);
                 }
@@ -764,18 +787,14 @@ void ITunesFeature::parsePlaylist(QXmlStreamReader& xml, QSqlQuery& query_insert
                     readNextStartElement(xml);
                     track_reference = xml.readElementText().toInt();
 
-                    query_insert_to_playlist_tracks.bindValue(":playlist_id", playlist_id);
-                    query_insert_to_playlist_tracks.bindValue(":track_id", track_reference);
-                    query_insert_to_playlist_tracks.bindValue(":position", playlist_position++);
-
                     //Insert tracks if we are not in a pre-build playlist
-                    if (!isSystemPlaylist && !query_insert_to_playlist_tracks.exec()) {
-                        qDebug() << "SQL Error in ITunesFeature.cpp: line" << __LINE__ << " "
-                                 << query_insert_to_playlist_tracks.lastError();
-                        qDebug() << "trackid" << track_reference;
-                        qDebug() << "playlistname; " << playlistname;
-                        qDebug() << "-----------------";
+                    if (!isSystemPlaylist) {
+                        pWriter->insertRow(kPlaylistTracksTable,
+                                QVariantList{db_playlist_id,
+                                        track_reference,
+                                        playlist_position});
                     }
+                    ++playlist_position;
                 }
             }
         }
@@ -792,20 +811,6 @@ void ITunesFeature::parsePlaylist(QXmlStreamReader& xml, QSqlQuery& query_insert
     }
 }
 
-void ITunesFeature::clearTable(QString table_name) {
-    QSqlQuery query(m_database);
-    query.prepare("delete from "+table_name);
-    bool success = query.exec();
-
-    if (!success) {
-        qDebug() << "Could not delete remove old entries from table "
-                 << table_name << " : " << query.lastError();
-    } else {
-        qDebug() << "iTunes table entries of '"
-                 << table_name <<"' have been cleared.";
-    }
-}
-
 void ITunesFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_future.result());
     if (root) {
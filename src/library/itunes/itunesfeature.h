@@ -17,6 +17,7 @@
 #include "library/treeitem.h"
 
 class BaseExternalTrackModel;
+class ExternalLibraryTableWriter;
 class BaseExternalPlaylistModel;
 class WLibrarySidebar;
 
@@ -45,13 +46,14 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     static QString getiTunesMusicPath();
     // returns the invisible rootItem for the sidebar model
     TreeItem* importLibrary();
+    // returns the rootItem for the playlists of a previous import
+    TreeItem* loadPlaylists();
     void guessMusicLibraryMountpoint(QXmlStreamReader& xml);
-    void parseTracks(QXmlStreamReader& xml);
-    void parseTrack(QXmlStreamReader& xml, QSqlQuery& query);
-    TreeItem* parsePlaylists(QXmlStreamReader &xml);
-    void parsePlaylist(QXmlStreamReader& xml, QSqlQuery& query1,
-                       QSqlQuery &query2, TreeItem*);
-    void clearTable(QString table_name);
+    void parseTracks(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter);
+    void parseTrack(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter);
+    TreeItem* parsePlaylists(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter);
+    void parsePlaylist(QXmlStreamReader& xml, ExternalLibraryTableWriter* pWriter,
+                       QSet<QString>* pPlaylistNames, TreeItem*);
     bool readNextStartElement(QXmlStreamReader& xml);
 
     BaseExternalTrackModel* m_pITunesTrackModel;
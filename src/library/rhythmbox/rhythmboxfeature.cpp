@@ -7,11 +7,63 @@
 
 #include "library/baseexternaltrackmodel.h"
 #include "library/baseexternalplaylistmodel.h"
+#include "library/dao/settingsdao.h"
+#include "library/externallibrarytablewriter.h"
 #include "library/library.h"
 #include "library/trackcollection.h"
 #include "library/trackcollectionmanager.h"
 #include "library/treeitem.h"
 #include "library/queryutil.h"
+#include "util/assert.h"
+
+namespace {
+
+// Digest of the last Rhythmbox database that has been imported completely
+const QString kImportDigestKey = "mixxx.rhythmboxfeature.importdigest";
+
+// The indices of the tables registered by addImportTables()
+enum ImportTable {
+    kPlaylistTracksTable = 0,
+    kLibraryTable = 1,
+    kPlaylistsTable = 2,
+};
+
+void addImportTables(ExternalLibraryTableWriter* pWriter) {
+    int tableIndex = pWriter->addTable("rhythmbox_playlist_tracks",
+            QStringList{"playlist_id", "track_id", "position"});
+    DEBUG_ASSERT(tableIndex == kPlaylistTracksTable);
+    tableIndex = pWriter->addTable("rhythmbox_library",
+            QStringList{"id",
+                    "artist",
+                    "title",
+                    "album",
+                    "year",
+                    "genre",
+                    "comment",
+                    "tracknumber",
+                    "bpm",
+                    "bitrate",
+                    "duration",
+                    "location",
+                    "rating"});
+    DEBUG_ASSERT(tableIndex == kLibraryTable);
+    tableIndex = pWriter->addTable("rhythmbox_playlists",
+            QStringList{"id", "name"});
+    DEBUG_ASSERT(tableIndex == kPlaylistsTable);
+}
+
+QString playlistsFilePath() {
+    QString path = QDir::homePath() + "/.gnome2/rhythmbox/playlists.xml";
+    if (!QFile::exists(path)) {
+        path = QDir::homePath() + "/.local/share/rhythmbox/playlists.xml";
+        if (!QFile::exists(path)) {
+            return QString();
+        }
+    }
+    return path;
+}
+
+} // anonymous namespace
 
 RhythmboxFeature::RhythmboxFeature(Library* pLibrary, UserSettingsPointer pConfig)
         : BaseExternalLibraryFeature(pLibrary, pConfig),
@@ -152,21 +204,23 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
         return NULL;
 
-    //Delete all table entries of Traktor feature
-    ScopedTransaction transaction(m_database);
-    clearTable("rhythmbox_playlist_tracks");
-    clearTable("rhythmbox_library");
-    clearTable("rhythmbox_playlists");
-    transaction.commit();
-
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO rhythmbox_library (artist, title, album, year, "
-                  "genre, comment, tracknumber, bpm, bitrate,"
-                  "duration, location, rating ) "
-                  "VALUES (:artist, :title, :album, :year, :genre, :comment, "
-                  ":tracknumber, :bpm, :bitrate, :duration, :location, :rating )");
+    SettingsDAO settings(m_database);
+    const QString digest = ExternalLibraryTableWriter::digestSourceFiles(
+            QStringList{db.fileName(), playlistsFilePath()});
+    if (settings.getValue(kImportDigestKey) == digest) {
+        qDebug() << "Rhythmbox music collection is unchanged, skipping import";
+        return loadPlaylists();
+    }
+    // Invalidate the digest until the new import has been committed
+    settings.setValue(kImportDigestKey, QString());
 
+    // The tables are cleared and written by a separate thread while parsing
+    ExternalLibraryTableWriter writer(m_database, "RHYTHMBOX_WRITER");
+    addImportTables(&writer);
+    writer.start(QThread::LowPriority);
+    // Playlist entries refer to the tracks of the collection by location
+    QHash<QString, int> trackIdsByLocation;
+    int nTracks = 0;
 
     QXmlStreamReader xml(&db);
     while (!xml.atEnd() && !m_cancelImport) {
@@ -175,13 +229,13 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
             QXmlStreamAttributes attr = xml.attributes();
             //Check if we really parse a track and not album art information
             if (attr.value("type").toString() == "song") {
-                importTrack(xml, query);
+                importTrack(xml, ++nTracks, &writer, &trackIdsByLocation);
             }
         }
     }
-    transaction.commit();
 
     if (xml.hasError()) {
+        writer.finish();
         // do error handling
         qDebug() << "Cannot process Rhythmbox music collection";
         qDebug() << "XML ERROR: " << xml.errorString();
@@ -190,33 +244,47 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
 
     db.close();
     if (m_cancelImport) {
+        writer.finish();
         return NULL;
     }
-    return importPlaylists();
+    std::unique_ptr<TreeItem> rootItem(
+            importPlaylists(&writer, trackIdsByLocation));
+    if (writer.finish() && rootItem && !m_cancelImport) {
+        settings.setValue(kImportDigestKey, digest);
+    }
+    return rootItem.release();
 }
 
-TreeItem* RhythmboxFeature::importPlaylists() {
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/playlists.xml");
-    if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/playlists.xml");
-        if (!db.exists()) {
-            return NULL;
-        }
+TreeItem* RhythmboxFeature::loadPlaylists() {
+    // The playlists have been numbered in the order of their appearance
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT name FROM rhythmbox_playlists ORDER BY id")) {
+        LOG_FAILED_QUERY(query);
+        return nullptr;
+    }
+    std::unique_ptr<TreeItem> rootItem = TreeItem::newRoot(this);
+    while (query.next()) {
+        rootItem->appendChild(query.value(0).toString());
+    }
+    return rootItem.release();
+}
+
+TreeItem* RhythmboxFeature::importPlaylists(
+        ExternalLibraryTableWriter* pWriter,
+        const QHash<QString, int>& trackIdsByLocation) {
+    QFile db(playlistsFilePath());
+    if (db.fileName().isEmpty()) {
+        return NULL;
     }
     //Open file
      if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
         return NULL;
 
-    QSqlQuery query_insert_to_playlists(m_database);
-    query_insert_to_playlists.prepare("INSERT INTO rhythmbox_playlists (id, name) "
-                                      "VALUES (:id, :name)");
-
-    QSqlQuery query_insert_to_playlist_tracks(m_database);
-    query_insert_to_playlist_tracks.prepare(
-            "INSERT INTO rhythmbox_playlist_tracks (playlist_id, track_id, position) "
-            "VALUES (:playlist_id, :track_id, :position)");
     //The tree structure holding the playlists
     std::unique_ptr<TreeItem> rootItem = TreeItem::newRoot(this);
+    // Names of all imported playlists, which are numbered in the order
+    // of their appearance to restore the sidebar from the database
+    QSet<QString> playlistNames;
 
     QXmlStreamReader xml(&db);
     while (!xml.atEnd() && !m_cancelImport) {
@@ -231,20 +299,18 @@ TreeItem* RhythmboxFeature::importPlaylists() {
                 //Construct the childmodel
                 rootItem->appendChild(playlist_name);
 
-                //Execute SQL statement
-                query_insert_to_playlists.bindValue(":name", playlist_name);
-
-                if (!query_insert_to_playlists.exec()) {
-                    LOG_FAILED_QUERY(query_insert_to_playlists)
-                            << "Couldn't insert playlist:" << playlist_name;
+                // Playlist names must be unique
+                if (playlistNames.contains(playlist_name)) {
+                    qDebug() << "Couldn't insert duplicate playlist:" << playlist_name;
                     continue;
                 }
-
-                // get playlist_id
-                int playlist_id = query_insert_to_playlists.lastInsertId().toInt();
+                playlistNames.insert(playlist_name);
+                const int playlist_id = playlistNames.size();
+                pWriter->insertRow(kPlaylistsTable,
+                        QVariantList{playlist_id, playlist_name});
 
                 //Process playlist entries
-                importPlaylist(xml, query_insert_to_playlist_tracks, playlist_id);
+                importPlaylist(xml, playlist_id, pWriter, trackIdsByLocation);
             }
         }
     }
@@ -260,7 +326,9 @@ TreeItem* RhythmboxFeature::importPlaylists() {
     return rootItem.release();
 }
 
-void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+void RhythmboxFeature::importTrack(QXmlStreamReader &xml, int track_id,
+        ExternalLibraryTableWriter* pWriter,
+        QHash<QString, int>* pTrackIdsByLocation) {
     QString title;
     QString artist;
     QString album;
@@ -336,32 +404,31 @@ void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
         return;
     }
 
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-
-    if (!success) {
-        qDebug() << "SQL Error in rhythmboxfeature.cpp: line" << __LINE__
-                 << " " << query.lastError();
-        return;
+    pWriter->insertRow(kLibraryTable,
+            QVariantList{track_id,
+                    artist,
+                    title,
+                    album,
+                    year,
+                    genre,
+                    comment,
+                    tracknumber,
+                    bpm,
+                    bitrate,
+                    playtime,
+                    location,
+                    rating});
+    // Locations are unique, i.e. only the first entry will be inserted
+    if (!pTrackIdsByLocation->contains(location)) {
+        pTrackIdsByLocation->insert(location, track_id);
     }
 }
 
-// reads all playlist entries and executes a SQL statement
+// reads all playlist entries and queues them for insertion
 void RhythmboxFeature::importPlaylist(QXmlStreamReader &xml,
-                                      QSqlQuery &query_insert_to_playlist_tracks,
-                                      int playlist_id) {
+                                      int playlist_id,
+                                      ExternalLibraryTableWriter* pWriter,
+                                      const QHash<QString, int>& trackIdsByLocation) {
     int playlist_position = 1;
     while (!xml.atEnd()) {
         //read next XML element
@@ -370,34 +437,9 @@ void RhythmboxFeature::importPlaylist(QXmlStreamReader &xml,
             const auto trackFile = TrackFile::fromUrl(xml.readElementText());
 
             //get the ID of the file in the rhythmbox_library table
-            int track_id = -1;
-            QSqlQuery finder_query(m_database);
-            finder_query.prepare("select id from rhythmbox_library where location=:path");
-            finder_query.bindValue(":path", trackFile.location());
-            bool success = finder_query.exec();
-
-            if (success) {
-                const int idColumn = finder_query.record().indexOf("id");
-                while (finder_query.next()) {
-                    track_id = finder_query.value(idColumn).toInt();
-                }
-             } else {
-                qDebug() << "SQL Error in RhythmboxFeature.cpp: line"
-                         << __LINE__ << " " << finder_query.lastError();
-            }
-
-            query_insert_to_playlist_tracks.bindValue(":playlist_id", playlist_id);
-            query_insert_to_playlist_tracks.bindValue(":track_id", track_id);
-            query_insert_to_playlist_tracks.bindValue(":position", playlist_position++);
-            success = query_insert_to_playlist_tracks.exec();
-
-            if (!success) {
-                qDebug() << "SQL Error in RhythmboxFeature.cpp: line" << __LINE__ << " "
-                         << query_insert_to_playlist_tracks.lastError()
-                         << "trackid" << track_id
-                         << "playlis ID " << playlist_id
-                         << "-----------------";
-            }
+            const int track_id = trackIdsByLocation.value(trackFile.location(), -1);
+            pWriter->insertRow(kPlaylistTracksTable,
+                    QVariantList{playlist_id, track_id, playlist_position++});
         }
         // Exit the the loop if we reach the closing <playlist> tag
         if (xml.isEndElement() && xml.name() == "playlist") {
@@ -406,21 +448,6 @@ void RhythmboxFeature::importPlaylist(QXmlStreamReader &xml,
     }
 }
 
-void RhythmboxFeature::clearTable(QString table_name) {
-    qDebug() << "clearTable Thread Id: " << QThread::currentThread();
-    QSqlQuery query(m_database);
-    query.prepare("delete from "+table_name);
-    bool success = query.exec();
-
-    if (!success) {
-        qDebug() << "Could not delete remove old entries from table "
-                 << table_name << " : " << query.lastError();
-    } else {
-        qDebug() << "Rhythmbox table entries of '" << table_name
-                 << "' have been cleared.";
-    }
-}
-
 void RhythmboxFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_track_future.result());
     if (root) {
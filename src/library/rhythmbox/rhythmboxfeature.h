@@ -17,6 +17,7 @@
 
 class BaseExternalTrackModel;
 class BaseExternalPlaylistModel;
+class ExternalLibraryTableWriter;
 
 class RhythmboxFeature : public BaseExternalLibraryFeature {
     Q_OBJECT
@@ -32,7 +33,10 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     // processes the music collection
     TreeItem* importMusicCollection();
     // processes the playlist entries
-    TreeItem* importPlaylists();
+    TreeItem* importPlaylists(ExternalLibraryTableWriter* pWriter,
+            const QHash<QString, int>& trackIdsByLocation);
+    // restores the playlists of a previous import
+    TreeItem* loadPlaylists();
 
   public slots:
     void activate();
@@ -41,12 +45,14 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
 
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
-    // Removes all rows from a given table
-    void clearTable(QString table_name);
-    // reads the properties of a track and executes a SQL statement
-    void importTrack(QXmlStreamReader &xml, QSqlQuery &query);
-    // reads all playlist entries and executes a SQL statement
-    void importPlaylist(QXmlStreamReader &xml, QSqlQuery &query, int playlist_id);
+    // reads the properties of a track and queues it for insertion
+    void importTrack(QXmlStreamReader &xml, int track_id,
+            ExternalLibraryTableWriter* pWriter,
+            QHash<QString, int>* pTrackIdsByLocation);
+    // reads all playlist entries and queues them for insertion
+    void importPlaylist(QXmlStreamReader &xml, int playlist_id,
+            ExternalLibraryTableWriter* pWriter,
+            const QHash<QString, int>& trackIdsByLocation);
 
     BaseExternalTrackModel* m_pRhythmboxTrackModel;
     BaseExternalPlaylistModel* m_pRhythmboxPlaylistModel;
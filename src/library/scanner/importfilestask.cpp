@@ -1,9 +1,21 @@
 #include "library/scanner/importfilestask.h"
 
 #include "library/scanner/libraryscanner.h"
-#include "track/trackfile.h"
+#include "sources/soundsourceproxy.h"
+#include "track/globaltrackcache.h"
+#include "track/track.h"
+#include "util/performancetimer.h"
 #include "util/timer.h"
 
+namespace {
+
+// The number of parsed tracks that are handed over to the
+// database writer at once. Directories with less files are
+// handed over as a whole.
+constexpr int kPreparsedTracksBatchSize = 64;
+
+} // anonymous namespace
+
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
         const ScannerGlobalPointer scannerGlobal,
         const QString& dirPath,
@@ -21,8 +33,33 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
           m_pToken(pToken) {
 }
 
+//static
+TrackPointer ImportFilesTask::preparseTrack(
+        TrackFile trackFile,
+        SecurityTokenPointer pToken) {
+    ScopedTimer timer("ImportFilesTask::preparseTrack");
+    if (!SoundSourceProxy::isFileSupported(trackFile)) {
+        return TrackPointer();
+    }
+    {
+        // A cached track object might export its metadata into this
+        // file while we are reading it. Only the lookup needs to be
+        // guarded, parsing is done without locking the cache.
+        const auto trackRef = TrackRef::fromFileInfo(trackFile);
+        if (GlobalTrackCache::lookupTrackByRef(trackRef)) {
+            return TrackPointer();
+        }
+    }
+    TrackPointer pTrack = Track::newTemporary(
+            std::move(trackFile),
+            std::move(pToken));
+    SoundSourceProxy(pTrack).updateTrackFromSource();
+    return pTrack;
+}
+
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
+    TrackPointerList preparsedTracks;
     for (const QFileInfo& fileInfo: m_filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
@@ -30,8 +67,10 @@ void ImportFilesTask::run() {
             return;
         }
 
-        const QString trackLocation(TrackFile(fileInfo).location());
+        const TrackFile trackFile(fileInfo);
+        const QString trackLocation(trackFile.location());
         //qDebug() << "ImportFilesTask::run" << trackLocation;
+        m_scannerGlobal->fileExamined();
 
         // If the file does not exist in the database then add it. If it
         // does then it is either in the user's library OR the user has
@@ -50,9 +89,25 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit addNewTrack(trackLocation);
+            PerformanceTimer parseTimer;
+            parseTimer.start();
+            TrackPointer pTrack = preparseTrack(trackFile, m_pToken);
+            if (!pTrack) {
+                // Fallback: Parse and add the file on the scanner thread
+                emit addNewTrack(trackLocation);
+                continue;
+            }
+            m_scannerGlobal->fileParsed(parseTimer.elapsed());
+            preparsedTracks.append(std::move(pTrack));
+            if (preparsedTracks.size() >= kPreparsedTracksBatchSize) {
+                emit addPreparsedTracks(preparsedTracks);
+                preparsedTracks.clear();
+            }
         }
     }
+    if (!preparsedTracks.isEmpty()) {
+        emit addPreparsedTracks(preparsedTracks);
+    }
     // Insert or update the hash in the database.
     emit directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash);
     setSuccess(true);
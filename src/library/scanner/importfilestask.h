@@ -2,11 +2,17 @@
 
 #include <QFileInfo>
 
-#include "util/sandbox.h"
 #include "library/scanner/scannertask.h"
+#include "track/track_decl.h"
+#include "track/trackfile.h"
+#include "util/sandbox.h"
 
 /// Import the provided files. Successful if the scan completed without being
 /// cancelled. False if the scan was cancelled part-way through.
+///
+/// New files are parsed concurrently by the worker threads and handed
+/// over in batches to the LibraryScanner thread that finally writes
+/// them into the database.
 class ImportFilesTask : public ScannerTask {
     Q_OBJECT
   public:
@@ -22,6 +28,17 @@ class ImportFilesTask : public ScannerTask {
 
     virtual void run();
 
+    /// Parses the metadata and cover art of a file that is not yet
+    /// stored in the library into a temporary track object.
+    ///
+    /// Returns a null pointer if the file is not supported or if it
+    /// is currently referenced by a cached track object. Those files
+    /// must be imported while the GlobalTrackCache is locked to prevent
+    /// reading a file while its metadata is exported.
+    static TrackPointer preparseTrack(
+            TrackFile trackFile,
+            SecurityTokenPointer pToken);
+
   private:
     const QString m_dirPath;
     const bool m_prevHashExists;
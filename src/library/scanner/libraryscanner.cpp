@@ -13,14 +13,24 @@
 #include "util/db/fwdsqlquery.h"
 #include "util/file.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
 namespace {
 
-// TODO(rryan) make configurable
-const int kScannerThreadPoolSize = 1;
+const ConfigKey kScannerThreadPoolSizeConfigKey =
+        ConfigKey("[Library]", "ScannerThreadPoolSize");
+
+// Reading directories and parsing file tags is mostly I/O bound,
+// especially for libraries on network storage. Use one worker per
+// core by default.
+int scannerThreadPoolSize(const UserSettingsPointer& pConfig) {
+    const int defaultSize = math_max(1, QThread::idealThreadCount());
+    return math_max(1,
+            pConfig->getValue(kScannerThreadPoolSizeConfigKey, defaultSize));
+}
 
 mixxx::Logger kLogger("LibraryScanner");
 
@@ -37,6 +47,21 @@ int execCleanupQuery(FwdSqlQuery& query) {
     return query.numRowsAffected();
 }
 
+void logStageThroughput(
+        const char* stage,
+        int numFiles,
+        mixxx::Duration elapsed) {
+    const double seconds = elapsed.toDoubleSeconds();
+    kLogger.info()
+            << stage
+            << numFiles
+            << "files in"
+            << elapsed.debugMillisWithUnit()
+            << "=>"
+            << (seconds > 0 ? numFiles / seconds : 0.0)
+            << "files/s";
+}
+
 } // anonymous namespace
 
 LibraryScanner::LibraryScanner(
@@ -57,7 +82,11 @@ LibraryScanner::LibraryScanner(
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_pool.setMaxThreadCount(scannerThreadPoolSize(pConfig));
+    kLogger.info()
+            << "Using"
+            << m_pool.maxThreadCount()
+            << "worker thread(s)";
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
@@ -388,6 +417,23 @@ void LibraryScanner::slotFinishUnhashedScan() {
         kLogger.debug() << "Scan cancelled";
     }
 
+    // Throughput of the import pipeline stages. All examined files,
+    // not only the new ones, are related to the total scan time.
+    // Parsing is done concurrently, i.e. the accumulated parse time
+    // might exceed the total scan time.
+    logStageThroughput(
+            "Examine:",
+            m_scannerGlobal->numExaminedFiles(),
+            m_scannerGlobal->timerElapsed());
+    logStageThroughput(
+            "Parse (accumulated):",
+            m_scannerGlobal->numParsedFiles(),
+            m_scannerGlobal->parseDuration());
+    logStageThroughput(
+            "Write:",
+            m_scannerGlobal->numWrittenTracks(),
+            m_scannerGlobal->writeDuration());
+
     // TODO(XXX) doesn't take into account verifyRemainingTracks.
     qDebug("Scan took: %s. "
            "%d unchanged directories. "
@@ -480,6 +526,10 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
             &ScannerTask::addNewTrack,
             this,
             &LibraryScanner::slotAddNewTrack);
+    connect(pTask,
+            &ScannerTask::addPreparsedTracks,
+            this,
+            &LibraryScanner::slotAddPreparsedTracks);
 
     // Progress signals.
     // Pass directly to the main thread
@@ -535,8 +585,38 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
 void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
     //kLogger.debug() << "slotAddNewTrack" << trackPath;
     ScopedTimer timer("LibraryScanner::addNewTrack");
+    PerformanceTimer writeTimer;
+    writeTimer.start();
     // For statistics tracking and to detect moved tracks
     TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false));
+    if (m_scannerGlobal) {
+        m_scannerGlobal->tracksWritten(1, writeTimer.elapsed());
+    }
+    afterTrackAdded(trackPath, pTrack);
+}
+
+void LibraryScanner::slotAddPreparsedTracks(
+        const TrackPointerList& preparsedTracks) {
+    ScopedTimer timer("LibraryScanner::addPreparsedTracks");
+    PerformanceTimer writeTimer;
+    writeTimer.start();
+    for (const auto& pPreparsedTrack : preparsedTracks) {
+        if (m_scannerGlobal && m_scannerGlobal->shouldCancel()) {
+            return;
+        }
+        TrackPointer pTrack(
+                m_trackDao.addTracksAddPreparsedTrack(pPreparsedTrack, false));
+        afterTrackAdded(pPreparsedTrack->getLocation(), pTrack);
+    }
+    if (m_scannerGlobal) {
+        m_scannerGlobal->tracksWritten(
+                preparsedTracks.size(), writeTimer.elapsed());
+    }
+}
+
+void LibraryScanner::afterTrackAdded(
+        const QString& trackPath,
+        const TrackPointer& pTrack) {
     if (pTrack) {
         DEBUG_ASSERT(!pTrack->isDirty());
         // The track's actual location might differ from the
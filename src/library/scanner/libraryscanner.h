@@ -72,6 +72,7 @@ class LibraryScanner : public QThread {
     void slotDirectoryUnchanged(const QString& directoryPath);
     void slotTrackExists(const QString& trackPath);
     void slotAddNewTrack(const QString& trackPath);
+    void slotAddPreparsedTracks(const TrackPointerList& preparsedTracks);
 
   private:
     enum ScannerState {
@@ -97,6 +98,12 @@ class LibraryScanner : public QThread {
 
     void cleanUpScan();
 
+    // Acknowledges the result of adding a single track and notifies
+    // the main thread.
+    void afterTrackAdded(
+            const QString& trackPath,
+            const TrackPointer& pTrack);
+
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
 
     // The pool of threads used for worker tasks.
@@ -9,8 +9,10 @@
 #include <QSet>
 #include <QSharedPointer>
 #include <QStringList>
+#include <atomic>
 
 #include "util/cache.h"
+#include "util/duration.h"
 #include "util/performancetimer.h"
 #include "util/sandbox.h"
 #include "util/task.h"
@@ -175,6 +177,38 @@ class ScannerGlobal {
         m_numScannedDirectories++;
     }
 
+    // Per-stage throughput counters. Files are examined and parsed
+    // concurrently by the worker tasks and written only by the
+    // LibraryScanner thread. Examined files include those that are
+    // already in the database.
+    int numExaminedFiles() const {
+        return m_numExaminedFiles.load();
+    }
+    void fileExamined() {
+        m_numExaminedFiles.fetch_add(1);
+    }
+
+    int numParsedFiles() const {
+        return m_numParsedFiles.load();
+    }
+    mixxx::Duration parseDuration() const {
+        return mixxx::Duration::fromNanos(m_parseNanos.load());
+    }
+    void fileParsed(mixxx::Duration elapsed) {
+        m_numParsedFiles.fetch_add(1);
+        m_parseNanos.fetch_add(elapsed.toIntegerNanos());
+    }
+
+    int numWrittenTracks() const {
+        return m_numWrittenTracks;
+    }
+    mixxx::Duration writeDuration() const {
+        return m_writeDuration;
+    }
+    void tracksWritten(int numTracks, mixxx::Duration elapsed) {
+        m_numWrittenTracks += numTracks;
+        m_writeDuration += elapsed;
+    }
 
   private:
     TaskWatcher m_watcher;
@@ -220,6 +254,11 @@ class ScannerGlobal {
     // Stats tracking.
     PerformanceTimer m_timer;
     int m_numScannedDirectories;
+    std::atomic<int> m_numExaminedFiles{0};
+    std::atomic<int> m_numParsedFiles{0};
+    std::atomic<qint64> m_parseNanos{0};
+    int m_numWrittenTracks{0};
+    mixxx::Duration m_writeDuration;
 };
 
 typedef QSharedPointer<ScannerGlobal> ScannerGlobalPointer;
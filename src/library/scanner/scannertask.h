@@ -5,6 +5,7 @@
 #include <QRunnable>
 
 #include "library/scanner/scannerglobal.h"
+#include "track/track_decl.h"
 
 class LibraryScanner;
 
@@ -25,6 +26,9 @@ class ScannerTask : public QObject, public QRunnable {
     void directoryUnchanged(const QString& directoryPath);
     void trackExists(const QString& filePath);
     void addNewTrack(const QString& filePath);
+    // Tracks that have already been parsed by the task and
+    // only need to be written into the database.
+    void addPreparsedTracks(const TrackPointerList& preparsedTracks);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
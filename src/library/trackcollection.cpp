@@ -533,6 +533,13 @@ TrackPointer TrackCollection::getTrackById(
     return m_trackDao.getTrackById(trackId);
 }
 
+QList<TrackPointer> TrackCollection::getTracksByIds(
+        const QList<TrackId>& trackIds) const {
+    DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
+
+    return m_trackDao.getTracksByIds(trackIds);
+}
+
 TrackPointer TrackCollection::getTrackByRef(
         const TrackRef& trackRef) const {
     DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
@@ -92,6 +92,8 @@ class TrackCollection : public QObject,
 
     TrackPointer getTrackById(
             TrackId trackId) const;
+    QList<TrackPointer> getTracksByIds(
+            const QList<TrackId>& trackIds) const;
 
     TrackPointer getTrackByRef(
             const TrackRef& trackRef) const;
@@ -10,6 +10,8 @@
 
 #include "library/traktor/traktorfeature.h"
 
+#include "library/dao/settingsdao.h"
+#include "library/externallibrarytablewriter.h"
 #include "library/librarytablemodel.h"
 #include "library/missingtablemodel.h"
 #include "library/queryutil.h"
@@ -17,10 +19,48 @@
 #include "library/trackcollection.h"
 #include "library/trackcollectionmanager.h"
 #include "library/treeitem.h"
+#include "util/assert.h"
 #include "util/sandbox.h"
 
 namespace {
 
+// Digest of the last Traktor collection that has been imported completely
+const QString kCollectionDigestKey = "mixxx.traktorfeature.collectiondigest";
+
+const QString kPlaylistPathDelimiter = "-->";
+
+// The indices of the tables registered by addImportTables()
+enum ImportTable {
+    kPlaylistTracksTable = 0,
+    kLibraryTable = 1,
+    kPlaylistsTable = 2,
+};
+
+void addImportTables(ExternalLibraryTableWriter* pWriter) {
+    int tableIndex = pWriter->addTable("traktor_playlist_tracks",
+            QStringList{"playlist_id", "track_id", "position"});
+    DEBUG_ASSERT(tableIndex == kPlaylistTracksTable);
+    tableIndex = pWriter->addTable("traktor_library",
+            QStringList{"id",
+                    "artist",
+                    "title",
+                    "album",
+                    "year",
+                    "genre",
+                    "comment",
+                    "tracknumber",
+                    "bpm",
+                    "bitrate",
+                    "duration",
+                    "location",
+                    "rating",
+                    "key"});
+    DEBUG_ASSERT(tableIndex == kLibraryTable);
+    tableIndex = pWriter->addTable("traktor_playlists",
+            QStringList{"id", "name"});
+    DEBUG_ASSERT(tableIndex == kPlaylistsTable);
+}
+
 QString fromTraktorSeparators(QString path) {
     // Traktor uses /: instead of just / as delimiting character for some reasons
     return path.replace("/:", "/");
@@ -188,20 +228,16 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     thisThread->setPriority(QThread::LowPriority);
     //Invisible root item of Traktor's child model
     TreeItem* root = NULL;
-    //Delete all table entries of Traktor feature
-    ScopedTransaction transaction(m_database);
-    clearTable("traktor_playlist_tracks");
-    clearTable("traktor_library");
-    clearTable("traktor_playlists");
-    transaction.commit();
-
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO traktor_library (artist, title, album, year,"
-                  "genre,comment,tracknumber,bpm, bitrate,duration, location,"
-                  "rating,key) VALUES (:artist, :title, :album, :year,:genre,"
-                  ":comment, :tracknumber,:bpm, :bitrate,:duration, :location,"
-                  ":rating,:key)");
+
+    SettingsDAO settings(m_database);
+    const QString digest =
+            ExternalLibraryTableWriter::digestSourceFiles(QStringList{file});
+    if (settings.getValue(kCollectionDigestKey) == digest) {
+        qDebug() << "Traktor music collection is unchanged, skipping import";
+        return loadPlaylists();
+    }
+    // Invalidate the digest until the new import has been committed
+    settings.setValue(kCollectionDigestKey, QString());
 
     //Parse Trakor XML file using SAX (for performance)
     QFile traktor_file(file);
@@ -209,6 +245,14 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
         qDebug() << "Cannot open Traktor music collection";
         return NULL;
     }
+
+    // The tables are cleared and written by a separate thread while parsing
+    ExternalLibraryTableWriter writer(m_database, "TRAKTOR_WRITER");
+    addImportTables(&writer);
+    writer.start(QThread::LowPriority);
+    // Playlist entries refer to the tracks of the collection by location
+    QHash<QString, int> trackIdsByLocation;
+
     QXmlStreamReader xml(&traktor_file);
     bool inCollectionTag = false;
     bool inPlaylistsTag = false;
@@ -223,9 +267,10 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
             }
             // Each "ENTRY" tag in <COLLECTION> represents a track
             if (inCollectionTag && xml.name() == "ENTRY") {
+                //increment number of files in the music collection
+                ++nAudioFiles;
                 //parse track
-                parseTrack(xml, query);
-                ++nAudioFiles; //increment number of files in the music collection
+                parseTrack(xml, nAudioFiles, &writer, &trackIdsByLocation);
             }
             if (xml.name() == "PLAYLISTS") {
                 inPlaylistsTag = true;
@@ -236,7 +281,7 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
 
                 if (nodetype == "FOLDER" && name == "$ROOT") {
                     //process all playlists
-                    root = parsePlaylists(xml);
+                    root = parsePlaylists(xml, &writer, trackIdsByLocation);
                     isRootFolderParsed = true;
                 }
             }
@@ -250,6 +295,10 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
             }
         }
     }
+    // Even if an error occurred, commit the transaction. The file may have been
+    // half-parsed.
+    const bool committed = writer.finish();
+
     if (xml.hasError()) {
          // do error handling
          qDebug() << "Cannot process Traktor music collection";
@@ -259,13 +308,58 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     }
 
     qDebug() << "Found: " << nAudioFiles << " audio files in Traktor";
-    //initialize TraktorTableModel
-    transaction.commit();
+    if (committed && !m_cancelImport) {
+        settings.setValue(kCollectionDigestKey, digest);
+    }
 
     return root;
 }
 
-void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+TreeItem* TraktorFeature::loadPlaylists() {
+    // The playlists and folders have been numbered in the order of their
+    // appearance in the collection and are named by their path. The path
+    // of a folder ends with a delimiter.
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT name FROM traktor_playlists ORDER BY id")) {
+        LOG_FAILED_QUERY(query);
+        return NULL;
+    }
+    std::unique_ptr<TreeItem> rootItem = TreeItem::newRoot(this);
+    QHash<QString, TreeItem*> folders;
+    while (query.next()) {
+        const QString playlist_path = query.value(0).toString();
+        const QStringList names = playlist_path.split(kPlaylistPathDelimiter,
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+                Qt::SkipEmptyParts);
+#else
+                QString::SkipEmptyParts);
+#endif
+        if (names.isEmpty()) {
+            continue;
+        }
+        const bool isFolder = playlist_path.endsWith(kPlaylistPathDelimiter);
+        TreeItem* parent = rootItem.get();
+        QString current_path;
+        for (int i = 0; i < (isFolder ? names.size() : names.size() - 1); ++i) {
+            current_path += kPlaylistPathDelimiter;
+            current_path += names.at(i);
+            TreeItem* folder = folders.value(current_path);
+            if (!folder) {
+                folder = parent->appendChild(names.at(i), current_path);
+                folders.insert(current_path, folder);
+            }
+            parent = folder;
+        }
+        if (!isFolder) {
+            parent->appendChild(names.last(), playlist_path);
+        }
+    }
+    return rootItem.release();
+}
+
+void TraktorFeature::parseTrack(QXmlStreamReader &xml, int track_id,
+        ExternalLibraryTableWriter* pWriter,
+        QHash<QString, int>* pTrackIdsByLocation) {
     QString title;
     QString artist;
     QString album;
@@ -354,25 +448,24 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
 
     // If we reach the end of ENTRY within the COLLECTION tag
     // Save parsed track to database
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":key", key);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-    if (!success) {
-        qDebug() << "SQL Error in TraktorTableModel.cpp: line"
-                 << __LINE__ << " " << query.lastError();
-        return;
+    pWriter->insertRow(kLibraryTable,
+            QVariantList{track_id,
+                    artist,
+                    title,
+                    album,
+                    year,
+                    genre,
+                    comment,
+                    tracknumber,
+                    bpm,
+                    bitrate,
+                    playtime,
+                    location,
+                    rating,
+                    key});
+    // Locations are unique, i.e. only the first entry will be inserted
+    if (!pTrackIdsByLocation->contains(location)) {
+        pTrackIdsByLocation->insert(location, track_id);
     }
 }
 
@@ -381,27 +474,26 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
 // A folder can contain folders and playlists. A playlist contains entries but no folders.
 // In other words, Traktor uses a tree structure to organize music.
 // Inner nodes represent folders while leaves are playlists.
-TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
+TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml,
+        ExternalLibraryTableWriter* pWriter,
+        const QHash<QString, int>& trackIdsByLocation) {
 
     qDebug() << "Process RootFolder";
     //Each playlist is unique and can be identified by a path in the tree structure.
     QString current_path = "";
     QMap<QString,QString> map;
+    // Paths of all imported playlists and folders, which are numbered in
+    // the order of their appearance to restore the sidebar from the
+    // database
+    QSet<QString> playlist_paths;
+    QSet<QString> folder_paths;
+    int row_id = 0;
 
-    QString delimiter = "-->";
+    const QString& delimiter = kPlaylistPathDelimiter;
 
     std::unique_ptr<TreeItem> rootItem = TreeItem::newRoot(this);
     TreeItem* parent = rootItem.get();
 
-    QSqlQuery query_insert_to_playlists(m_database);
-    query_insert_to_playlists.prepare("INSERT INTO traktor_playlists (name) "
-                  "VALUES (:name)");
-
-    QSqlQuery query_insert_to_playlist_tracks(m_database);
-    query_insert_to_playlist_tracks.prepare(
-        "INSERT INTO traktor_playlist_tracks (playlist_id, track_id, position) "
-        "VALUES (:playlist_id, :track_id, :position)");
-
     while (!xml.atEnd() && !m_cancelImport) {
         //read next XML element
         xml.readNext();
@@ -419,6 +511,13 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
                     //qDebug() << "Folder: " +current_path << " has parent " << parent->getData().toString();
                     map.insert(current_path, "FOLDER");
                     parent = parent->appendChild(name, current_path);
+                    // Folders are stored with a trailing delimiter to
+                    // restore them even if they contain no playlists
+                    if (!folder_paths.contains(current_path)) {
+                        folder_paths.insert(current_path);
+                        pWriter->insertRow(kPlaylistsTable,
+                                QVariantList{++row_id, current_path + delimiter});
+                    }
                } else if (type == "PLAYLIST") {
                     current_path += delimiter;
                     current_path += name;
@@ -427,9 +526,18 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
 
                     parent->appendChild(name, current_path);
                     // process all the entries within the playlist 'name' having path 'current_path'
-                    parsePlaylistEntries(xml, current_path,
-                                         query_insert_to_playlists,
-                                         query_insert_to_playlist_tracks);
+                    // In the database, the name of a playlist is specified by the unique path,
+                    // e.g., /someFolderA/someFolderB/playlistA"
+                    if (playlist_paths.contains(current_path)) {
+                        qDebug() << "Skipping duplicate Traktor playlist" << current_path;
+                        continue;
+                    }
+                    playlist_paths.insert(current_path);
+                    const int playlist_id = ++row_id;
+                    pWriter->insertRow(kPlaylistsTable,
+                            QVariantList{playlist_id, current_path});
+                    parsePlaylistEntries(xml, current_path, playlist_id,
+                                         pWriter, trackIdsByLocation);
                 }
             }
         }
@@ -457,38 +565,11 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
 
 void TraktorFeature::parsePlaylistEntries(
         QXmlStreamReader &xml,
-        QString playlist_path,
-        QSqlQuery query_insert_into_playlist,
-        QSqlQuery query_insert_into_playlisttracks) {
-    // In the database, the name of a playlist is specified by the unique path,
-    // e.g., /someFolderA/someFolderB/playlistA"
-    query_insert_into_playlist.bindValue(":name", playlist_path);
-
-    if (!query_insert_into_playlist.exec()) {
-        LOG_FAILED_QUERY(query_insert_into_playlist)
-                << "Failed to insert playlist in TraktorTableModel:"
-                << playlist_path;
-        return;
-    }
-
-    // Get playlist id
-    QSqlQuery id_query(m_database);
-    id_query.prepare("select id from traktor_playlists where name=:path");
-    id_query.bindValue(":path", playlist_path);
-
-    if (!id_query.exec()) {
-        LOG_FAILED_QUERY(id_query) << "Could not get inserted playlist id for Traktor playlist::"
-                                   << playlist_path;
-        return;
-    }
-
-    //playlist_id = id_query.lastInsertId().toInt();
-    int playlist_id = -1;
-    const int idColumn = id_query.record().indexOf("id");
-    while (id_query.next()) {
-        playlist_id = id_query.value(idColumn).toInt();
-    }
-
+        const QString& playlist_path,
+        int playlist_id,
+        ExternalLibraryTableWriter* pWriter,
+        const QHash<QString, int>& trackIdsByLocation) {
+    //qDebug() << "Parse Traktor playlist" << playlist_path;
     int playlist_position = 1;
     while (!xml.atEnd() && !m_cancelImport) {
         //read next XML element
@@ -505,28 +586,9 @@ void TraktorFeature::parsePlaylistEntries(
                     #endif
 
                     //insert to database
-                    int track_id = -1;
-                    QSqlQuery finder_query(m_database);
-                    finder_query.prepare("select id from traktor_library where location=:path");
-                    finder_query.bindValue(":path", key);
-
-                    if (!finder_query.exec()) {
-                        LOG_FAILED_QUERY(finder_query) << "Could not get track id:" << key;
-                        continue;
-                    }
-
-                    if (finder_query.next()) {
-                        track_id = finder_query.value(finder_query.record().indexOf("id")).toInt();
-                    }
-
-                    query_insert_into_playlisttracks.bindValue(":playlist_id", playlist_id);
-                    query_insert_into_playlisttracks.bindValue(":track_id", track_id);
-                    query_insert_into_playlisttracks.bindValue(":position", playlist_position++);
-                    if (!query_insert_into_playlisttracks.exec()) {
-                        LOG_FAILED_QUERY(query_insert_into_playlisttracks)
-                                << "trackid" << track_id << " with path " << key
-                                << "playlistname; " << playlist_path <<" with ID " << playlist_id;
-                    }
+                    const int track_id = trackIdsByLocation.value(key, -1);
+                    pWriter->insertRow(kPlaylistTracksTable,
+                            QVariantList{playlist_id, track_id, playlist_position++});
                 }
             }
         }
@@ -539,17 +601,6 @@ void TraktorFeature::parsePlaylistEntries(
     }
 }
 
-void TraktorFeature::clearTable(QString table_name) {
-    QSqlQuery query(m_database);
-    query.prepare("delete from "+table_name);
-
-    if (!query.exec())
-        qDebug() << "Could not delete remove old entries from table "
-                 << table_name << " : " << query.lastError();
-    else
-        qDebug() << "Traktor table entries of '" << table_name << "' have been cleared.";
-}
-
 QString TraktorFeature::getTraktorMusicDatabase() {
     QString musicFolder = "";
 
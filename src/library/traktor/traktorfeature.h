@@ -16,6 +16,8 @@
 #include "library/baseexternalplaylistmodel.h"
 #include "library/treeitemmodel.h"
 
+class ExternalLibraryTableWriter;
+
 class TraktorTrackModel : public BaseExternalTrackModel {
   public:
     TraktorTrackModel(QObject* parent,
@@ -53,14 +55,20 @@ class TraktorFeature : public BaseExternalLibraryFeature {
   private:
     BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist) override;
     TreeItem* importLibrary(QString file);
+    // restores the childmodel from the playlists of a previous import
+    TreeItem* loadPlaylists();
     // parses a track in the music collection
-    void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    void parseTrack(QXmlStreamReader &xml, int track_id,
+            ExternalLibraryTableWriter* pWriter,
+            QHash<QString, int>* pTrackIdsByLocation);
     // Iterates over all playliost and folders and constructs the childmodel
-    TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    TreeItem* parsePlaylists(QXmlStreamReader &xml,
+            ExternalLibraryTableWriter* pWriter,
+            const QHash<QString, int>& trackIdsByLocation);
     // processes a particular playlist
-    void parsePlaylistEntries(QXmlStreamReader &xml, QString playlist_path,
-    QSqlQuery query_insert_into_playlist, QSqlQuery query_insert_into_playlisttracks);
-    void clearTable(QString table_name);
+    void parsePlaylistEntries(QXmlStreamReader &xml, const QString& playlist_path,
+            int playlist_id, ExternalLibraryTableWriter* pWriter,
+            const QHash<QString, int>& trackIdsByLocation);
     static QString getTraktorMusicDatabase();
     // private fields
     TreeItemModel m_childModel;
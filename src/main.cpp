@@ -23,8 +23,10 @@
 #include <QString>
 #include <QTextCodec>
 
+#include "engine/offlinerenderer.h"
 #include "mixxx.h"
 #include "mixxxapplication.h"
+#include "preferences/settingsmanager.h"
 #include "sources/soundsourceproxy.h"
 #include "errordialoghandler.h"
 #include "util/cmdlineargs.h"
@@ -41,6 +43,7 @@ namespace {
 // Exit codes
 constexpr int kFatalErrorOnStartupExitCode = 1;
 constexpr int kParseCmdlineArgsErrorExitCode = 2;
+constexpr int kOfflineRenderErrorExitCode = 3;
 
 int runMixxx(MixxxApplication* app, const CmdlineArgs& args) {
     MixxxMainWindow mainWindow(app, args);
@@ -58,6 +61,23 @@ int runMixxx(MixxxApplication* app, const CmdlineArgs& args) {
     }
 }
 
+int runOfflineRender(const CmdlineArgs& args) {
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    if (!OfflineRenderer::readScript(
+                args.getRenderScriptPath(), &script, &errorMessage)) {
+        qCritical() << errorMessage;
+        return kOfflineRenderErrorExitCode;
+    }
+    SettingsManager settingsManager(args.getSettingsPath());
+    OfflineRenderer renderer(settingsManager.settings());
+    if (!renderer.render(script, args.getRenderOutputPath(), &errorMessage)) {
+        qCritical() << errorMessage;
+        return kOfflineRenderErrorExitCode;
+    }
+    return 0;
+}
+
 } // anonymous namespace
 
 int main(int argc, char * argv[]) {
@@ -136,7 +156,12 @@ int main(int argc, char * argv[]) {
     // When the last window is closed, terminate the Qt event loop.
     QObject::connect(&app, &MixxxApplication::lastWindowClosed, &app, &MixxxApplication::quit);
 
-    int exitCode = runMixxx(&app, args);
+    int exitCode;
+    if (args.getOfflineRender()) {
+        exitCode = runOfflineRender(args);
+    } else {
+        exitCode = runMixxx(&app, args);
+    }
 
     qDebug() << "Mixxx shutdown complete with code" << exitCode;
 
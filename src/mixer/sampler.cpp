@@ -1,6 +1,9 @@
 #include "mixer/sampler.h"
 
 #include "control/controlobject.h"
+#include "control/controlpushbutton.h"
+#include "engine/channels/enginedeck.h"
+#include "engine/enginebuffer.h"
 
 Sampler::Sampler(QObject* pParent,
         UserSettingsPointer pConfig,
@@ -18,5 +21,36 @@ Sampler::Sampler(QObject* pParent,
                   handleGroup,
                   /*defaultMaster*/ true,
                   /*defaultHeadphones*/ false,
-                  /*primaryDeck*/ false) {
+                  /*primaryDeck*/ false),
+          m_bResident(false) {
+    m_pResident = std::make_unique<ControlPushButton>(
+            ConfigKey(getGroup(), "resident"));
+    m_pResident->setButtonMode(ControlPushButton::TOGGLE);
+    connect(m_pResident.get(),
+            &ControlObject::valueChanged,
+            this,
+            &Sampler::slotResidentChanged);
+}
+
+Sampler::~Sampler() = default;
+
+void Sampler::setResident(bool resident) {
+    m_bResident = resident;
+    getEngineDeck()->getEngineBuffer()->setResidentSamples(resident);
+    m_pResident->set(resident ? 1.0 : 0.0);
+}
+
+void Sampler::slotResidentChanged(double value) {
+    const bool resident = value > 0.0;
+    if (resident == m_bResident) {
+        return;
+    }
+    m_bResident = resident;
+    getEngineDeck()->getEngineBuffer()->setResidentSamples(resident);
+    // Reload a stopped sample to apply the mode immediately. A playing
+    // sample is switched with the next load.
+    TrackPointer pTrack = getLoadedTrack();
+    if (pTrack && ControlObject::get(ConfigKey(getGroup(), "play")) == 0.0) {
+        slotLoadTrack(pTrack, false);
+    }
 }
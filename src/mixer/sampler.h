@@ -2,6 +2,8 @@
 
 #include "mixer/basetrackplayer.h"
 
+class ControlPushButton;
+
 class Sampler : public BaseTrackPlayerImpl {
     Q_OBJECT
   public:
@@ -12,5 +14,18 @@ class Sampler : public BaseTrackPlayerImpl {
             VisualsManager* pVisualsManager,
             EngineChannel::ChannelOrientation defaultOrientation,
             const ChannelHandleAndGroup& handleGroup);
-    ~Sampler() override = default;
+    ~Sampler() override;
+
+    // Changes the resident mode for the next load without reloading the
+    // loaded track, e.g. before restoring a sampler bank.
+    void setResident(bool resident);
+
+  private slots:
+    void slotResidentChanged(double value);
+
+  private:
+    // Decodes short tracks completely while loading, see
+    // CachingReader::setResidentSamples()
+    std::unique_ptr<ControlPushButton> m_pResident;
+    bool m_bResident;
 };
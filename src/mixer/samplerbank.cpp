@@ -100,6 +100,9 @@ bool SamplerBank::saveSamplerBankToPath(const QString& samplerBankPath) {
             QString samplerLocation = pTrack->getLocation();
             samplerNode.setAttribute("location", samplerLocation);
         }
+        if (ControlObject::get(ConfigKey(pSampler->getGroup(), "resident")) > 0.0) {
+            samplerNode.setAttribute("resident", 1);
+        }
         root.appendChild(samplerNode);
     }
 
@@ -171,6 +174,7 @@ bool SamplerBank::loadSamplerBankFromPath(const QString& samplerBankPath) {
             if (e.tagName() == "sampler") {
                 QString group = e.attribute("group", "");
                 QString location = e.attribute("location", "");
+                bool resident = e.attribute("resident", "0").toInt() != 0;
                 int samplerNum;
 
                 if (!group.isEmpty()
@@ -179,6 +183,15 @@ bool SamplerBank::loadSamplerBankFromPath(const QString& samplerBankPath) {
                         m_pCONumSamplers->set(samplerNum);
                     }
 
+                    // The track is decoded completely by the reader in
+                    // the background, before it is reported as loaded.
+                    // Applied by the load below instead of reloading the
+                    // previous track.
+                    Sampler* pSampler = m_pPlayerManager->getSampler(samplerNum);
+                    if (pSampler) {
+                        pSampler->setResident(resident);
+                    }
+
                     if (location.isEmpty()) {
                         m_pPlayerManager->slotLoadTrackToPlayer(TrackPointer(), group);
                     } else {
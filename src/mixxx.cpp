@@ -70,6 +70,12 @@
 #include "preferences/dialog/dlgprefmodplug.h"
 #endif
 
+#ifdef __MAD__
+#include <QtConcurrentRun>
+
+#include "sources/soundsourcemp3.h"
+#endif
+
 #if defined(Q_OS_LINUX)
 #include <X11/Xlib.h>
 #include <X11/Xlibint.h>
@@ -85,6 +91,11 @@ namespace {
 
 const mixxx::Logger kLogger("MixxxMainWindow");
 
+#ifdef __MAD__
+// Upper bound for the size of all persistent MP3 seek indexes
+constexpr qint64 kMp3SeekIndexCacheMaxBytes = 64 * 1024 * 1024;
+#endif
+
 // hack around https://gitlab.freedesktop.org/xorg/lib/libx11/issues/25
 // https://bugs.launchpad.net/mixxx/+bug/1805559
 #if defined(Q_OS_LINUX)
@@ -336,7 +347,18 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     delete pModplugPrefs; // not needed anymore
 #endif
 
-    CoverArtCache::createInstance();
+#ifdef __MAD__
+    // Reopening MP3 files doesn't require to scan all frame headers again
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(
+            QDir(pConfig->getSettingsPath()).filePath("analysis/mp3seekindex"));
+    // Limit the disk usage in the background
+    QtConcurrent::run([] {
+        mixxx::SoundSourceMp3::purgeSeekIndexCache(kMp3SeekIndexCacheMaxBytes);
+    });
+#endif
+
+    CoverArtCache::createInstance(
+            QDir(pConfig->getSettingsPath()).filePath("coverart_thumbnails"));
 
     launchProgress(30);
 
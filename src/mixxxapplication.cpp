@@ -79,6 +79,7 @@ void MixxxApplication::registerMetaTypes() {
     qRegisterMetaType<QList<TrackRef>>();
     qRegisterMetaType<QList<QPair<TrackRef, TrackRef>>>();
     qRegisterMetaType<TrackPointer>();
+    qRegisterMetaType<TrackPointerList>();
 
     // Crates
     qRegisterMetaType<CrateId>();
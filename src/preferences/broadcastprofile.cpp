@@ -8,6 +8,7 @@
 #include <QRegExp>
 #include <QString>
 #include <QStringList>
+#include <cmath>
 
 #ifdef __QTKEYCHAIN__
 #include <qt5keychain/keychain.h>
@@ -439,6 +440,26 @@ int BroadcastProfile::connectionStatus() {
     return atomicLoadRelaxed(m_connectionStatus);
 }
 
+void BroadcastProfile::setEncoderStats(double cpuLoad, int subscriberCount) {
+    const int cpuLoadPercent = static_cast<int>(std::round(cpuLoad * 100));
+    const int oldCpuLoadPercent =
+            m_encoderCpuLoadPercent.fetchAndStoreRelaxed(cpuLoadPercent);
+    const int oldSubscriberCount =
+            m_encoderSubscriberCount.fetchAndStoreRelaxed(subscriberCount);
+    if (cpuLoadPercent != oldCpuLoadPercent ||
+            subscriberCount != oldSubscriberCount) {
+        emit encoderStatsChanged(encoderCpuLoad(), subscriberCount);
+    }
+}
+
+double BroadcastProfile::encoderCpuLoad() {
+    return atomicLoadRelaxed(m_encoderCpuLoadPercent) / 100.0;
+}
+
+int BroadcastProfile::encoderSubscriberCount() {
+    return atomicLoadRelaxed(m_encoderSubscriberCount);
+}
+
 void BroadcastProfile::setSecureCredentialStorage(bool value) {
     m_secureCredentials = value;
 }
@@ -531,6 +552,10 @@ void BroadcastProfile::relayConnectionStatus(int newConnectionStatus) {
     setConnectionStatus(newConnectionStatus);
 }
 
+void BroadcastProfile::relayEncoderStats(double cpuLoad, int subscriberCount) {
+    setEncoderStats(cpuLoad, subscriberCount);
+}
+
 // This was useless before, but now comes in handy for multi-broadcasting,
 // where it means "this connection is enabled and will be started by Mixxx"
 bool BroadcastProfile::getEnabled() const {
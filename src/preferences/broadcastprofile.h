@@ -42,6 +42,12 @@ class BroadcastProfile : public QObject {
     void setConnectionStatus(int newState);
     int connectionStatus();
 
+    // The load of the encoder while connected, which might be shared
+    // with other connections that use the same encoder settings
+    void setEncoderStats(double cpuLoad, int subscriberCount);
+    double encoderCpuLoad();
+    int encoderSubscriberCount();
+
     void setSecureCredentialStorage(bool enabled);
     bool secureCredentialStorage();
 
@@ -142,10 +148,12 @@ class BroadcastProfile : public QObject {
     void profileNameChanged(QString oldName, QString newName);
     void statusChanged(bool newStatus);
     void connectionStatusChanged(int newConnectionStatus);
+    void encoderStatsChanged(double cpuLoad, int subscriberCount);
 
   public slots:
     void relayStatus(bool newStatus);
     void relayConnectionStatus(int newConnectionStatus);
+    void relayEncoderStats(double cpuLoad, int subscriberCount);
 
   private:
     void adoptDefaultValues();
@@ -198,6 +206,9 @@ class BroadcastProfile : public QObject {
     bool m_oggDynamicUpdate;
 
     QAtomicInt m_connectionStatus;
+    // In whole percents to limit the updates of the preferences
+    QAtomicInt m_encoderCpuLoadPercent;
+    QAtomicInt m_encoderSubscriberCount;
 };
 
 #endif // BROADCASTPROFILE_H
@@ -9,6 +9,7 @@ namespace {
 const int kColumnEnabled = 0;
 const int kColumnName = 1;
 const int kColumnStatus = 2;
+const int kColumnEncoder = 3;
 }
 
 BroadcastSettingsModel::BroadcastSettingsModel() {
@@ -28,10 +29,14 @@ void BroadcastSettingsModel::resetFromSettings(BroadcastSettingsPointer pSetting
     for(BroadcastProfilePtr profile : pSettings->profiles()) {
         BroadcastProfilePtr copy = profile->valuesCopy();
         copy->setConnectionStatus(profile->connectionStatus());
+        copy->setEncoderStats(profile->encoderCpuLoad(),
+                profile->encoderSubscriberCount());
         connect(profile.data(), SIGNAL(statusChanged(bool)),
                 copy.data(), SLOT(relayStatus(bool)));
         connect(profile.data(), SIGNAL(connectionStatusChanged(int)),
                 copy.data(), SLOT(relayConnectionStatus(int)));
+        connect(profile.data(), SIGNAL(encoderStatsChanged(double, int)),
+                copy.data(), SLOT(relayEncoderStats(double, int)));
         addProfileToModel(copy);
     }
 }
@@ -52,6 +57,8 @@ bool BroadcastSettingsModel::addProfileToModel(BroadcastProfilePtr profile) {
             this, SLOT(onProfileNameChanged(QString,QString)));
     connect(profile.data(), SIGNAL(connectionStatusChanged(int)),
             this, SLOT(onConnectionStatusChanged(int)));
+    connect(profile.data(), SIGNAL(encoderStatsChanged(double, int)),
+            this, SLOT(onEncoderStatsChanged(double, int)));
     m_profiles.insert(profile->getProfileName(), BroadcastProfilePtr(profile));
 
     endInsertRows();
@@ -85,7 +92,7 @@ int BroadcastSettingsModel::rowCount(const QModelIndex& parent) const {
 
 int BroadcastSettingsModel::columnCount(const QModelIndex& parent) const {
     Q_UNUSED(parent);
-    return 3;
+    return 4;
 }
 
 QVariant BroadcastSettingsModel::data(const QModelIndex& index, int role) const {
@@ -119,6 +126,14 @@ QVariant BroadcastSettingsModel::data(const QModelIndex& index, int role) const
                 return Qt::AlignCenter;
             }
         }
+        else if (column == kColumnEncoder) {
+            if (role == Qt::DisplayRole) {
+                return encoderStatsString(profile);
+            }
+            else if (role == Qt::TextAlignmentRole) {
+                return Qt::AlignCenter;
+            }
+        }
     }
 
     return QVariant();
@@ -134,6 +149,8 @@ QVariant BroadcastSettingsModel::headerData(int section, Qt::Orientation orienta
                 return tr("Name");
             } else if (section == kColumnStatus) {
                 return tr("Status");
+            } else if (section == kColumnEncoder) {
+                return tr("Encoder");
             }
         }
     }
@@ -212,6 +229,21 @@ QColor BroadcastSettingsModel::connectionStatusColor(BroadcastProfilePtr profile
         }
 }
 
+QString BroadcastSettingsModel::encoderStatsString(BroadcastProfilePtr profile) {
+    const int subscriberCount = profile->encoderSubscriberCount();
+    if (subscriberCount <= 0) {
+        // Not connected
+        return QString();
+    }
+    const QString cpuLoad = tr("%1 % CPU").arg(
+            QString::number(profile->encoderCpuLoad() * 100, 'f', 0));
+    if (subscriberCount == 1) {
+        return cpuLoad;
+    }
+    // The encoder is shared with other connections
+    return tr("%1 (shared by %2)").arg(cpuLoad, QString::number(subscriberCount));
+}
+
 void BroadcastSettingsModel::onProfileNameChanged(QString oldName, QString newName) {
     if (!m_profiles.contains(oldName))
         return;
@@ -234,3 +266,12 @@ void BroadcastSettingsModel::onConnectionStatusChanged(int newStatus) {
     QModelIndex end = this->index(this->rowCount()-1, kColumnStatus);
     emit dataChanged(start, end);
 }
+
+void BroadcastSettingsModel::onEncoderStatsChanged(double cpuLoad, int subscriberCount) {
+    Q_UNUSED(cpuLoad);
+    Q_UNUSED(subscriberCount);
+    // Refresh the whole encoder column
+    QModelIndex start = this->index(0, kColumnEncoder);
+    QModelIndex end = this->index(this->rowCount()-1, kColumnEncoder);
+    emit dataChanged(start, end);
+}
@@ -40,10 +40,12 @@ class BroadcastSettingsModel : public QAbstractTableModel {
   private slots:
     void onProfileNameChanged(QString oldName, QString newName);
     void onConnectionStatusChanged(int newStatus);
+    void onEncoderStatsChanged(double cpuLoad, int subscriberCount);
 
   private:
     static QString connectionStatusString(BroadcastProfilePtr profile);
     static QColor connectionStatusColor(BroadcastProfilePtr profile);
+    static QString encoderStatsString(BroadcastProfilePtr profile);
 
     QMap<QString, BroadcastProfilePtr> m_profiles;
 };
@@ -28,6 +28,7 @@ namespace {
 const char* kSettingsGroupHeader = "Settings for %1";
 const int kColumnEnabled = 0;
 const int kColumnName = 1;
+const int kColumnStatus = 2;
 const mixxx::Logger kLogger("DlgPrefBroadcast");
 }
 
@@ -617,7 +618,8 @@ void DlgPrefBroadcast::onSectionResized() {
 
     sender()->blockSignals(true);
     connectionList->setColumnWidth(kColumnEnabled, 100);
-    connectionList->setColumnWidth(kColumnName, static_cast<int>(width * 0.65));
+    connectionList->setColumnWidth(kColumnName, static_cast<int>(width * 0.45));
+    connectionList->setColumnWidth(kColumnStatus, static_cast<int>(width * 0.2));
     // The last column is automatically resized to fill
     // the remaining width, thanks to stretchLastSection set to true.
     sender()->blockSignals(false);
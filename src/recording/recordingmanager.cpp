@@ -57,7 +57,7 @@ RecordingManager::RecordingManager(UserSettingsPointer pConfig, EngineMaster* pE
                 &EngineRecord::durationRecorded,
                 this,
                 &RecordingManager::slotDurationRecorded);
-        pSidechain->addSideChainWorker(pEngineRecord);
+        pSidechain->addSideChainWorker(pEngineRecord, RECORDING_PREF_KEY);
     }
 }
 
@@ -353,6 +353,8 @@ void SoundDeviceNetwork::workerWrite(NetworkOutputStreamWorkerPtr pWorker,
         if (writeAvailable < writeRequired) {
             kLogger.warning() << "write: worker buffer full, losing samples";
             pWorker->incOverflowCount();
+            pWorker->addDroppedFrames(
+                    (writeRequired - writeAvailable) / m_iNumOutputChannels);
         }
 
         int copyCount = math_min(writeAvailable, writeRequired);
@@ -380,6 +382,8 @@ void SoundDeviceNetwork::workerWriteSilence(NetworkOutputStreamWorkerPtr pWorker
         if (writeAvailable < writeRequired) {
             kLogger.warning() << "writeSilence: worker buffer full, losing samples";
             pWorker->incOverflowCount();
+            pWorker->addDroppedFrames(
+                    (writeRequired - writeAvailable) / m_iNumOutputChannels);
         }
 
         int clearCount = math_min(writeAvailable, writeRequired);
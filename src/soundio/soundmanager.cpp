@@ -599,6 +599,9 @@ void SoundManager::checkConfig() {
 }
 
 void SoundManager::onDeviceOutputCallback(const SINT iFramesPerBuffer) {
+    // Notify receivers in other threads once per GUI frame about control
+    // changes instead of queuing a signal for each change.
+    ScopedCoalescedValueChanges coalescedValueChanges;
     // Produce a block of samples for output. EngineMaster expects stereo
     // samples so multiply iFramesPerBuffer by 2.
     m_pMaster->process(iFramesPerBuffer * 2);
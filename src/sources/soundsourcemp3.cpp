@@ -1,11 +1,20 @@
 #include "sources/soundsourcemp3.h"
 #include "sources/mp3decoding.h"
 
+#include "util/file.h"
 #include "util/logger.h"
 #include "util/math.h"
 
 #include <id3tag.h>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <algorithm>
+
 namespace mixxx {
 
 namespace {
@@ -157,6 +166,68 @@ bool decodeFrameHeader(
     return true;
 }
 
+// Persistent seek index
+constexpr quint32 kSeekIndexMagic = 0x4d534958; // "MSIX"
+constexpr quint32 kSeekIndexVersion = 1;
+const QString kSeekIndexFileSuffix = QStringLiteral(".mp3seek");
+
+// Only the beginning and the end of a file are hashed to detect
+// modifications that preserve both the file size and the time stamp
+constexpr qint64 kSeekIndexFingerprintBytes = 64 * 1024;
+
+// Subsequent seek frames usually differ by a constant number of sample
+// frames and a similar number of bytes. Each delta is stored as the
+// zigzag encoded difference to the preceding delta with a variable
+// number of bytes, i.e. mostly with a single byte.
+inline quint64 zigzagEncode(qint64 value) {
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+inline qint64 zigzagDecode(quint64 value) {
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+void appendVarint(QByteArray* pData, quint64 value) {
+    while (value >= 0x80) {
+        pData->append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    pData->append(static_cast<char>(value));
+}
+
+bool readVarint(const char** ppData, const char* pEnd, quint64* pValue) {
+    quint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*ppData >= pEnd) {
+            return false;
+        }
+        const auto byte = static_cast<unsigned char>(*(*ppData)++);
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *pValue = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool isFrameSync(const unsigned char* pData) {
+    return (pData[0] == 0xff) && ((pData[1] & 0xe0) == 0xe0);
+}
+
+// Each seek frame is stored with at least one byte for each of its
+// two varints
+constexpr int kSeekIndexMinBytesPerFrame = 2;
+
+// Files are opened concurrently by the reader and analyzer threads
+QMutex s_seekIndexCacheDirMutex;
+QString s_seekIndexCacheDir;
+
+QString seekIndexCacheDir() {
+    QMutexLocker locker(&s_seekIndexCacheDirMutex);
+    return s_seekIndexCacheDir;
+}
+
 } // anonymous namespace
 
 //static
@@ -167,6 +238,34 @@ const QStringList SoundSourceProviderMp3::kSupportedFileExtensions = {
         QStringLiteral("mp3"),
 };
 
+//static
+void SoundSourceMp3::setSeekIndexCacheDir(const QString& cacheDir) {
+    if (!cacheDir.isEmpty() && !QDir().mkpath(cacheDir)) {
+        kLogger.warning()
+                << "Failed to create seek index directory"
+                << cacheDir;
+    }
+    QMutexLocker locker(&s_seekIndexCacheDirMutex);
+    s_seekIndexCacheDir = cacheDir;
+}
+
+//static
+int SoundSourceMp3::purgeSeekIndexCache(qint64 maxTotalBytes) {
+    const QString cacheDir = seekIndexCacheDir();
+    if (cacheDir.isEmpty()) {
+        return 0;
+    }
+    const int numDeleted = purgeLeastRecentlyModifiedFiles(
+            QDir(cacheDir),
+            QStringList{QChar('*') + kSeekIndexFileSuffix},
+            maxTotalBytes);
+    kLogger.info()
+            << "Purged"
+            << numDeleted
+            << "seek indexes";
+    return numDeleted;
+}
+
 SoundSourceMp3::SoundSourceMp3(const QUrl& url)
         : SoundSource(url),
           m_file(getLocalFileName()),
@@ -222,6 +321,28 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     mad_stream_buffer(&m_madStream, m_pFileData, m_fileSize);
     DEBUG_ASSERT(m_pFileData == m_madStream.this_frame);
 
+    const QString seekIndexPath = seekIndexFilePath();
+    if (!loadSeekIndex(seekIndexPath)) {
+        const OpenResult scanResult = scanSeekFrames();
+        if (scanResult != OpenResult::Succeeded) {
+            return scanResult;
+        }
+        storeSeekIndex(seekIndexPath);
+    }
+
+    // Restart decoding at the beginning of the audio stream
+    restartDecoding(m_seekFrameList.front());
+
+    if (m_curFrameIndex != frameIndexMin()) {
+        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
+        // Abort
+        return OpenResult::Failed;
+    }
+
+    return OpenResult::Succeeded;
+}
+
+SoundSource::OpenResult SoundSourceMp3::scanSeekFrames() {
     DEBUG_ASSERT(m_seekFrameList.empty());
     m_avgSeekFrameCount = 0;
     m_curFrameIndex = 0;
@@ -401,16 +522,203 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     addSeekFrame(m_curFrameIndex, 0);
     DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
 
-    // Restart decoding at the beginning of the audio stream
-    restartDecoding(m_seekFrameList.front());
+    return OpenResult::Succeeded;
+}
 
-    if (m_curFrameIndex != frameIndexMin()) {
-        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
-        // Abort
-        return OpenResult::Failed;
+QString SoundSourceMp3::seekIndexFilePath() const {
+    const QString cacheDir = seekIndexCacheDir();
+    if (cacheDir.isEmpty()) {
+        return QString();
     }
+    const QByteArray pathDigest = QCryptographicHash::hash(
+            QFileInfo(m_file).absoluteFilePath().toUtf8(),
+            QCryptographicHash::Sha1);
+    return QDir(cacheDir).filePath(
+            QString::fromLatin1(pathDigest.toHex()) + kSeekIndexFileSuffix);
+}
 
-    return OpenResult::Succeeded;
+QByteArray SoundSourceMp3::seekIndexFingerprint() const {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint64 fileSize = static_cast<qint64>(m_fileSize);
+    const qint64 headSize = math_min(fileSize, kSeekIndexFingerprintBytes);
+    hash.addData(reinterpret_cast<const char*>(m_pFileData), headSize);
+    const qint64 tailSize = math_min(fileSize - headSize, kSeekIndexFingerprintBytes);
+    hash.addData(reinterpret_cast<const char*>(m_pFileData + (fileSize - tailSize)), tailSize);
+    return hash.result();
+}
+
+bool SoundSourceMp3::loadSeekIndex(const QString& filePath) {
+    if (filePath.isEmpty()) {
+        return false;
+    }
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (magic != kSeekIndexMagic || version != kSeekIndexVersion) {
+        return false;
+    }
+    quint64 fileSize;
+    qint64 lastModified;
+    QByteArray fingerprint;
+    stream >> fileSize >> lastModified >> fingerprint;
+    if (fileSize != m_fileSize ||
+            lastModified != QFileInfo(m_file).lastModified().toMSecsSinceEpoch() ||
+            fingerprint != seekIndexFingerprint()) {
+        kLogger.debug()
+                << "Ignoring outdated seek index of"
+                << m_file.fileName();
+        return false;
+    }
+    qint32 channelCount;
+    qint32 sampleRate;
+    qint32 bitrate;
+    qint64 totalFrameLength;
+    quint32 seekFrameCount;
+    QByteArray compressedDeltas;
+    stream >> channelCount >> sampleRate >> bitrate >> totalFrameLength >> seekFrameCount >> compressedDeltas;
+    if (stream.status() != QDataStream::Ok) {
+        kLogger.warning()
+                << "Failed to read seek index"
+                << filePath;
+        return false;
+    }
+    const QByteArray deltas = qUncompress(compressedDeltas);
+    // The count is only trusted if the data can hold that many frames
+    if (seekFrameCount == 0 ||
+            seekFrameCount > static_cast<quint32>(
+                                     deltas.size() / kSeekIndexMinBytesPerFrame)) {
+        kLogger.warning()
+                << "Ignoring invalid seek index of"
+                << m_file.fileName();
+        return false;
+    }
+
+    // Decode into a separate list and only take it if all frames are valid
+    SeekFrameList seekFrameList;
+    seekFrameList.reserve(seekFrameCount + 1);
+    const char* pData = deltas.constData();
+    const char* const pEnd = pData + deltas.size();
+    qint64 frameIndex = 0;
+    qint64 frameIndexDelta = 0;
+    qint64 byteOffset = 0;
+    qint64 byteOffsetDelta = 0;
+    for (quint32 i = 0; i < seekFrameCount; ++i) {
+        quint64 frameIndexDeltaDiff;
+        quint64 byteOffsetDeltaDiff;
+        if (!readVarint(&pData, pEnd, &frameIndexDeltaDiff) ||
+                !readVarint(&pData, pEnd, &byteOffsetDeltaDiff)) {
+            return false;
+        }
+        frameIndexDelta += zigzagDecode(frameIndexDeltaDiff);
+        byteOffsetDelta += zigzagDecode(byteOffsetDeltaDiff);
+        frameIndex += frameIndexDelta;
+        byteOffset += byteOffsetDelta;
+        if ((i > 0 && (frameIndexDelta <= 0 || byteOffsetDelta <= 0)) ||
+                byteOffset < 0 ||
+                byteOffset + 1 >= static_cast<qint64>(m_fileSize)) {
+            return false;
+        }
+        seekFrameList.push_back(SeekFrameType{
+                static_cast<SINT>(frameIndex),
+                m_pFileData + byteOffset});
+    }
+    if (seekFrameList.empty() ||
+            seekFrameList.front().frameIndex != 0 ||
+            totalFrameLength <= seekFrameList.back().frameIndex) {
+        return false;
+    }
+
+    // Only the first and the last seek frame are checked. They are
+    // usually located in the pages that have already been read for the
+    // fingerprint. Checking seek frames in between would read pages
+    // scattered across the whole file while opening it, and a corrupt
+    // seek index file has already been rejected by the checksum of
+    // qUncompress().
+    if (!isFrameSync(seekFrameList.front().pInputData) ||
+            !isFrameSync(seekFrameList.back().pInputData)) {
+        kLogger.warning()
+                << "Ignoring invalid seek index of"
+                << m_file.fileName();
+        return false;
+    }
+
+    const auto restoredChannelCount = audio::ChannelCount(channelCount);
+    if (!restoredChannelCount.isValid() ||
+            restoredChannelCount > kChannelCountMax ||
+            getIndexBySampleRate(audio::SampleRate(sampleRate)) >= kSampleRateCount) {
+        return false;
+    }
+    initChannelCountOnce(restoredChannelCount);
+    initSampleRateOnce(audio::SampleRate(sampleRate));
+    initFrameIndexRangeOnce(IndexRange::forward(0, static_cast<SINT>(totalFrameLength)));
+    if (audio::Bitrate(bitrate).isValid()) {
+        initBitrateOnce(audio::Bitrate(bitrate));
+    }
+
+    m_seekFrameList = std::move(seekFrameList);
+    m_avgSeekFrameCount = frameLength() / m_seekFrameList.size();
+    // Terminate m_seekFrameList
+    addSeekFrame(frameIndexMax(), 0);
+    m_curFrameIndex = frameIndexMax();
+    return true;
+}
+
+void SoundSourceMp3::storeSeekIndex(const QString& filePath) const {
+    if (filePath.isEmpty()) {
+        return;
+    }
+    DEBUG_ASSERT(!m_seekFrameList.empty());
+    // The terminating seek frame is not stored
+    const auto seekFrameCount = static_cast<quint32>(m_seekFrameList.size() - 1);
+
+    QByteArray deltas;
+    deltas.reserve(seekFrameCount * 2);
+    qint64 frameIndex = 0;
+    qint64 frameIndexDelta = 0;
+    qint64 byteOffset = 0;
+    qint64 byteOffsetDelta = 0;
+    for (quint32 i = 0; i < seekFrameCount; ++i) {
+        const SeekFrameType& seekFrame = m_seekFrameList[i];
+        const qint64 nextFrameIndexDelta = seekFrame.frameIndex - frameIndex;
+        const qint64 nextByteOffsetDelta = (seekFrame.pInputData - m_pFileData) - byteOffset;
+        appendVarint(&deltas, zigzagEncode(nextFrameIndexDelta - frameIndexDelta));
+        appendVarint(&deltas, zigzagEncode(nextByteOffsetDelta - byteOffsetDelta));
+        frameIndex += nextFrameIndexDelta;
+        frameIndexDelta = nextFrameIndexDelta;
+        byteOffset += nextByteOffsetDelta;
+        byteOffsetDelta = nextByteOffsetDelta;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning()
+                << "Failed to store seek index"
+                << filePath;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << kSeekIndexMagic << kSeekIndexVersion;
+    stream << m_fileSize
+           << QFileInfo(m_file).lastModified().toMSecsSinceEpoch()
+           << seekIndexFingerprint();
+    stream << static_cast<qint32>(getSignalInfo().getChannelCount())
+           << static_cast<qint32>(getSignalInfo().getSampleRate())
+           << static_cast<qint32>(getBitrate())
+           << static_cast<qint64>(frameLength())
+           << seekFrameCount
+           << qCompress(deltas);
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        kLogger.warning()
+                << "Failed to store seek index"
+                << filePath;
+    }
 }
 
 void SoundSourceMp3::close() {
@@ -23,6 +23,15 @@ class SoundSourceMp3 final : public SoundSource {
 
     void close() override;
 
+    // Enables the persistent seek index for all subsequently opened files.
+    // An empty path disables it.
+    static void setSeekIndexCacheDir(const QString& cacheDir);
+
+    // Deletes the least recently stored seek indexes until the total size
+    // of all stored seek indexes does not exceed the given limit. Returns
+    // the number of deleted seek indexes.
+    static int purgeSeekIndexCache(qint64 maxTotalBytes);
+
   protected:
     ReadableSampleFrames readSampleFramesClamped(
             WritableSampleFrames sampleFrames) override;
@@ -53,6 +62,17 @@ class SoundSourceMp3 final : public SoundSource {
 
     void addSeekFrame(SINT frameIndex, const unsigned char* pInputData);
 
+    /** Decodes all frame headers to populate m_seekFrameList. */
+    OpenResult scanSeekFrames();
+
+    /** The seek frames of a file are stored after it has been scanned
+     * and restored instead of scanning the file again if the file has
+     * not been modified in between. */
+    QString seekIndexFilePath() const;
+    QByteArray seekIndexFingerprint() const;
+    bool loadSeekIndex(const QString& filePath);
+    void storeSeekIndex(const QString& filePath) const;
+
     /** Returns the position in m_seekFrameList of the requested frame index. */
     SINT findSeekFrameIndex(SINT frameIndex) const;
 
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "test/mixxxtest.h"
+#include "track/globaltrackcache.h"
+#include "track/track.h"
+#include "util/duration.h"
+
+namespace mixxxtest {
+
+/// Sets up the environment of a test fixture, i.e. the QApplication, the
+/// settings and everything else the fixture Test provides, for a benchmark
+/// function that runs outside of googletest.
+///
+/// Benchmarks that need additional helpers derive from this class.
+template<typename Test = MixxxTest>
+class BenchmarkFixture : public Test {
+  public:
+    using Test::config;
+    using Test::getTestDataDir;
+
+  private:
+    // Never run by googletest
+    void TestBody() override {
+    }
+};
+
+/// Creates the GlobalTrackCache for benchmarks that use tracks without a
+/// library. Evicted tracks are deleted without saving them.
+class BenchmarkTrackCacheScope final : public virtual GlobalTrackCacheSaver {
+  public:
+    BenchmarkTrackCacheScope() {
+        GlobalTrackCache::createInstance(this, deleteTrack);
+    }
+    ~BenchmarkTrackCacheScope() override {
+        GlobalTrackCache::destroyInstance();
+    }
+
+    void saveEvictedTrack(Track* pTrack) noexcept override {
+        Q_UNUSED(pTrack);
+    }
+
+  private:
+    static void deleteTrack(Track* pTrack) {
+        delete pTrack;
+    }
+};
+
+/// Returns the given percentile in the range [0, 1] of a non-empty,
+/// ascending list of durations in microseconds.
+inline double percentileMicros(
+        const std::vector<mixxx::Duration>& sortedDurations,
+        double percentile) {
+    DEBUG_ASSERT(!sortedDurations.empty());
+    const auto index = static_cast<std::size_t>(
+            percentile * (sortedDurations.size() - 1) + 0.5);
+    return sortedDurations[index].toDoubleMicros();
+}
+
+} // namespace mixxxtest
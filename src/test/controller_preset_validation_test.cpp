@@ -1,6 +1,8 @@
 #include "test/controller_preset_validation_test.h"
 
 #include "controllers/defs_controllers.h"
+#include "controllers/midi/midiutils.h"
+#include "mixer/playermanager.h"
 
 FakeControllerJSProxy::FakeControllerJSProxy()
         : ControllerJSProxy(nullptr) {
@@ -11,6 +13,18 @@ void FakeControllerJSProxy::send(QList<int> data, unsigned int length) {
     Q_UNUSED(length);
 }
 
+void FakeControllerJSProxy::send(QList<int> data, unsigned int length, unsigned int reportID) {
+    Q_UNUSED(data);
+    Q_UNUSED(length);
+    Q_UNUSED(reportID);
+}
+
+void FakeControllerJSProxy::sendFeatureReport(
+        const QList<int>& dataList, unsigned int reportID) {
+    Q_UNUSED(dataList);
+    Q_UNUSED(reportID);
+}
+
 void FakeControllerJSProxy::sendSysexMsg(QList<int> data, unsigned int length) {
     Q_UNUSED(data);
     Q_UNUSED(length);
@@ -121,6 +135,57 @@ bool lintPresetInfo(const PresetInfo& preset) {
     return result;
 }
 
+bool lintMidiInputMapping(const QString& path, const MidiInputMapping& mapping) {
+    const MidiOptions& options = mapping.options;
+    if (!options.scratch_touch && !options.scratch_tick) {
+        return true;
+    }
+    bool result = true;
+    const unsigned char opCode = MidiUtils::opCodeFromStatus(mapping.key.status);
+    if (options.script) {
+        qWarning() << "LINT:" << path << "combines a scratch option with"
+                   << "script-binding for" << mapping.control.item;
+        result = false;
+    }
+    if (!PlayerManager::isDeckGroup(mapping.control.group)) {
+        qWarning() << "LINT:" << path << "has a scratch mapping for"
+                   << mapping.control.group << "which is not a deck.";
+        result = false;
+    }
+    if (options.scratch_touch) {
+        if (opCode != MIDI_NOTE_ON && opCode != MIDI_NOTE_OFF && opCode != MIDI_CC) {
+            qWarning() << "LINT:" << path << "has scratch-touch on a message"
+                       << "that is neither a note nor a control change.";
+            result = false;
+        }
+        if (!mapping.scratch.isValid()) {
+            qWarning() << "LINT:" << path << "has invalid scratch-touch parameters for"
+                       << mapping.control.group;
+            result = false;
+        }
+    }
+    if (options.scratch_tick && opCode != MIDI_CC) {
+        qWarning() << "LINT:" << path << "has scratch-tick on a message"
+                   << "that is not a control change.";
+        result = false;
+    }
+    return result;
+}
+
+bool ControllerPresetValidationTest::lintMidiInputMappings(const PresetInfo& preset) {
+    QSharedPointer<MidiControllerPreset> pPreset =
+            ControllerPresetFileHandler::loadPreset(preset.getPath(), m_presetPath)
+                    .dynamicCast<MidiControllerPreset>();
+    if (pPreset.isNull()) {
+        return false;
+    }
+    bool result = true;
+    for (const MidiInputMapping& mapping : pPreset->getInputMappings()) {
+        result = lintMidiInputMapping(preset.getPath(), mapping) && result;
+    }
+    return result;
+}
+
 TEST_F(ControllerPresetValidationTest, MidiPresetsValid) {
     foreach (const PresetInfo& preset,
              m_pEnumerator->getPresetsByExtension(MIDI_PRESET_EXTENSION)) {
@@ -128,6 +193,7 @@ TEST_F(ControllerPresetValidationTest, MidiPresetsValid) {
         std::string errorDescription = "Error while validating " + preset.getPath().toStdString();
         EXPECT_TRUE(preset.isValid()) << errorDescription;
         EXPECT_TRUE(lintPresetInfo(preset)) << errorDescription;
+        EXPECT_TRUE(lintMidiInputMappings(preset)) << errorDescription;
         EXPECT_TRUE(testLoadPreset(preset)) << errorDescription;
     }
 }
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <QObject>
 
 #include "controllers/controller.h"
@@ -13,6 +15,12 @@ class FakeControllerJSProxy : public ControllerJSProxy {
 
     Q_INVOKABLE void send(QList<int> data, unsigned int length = 0) override;
 
+    // HID reports
+    Q_INVOKABLE void send(QList<int> data, unsigned int length, unsigned int reportID);
+
+    Q_INVOKABLE void sendFeatureReport(
+            const QList<int>& dataList, unsigned int reportID);
+
     Q_INVOKABLE void sendSysexMsg(QList<int> data, unsigned int length = 0);
 
     Q_INVOKABLE void sendShortMsg(unsigned char status,
@@ -97,6 +105,7 @@ class ControllerPresetValidationTest : public MixxxTest {
     void SetUp() override;
 
     bool testLoadPreset(const PresetInfo& preset);
+    bool lintMidiInputMappings(const PresetInfo& preset);
 
     QDir m_presetPath;
     QScopedPointer<PresetInfoEnumerator> m_pEnumerator;
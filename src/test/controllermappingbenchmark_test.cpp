@@ -0,0 +1,713 @@
+#include "test/controllermappingbenchmark_test.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QThread>
+#include <algorithm>
+
+#include "control/control.h"
+#include "controllers/controllerpresetfilehandler.h"
+#include "controllers/engine/controllerengine.h"
+#include "test/benchmarkutil.h"
+#include "test/mixxxtest.h"
+#include "util/performancetimer.h"
+#include "util/time.h"
+
+// Benchmarks of controller mappings, i.e. the XML presets and their scripts
+// in res/controllers, to find mappings that stall the controller thread,
+// e.g. during fast jog wheel scratching.
+//
+// Each preset in kBenchmarkPresets is replayed with a synthetic capture of
+// its jog wheels. Another preset and a recorded capture can be given with
+// the environment variables MIXXX_REPLAY_PRESET and MIXXX_REPLAY_CAPTURE,
+// e.g.
+//
+//   MIXXX_REPLAY_PRESET="res/controllers/Pioneer-DDJ-SB2.midi.xml" \
+//   MIXXX_REPLAY_CAPTURE=scratch.txt \
+//   mixxx-test --benchmark --benchmark_filter=BM_ControllerMappingReplay
+//
+// A capture has one message per line, the timestamp in seconds followed by
+// the bytes in hex:
+//
+//   # Jog wheel of deck 1
+//   0.000 b0 22 41
+//   0.001 b0 22 41
+//
+// MIDI messages with up to 3 bytes are short messages, all other messages
+// are handled as SysEx or as HID reports. They are handled as fast as
+// possible while mixxx::Time follows their timestamps.
+//
+// Besides the mean time per message each benchmark reports the 50th and
+// 99th percentile and the maximum in microseconds, the number of messages
+// that took longer than the interval of a fast turning jog wheel, the
+// control updates per message and the duration of a full garbage collection
+// of the script engine after the replay.
+//
+// BM_ScratchMapping compares the native scratch-touch and scratch-tick
+// options of MIDI mappings with the equivalent script functions.
+
+namespace {
+
+const char* const kBenchmarkPresets[] = {
+        "Pioneer-DDJ-SB2.midi.xml",
+        "Numark Mixtrack Platinum.midi.xml",
+        "Hercules DJ Control MP3.hid.xml",
+};
+
+constexpr int kSyntheticMessageCount = 2000;
+const mixxx::Duration kSyntheticMessageInterval = mixxx::Duration::fromMillis(1);
+// A message that takes longer delays the next one of a fast jog wheel
+constexpr double kSlowMessageMicros = 1000.0;
+
+// Items that ControllerEngine accesses itself, e.g. for scratching
+const char* const kEngineItems[] = {
+        "play",
+        "rate_ratio",
+        "reverse",
+        "scratch2",
+        "scratch2_enable",
+};
+
+// Groups that scripts usually compose from a deck number
+QStringList defaultGroups() {
+    QStringList groups{"[Master]"};
+    for (int i = 1; i <= 4; ++i) {
+        groups << QString("[Channel%1]").arg(i)
+               << QString("[Sampler%1]").arg(i);
+    }
+    return groups;
+}
+
+} // anonymous namespace
+
+ReplayMidiController::ReplayMidiController() {
+    setDeviceName("Replay");
+    startEngine();
+    getEngine()->setTesting(true);
+}
+
+ReplayMidiController::~ReplayMidiController() {
+}
+
+//static
+bool ControllerMappingReplay::parseCapture(
+        QTextStream* pStream,
+        QList<Message>* pMessages,
+        QString* pErrorMessage) {
+    int lineNumber = 0;
+    while (!pStream->atEnd()) {
+        const QString line = pStream->readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList fields = line.split(
+                QRegularExpression("\\s+"), QString::SkipEmptyParts);
+        bool ok = fields.size() >= 2;
+        Message message;
+        if (ok) {
+            message.timestamp = mixxx::Duration::fromSeconds(
+                    fields.at(0).toDouble(&ok));
+        }
+        for (int i = 1; ok && i < fields.size(); ++i) {
+            const int byte = fields.at(i).toInt(&ok, 16);
+            ok = ok && byte >= 0 && byte <= 0xFF;
+            message.data.append(static_cast<char>(byte));
+        }
+        if (!ok) {
+            *pErrorMessage = QString("Invalid capture line %1: %2")
+                                     .arg(QString::number(lineNumber), line);
+            return false;
+        }
+        pMessages->append(message);
+    }
+    return true;
+}
+
+//static
+bool ControllerMappingReplay::readCapture(
+        const QString& filePath,
+        QList<Message>* pMessages,
+        QString* pErrorMessage) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *pErrorMessage = QString("Unable to open capture %1").arg(filePath);
+        return false;
+    }
+    QTextStream stream(&file);
+    return parseCapture(&stream, pMessages, pErrorMessage);
+}
+
+ControllerMappingReplay::ControllerMappingReplay()
+        : m_controlUpdates(0) {
+}
+
+ControllerMappingReplay::~ControllerMappingReplay() {
+    if (m_pController) {
+        // Runs the shutdown functions of the scripts
+        m_pController->stopEngine();
+        m_pController.reset();
+    }
+    for (const auto& connection : qAsConst(m_controlConnections)) {
+        QObject::disconnect(connection);
+    }
+}
+
+bool ControllerMappingReplay::loadPreset(
+        const QString& presetFilePath, QString* pErrorMessage) {
+    const QDir systemPresetsPath(QDir::current().absoluteFilePath("res/controllers"));
+    ControllerPresetPointer pPreset = ControllerPresetFileHandler::loadPreset(
+            QFileInfo(presetFilePath), systemPresetsPath);
+    if (pPreset.isNull()) {
+        *pErrorMessage = QString("Unable to load preset %1").arg(presetFilePath);
+        return false;
+    }
+    return loadPreset(*pPreset,
+            presetFilePath.endsWith(HID_PRESET_EXTENSION),
+            pErrorMessage);
+}
+
+bool ControllerMappingReplay::loadPreset(
+        const ControllerPreset& preset, bool hid, QString* pErrorMessage) {
+    VERIFY_OR_DEBUG_ASSERT(!m_pController) {
+        *pErrorMessage = "A preset has already been loaded";
+        return false;
+    }
+    if (hid) {
+        m_pController = std::make_unique<FakeController>();
+    } else {
+        m_pController = std::make_unique<ReplayMidiController>();
+        const auto* pMidiPreset = dynamic_cast<const MidiControllerPreset*>(&preset);
+        if (pMidiPreset) {
+            addMidiPresetKeys(*pMidiPreset);
+        }
+    }
+    for (const auto& scriptFile : preset.getScriptFiles()) {
+        QFile file(scriptFile.file.absoluteFilePath());
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            addScriptKeys(QString::fromUtf8(file.readAll()));
+        }
+    }
+    createControls();
+
+    m_pController->setPreset(preset);
+    if (!m_pController->applyPreset(true)) {
+        *pErrorMessage = QString("Unable to load the scripts of %1").arg(preset.name());
+        return false;
+    }
+    return true;
+}
+
+QList<ControllerMappingReplay::Message> ControllerMappingReplay::syntheticCapture(
+        int messageCount) const {
+    QList<Message> messages;
+    if (m_jogKeys.isEmpty()) {
+        return messages;
+    }
+    for (int i = 0; i < messageCount; ++i) {
+        const MidiKey key = m_jogKeys.at(i % m_jogKeys.size());
+        // Relative values like most jog wheels, 4 ticks in each direction
+        const unsigned char value = (i / 4) % 2 ? 0x3F : 0x41;
+        Message message;
+        message.timestamp = kSyntheticMessageInterval * i;
+        message.data.append(static_cast<char>(key.status));
+        message.data.append(static_cast<char>(key.control));
+        message.data.append(static_cast<char>(value));
+        messages.append(message);
+    }
+    return messages;
+}
+
+void ControllerMappingReplay::replay(const QList<Message>& messages, Clock clock) {
+    m_messageDurations.clear();
+    m_messageDurations.reserve(messages.size());
+    m_controlUpdates = 0;
+    if (messages.isEmpty()) {
+        return;
+    }
+    MidiController* pMidiController = dynamic_cast<MidiController*>(m_pController.get());
+    if (clock == Clock::Mock) {
+        mixxx::Time::setTestMode(true);
+    }
+    const mixxx::Duration firstTimestamp = messages.first().timestamp;
+    PerformanceTimer replayTimer;
+    replayTimer.start();
+    PerformanceTimer timer;
+    for (const auto& message : messages) {
+        mixxx::Duration timestamp;
+        if (clock == Clock::Mock) {
+            timestamp = message.timestamp;
+            mixxx::Time::setTestElapsedTime(timestamp);
+        } else {
+            const mixxx::Duration due = message.timestamp - firstTimestamp;
+            while (replayTimer.elapsed() < due) {
+                QCoreApplication::processEvents();
+                const qint64 remainingMicros =
+                        (due - replayTimer.elapsed()).toIntegerMicros();
+                if (remainingMicros > 0) {
+                    QThread::usleep(std::min<qint64>(remainingMicros, 1000));
+                }
+            }
+            timestamp = mixxx::Time::elapsed();
+        }
+        timer.start();
+        if (pMidiController &&
+                message.data.size() <= 3 &&
+                static_cast<unsigned char>(message.data.at(0)) != MIDI_SYSEX) {
+            unsigned char bytes[3] = {0, 0, 0};
+            for (int i = 0; i < message.data.size(); ++i) {
+                bytes[i] = static_cast<unsigned char>(message.data.at(i));
+            }
+            pMidiController->receive(bytes[0], bytes[1], bytes[2], timestamp);
+        } else {
+            m_pController->receive(message.data, timestamp);
+        }
+        m_messageDurations.push_back(timer.elapsed());
+        // Script timers and queued connections
+        QCoreApplication::processEvents();
+    }
+    if (clock == Clock::Mock) {
+        mixxx::Time::setTestMode(false);
+    }
+
+    timer.start();
+    m_pController->getEngine()->collectGarbage();
+    m_garbageCollectionDuration = timer.elapsed();
+}
+
+void ControllerMappingReplay::addMidiPresetKeys(const MidiControllerPreset& preset) {
+    const auto& inputMappings = preset.getInputMappings();
+    for (const auto& mapping : inputMappings) {
+        if (!mapping.options.script) {
+            m_keys.insert(mapping.control);
+        }
+        const QString name = mapping.control.item.toLower();
+        if (name.contains("jog") || name.contains("wheel") || name.contains("scratch")) {
+            m_jogKeys.append(mapping.key);
+        }
+    }
+    if (m_jogKeys.isEmpty()) {
+        for (const auto& mapping : inputMappings) {
+            m_jogKeys.append(mapping.key);
+        }
+    }
+    const auto& outputMappings = preset.getOutputMappings();
+    for (auto it = outputMappings.begin(); it != outputMappings.end(); ++it) {
+        m_keys.insert(it.key());
+    }
+}
+
+// Collects the groups and items of the controls that the scripts access.
+// Groups are often composed from a deck number and items are passed in
+// variables, so every item is created for every group.
+void ControllerMappingReplay::addScriptKeys(const QString& code) {
+    static const QRegularExpression kEngineCall(
+            "engine\\.\\w+\\(\\s*(?:[\"'](\\[\\w+\\])[\"']|[^,()]+)"
+            "\\s*,\\s*[\"']([\\w.]+)[\"']");
+    static const QRegularExpression kComponentKey(
+            "\\b(?:inKey|outKey|key)\\s*:\\s*[\"']([\\w.]+)[\"']");
+    static const QRegularExpression kGroup("[\"'](\\[\\w+\\])[\"']");
+    auto it = kEngineCall.globalMatch(code);
+    while (it.hasNext()) {
+        const auto match = it.next();
+        if (!match.captured(1).isEmpty()) {
+            m_groups.insert(match.captured(1));
+        }
+        m_items.insert(match.captured(2));
+    }
+    it = kComponentKey.globalMatch(code);
+    while (it.hasNext()) {
+        m_items.insert(it.next().captured(1));
+    }
+    it = kGroup.globalMatch(code);
+    while (it.hasNext()) {
+        m_groups.insert(it.next().captured(1));
+    }
+}
+
+void ControllerMappingReplay::createControls() {
+    for (const auto& group : defaultGroups()) {
+        m_groups.insert(group);
+    }
+    for (const char* item : kEngineItems) {
+        m_items.insert(item);
+    }
+    for (const auto& group : qAsConst(m_groups)) {
+        for (const auto& item : qAsConst(m_items)) {
+            m_keys.insert(ConfigKey(group, item));
+        }
+    }
+    for (const auto& key : qAsConst(m_keys)) {
+        if (!key.isValid() ||
+                ControlObject::getControl(key, ControlFlag::NoWarnIfMissing)) {
+            continue;
+        }
+        m_controls.push_back(std::make_unique<ControlObject>(key));
+        QSharedPointer<ControlDoublePrivate> pControl =
+                ControlDoublePrivate::getControl(key);
+        m_controlConnections.append(QObject::connect(pControl.data(),
+                &ControlDoublePrivate::valueChanged,
+                [this] {
+                    ++m_controlUpdates;
+                }));
+    }
+}
+
+namespace {
+
+class ControllerMappingReplayTest : public MixxxTest {};
+
+TEST_F(ControllerMappingReplayTest, ReplayCapture) {
+    const ConfigKey rateKey("[Channel1]", "rate");
+    const MidiKey midiKey(MIDI_CC, 0x10);
+    MidiControllerPreset preset;
+    preset.addInputMapping(midiKey.key,
+            MidiInputMapping(midiKey, MidiOptions(), rateKey));
+
+    QString captureText(
+            "# Rate fader\n"
+            "0.000 b0 10 40\n"
+            "\n"
+            "0.010 b0 10 7f\n"
+            "0.020 b0 10 7f\n");
+    QTextStream captureStream(&captureText);
+    QList<ControllerMappingReplay::Message> messages;
+    QString errorMessage;
+    ASSERT_TRUE(ControllerMappingReplay::parseCapture(
+            &captureStream, &messages, &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_EQ(3, messages.size());
+    EXPECT_EQ(mixxx::Duration::fromMillis(10), messages.at(1).timestamp);
+    EXPECT_EQ(QByteArray("\xb0\x10\x7f"), messages.at(1).data);
+
+    ControllerMappingReplay replay;
+    ASSERT_TRUE(replay.loadPreset(preset, false, &errorMessage))
+            << errorMessage.toStdString();
+    replay.replay(messages);
+    EXPECT_EQ(3u, replay.messageDurations().size());
+    // The last message does not change the value
+    EXPECT_EQ(2, replay.controlUpdates());
+    EXPECT_LT(0.0, ControlObject::get(rateKey));
+}
+
+TEST_F(ControllerMappingReplayTest, MockClockFollowsTimestamps) {
+    const ConfigKey rateKey("[Channel1]", "rate");
+    const MidiKey midiKey(MIDI_CC, 0x10);
+    MidiControllerPreset preset;
+    preset.addInputMapping(midiKey.key,
+            MidiInputMapping(midiKey, MidiOptions(), rateKey));
+    ControllerMappingReplay replay;
+    QString errorMessage;
+    ASSERT_TRUE(replay.loadPreset(preset, false, &errorMessage))
+            << errorMessage.toStdString();
+
+    QList<mixxx::Duration> updateTimes;
+    QObject::connect(ControlDoublePrivate::getControl(rateKey).data(),
+            &ControlDoublePrivate::valueChanged,
+            [&updateTimes] {
+                updateTimes.append(mixxx::Time::elapsed());
+            });
+    QList<ControllerMappingReplay::Message> messages;
+    messages.append({mixxx::Duration::fromMillis(10), QByteArray("\xb0\x10\x40")});
+    messages.append({mixxx::Duration::fromMillis(250), QByteArray("\xb0\x10\x7f")});
+    replay.replay(messages, ControllerMappingReplay::Clock::Mock);
+
+    const QList<mixxx::Duration> expected = {
+            mixxx::Duration::fromMillis(10),
+            mixxx::Duration::fromMillis(250),
+    };
+    EXPECT_EQ(expected, updateTimes);
+}
+
+// The first message starts a timer that is due before the second message
+const char kTimerScript[] =
+        "var ReplayTimer = {};\n"
+        "ReplayTimer.init = function(id, debugging) {};\n"
+        "ReplayTimer.shutdown = function() {};\n"
+        "ReplayTimer.start = function(channel, control, value, status, group) {\n"
+        "    engine.beginTimer(20, function() {\n"
+        "        engine.setValue(\"[Channel1]\", \"rate\", 1);\n"
+        "    }, true);\n"
+        "};\n"
+        "ReplayTimer.check = function(channel, control, value, status, group) {\n"
+        "    engine.setValue(\"[Channel1]\", \"pregain\",\n"
+        "            engine.getValue(\"[Channel1]\", \"rate\"));\n"
+        "};\n";
+
+TEST_F(ControllerMappingReplayTest, RealTimeRunsTimersBetweenMessages) {
+    QTemporaryDir scriptDir;
+    QFile scriptFile(scriptDir.filePath("ReplayTimer.js"));
+    ASSERT_TRUE(scriptFile.open(QIODevice::WriteOnly | QIODevice::Text));
+    scriptFile.write(kTimerScript);
+    scriptFile.close();
+    MidiControllerPreset preset;
+    preset.addScriptFile(scriptFile.fileName(),
+            "ReplayTimer",
+            QFileInfo(scriptFile.fileName()));
+    MidiOptions options;
+    options.script = true;
+    const MidiKey startKey(MIDI_NOTE_ON, 0x01);
+    const MidiKey checkKey(MIDI_NOTE_ON, 0x02);
+    preset.addInputMapping(startKey.key,
+            MidiInputMapping(startKey,
+                    options,
+                    ConfigKey("[Channel1]", "ReplayTimer.start")));
+    preset.addInputMapping(checkKey.key,
+            MidiInputMapping(checkKey,
+                    options,
+                    ConfigKey("[Channel1]", "ReplayTimer.check")));
+    ControllerMappingReplay replay;
+    QString errorMessage;
+    ASSERT_TRUE(replay.loadPreset(preset, false, &errorMessage))
+            << errorMessage.toStdString();
+
+    QList<ControllerMappingReplay::Message> messages;
+    messages.append({mixxx::Duration::fromMillis(1000), QByteArray("\x90\x01\x7f")});
+    messages.append({mixxx::Duration::fromMillis(1100), QByteArray("\x90\x02\x7f")});
+    PerformanceTimer timer;
+    timer.start();
+    replay.replay(messages, ControllerMappingReplay::Clock::RealTime);
+
+    // Relative to the first message
+    EXPECT_GE(timer.elapsed(), mixxx::Duration::fromMillis(100));
+    EXPECT_EQ(1.0, ControlObject::get(ConfigKey("[Channel1]", "pregain")));
+}
+
+TEST_F(ControllerMappingReplayTest, InvalidCapture) {
+    QString captureText("0.000 b0 10 100\n");
+    QTextStream captureStream(&captureText);
+    QList<ControllerMappingReplay::Message> messages;
+    QString errorMessage;
+    EXPECT_FALSE(ControllerMappingReplay::parseCapture(
+            &captureStream, &messages, &errorMessage));
+    EXPECT_FALSE(errorMessage.isEmpty());
+}
+
+struct ReplayTarget {
+    QString presetFilePath;
+    QString captureFilePath; // synthetic capture if empty
+};
+
+QList<ReplayTarget> replayTargets() {
+    const QString presetFilePath = QString::fromLocal8Bit(qgetenv("MIXXX_REPLAY_PRESET"));
+    if (!presetFilePath.isEmpty()) {
+        return {{presetFilePath, QString::fromLocal8Bit(qgetenv("MIXXX_REPLAY_CAPTURE"))}};
+    }
+    QList<ReplayTarget> targets;
+    const QDir presetsDir(QDir::current().absoluteFilePath("res/controllers"));
+    for (const char* preset : kBenchmarkPresets) {
+        targets.append({presetsDir.absoluteFilePath(preset), QString()});
+    }
+    return targets;
+}
+
+void setDurationCounters(
+        benchmark::State& state,
+        std::vector<mixxx::Duration>* pDurations) {
+    std::sort(pDurations->begin(), pDurations->end());
+    const auto slowMessages = std::count_if(pDurations->begin(),
+            pDurations->end(),
+            [](const mixxx::Duration& duration) {
+                return duration.toDoubleMicros() > kSlowMessageMicros;
+            });
+    state.counters["p50_us"] = mixxxtest::percentileMicros(*pDurations, 0.5);
+    state.counters["p99_us"] = mixxxtest::percentileMicros(*pDurations, 0.99);
+    state.counters["max_us"] = pDurations->back().toDoubleMicros();
+    state.counters["slow"] = static_cast<double>(slowMessages);
+}
+
+// The same jog wheel of deck 1, once with the native scratch options and
+// once with the script functions that mappings usually use for it
+const MidiKey kTouchKey(MIDI_NOTE_ON, 0x20);
+const MidiKey kReleaseKey(MIDI_NOTE_OFF, 0x20);
+const MidiKey kTickKey(MIDI_CC, 0x21);
+
+const char kScratchScript[] =
+        "var ScratchBenchmark = {};\n"
+        "ScratchBenchmark.init = function(id, debugging) {};\n"
+        "ScratchBenchmark.shutdown = function() {};\n"
+        "ScratchBenchmark.wheelTouch = function(channel, control, value, status, group) {\n"
+        "    if ((status & 0xF0) === 0x90 && value > 0) {\n"
+        "        engine.scratchEnable(1, 128, 33 + 1 / 3, 1 / 8, 1 / 8 / 32, true);\n"
+        "    } else {\n"
+        "        engine.scratchDisable(1, true);\n"
+        "    }\n"
+        "};\n"
+        "ScratchBenchmark.wheelTurn = function(channel, control, value, status, group) {\n"
+        "    var interval = value - 64;\n"
+        "    if (engine.isScratching(1)) {\n"
+        "        engine.scratchTick(1, interval);\n"
+        "    } else {\n"
+        "        engine.setValue(group, \"jog\", engine.getValue(group, \"jog\") + interval);\n"
+        "    }\n"
+        "};\n";
+
+bool scratchPreset(bool native,
+        const QTemporaryDir& scriptDir,
+        MidiControllerPreset* pPreset) {
+    MidiOptions touchOptions;
+    MidiOptions tickOptions;
+    ConfigKey touchKey("[Channel1]", "ScratchBenchmark.wheelTouch");
+    ConfigKey tickKey("[Channel1]", "ScratchBenchmark.wheelTurn");
+    if (native) {
+        touchOptions.scratch_touch = true;
+        tickOptions.scratch_tick = true;
+        touchKey.item = "scratch2_enable";
+        tickKey.item = "jog";
+    } else {
+        QFile scriptFile(scriptDir.filePath("ScratchBenchmark.js"));
+        if (!scriptFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            return false;
+        }
+        scriptFile.write(kScratchScript);
+        scriptFile.close();
+        pPreset->addScriptFile(scriptFile.fileName(),
+                "ScratchBenchmark",
+                QFileInfo(scriptFile.fileName()));
+        touchOptions.script = true;
+        tickOptions.script = true;
+    }
+    for (const MidiKey& key : {kTouchKey, kReleaseKey}) {
+        pPreset->addInputMapping(key.key, MidiInputMapping(key, touchOptions, touchKey));
+    }
+    pPreset->addInputMapping(kTickKey.key, MidiInputMapping(kTickKey, tickOptions, tickKey));
+    return true;
+}
+
+// Touches the jog wheel, scratches back and forth and releases it again
+QList<ControllerMappingReplay::Message> scratchCapture(int messageCount) {
+    QList<ControllerMappingReplay::Message> messages;
+    for (int i = 0; i < messageCount; ++i) {
+        ControllerMappingReplay::Message message;
+        message.timestamp = kSyntheticMessageInterval * i;
+        MidiKey key = kTickKey;
+        unsigned char value = (i / 4) % 2 ? 0x3F : 0x41;
+        if (i % 100 == 0) {
+            key = kTouchKey;
+            value = 0x7F;
+        } else if (i % 100 == 99) {
+            key = kReleaseKey;
+            value = 0x00;
+        }
+        message.data.append(static_cast<char>(key.status));
+        message.data.append(static_cast<char>(key.control));
+        message.data.append(static_cast<char>(value));
+        messages.append(message);
+    }
+    return messages;
+}
+
+} // anonymous namespace
+
+// Argument: index of the replayed preset
+static void BM_ControllerMappingReplay(benchmark::State& state) {
+    const ReplayTarget target = replayTargets().value(static_cast<int>(state.range(0)));
+    state.SetLabel(QFileInfo(target.presetFilePath).fileName().toStdString());
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    ControllerMappingReplay replay;
+    QString errorMessage;
+    if (!replay.loadPreset(target.presetFilePath, &errorMessage)) {
+        state.SkipWithError(errorMessage.toLocal8Bit().constData());
+        return;
+    }
+    QList<ControllerMappingReplay::Message> messages;
+    if (target.captureFilePath.isEmpty()) {
+        messages = replay.syntheticCapture(kSyntheticMessageCount);
+    } else if (!ControllerMappingReplay::readCapture(
+                       target.captureFilePath, &messages, &errorMessage)) {
+        state.SkipWithError(errorMessage.toLocal8Bit().constData());
+        return;
+    }
+    if (messages.isEmpty()) {
+        state.SkipWithError("Nothing to replay, HID presets need a capture");
+        return;
+    }
+
+    std::vector<mixxx::Duration> durations;
+    mixxx::Duration garbageCollectionDuration;
+    int controlUpdates = 0;
+    while (state.KeepRunning()) {
+        replay.replay(messages);
+        mixxx::Duration totalDuration;
+        for (const auto& duration : replay.messageDurations()) {
+            totalDuration += duration;
+        }
+        state.SetIterationTime(totalDuration.toDoubleSeconds() / messages.size());
+        durations.insert(durations.end(),
+                replay.messageDurations().begin(),
+                replay.messageDurations().end());
+        garbageCollectionDuration = replay.garbageCollectionDuration();
+        controlUpdates += replay.controlUpdates();
+    }
+    if (durations.empty()) {
+        return;
+    }
+
+    setDurationCounters(state, &durations);
+    state.counters["updates_per_msg"] =
+            static_cast<double>(controlUpdates) / durations.size();
+    state.counters["gc_us"] = garbageCollectionDuration.toDoubleMicros();
+}
+BENCHMARK(BM_ControllerMappingReplay)
+        ->ArgNames({"preset"})
+        ->Apply([](benchmark::internal::Benchmark* pBenchmark) {
+            for (int i = 0; i < replayTargets().size(); ++i) {
+                pBenchmark->Arg(i);
+            }
+        })
+        ->Iterations(1)
+        ->UseManualTime()
+        ->Unit(benchmark::kMicrosecond);
+
+// Argument: 1 for the native scratch options, 0 for script functions
+static void BM_ScratchMapping(benchmark::State& state) {
+    const bool native = state.range(0) != 0;
+    state.SetLabel(native ? "native" : "script");
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    QTemporaryDir scriptDir;
+    MidiControllerPreset preset;
+    if (!scratchPreset(native, scriptDir, &preset)) {
+        state.SkipWithError("Unable to write the script");
+        return;
+    }
+    ControllerMappingReplay replay;
+    QString errorMessage;
+    if (!replay.loadPreset(preset, false, &errorMessage)) {
+        state.SkipWithError(errorMessage.toLocal8Bit().constData());
+        return;
+    }
+    const QList<ControllerMappingReplay::Message> messages =
+            scratchCapture(kSyntheticMessageCount);
+
+    std::vector<mixxx::Duration> durations;
+    while (state.KeepRunning()) {
+        replay.replay(messages);
+        mixxx::Duration totalDuration;
+        for (const auto& duration : replay.messageDurations()) {
+            totalDuration += duration;
+        }
+        state.SetIterationTime(totalDuration.toDoubleSeconds() / messages.size());
+        durations.insert(durations.end(),
+                replay.messageDurations().begin(),
+                replay.messageDurations().end());
+    }
+    if (durations.empty()) {
+        return;
+    }
+    setDurationCounters(state, &durations);
+}
+BENCHMARK(BM_ScratchMapping)
+        ->ArgNames({"native"})
+        ->Arg(0)
+        ->Arg(1)
+        ->Iterations(1)
+        ->UseManualTime()
+        ->Unit(benchmark::kMicrosecond);
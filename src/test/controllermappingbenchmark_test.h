@@ -0,0 +1,123 @@
+#pragma once
+
+#include <QList>
+#include <QSet>
+#include <QTextStream>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "controllers/controller.h"
+#include "controllers/defs_controllers.h"
+#include "controllers/midi/midicontroller.h"
+#include "controllers/midi/midicontrollerpreset.h"
+#include "test/controller_preset_validation_test.h"
+#include "util/duration.h"
+
+class ReplayMidiController : public MidiController {
+    Q_OBJECT
+  public:
+    ReplayMidiController();
+    ~ReplayMidiController() override;
+
+  protected:
+    void sendShortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2) override {
+        Q_UNUSED(status);
+        Q_UNUSED(byte1);
+        Q_UNUSED(byte2);
+    }
+
+  private:
+    void sendBytes(const QByteArray& data) override {
+        Q_UNUSED(data);
+    }
+
+    int open() override {
+        return 0;
+    }
+    int close() override {
+        return 0;
+    }
+};
+
+/// Replays recorded controller input against a controller mapping, i.e. an
+/// XML preset and its scripts. Instead of the engine the mapping is
+/// connected to stand-in controls for all controls that are referenced by
+/// the preset and its scripts. HID presets are loaded into a
+/// FakeController.
+class ControllerMappingReplay {
+  public:
+    struct Message {
+        mixxx::Duration timestamp;
+        QByteArray data;
+    };
+
+    /// How the time between the recorded messages passes during a replay
+    enum class Clock {
+        /// mixxx::Time follows the timestamps of the messages, e.g. for
+        /// soft takeover, but the messages are handled as fast as possible
+        Mock,
+        /// Waits until each message is due, i.e. script timers run between
+        /// the messages like with the device
+        RealTime,
+    };
+
+    /// Parses a capture with one message per line, the timestamp in seconds
+    /// followed by the bytes in hex, e.g. "0.001 b0 22 41". Empty lines and
+    /// lines starting with # are ignored.
+    static bool parseCapture(
+            QTextStream* pStream,
+            QList<Message>* pMessages,
+            QString* pErrorMessage);
+    static bool readCapture(
+            const QString& filePath,
+            QList<Message>* pMessages,
+            QString* pErrorMessage);
+
+    ControllerMappingReplay();
+    ~ControllerMappingReplay();
+
+    bool loadPreset(const QString& presetFilePath, QString* pErrorMessage);
+    bool loadPreset(const ControllerPreset& preset, bool hid, QString* pErrorMessage);
+
+    /// Turns the jog wheels of a MIDI preset back and forth at 1 kHz, or
+    /// all inputs if there is no jog wheel. Empty for HID presets.
+    QList<Message> syntheticCapture(int messageCount) const;
+
+    /// Handles the messages at their timestamps according to the clock.
+    /// Script timers that are due run between the messages.
+    void replay(const QList<Message>& messages, Clock clock = Clock::Mock);
+
+    /// The time for handling each message of the last replay including
+    /// the scripts
+    const std::vector<mixxx::Duration>& messageDurations() const {
+        return m_messageDurations;
+    }
+    /// The number of control value changes caused by the last replay
+    int controlUpdates() const {
+        return m_controlUpdates;
+    }
+    /// The duration of a full garbage collection after the last replay
+    mixxx::Duration garbageCollectionDuration() const {
+        return m_garbageCollectionDuration;
+    }
+
+  private:
+    void addMidiPresetKeys(const MidiControllerPreset& preset);
+    void addScriptKeys(const QString& code);
+    void createControls();
+
+    std::unique_ptr<Controller> m_pController;
+    QSet<QString> m_groups;
+    QSet<QString> m_items;
+    QSet<ConfigKey> m_keys;
+    QList<MidiKey> m_jogKeys;
+    std::vector<std::unique_ptr<ControlObject>> m_controls;
+    QList<QMetaObject::Connection> m_controlConnections;
+
+    std::vector<mixxx::Duration> m_messageDurations;
+    int m_controlUpdates;
+    mixxx::Duration m_garbageCollectionDuration;
+};
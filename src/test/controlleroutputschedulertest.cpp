@@ -0,0 +1,238 @@
+#include "controllers/controlleroutputscheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QThread>
+
+#include "controllers/midi/midicontroller.h"
+#include "controllers/midi/midimessage.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+constexpr int kTimeoutMillis = 5000;
+
+class ControllerOutputSchedulerTest : public MixxxTest {
+  protected:
+    ControllerOutputSchedulerTest()
+            : m_scheduler([this](const QByteArray& message) {
+                  m_sentMessages.append(message);
+              }) {
+    }
+
+    // Processes the frame timer until all pending messages have been sent
+    bool waitUntilSent() {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_scheduler.hasPendingMessages()) {
+            if (timer.elapsed() > kTimeoutMillis) {
+                return false;
+            }
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        }
+        return true;
+    }
+
+    QList<QByteArray> m_sentMessages;
+    ControllerOutputScheduler m_scheduler;
+};
+
+TEST_F(ControllerOutputSchedulerTest, SendsLatestMessagePerKey) {
+    m_scheduler.schedule(1, "a1");
+    m_scheduler.schedule(2, "b1");
+    m_scheduler.schedule(1, "a2");
+    m_scheduler.schedule(1, "a3");
+    EXPECT_TRUE(m_sentMessages.isEmpty());
+
+    ASSERT_TRUE(waitUntilSent());
+    // In the order in which the keys have been scheduled first
+    ASSERT_EQ(2, m_sentMessages.size());
+    EXPECT_EQ(QByteArray("a3"), m_sentMessages[0]);
+    EXPECT_EQ(QByteArray("b1"), m_sentMessages[1]);
+    EXPECT_EQ(2u, m_scheduler.sentMessages());
+    EXPECT_EQ(2u, m_scheduler.suppressedMessages());
+}
+
+TEST_F(ControllerOutputSchedulerTest, FlushSendsImmediately) {
+    m_scheduler.setMaxMessagesPerSecond(1);
+    for (quint32 key = 0; key < 10; ++key) {
+        m_scheduler.schedule(key, QByteArray::number(key));
+    }
+    m_scheduler.flush();
+    EXPECT_FALSE(m_scheduler.hasPendingMessages());
+    ASSERT_EQ(10, m_sentMessages.size());
+    EXPECT_EQ(QByteArray("9"), m_sentMessages.last());
+}
+
+TEST_F(ControllerOutputSchedulerTest, RateLimit) {
+    // 1 message per frame
+    m_scheduler.setMaxMessagesPerSecond(
+            1000 / ControllerOutputScheduler::kFrameIntervalMillis);
+    m_scheduler.schedule(1, "a");
+    m_scheduler.schedule(2, "b");
+    m_scheduler.schedule(3, "c");
+
+    while (m_sentMessages.isEmpty()) {
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    EXPECT_EQ(1, m_sentMessages.size());
+    EXPECT_TRUE(m_scheduler.hasPendingMessages());
+
+    // A pending message is still updated while it waits for the next frame
+    m_scheduler.schedule(3, "c2");
+    ASSERT_TRUE(waitUntilSent());
+    ASSERT_EQ(3, m_sentMessages.size());
+    EXPECT_EQ(QByteArray("c2"), m_sentMessages[2]);
+}
+
+// Records the messages in the order in which they are sent to the device
+class RecordingMidiController : public MidiController {
+  public:
+    int open() override {
+        return 0;
+    }
+    int close() override {
+        return 0;
+    }
+    bool isPolling() const override {
+        return false;
+    }
+
+    static QByteArray shortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2) {
+        QByteArray message(3, 0);
+        message[0] = static_cast<char>(status);
+        message[1] = static_cast<char>(byte1);
+        message[2] = static_cast<char>(byte2);
+        return message;
+    }
+
+    QList<QByteArray> m_sentMessages;
+
+  protected:
+    void sendShortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2) override {
+        m_sentMessages.append(shortMsg(status, byte1, byte2));
+    }
+    void sendBytes(const QByteArray& data) override {
+        m_sentMessages.append(data);
+    }
+};
+
+class MidiControllerOutputSchedulerTest : public MixxxTest {
+  protected:
+    MidiControllerOutputSchedulerTest()
+            : m_proxy(&m_controller) {
+    }
+
+    bool waitUntilSent() {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_controller.outputScheduler().hasPendingMessages()) {
+            if (timer.elapsed() > kTimeoutMillis) {
+                return false;
+            }
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        }
+        return true;
+    }
+
+    static QByteArray shortMsg(unsigned char status,
+            unsigned char byte1,
+            unsigned char byte2) {
+        return RecordingMidiController::shortMsg(status, byte1, byte2);
+    }
+
+    RecordingMidiController m_controller;
+    MidiControllerJSProxy m_proxy;
+};
+
+TEST_F(MidiControllerOutputSchedulerTest, KeysByNoteControlAndChannel) {
+    // Note on and note off of the same note replace each other
+    m_proxy.scheduleShortMsg(MIDI_NOTE_ON | 0x01, 0x10, 0x7F);
+    m_proxy.scheduleShortMsg(MIDI_NOTE_OFF | 0x01, 0x10, 0x00);
+    // Another note and the same note on another channel do not
+    m_proxy.scheduleShortMsg(MIDI_NOTE_ON | 0x01, 0x11, 0x7F);
+    m_proxy.scheduleShortMsg(MIDI_NOTE_ON | 0x02, 0x10, 0x7F);
+    // Controls are keyed by their number
+    m_proxy.scheduleShortMsg(MIDI_CC | 0x01, 0x07, 0x10);
+    m_proxy.scheduleShortMsg(MIDI_CC | 0x01, 0x08, 0x20);
+    m_proxy.scheduleShortMsg(MIDI_CC | 0x01, 0x07, 0x30);
+    // The pitch bend of a channel has no number, the data bytes are the value
+    m_proxy.scheduleShortMsg(MIDI_PITCH_BEND | 0x01, 0x00, 0x40);
+    m_proxy.scheduleShortMsg(MIDI_PITCH_BEND | 0x01, 0x7F, 0x7F);
+    m_proxy.scheduleShortMsg(MIDI_PITCH_BEND | 0x02, 0x00, 0x00);
+    EXPECT_TRUE(m_controller.m_sentMessages.isEmpty());
+
+    ASSERT_TRUE(waitUntilSent());
+    const QList<QByteArray> expected = {
+            shortMsg(MIDI_NOTE_OFF | 0x01, 0x10, 0x00),
+            shortMsg(MIDI_NOTE_ON | 0x01, 0x11, 0x7F),
+            shortMsg(MIDI_NOTE_ON | 0x02, 0x10, 0x7F),
+            shortMsg(MIDI_CC | 0x01, 0x07, 0x30),
+            shortMsg(MIDI_CC | 0x01, 0x08, 0x20),
+            shortMsg(MIDI_PITCH_BEND | 0x01, 0x7F, 0x7F),
+            shortMsg(MIDI_PITCH_BEND | 0x02, 0x00, 0x00),
+    };
+    EXPECT_EQ(expected, m_controller.m_sentMessages);
+}
+
+TEST_F(MidiControllerOutputSchedulerTest, ProgramChangeFlushesScheduledMessages) {
+    m_proxy.scheduleShortMsg(MIDI_NOTE_ON, 0x10, 0x7F);
+    m_proxy.scheduleShortMsg(MIDI_CC, 0x07, 0x10);
+    // Not a state update and sent immediately, after the pending messages
+    m_proxy.scheduleShortMsg(MIDI_PROGRAM_CH, 0x05, 0x00);
+    EXPECT_FALSE(m_controller.outputScheduler().hasPendingMessages());
+    const QList<QByteArray> expected = {
+            shortMsg(MIDI_NOTE_ON, 0x10, 0x7F),
+            shortMsg(MIDI_CC, 0x07, 0x10),
+            shortMsg(MIDI_PROGRAM_CH, 0x05, 0x00),
+    };
+    EXPECT_EQ(expected, m_controller.m_sentMessages);
+}
+
+TEST_F(MidiControllerOutputSchedulerTest, SysexFlushesScheduledMessages) {
+    m_proxy.scheduleShortMsg(MIDI_CC, 0x07, 0x10);
+    m_proxy.sendSysexMsg({0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7});
+    EXPECT_FALSE(m_controller.outputScheduler().hasPendingMessages());
+    ASSERT_EQ(2, m_controller.m_sentMessages.size());
+    EXPECT_EQ(shortMsg(MIDI_CC, 0x07, 0x10), m_controller.m_sentMessages[0]);
+    EXPECT_EQ(QByteArray("\xF0\x7E\x7F\x06\x01\xF7"),
+            m_controller.m_sentMessages[1]);
+}
+
+TEST_F(MidiControllerOutputSchedulerTest, ScriptMessagesAreSentInOrder) {
+    // Pending feedback is sent first
+    m_proxy.scheduleShortMsg(MIDI_CC, 0x06, 0x7F);
+    // An NRPN sequence writes the same controls repeatedly. Each message
+    // has to be sent, in the order of the calls.
+    const QList<QByteArray> nrpn = {
+            shortMsg(MIDI_CC, 0x63, 0x01),
+            shortMsg(MIDI_CC, 0x62, 0x02),
+            shortMsg(MIDI_CC, 0x06, 0x10),
+            shortMsg(MIDI_CC, 0x26, 0x00),
+            shortMsg(MIDI_CC, 0x63, 0x01),
+            shortMsg(MIDI_CC, 0x62, 0x03),
+            shortMsg(MIDI_CC, 0x06, 0x20),
+            shortMsg(MIDI_CC, 0x26, 0x00),
+    };
+    for (const auto& message : nrpn) {
+        m_proxy.sendShortMsg(static_cast<unsigned char>(message[0]),
+                static_cast<unsigned char>(message[1]),
+                static_cast<unsigned char>(message[2]));
+    }
+    EXPECT_FALSE(m_controller.outputScheduler().hasPendingMessages());
+    QList<QByteArray> expected = {shortMsg(MIDI_CC, 0x06, 0x7F)};
+    expected.append(nrpn);
+    EXPECT_EQ(expected, m_controller.m_sentMessages);
+}
+
+} // namespace
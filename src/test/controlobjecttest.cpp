@@ -1,8 +1,16 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
+
+#include <QThread>
 #include <QtDebug>
+#include <atomic>
+#include <thread>
 
 #include "control/controlobject.h"
+#include "control/controlproxy.h"
+#include "util/math.h"
 #include "util/memory.h"
+#include "test/benchmarkutil.h"
 #include "test/mixxxtest.h"
 
 namespace {
@@ -36,6 +44,20 @@ TEST_F(ControlObjectTest, getControl) {
             (ControlObject*)nullptr);
 }
 
+TEST_F(ControlObjectTest, getControlOfRecreatedControl) {
+    // Enough lookups to publish a snapshot of all controls
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(ControlObject::getControl(ck1), co1.get());
+    }
+    co1.reset();
+    EXPECT_EQ(ControlObject::getControl(ck1, ControlFlag::NoAssertIfMissing),
+            (ControlObject*)nullptr);
+    co1 = std::make_unique<ControlObject>(ck1);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(ControlObject::getControl(ck1), co1.get());
+    }
+}
+
 TEST_F(ControlObjectTest, AliasRetrieval) {
     ConfigKey ck("[Microphone1]", "volume");
     ConfigKey ckAlias("[Microphone]", "volume");
@@ -85,4 +107,219 @@ TEST_F(ControlObjectTest, Persistence_ValidValue) {
     EXPECT_DOUBLE_EQ(5.0, co.get());
 }
 
+TEST_F(ControlObjectTest, CoalescedValueChanges) {
+    ControlProxy proxy(ck1);
+    int autoCount = 0;
+    double autoValue = 0.0;
+    proxy.connectValueChanged(&proxy, [&](double value) {
+        ++autoCount;
+        autoValue = value;
+    });
+    ControlProxy directProxy(ck1);
+    std::atomic<int> directCount(0);
+    directProxy.connectValueChanged(&directProxy, [&](double) {
+        ++directCount;
+    }, Qt::DirectConnection);
+
+    // Simulate the audio thread
+    std::thread engineThread([this] {
+        ScopedCoalescedValueChanges coalescedValueChanges;
+        co1->set(1.0);
+        co1->set(2.0);
+        co1->set(3.0);
+    });
+    engineThread.join();
+    application()->processEvents();
+
+    // Direct connections are notified immediately
+    EXPECT_EQ(3, directCount.load());
+    EXPECT_EQ(0, autoCount);
+
+    // Only the latest value is delivered
+    EXPECT_EQ(1, ControlDoublePrivate::drainCoalescedValueChanges());
+    EXPECT_EQ(1, autoCount);
+    EXPECT_DOUBLE_EQ(3.0, autoValue);
+    EXPECT_EQ(0, ControlDoublePrivate::drainCoalescedValueChanges());
+
+    // Changes from other threads are not deferred
+    co1->set(4.0);
+    EXPECT_EQ(2, autoCount);
+    EXPECT_DOUBLE_EQ(4.0, autoValue);
+}
+
+TEST_F(ControlObjectTest, CoalescedValueChangesOfDeletedControl) {
+    auto pProxy = std::make_unique<ControlProxy>(ck2);
+    pProxy->connectValueChanged(pProxy.get(), [](double) {});
+    auto pProxy1 = std::make_unique<ControlProxy>(ck1);
+    int count1 = 0;
+    pProxy1->connectValueChanged(pProxy1.get(), [&count1](double) {
+        ++count1;
+    });
+
+    std::thread engineThread([this] {
+        ScopedCoalescedValueChanges coalescedValueChanges;
+        co1->set(1.0);
+        co2->set(1.0);
+    });
+    engineThread.join();
+
+    // Deleting a control must unlink it from the pending changes
+    pProxy.reset();
+    co2.reset();
+    EXPECT_EQ(1, ControlDoublePrivate::drainCoalescedValueChanges());
+    EXPECT_EQ(1, count1);
+}
+
+TEST_F(ControlObjectTest, ValueChangesReachControllerThreadUncoalesced) {
+    // Like the controller thread, which receives the changes of the engine
+    // with queued connections and must not miss short pulses
+    QThread controllerThread;
+    controllerThread.start();
+    auto* pProxy = new ControlProxy(ck1);
+    pProxy->moveToThread(&controllerThread);
+    std::atomic<int> count(0);
+    std::atomic<double> lastValue(0.0);
+    pProxy->connectValueChanged(pProxy, [&](double value) {
+        lastValue.store(value);
+        ++count;
+    }, Qt::QueuedConnection);
+
+    std::thread engineThread([this] {
+        ScopedCoalescedValueChanges coalescedValueChanges;
+        co1->set(1.0);
+        co1->set(0.0);
+        for (int i = 1; i <= 10; ++i) {
+            co1->set(i);
+        }
+    });
+    engineThread.join();
+    // Delivered without waiting for the next frame of the GUI
+    EXPECT_EQ(0, ControlDoublePrivate::drainCoalescedValueChanges());
+
+    for (int i = 0; i < 1000 && count.load() < 12; ++i) {
+        QThread::msleep(1);
+    }
+    // The pulse and all intermediate values arrive
+    EXPECT_EQ(12, count.load());
+    EXPECT_DOUBLE_EQ(10.0, lastValue.load());
+
+    pProxy->deleteLater();
+    controllerThread.quit();
+    controllerThread.wait();
+}
+
+// Counts the queued signals that are delivered to the objects of the main
+// thread. The thread that emits a queued signal allocates an event with a
+// copy of the arguments for each of them.
+class QueuedSignalCounter : public QObject {
+  public:
+    bool eventFilter(QObject* pObject, QEvent* pEvent) override {
+        if (pEvent->type() == QEvent::MetaCall) {
+            ++m_count;
+        }
+        return QObject::eventFilter(pObject, pEvent);
+    }
+
+    long count() const {
+        return m_count;
+    }
+
+  private:
+    long m_count = 0;
+};
+
+} // anonymous namespace
+
+// Simulates audio callbacks that change a typical set of controls of 8 decks,
+// e.g. playposition, VU meters, beat_active, while the GUI listens to them
+// with auto connections. Reports the queued signals, i.e. the heap allocations
+// of the audio thread for them, per callback with and without coalescing the
+// change notifications.
+static void BM_EngineCallbackControlChanges(benchmark::State& state) {
+    const bool coalesce = state.range(0) != 0;
+    constexpr int kDecks = 8;
+    constexpr int kControlsPerDeck = 32;
+    constexpr int kCallbacksPerIteration = 100;
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    std::vector<std::unique_ptr<ControlObject>> controls;
+    std::vector<std::unique_ptr<ControlProxy>> proxies;
+    for (int deck = 1; deck <= kDecks; ++deck) {
+        const QString group = QStringLiteral("[Channel%1]").arg(deck);
+        for (int i = 0; i < kControlsPerDeck; ++i) {
+            const ConfigKey key(group, QStringLiteral("control%1").arg(i));
+            controls.push_back(std::make_unique<ControlObject>(key));
+            proxies.push_back(std::make_unique<ControlProxy>(key));
+            proxies.back()->connectValueChanged(proxies.back().get(), [](double value) {
+                benchmark::DoNotOptimize(value);
+            });
+        }
+    }
+
+    QueuedSignalCounter queuedSignals;
+    QCoreApplication::instance()->installEventFilter(&queuedSignals);
+    long callbacks = 0;
+    double value = 0.0;
+    while (state.KeepRunning()) {
+        std::thread engineThread([&] {
+            if (coalesce) {
+                ControlDoublePrivate::setCoalesceValueChanges(true);
+            }
+            for (int callback = 0; callback < kCallbacksPerIteration; ++callback) {
+                value += 1.0;
+                for (const auto& pControl : controls) {
+                    pControl->set(value);
+                }
+            }
+            ControlDoublePrivate::setCoalesceValueChanges(false);
+        });
+        engineThread.join();
+        callbacks += kCallbacksPerIteration;
+
+        // Deliver all changes like the GUI does once per frame
+        ControlDoublePrivate::drainCoalescedValueChanges();
+        QCoreApplication::processEvents();
+    }
+    QCoreApplication::instance()->removeEventFilter(&queuedSignals);
+    state.counters["queued_signals_per_callback"] =
+            static_cast<double>(queuedSignals.count()) / math_max(1L, callbacks);
+    state.SetItemsProcessed(callbacks * controls.size());
+}
+BENCHMARK(BM_EngineCallbackControlChanges)->Arg(0)->Arg(1);
+
+// Resolves 100k keys of existing controls like skins and controller mappings
+// do, concurrently from the given number of threads.
+static void BM_ControlLookup(benchmark::State& state) {
+    const int threadCount = static_cast<int>(state.range(0));
+    constexpr int kDecks = 8;
+    constexpr int kControlsPerDeck = 256;
+    constexpr int kLookupsPerThread = 100000;
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    std::vector<std::unique_ptr<ControlObject>> controls;
+    std::vector<ConfigKey> keys;
+    for (int deck = 1; deck <= kDecks; ++deck) {
+        const QString group = QStringLiteral("[Channel%1]").arg(deck);
+        for (int i = 0; i < kControlsPerDeck; ++i) {
+            keys.push_back(ConfigKey(group, QStringLiteral("control%1").arg(i)));
+            controls.push_back(std::make_unique<ControlObject>(keys.back()));
+        }
+    }
+
+    while (state.KeepRunning()) {
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < threadCount; ++thread) {
+            threads.emplace_back([&keys, thread] {
+                for (int i = 0; i < kLookupsPerThread; ++i) {
+                    const auto& key = keys[(i + thread * 97) % keys.size()];
+                    benchmark::DoNotOptimize(ControlObject::getControl(key));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * threadCount * kLookupsPerThread);
 }
+BENCHMARK(BM_ControlLookup)->Arg(1)->Arg(4)->UseRealTime();
@@ -1,7 +1,14 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QFile>
 #include <QFileInfo>
+#include <QTemporaryDir>
+#include <limits>
 
 #include "library/coverartcache.h"
+#include "library/coverartthumbnailcache.h"
 #include "library/coverartutils.h"
 #include "library/trackcollection.h"
 #include "test/librarytest.h"
@@ -82,3 +89,132 @@ TEST_F(CoverArtCacheTest, loadCoverFromFileRelative) {
 TEST_F(CoverArtCacheTest, loadCoverFromFileAbsolute) {
     loadCoverFromFile(QString(), kCoverLocationTest, kCoverLocationTest);
 }
+
+TEST_F(CoverArtCacheTest, loadCoverFromThumbnailCache) {
+    const auto pThumbnailCache = std::make_shared<const CoverArtThumbnailCache>(
+            QDir(getTestDataDir().filePath("thumbnails")));
+    const int width = 100;
+
+    CoverInfo info;
+    info.type = CoverInfo::FILE;
+    info.source = CoverInfo::GUESSED;
+    info.coverLocation = kCoverLocationTest;
+    EXPECT_FALSE(CoverArtThumbnailCache::isCacheable(info, width));
+
+    // The first request decodes the original image and stores the thumbnail
+    const auto res = CoverArtCache::loadCover(
+            nullptr, TrackPointer(), info, width, false, pThumbnailCache);
+    EXPECT_TRUE(res.coverInfoUpdated);
+    EXPECT_EQ(width, res.coverArt.loadedImage.image.width());
+    const CoverInfo updatedInfo = res.coverArt;
+    EXPECT_TRUE(CoverArtThumbnailCache::isCacheable(updatedInfo, width));
+    EXPECT_TRUE(QFileInfo::exists(pThumbnailCache->filePath(updatedInfo, width)));
+
+    // The second request is served from the thumbnail cache
+    const auto cachedRes = CoverArtCache::loadCover(
+            nullptr, TrackPointer(), updatedInfo, width, false, pThumbnailCache);
+    EXPECT_FALSE(cachedRes.coverInfoUpdated);
+    EXPECT_EQ(pThumbnailCache->filePath(updatedInfo, width),
+            cachedRes.coverArt.loadedImage.filePath);
+    EXPECT_EQ(res.coverArt.loadedImage.image.convertToFormat(QImage::Format_ARGB32),
+            cachedRes.coverArt.loadedImage.image.convertToFormat(QImage::Format_ARGB32));
+
+    // Thumbnails of other sizes are not affected
+    EXPECT_TRUE(pThumbnailCache->load(updatedInfo, width / 2).isNull());
+
+    EXPECT_EQ(0, pThumbnailCache->purge(std::numeric_limits<qint64>::max()));
+    EXPECT_EQ(1, pThumbnailCache->purge(0));
+    EXPECT_TRUE(pThumbnailCache->load(updatedInfo, width).isNull());
+}
+
+TEST_F(CoverArtCacheTest, replaceThumbnailOfModifiedImage) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const auto pThumbnailCache = std::make_shared<const CoverArtThumbnailCache>(
+            QDir(tempDir.filePath("thumbnails")));
+    const int width = 100;
+    const QString coverLocation = tempDir.filePath(kCoverFileTest);
+    ASSERT_TRUE(QFile::copy(kCoverLocationTest, coverLocation));
+
+    CoverInfo info;
+    info.type = CoverInfo::FILE;
+    info.source = CoverInfo::GUESSED;
+    info.coverLocation = coverLocation;
+    const auto res = CoverArtCache::loadCover(
+            nullptr, TrackPointer(), info, width, false, pThumbnailCache);
+    const CoverInfo storedInfo = res.coverArt;
+    ASSERT_TRUE(QFileInfo::exists(pThumbnailCache->filePath(storedInfo, width)));
+    EXPECT_FALSE(pThumbnailCache->load(storedInfo, width).isNull());
+
+    // Modify the image without updating the digest of the track
+    const QImage modifiedImage = QImage(coverLocation).mirrored(true, false);
+    ASSERT_TRUE(modifiedImage.save(coverLocation, "PNG"));
+    {
+        QFile file(coverLocation);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(
+                QDateTime::currentDateTime().addSecs(10),
+                QFileDevice::FileModificationTime));
+    }
+    EXPECT_TRUE(pThumbnailCache->load(storedInfo, width).isNull());
+
+    // The original image is loaded again and the thumbnail is stored
+    // with the new digest
+    const auto modifiedRes = CoverArtCache::loadCover(
+            nullptr, TrackPointer(), storedInfo, width, false, pThumbnailCache);
+    EXPECT_TRUE(modifiedRes.coverInfoUpdated);
+    const CoverInfo modifiedInfo = modifiedRes.coverArt;
+    EXPECT_EQ(CoverImageUtils::calculateDigest(QImage(coverLocation)),
+            modifiedInfo.imageDigest());
+    EXPECT_NE(storedInfo.imageDigest(), modifiedInfo.imageDigest());
+    EXPECT_TRUE(QFileInfo::exists(pThumbnailCache->filePath(modifiedInfo, width)));
+}
+
+// Simulates scrolling through the library with the cover art column
+// visible, i.e. repeatedly loading small covers after they have been
+// evicted from the in-memory pixmap cache. Argument 0 decodes and
+// scales the original images, argument 1 reads persistent thumbnails.
+static void BM_CoverArtScrollLibrary(benchmark::State& state) {
+    const bool useThumbnailCache = state.range(0) != 0;
+    constexpr int kCoverWidth = 64;
+
+    QTemporaryDir tempDir;
+    CoverArtThumbnailCachePointer pThumbnailCache;
+    if (useThumbnailCache) {
+        pThumbnailCache = std::make_shared<const CoverArtThumbnailCache>(
+                QDir(tempDir.path()));
+    }
+
+    const QDir testDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+    QList<CoverInfo> coverInfos;
+    for (const auto& fileName : {"cover-test-jpg.mp3", "cover-test-png.mp3", "cover-test.flac"}) {
+        CoverInfo info;
+        info.type = CoverInfo::METADATA;
+        info.source = CoverInfo::GUESSED;
+        info.trackLocation = testDir.absoluteFilePath(fileName);
+        info.refreshImageDigest();
+        coverInfos.append(info);
+    }
+    {
+        CoverInfo info;
+        info.type = CoverInfo::FILE;
+        info.source = CoverInfo::GUESSED;
+        info.coverLocation = testDir.absoluteFilePath(kCoverFileTest);
+        info.refreshImageDigest();
+        coverInfos.append(info);
+    }
+    // Warm up the thumbnail cache
+    for (const auto& info : qAsConst(coverInfos)) {
+        CoverArtCache::loadCover(
+                nullptr, TrackPointer(), info, kCoverWidth, false, pThumbnailCache);
+    }
+
+    while (state.KeepRunning()) {
+        for (const auto& info : qAsConst(coverInfos)) {
+            benchmark::DoNotOptimize(CoverArtCache::loadCover(
+                    nullptr, TrackPointer(), info, kCoverWidth, false, pThumbnailCache));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * coverInfos.size());
+}
+BENCHMARK(BM_CoverArtScrollLibrary)->Arg(0)->Arg(1);
@@ -1,3 +1,4 @@
+#include <benchmark/benchmark.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -79,6 +80,10 @@ class EngineBufferScaleLinearTest : public MixxxTest {
                 1.0, &tempoRatio, &pitchRatio);
     }
 
+    void SetInterpolation(EngineBufferScaleLinear::Interpolation interpolation) {
+        m_pScaler->setInterpolation(interpolation);
+    }
+
     void SetRateNoLerp(double rate) {
         // Set it twice to prevent rate LERP'ing
         SetRate(rate);
@@ -296,4 +301,136 @@ TEST_F(EngineBufferScaleLinearTest, TestRepeatedScaleCalls) {
     SampleUtil::free(pOutput);
 }
 
+TEST_F(EngineBufferScaleLinearTest, CubicInterpolationIsMoreAccurate) {
+    // One period of a sine with 64 frames, the same on both channels
+    const int kPeriodFrames = 64;
+    QVector<CSAMPLE> readBuffer;
+    for (int i = 0; i < kPeriodFrames; ++i) {
+        const CSAMPLE value = static_cast<CSAMPLE>(sin(2 * M_PI * i / kPeriodFrames));
+        readBuffer.push_back(value);
+        readBuffer.push_back(value);
+    }
+
+    EXPECT_CALL(*m_pReadAheadMock, getNextSamples(_, _, _))
+            .WillRepeatedly(Invoke(m_pReadAheadMock, &ReadAheadManagerMock::getNextSamplesFake));
+
+    const double kRate = 0.7;
+    const int kBufferSize = 1024;
+    CSAMPLE* pOutput = SampleUtil::alloc(kBufferSize);
+    double maxError[2] = {0.0, 0.0};
+    for (int cubic = 0; cubic < 2; ++cubic) {
+        m_pReadAheadMock->setReadBuffer(readBuffer.data(), readBuffer.size());
+        m_pScaler->clear();
+        SetInterpolation(cubic ? EngineBufferScaleLinear::Interpolation::Cubic
+                               : EngineBufferScaleLinear::Interpolation::Linear);
+        SetRateNoLerp(kRate);
+        double position = 0.0;
+        // The buffer boundaries of the read ahead manager are crossed many
+        // times, they must not add any errors.
+        for (int i = 0; i < 20; ++i) {
+            m_pScaler->scaleBuffer(pOutput, kBufferSize);
+            for (int frame = 0; frame < kBufferSize / 2; ++frame) {
+                const double expected = sin(2 * M_PI * position / kPeriodFrames);
+                EXPECT_FLOAT_EQ(pOutput[frame * 2], pOutput[frame * 2 + 1]);
+                // The taps before the start are silence
+                if (position >= 2.0) {
+                    maxError[cubic] = math_max(maxError[cubic],
+                            fabs(pOutput[frame * 2] - expected));
+                }
+                position += kRate;
+            }
+        }
+    }
+    EXPECT_LT(maxError[0], 2e-3);
+    EXPECT_LT(maxError[1], 1e-4);
+    EXPECT_LT(maxError[1], maxError[0] / 10);
+
+    SampleUtil::free(pOutput);
+}
+
+TEST_F(EngineBufferScaleLinearTest, FixedPointPhaseDoesNotDrift) {
+    CSAMPLE readBuffer[] = { 1.0f, -1.0f };
+    m_pReadAheadMock->setReadBuffer(readBuffer, 2);
+
+    EXPECT_CALL(*m_pReadAheadMock, getNextSamples(_, _, _))
+            .WillRepeatedly(Invoke(m_pReadAheadMock, &ReadAheadManagerMock::getNextSamplesFake));
+
+    // A rate that is not exactly representable
+    const double kRate = 1.0 / 3.0;
+    const int kBufferSize = 512;
+    const int kBuffers = 3000;
+    SetRateNoLerp(kRate);
+    CSAMPLE* pOutput = SampleUtil::alloc(kBufferSize);
+    double framesRead = 0;
+    for (int i = 0; i < kBuffers; ++i) {
+        framesRead += m_pScaler->scaleBuffer(pOutput, kBufferSize);
+    }
+    // Only the frames read ahead for the next position may differ
+    const double expectedFrames = kRate * kBuffers * kBufferSize / 2;
+    EXPECT_NEAR(expectedFrames, framesRead, 2.0);
+    EXPECT_EQ(framesRead * 2, m_pReadAheadMock->getSamplesRead());
+
+    SampleUtil::free(pOutput);
+}
+
+class ReadAheadManagerFake : public ReadAheadManager {
+  public:
+    ReadAheadManagerFake()
+            : ReadAheadManager(),
+              m_readPosition(0) {
+        for (int i = 0; i < kiLinearScaleReadAheadLength; ++i) {
+            m_buffer.push_back(static_cast<CSAMPLE>(sin(i * 0.01)));
+        }
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples) override {
+        Q_UNUSED(dRate);
+        for (SINT i = 0; i < requested_samples; ++i) {
+            buffer[i] = m_buffer[m_readPosition++ % m_buffer.size()];
+        }
+        return requested_samples;
+    }
+
+  private:
+    QVector<CSAMPLE> m_buffer;
+    SINT m_readPosition;
+};
+
 }  // namespace
+
+// Arguments: the rate in quarters, the buffer size in frames and whether
+// cubic interpolation is used.
+static void BM_ScaleLinear(benchmark::State& state) {
+    const double rate = state.range(0) / 4.0;
+    const SINT bufferSize = state.range(1) * 2;
+    ReadAheadManagerFake readAheadManager;
+    EngineBufferScaleLinear scaler(&readAheadManager);
+    scaler.setSampleRate(mixxx::audio::SampleRate(44100));
+    scaler.setInterpolation(state.range(2)
+                    ? EngineBufferScaleLinear::Interpolation::Cubic
+                    : EngineBufferScaleLinear::Interpolation::Linear);
+    // Twice to prevent rate LERP'ing
+    for (int i = 0; i < 2; ++i) {
+        double tempoRatio = rate;
+        double pitchRatio = rate;
+        scaler.setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    CSAMPLE* pOutput = SampleUtil::alloc(bufferSize);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(scaler.scaleBuffer(pOutput, bufferSize));
+    }
+    state.SetItemsProcessed(state.iterations() * (bufferSize / 2));
+    SampleUtil::free(pOutput);
+}
+BENCHMARK(BM_ScaleLinear)
+        ->ArgNames({"rate/4", "frames", "cubic"})
+        ->Apply([](benchmark::internal::Benchmark* pBenchmark) {
+            for (int rate : {-16, -8, -4, -1, 1, 3, 4, 5, 8, 16}) {
+                for (int frames : {256, 1024}) {
+                    for (int cubic = 0; cubic <= 1; ++cubic) {
+                        pBenchmark->Args({rate, frames, cubic});
+                    }
+                }
+            }
+        });
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "engine/bufferscalers/enginebufferscalerubberband.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+
+// Long enough for the impulse to pass the delay of the stretcher
+constexpr SINT kOutputFrames = 16384;
+constexpr SINT kBufferFrames = 512;
+
+// Provides an impulse at the first frame that is read after a seek followed
+// by silence. The preroll is silent, because there is no CachingReader.
+class ImpulseReadAheadManager : public ReadAheadManager {
+  public:
+    ImpulseReadAheadManager()
+            : m_impulsePending(true) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* pBuffer, SINT requestedSamples) override {
+        Q_UNUSED(dRate);
+        SampleUtil::clear(pBuffer, requestedSamples);
+        if (m_impulsePending && requestedSamples >= 2) {
+            pBuffer[0] = 1.0f;
+            pBuffer[1] = 1.0f;
+            m_impulsePending = false;
+        }
+        return requestedSamples;
+    }
+
+    void seek() {
+        m_impulsePending = true;
+    }
+
+  private:
+    bool m_impulsePending;
+};
+
+class EngineBufferScaleRubberBandTest : public MixxxTest {
+  protected:
+    EngineBufferScaleRubberBandTest()
+            : m_preroll(ConfigKey("[Master]", "keylock_preroll")),
+              m_crossfade(ConfigKey("[Master]", "keylock_crossfade")),
+              m_scaler(&m_readAheadManager) {
+        m_scaler.setSampleRate(mixxx::audio::SampleRate(kSampleRate));
+        m_scaler.allocateBuffers();
+        double tempoRatio = 1.05;
+        double pitchRatio = 1.0;
+        m_scaler.setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    // Seeks and returns the output frame with the largest amplitude
+    SINT seekAndFindImpulse() {
+        m_scaler.clear();
+        m_readAheadManager.seek();
+        std::vector<CSAMPLE> output(kOutputFrames * 2);
+        for (SINT frame = 0; frame < kOutputFrames; frame += kBufferFrames) {
+            m_scaler.scaleBuffer(&output[frame * 2], kBufferFrames * 2);
+        }
+        SINT impulseFrame = 0;
+        CSAMPLE impulseAbs = 0;
+        for (SINT frame = 0; frame < kOutputFrames; ++frame) {
+            if (std::abs(output[frame * 2]) > impulseAbs) {
+                impulseAbs = std::abs(output[frame * 2]);
+                impulseFrame = frame;
+            }
+        }
+        EXPECT_GT(impulseAbs, 0.0f);
+        return impulseFrame;
+    }
+
+    ControlObject m_preroll;
+    ControlObject m_crossfade;
+    ImpulseReadAheadManager m_readAheadManager;
+    EngineBufferScaleRubberBand m_scaler;
+};
+
+TEST_F(EngineBufferScaleRubberBandTest, ReportedLatencyMatchesDelayWithoutPreroll) {
+    m_preroll.set(0.0);
+    m_crossfade.set(0.0);
+    const double latency = m_scaler.getLatencyFrames();
+    ASSERT_GT(latency, 0.0);
+
+    EXPECT_NEAR(latency, seekAndFindImpulse(), latency / 8);
+}
+
+TEST_F(EngineBufferScaleRubberBandTest, PrerollAlignsOutputWithSeekPosition) {
+    m_preroll.set(1.0);
+    m_crossfade.set(0.0);
+    const double latency = m_scaler.getLatencyFrames();
+    ASSERT_GT(latency, 0.0);
+
+    // The first output frame belongs to the seek position, not to the
+    // delay of the stretcher or the preroll
+    EXPECT_LT(seekAndFindImpulse(), latency / 8);
+    // Also when seeking again during playback
+    EXPECT_LT(seekAndFindImpulse(), latency / 8);
+}
+
+} // anonymous namespace
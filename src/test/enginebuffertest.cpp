@@ -4,14 +4,19 @@
 #include <gmock/gmock.h>
 #include <QtDebug>
 #include <QTest>
+#include <cmath>
 
 #include "mixer/basetrackplayer.h"
 #include "preferences/usersettings.h"
 #include "control/controlobject.h"
+#include "engine/cachingreader/cachingreader.h"
+#include "engine/cachingreader/residentsample.h"
 #include "test/mockedenginebackendtest.h"
 #include "test/mixxxtest.h"
 #include "test/signalpathtest.h"
 #include "engine/controls/ratecontrol.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
 
 // In case any of the test in this file fail. You can use the audioplot.py tool
 // in the tools folder to visually compare the results of the enginebuffer
@@ -389,6 +394,134 @@ TEST_F(EngineBufferE2ETest, RubberbandReverseTest) {
     // on the uses library version
 }
 
+TEST_F(EngineBufferE2ETest, RubberbandPrerollCrossfadeSeekTest) {
+    // Seeking with a primed stretcher and a crossfade between both
+    // stretchers must produce audio right after the seek. The alignment
+    // of the output with the seek position is covered by
+    // EngineBufferScaleRubberBandTest.
+    ControlObject::set(ConfigKey("[Master]", "keylock_engine"),
+                       static_cast<double>(EngineBuffer::RUBBERBAND));
+    ControlObject::set(ConfigKey("[Master]", "keylock_preroll"), 1.0);
+    ControlObject::set(ConfigKey("[Master]", "keylock_crossfade"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup1, "keylock"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup1, "rate"), 0.05);
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    ProcessBuffer();
+    ProcessBuffer();
+    m_pChannel1->getEngineBuffer()->queueNewPlaypos(10000,
+                                                    EngineBuffer::SEEK_EXACT);
+    ProcessBuffer();
+    const CSAMPLE* pBuffer = m_pEngineMaster->masterBuffer();
+    CSAMPLE_GAIN maxAbs = 0;
+    for (int i = 0; i < kProcessBufferSize; ++i) {
+        ASSERT_TRUE(std::isfinite(pBuffer[i]));
+        maxAbs = math_max(maxAbs, std::abs(pBuffer[i]));
+    }
+    EXPECT_GT(maxAbs, 0.0f);
+    // The fade has been completed within the previous buffer. Seeking
+    // again swaps the stretchers back.
+    m_pChannel1->getEngineBuffer()->queueNewPlaypos(20000,
+                                                    EngineBuffer::SEEK_EXACT);
+    ProcessBuffer();
+    ProcessBuffer();
+    // The RealTime stretcher delays the output by a few thousand frames
+    const double latencyMillis =
+            ControlObject::get(ConfigKey(m_sGroup1, "keylock_latency"));
+    EXPECT_GT(latencyMillis, 0.0);
+    EXPECT_LT(latencyMillis, 200.0);
+    EXPECT_GT(ControlObject::get(ConfigKey(m_sGroup1, "keylock_usage")), 0.0);
+
+    // The indicators are updated while paused. Each update covers at
+    // least 1/30 s, i.e. 3 buffers.
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 0.0);
+    for (int i = 0; i < 6; ++i) {
+        ProcessBuffer();
+    }
+    EXPECT_EQ(0.0, ControlObject::get(ConfigKey(m_sGroup1, "keylock_usage")));
+}
+
+TEST_F(EngineBufferE2ETest, EjectReleasesTrackBuffersAfterGracePeriod) {
+    constexpr int kDelayMillis = 1000;
+    const QString kTrackLocationTest =
+            mixxxtest::sourceTestDir().absoluteFilePath("sine-30.wav");
+    EngineBuffer* pEngineBuffer = m_pChannel1->getEngineBuffer();
+    pEngineBuffer->setReleaseTrackBuffersDelay(kDelayMillis);
+    const qint64 loadedBytes = EngineBuffer::allocatedTrackBufferBytes();
+    const qint64 loadedCacheBytes = CachingReader::allocatedCacheBytes();
+
+    ControlObject::set(ConfigKey(m_sGroup1, "eject"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup1, "eject"), 0.0);
+    ProcessBuffer();
+    application()->processEvents();
+    ASSERT_FALSE(pEngineBuffer->isTrackLoaded());
+    // Kept during the grace period
+    EXPECT_EQ(loadedBytes, EngineBuffer::allocatedTrackBufferBytes());
+
+    // Released afterwards, although the engine no longer processes the
+    // inactive deck
+    PerformanceTimer timer;
+    timer.start();
+    while (CachingReader::allocatedCacheBytes() == loadedCacheBytes &&
+            timer.elapsed().toIntegerMillis() < 10 * kDelayMillis) {
+        ProcessBuffer();
+        application()->processEvents();
+        QTest::qSleep(10);
+    }
+    ASSERT_FALSE(pEngineBuffer->isTrackLoaded());
+    EXPECT_LE(kDelayMillis, timer.elapsed().toIntegerMillis());
+    ASSERT_LT(timer.elapsed().toIntegerMillis(), 10 * kDelayMillis)
+            << "The cache of the ejected deck has not been released";
+    // The scalers are released together with the cache
+    const qint64 releasedCacheBytes =
+            loadedCacheBytes - CachingReader::allocatedCacheBytes();
+    EXPECT_GT(releasedCacheBytes, 0);
+    const qint64 releasedBytes = EngineBuffer::allocatedTrackBufferBytes();
+    EXPECT_GE(loadedBytes - releasedBytes, releasedCacheBytes);
+
+    // Loading again within the grace period keeps them
+    loadTrack(m_pMixerDeck1, Track::newTemporary(kTrackLocationTest));
+    EXPECT_EQ(loadedBytes, EngineBuffer::allocatedTrackBufferBytes());
+    ControlObject::set(ConfigKey(m_sGroup1, "eject"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup1, "eject"), 0.0);
+    ProcessBuffer();
+    application()->processEvents();
+    loadTrack(m_pMixerDeck1, Track::newTemporary(kTrackLocationTest));
+    timer.start();
+    while (timer.elapsed().toIntegerMillis() < 2 * kDelayMillis) {
+        ProcessBuffer();
+        application()->processEvents();
+        QTest::qSleep(10);
+    }
+    EXPECT_EQ(loadedBytes, EngineBuffer::allocatedTrackBufferBytes());
+}
+
+TEST_F(EngineBufferE2ETest, EjectFreesResidentSample) {
+    const QString kTrackLocationTest =
+            mixxxtest::sourceTestDir().absoluteFilePath("sine-30.wav");
+    // Decoded completely like in a sampler
+    EngineBuffer* pEngineBuffer = m_pChannel2->getEngineBuffer();
+    pEngineBuffer->setResidentSamples(true);
+    const qint64 unloadedBytes = ResidentSample::allocatedBytes();
+    loadTrack(m_pMixerDeck2, Track::newTemporary(kTrackLocationTest));
+    ASSERT_GT(ResidentSample::allocatedBytes(), unloadedBytes);
+
+    ControlObject::set(ConfigKey(m_sGroup2, "eject"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup2, "eject"), 0.0);
+    application()->processEvents();
+    ASSERT_FALSE(pEngineBuffer->isTrackLoaded());
+
+    // A single callback runs the worker. The sample is dropped without
+    // waiting for the engine to process the unloading.
+    ProcessBuffer();
+    PerformanceTimer timer;
+    timer.start();
+    while (ResidentSample::allocatedBytes() > unloadedBytes &&
+            timer.elapsed().toIntegerMillis() < 5000) {
+        QTest::qSleep(1);
+    }
+    EXPECT_EQ(unloadedBytes, ResidentSample::allocatedBytes());
+}
+
 TEST_F(EngineBufferE2ETest, CueGotoAndStopTest) {
     // Be sure, that the Crossfade buffer is processed only once
     // Bug #1504838
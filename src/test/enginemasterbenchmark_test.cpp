@@ -0,0 +1,252 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <vector>
+
+#include "engine/offlinerenderer.h"
+#include "sources/soundsourceproxy.h"
+#include "test/benchmarkutil.h"
+#include "test/mixxxtest.h"
+
+// Benchmarks of the audio callback, i.e. EngineMaster::process() with
+// decks playing the reference files in src/test. The engine is driven by
+// the OfflineRenderer that waits for the caching readers between buffers,
+// so the measured times do not include any disk I/O.
+//
+// Besides the mean time per callback each benchmark reports the 50th and
+// 99th percentile and the maximum in microseconds, and the number of
+// callbacks that took longer than the duration of the buffer, i.e. that
+// would have caused an xrun with a real sound device.
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr double kRenderSeconds = 5.0;
+constexpr double kBpm = 120.0;
+
+enum class BenchmarkScale {
+    Linear,
+    SoundTouch,
+    RubberBand,
+};
+
+const char* scaleName(BenchmarkScale scale) {
+    switch (scale) {
+    case BenchmarkScale::Linear:
+        return "Linear";
+    case BenchmarkScale::SoundTouch:
+        return "SoundTouch";
+    case BenchmarkScale::RubberBand:
+        return "RubberBand";
+    }
+    return "";
+}
+
+QString benchmarkScript(
+        int framesPerBuffer,
+        int deckCount,
+        BenchmarkScale scale,
+        bool features) {
+    const QDir testDir = mixxxtest::sourceTestDir();
+    QStringList filePaths;
+    filePaths << testDir.absoluteFilePath("sine-30.wav");
+    if (SoundSourceProxy::isFileExtensionSupported("mp3")) {
+        filePaths << testDir.absoluteFilePath("id3-test-data/cover-test-vbr.mp3");
+    }
+
+    QString script;
+    QTextStream stream(&script);
+    stream << "decks " << deckCount << '\n'
+           << "samplerate " << kSampleRate << '\n'
+           << "buffer " << framesPerBuffer << '\n';
+    switch (scale) {
+    case BenchmarkScale::Linear:
+        break;
+    case BenchmarkScale::SoundTouch:
+        stream << "0 set [Master] keylock_engine 0\n";
+        break;
+    case BenchmarkScale::RubberBand:
+        stream << "0 set [Master] keylock_engine 1\n";
+        break;
+    }
+    for (int i = 0; i < deckCount; ++i) {
+        const QString group = QString("[Channel%1]").arg(i + 1);
+        stream << "0 load " << group << ' ' << filePaths.at(i % filePaths.size()) << '\n'
+               << "0 bpm " << group << ' ' << kBpm << '\n'
+               // Slightly different tempos for a non-trivial scaling ratio
+               << "0 set " << group << " rate " << 0.02 * (i + 1) << '\n'
+               << "0 set " << group << " keylock "
+               << (scale == BenchmarkScale::Linear ? 0 : 1) << '\n'
+               << "0 set " << group << " play 1\n";
+        if (features) {
+            stream << "0 set " << group << " sync_enabled 1\n"
+                   << "0.5 set " << group << " beatloop_4_activate 1\n"
+                   << "0 set [EffectRack1_EffectUnit1] group_" << group
+                   << "_enable 1\n";
+        }
+    }
+    if (features) {
+        // effect_selector is a relative encoder that steps through the
+        // visible effects on every write of a positive value. Stepping a
+        // cleared slot i times loads the i-th effect, i.e. each slot of
+        // the chain loads a different effect independent of the defaults.
+        for (int i = 1; i <= 3; ++i) {
+            const QString group =
+                    QString("[EffectRack1_EffectUnit1_Effect%1]").arg(i);
+            stream << "0 set " << group << " clear 1\n";
+            for (int step = 0; step < i; ++step) {
+                stream << "0 set " << group << " effect_selector 1\n";
+            }
+            stream << "0 set " << group << " enabled 1\n";
+        }
+    }
+    stream << kRenderSeconds << " end\n";
+    stream.flush();
+    return script;
+}
+
+} // anonymous namespace
+
+// Arguments: frames per buffer, number of decks, EngineBufferScale of the
+// keylock and whether loops, sync and an effect chain are enabled.
+static void BM_EngineMasterCallback(benchmark::State& state) {
+    const int framesPerBuffer = static_cast<int>(state.range(0));
+    const int deckCount = static_cast<int>(state.range(1));
+    const auto scale = static_cast<BenchmarkScale>(state.range(2));
+    const bool features = state.range(3) != 0;
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    QString scriptText = benchmarkScript(framesPerBuffer, deckCount, scale, features);
+    QTextStream scriptStream(&scriptText);
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    if (!OfflineRenderer::parseScript(&scriptStream, &script, &errorMessage)) {
+        state.SkipWithError(errorMessage.toLocal8Bit().constData());
+        return;
+    }
+
+    std::vector<mixxx::Duration> durations;
+    OfflineRenderer renderer(fixture.config());
+    while (state.KeepRunning()) {
+        if (!renderer.render(script, QString(), &errorMessage)) {
+            state.SkipWithError(errorMessage.toLocal8Bit().constData());
+            return;
+        }
+        const auto& callbackDurations = renderer.callbackDurations();
+        mixxx::Duration totalDuration;
+        for (const auto& duration : callbackDurations) {
+            totalDuration += duration;
+        }
+        state.SetIterationTime(
+                totalDuration.toDoubleSeconds() / callbackDurations.size());
+        durations.insert(durations.end(),
+                callbackDurations.begin(),
+                callbackDurations.end());
+    }
+    if (durations.empty()) {
+        return;
+    }
+
+    std::sort(durations.begin(), durations.end());
+    const double bufferMicros = 1000000.0 * framesPerBuffer / kSampleRate;
+    const auto xruns = std::count_if(durations.begin(),
+            durations.end(),
+            [bufferMicros](const mixxx::Duration& duration) {
+                return duration.toDoubleMicros() > bufferMicros;
+            });
+    state.counters["p50_us"] = mixxxtest::percentileMicros(durations, 0.5);
+    state.counters["p99_us"] = mixxxtest::percentileMicros(durations, 0.99);
+    state.counters["max_us"] = durations.back().toDoubleMicros();
+    state.counters["xruns"] = static_cast<double>(xruns);
+    state.SetLabel(QString("%1%2")
+                           .arg(scaleName(scale),
+                                   features ? "+loop+sync+fx" : "")
+                           .toStdString());
+}
+BENCHMARK(BM_EngineMasterCallback)
+        ->ArgNames({"frames", "decks", "scale", "features"})
+        ->Apply([](benchmark::internal::Benchmark* pBenchmark) {
+            for (int framesPerBuffer : {64, 256, 1024}) {
+                for (int deckCount : {1, 4}) {
+                    for (int scale = 0; scale <= 2; ++scale) {
+                        for (int features = 0; features <= 1; ++features) {
+                            pBenchmark->Args({framesPerBuffer, deckCount, scale, features});
+                        }
+                    }
+                }
+            }
+        })
+        ->Iterations(1)
+        ->UseManualTime()
+        ->Unit(benchmark::kMicrosecond);
+
+// Reports the memory that is allocated for playing tracks, i.e. the reader
+// caches and the keylock buffers, for different numbers of players. Empty
+// samplers do not allocate anything. eagerMB is the memory if every player
+// allocated its buffers upfront. Both exclude the internal memory of the
+// RubberBand stretchers, see EngineBuffer::allocatedTrackBufferBytes().
+//
+// Arguments: number of decks and samplers and how many of the samplers
+// have a track loaded. All decks play a track.
+static void BM_PlayerMemory(benchmark::State& state) {
+    const int deckCount = static_cast<int>(state.range(0));
+    const int samplerCount = static_cast<int>(state.range(1));
+    const int loadedSamplerCount = static_cast<int>(state.range(2));
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    const QString filePath = mixxxtest::sourceTestDir().absoluteFilePath("sine-30.wav");
+    QString scriptText;
+    QTextStream stream(&scriptText);
+    stream << "decks " << deckCount << '\n'
+           << "samplers " << samplerCount << '\n';
+    for (int i = 1; i <= deckCount; ++i) {
+        stream << "0 load [Channel" << i << "] " << filePath << '\n'
+               << "0 set [Channel" << i << "] play 1\n";
+    }
+    for (int i = 1; i <= loadedSamplerCount; ++i) {
+        stream << "0 load [Sampler" << i << "] " << filePath << '\n';
+    }
+    stream << "1 end\n";
+    stream.flush();
+
+    QTextStream scriptStream(&scriptText);
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    if (!OfflineRenderer::parseScript(&scriptStream, &script, &errorMessage)) {
+        state.SkipWithError(errorMessage.toLocal8Bit().constData());
+        return;
+    }
+
+    OfflineRenderer renderer(fixture.config());
+    while (state.KeepRunning()) {
+        if (!renderer.render(script, QString(), &errorMessage)) {
+            state.SkipWithError(errorMessage.toLocal8Bit().constData());
+            return;
+        }
+    }
+    constexpr double kBytesPerMB = 1024.0 * 1024.0;
+    const double loadedPlayerCount = deckCount + loadedSamplerCount;
+    const double bytesPerPlayer = renderer.trackBufferBytes() / loadedPlayerCount;
+    state.counters["MB"] = renderer.trackBufferBytes() / kBytesPerMB;
+    state.counters["eagerMB"] =
+            bytesPerPlayer * (deckCount + samplerCount) / kBytesPerMB;
+}
+BENCHMARK(BM_PlayerMemory)
+        ->ArgNames({"decks", "samplers", "loaded"})
+        ->Apply([](benchmark::internal::Benchmark* pBenchmark) {
+            for (int deckCount : {2, 4}) {
+                for (int samplerCount : {0, 16, 64}) {
+                    for (int loadedSamplerCount : {0, 4}) {
+                        if (loadedSamplerCount <= samplerCount) {
+                            pBenchmark->Args({deckCount, samplerCount, loadedSamplerCount});
+                        }
+                    }
+                }
+            }
+        })
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
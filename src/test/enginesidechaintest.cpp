@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "engine/engine.h"
+#include "engine/sidechain/enginesidechain.h"
+#include "engine/sidechain/sidechainworker.h"
+#include "test/mixxxtest.h"
+#include "util/sample.h"
+
+namespace {
+
+constexpr int kFramesPerBuffer = 1024;
+// 2 s @ 44.1 kHz
+constexpr int kBufferCount = 86;
+constexpr int kTotalFrames = kBufferCount * kFramesPerBuffer;
+
+// Collects all samples like the recording does
+class CollectingWorker : public SideChainWorker {
+  public:
+    explicit CollectingWorker(std::vector<CSAMPLE>* pSamples)
+            : m_pSamples(pSamples) {
+    }
+
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override {
+        m_pSamples->insert(m_pSamples->end(), pBuffer, pBuffer + iBufferSize);
+    }
+    void shutdown() override {
+    }
+
+  private:
+    std::vector<CSAMPLE>* const m_pSamples;
+};
+
+// Stalls on each buffer like a broadcast encoder that writes to a slow
+// server
+class StallingWorker : public SideChainWorker {
+  public:
+    explicit StallingWorker(std::atomic<int>* pProcessedFrames)
+            : m_pProcessedFrames(pProcessedFrames) {
+    }
+
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override {
+        Q_UNUSED(pBuffer);
+        QThread::msleep(200);
+        m_pProcessedFrames->fetch_add(iBufferSize / mixxx::kEngineChannelCount);
+    }
+    void shutdown() override {
+    }
+
+  private:
+    std::atomic<int>* const m_pProcessedFrames;
+};
+
+class EngineSideChainTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        // The recording never drops anything during the test
+        config()->setValue(ConfigKey("[Recording]", "SideChainBufferFrames"),
+                4 * kTotalFrames);
+        config()->setValue(ConfigKey("[Stalling]", "SideChainBufferFrames"), 8192);
+        m_pSideChain = std::make_unique<EngineSideChain>(config(), nullptr);
+    }
+
+    std::unique_ptr<EngineSideChain> m_pSideChain;
+};
+
+TEST_F(EngineSideChainTest, StallingWorkerDoesNotAffectOthers) {
+    std::vector<CSAMPLE> recordedSamples;
+    std::atomic<int> stalledFrames(0);
+    m_pSideChain->addSideChainWorker(
+            new CollectingWorker(&recordedSamples), "[Recording]");
+    m_pSideChain->addSideChainWorker(
+            new StallingWorker(&stalledFrames), "[Stalling]");
+
+    // Faster than real time, as if the sidechain was starved
+    std::vector<CSAMPLE> buffer(kFramesPerBuffer * mixxx::kEngineChannelCount);
+    CSAMPLE value = 0;
+    for (int i = 0; i < kBufferCount; ++i) {
+        for (auto& sample : buffer) {
+            sample = value++;
+        }
+        m_pSideChain->writeSamples(buffer.data(), kFramesPerBuffer);
+    }
+
+    // Every frame is either processed or dropped by the stalling worker
+    const ConfigKey droppedFramesKey("[Stalling]", "sidechain_dropped_frames");
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (stalledFrames.load() + ControlObject::get(droppedFramesKey) < kTotalFrames) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+        QThread::msleep(10);
+    }
+    EXPECT_GT(ControlObject::get(droppedFramesKey), 0);
+    EXPECT_GE(ControlObject::get(ConfigKey("[Stalling]", "sidechain_overflows")), 1);
+    EXPECT_EQ(0, ControlObject::get(ConfigKey("[Recording]", "sidechain_dropped_frames")));
+    EXPECT_EQ(0, ControlObject::get(ConfigKey("[Recording]", "sidechain_overflows")));
+
+    // The remaining samples are processed on shutdown
+    m_pSideChain.reset();
+    ASSERT_EQ(static_cast<size_t>(kTotalFrames * mixxx::kEngineChannelCount),
+            recordedSamples.size());
+    for (size_t i = 0; i < recordedSamples.size(); ++i) {
+        ASSERT_EQ(static_cast<CSAMPLE>(i), recordedSamples[i]);
+    }
+}
+
+} // namespace
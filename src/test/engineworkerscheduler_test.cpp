@@ -0,0 +1,404 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "engine/engineworker.h"
+#include "engine/engineworkerscheduler.h"
+
+namespace {
+
+class CountingWorker : public EngineWorker {
+  public:
+    explicit CountingWorker(std::atomic<int>* pRunSequence = nullptr)
+            : m_pRunSequence(pRunSequence),
+              m_runCount(0),
+              m_lastRunSequence(-1),
+              m_requeueCount(0) {
+    }
+    ~CountingWorker() override {
+        stopScheduling();
+    }
+
+    void run() override {
+        if (m_pRunSequence) {
+            m_lastRunSequence.store(m_pRunSequence->fetch_add(1));
+        }
+        m_lastRunTime.store(std::chrono::steady_clock::now().time_since_epoch().count());
+        if (m_requeueCount.load() > 0) {
+            m_requeueCount.fetch_sub(1);
+            workReady();
+        }
+        m_runCount.fetch_add(1);
+    }
+
+    std::atomic<int>* const m_pRunSequence;
+    std::atomic<int> m_runCount;
+    std::atomic<int> m_lastRunSequence;
+    std::atomic<int> m_requeueCount;
+    std::atomic<std::chrono::steady_clock::rep> m_lastRunTime;
+};
+
+template<typename Worker>
+bool waitForRunCount(const Worker& worker, int runCount) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (worker.m_runCount.load() < runCount) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        QThread::yieldCurrentThread();
+    }
+    return true;
+}
+
+// Blocks in run() like a worker that loads a track, until finish() is called
+class LoadingWorker : public EngineWorker {
+  public:
+    LoadingWorker()
+            : m_loading(true),
+              m_started(false) {
+    }
+    ~LoadingWorker() override {
+        finish();
+        stopScheduling();
+    }
+
+    void run() override {
+        m_started.store(true);
+        m_semaFinish.acquire();
+        m_loading.store(false);
+    }
+
+    bool hasLongRunningWork() const override {
+        return m_loading.load();
+    }
+
+    bool waitUntilStarted() const {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!m_started.load()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            QThread::yieldCurrentThread();
+        }
+        return true;
+    }
+
+    void finish() {
+        if (m_loading.load() && m_started.load()) {
+            m_semaFinish.release();
+        }
+    }
+
+  private:
+    std::atomic<bool> m_loading;
+    std::atomic<bool> m_started;
+    QSemaphore m_semaFinish;
+};
+
+TEST(EngineWorkerSchedulerTest, HighPriorityRunsFirst) {
+    std::atomic<int> runSequence(0);
+    CountingWorker idleSampler(&runSequence);
+    CountingWorker playingDeck(&runSequence);
+    playingDeck.setPriority(EngineWorker::Priority::High);
+
+    EngineWorkerScheduler scheduler(nullptr, 1);
+    idleSampler.setScheduler(&scheduler);
+    playingDeck.setScheduler(&scheduler);
+
+    // Both are ready before the single pool thread starts
+    idleSampler.workReady();
+    playingDeck.workReady();
+    EXPECT_TRUE(idleSampler.isBusy());
+    EXPECT_TRUE(playingDeck.isBusy());
+    scheduler.start();
+    scheduler.runWorkers();
+
+    ASSERT_TRUE(waitForRunCount(idleSampler, 1));
+    ASSERT_TRUE(waitForRunCount(playingDeck, 1));
+    EXPECT_EQ(0, playingDeck.m_lastRunSequence.load());
+    EXPECT_EQ(1, idleSampler.m_lastRunSequence.load());
+}
+
+TEST(EngineWorkerSchedulerTest, WorkReadyWhileRunning) {
+    CountingWorker worker;
+    EngineWorkerScheduler scheduler(nullptr, 2);
+    worker.setScheduler(&scheduler);
+    scheduler.start();
+
+    worker.m_requeueCount.store(3);
+    worker.workReady();
+    scheduler.runWorkers();
+    ASSERT_TRUE(waitForRunCount(worker, 4));
+    while (worker.isBusy()) {
+        QThread::yieldCurrentThread();
+    }
+    EXPECT_EQ(4, worker.m_runCount.load());
+}
+
+TEST(EngineWorkerSchedulerTest, ReservedThreadRunsPlayingDecksDuringLoads) {
+    LoadingWorker loadingDeck;
+    loadingDeck.setPriority(EngineWorker::Priority::High);
+    CountingWorker idleSampler;
+    CountingWorker playingDeck;
+    playingDeck.setPriority(EngineWorker::Priority::High);
+
+    EngineWorkerScheduler scheduler(nullptr, 2);
+    loadingDeck.setScheduler(&scheduler);
+    idleSampler.setScheduler(&scheduler);
+    playingDeck.setScheduler(&scheduler);
+    scheduler.start();
+
+    loadingDeck.workReady();
+    scheduler.runWorkers();
+    ASSERT_TRUE(loadingDeck.waitUntilStarted());
+
+    // The load occupies the only thread that is not reserved
+    idleSampler.workReady();
+    playingDeck.workReady();
+    scheduler.runWorkers();
+    ASSERT_TRUE(waitForRunCount(playingDeck, 1));
+    EXPECT_EQ(0, idleSampler.m_runCount.load());
+
+    loadingDeck.finish();
+    ASSERT_TRUE(waitForRunCount(idleSampler, 1));
+}
+
+TEST(EngineWorkerSchedulerTest, WorkersOutliveScheduler) {
+    CountingWorker worker;
+    {
+        EngineWorkerScheduler scheduler(nullptr, 2);
+        worker.setScheduler(&scheduler);
+        scheduler.start();
+        worker.workReady();
+        scheduler.runWorkers();
+        ASSERT_TRUE(waitForRunCount(worker, 1));
+    }
+    // The destructor of the worker must not access the deleted scheduler
+}
+
+// The scheduling before the thread pool for comparison: Every worker owns a
+// thread that waits on a semaphore. The engine callback wakes a dedicated
+// scheduler thread that locks a mutex and wakes the threads of all ready
+// workers.
+class LegacyEngineWorker : public QThread {
+  public:
+    LegacyEngineWorker()
+            : m_runCount(0),
+              m_quit(false) {
+        m_notReady.test_and_set();
+    }
+    ~LegacyEngineWorker() override {
+        m_quit.store(true);
+        m_semaRun.release();
+        wait();
+    }
+
+    void wakeIfReady() {
+        if (!m_notReady.test_and_set()) {
+            m_semaRun.release();
+        }
+    }
+
+    void setReady() {
+        m_notReady.clear();
+    }
+
+    std::atomic<int> m_runCount;
+    std::atomic<std::chrono::steady_clock::rep> m_lastRunTime;
+
+  protected:
+    void run() override {
+        while (true) {
+            m_semaRun.acquire();
+            if (m_quit.load()) {
+                return;
+            }
+            m_lastRunTime.store(std::chrono::steady_clock::now().time_since_epoch().count());
+            m_runCount.fetch_add(1);
+        }
+    }
+
+  private:
+    std::atomic_flag m_notReady;
+    QSemaphore m_semaRun;
+    std::atomic<bool> m_quit;
+};
+
+class LegacyEngineWorkerScheduler : public QThread {
+  public:
+    LegacyEngineWorkerScheduler()
+            : m_bWakeScheduler(false),
+              m_bWaiting(false),
+              m_bQuit(false) {
+    }
+    ~LegacyEngineWorkerScheduler() override {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_bQuit = true;
+        }
+        m_waitCondition.wakeAll();
+        wait();
+    }
+
+    void addWorker(LegacyEngineWorker* pWorker) {
+        QMutexLocker lock(&m_mutex);
+        m_workers.push_back(pWorker);
+    }
+
+    void workReady(LegacyEngineWorker* pWorker) {
+        pWorker->setReady();
+        m_bWakeScheduler = true;
+    }
+
+    void runWorkers() {
+        if (m_bWakeScheduler) {
+            m_bWakeScheduler = false;
+            m_waitCondition.wakeAll();
+        }
+    }
+
+    // The callback does not synchronize with the scheduler thread, i.e. a
+    // wake-up is lost while it is still busy with the previous one. Only
+    // used by the benchmark between the measurements.
+    bool isWaiting() {
+        QMutexLocker lock(&m_mutex);
+        return m_bWaiting;
+    }
+
+  protected:
+    void run() override {
+        QMutexLocker lock(&m_mutex);
+        while (!m_bQuit) {
+            for (const auto& pWorker : m_workers) {
+                pWorker->wakeIfReady();
+            }
+            m_bWaiting = true;
+            m_waitCondition.wait(&m_mutex);
+            m_bWaiting = false;
+        }
+    }
+
+  private:
+    std::vector<LegacyEngineWorker*> m_workers;
+    QMutex m_mutex;
+    QWaitCondition m_waitCondition;
+    bool m_bWakeScheduler;
+    bool m_bWaiting;
+    bool m_bQuit;
+};
+
+template<typename Worker>
+double wakeLatencySeconds(
+        Worker* pWorker, std::chrono::steady_clock::time_point wakeTime) {
+    const auto runTime = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(pWorker->m_lastRunTime.load()));
+    return std::chrono::duration<double>(runTime - wakeTime).count();
+}
+
+} // anonymous namespace
+
+// Measures the time from runWorkers() in the engine callback until the
+// reader of a playing deck runs, while the readers of the other decks and
+// the samplers are registered but idle. Compare with
+// BM_LegacyEngineWorkerWakeLatency.
+//
+// Arguments: number of decks and samplers and the number of pool threads
+static void BM_EngineWorkerWakeLatency(benchmark::State& state) {
+    const int deckCount = static_cast<int>(state.range(0));
+    const int samplerCount = static_cast<int>(state.range(1));
+    const int threadCount = static_cast<int>(state.range(2));
+
+    EngineWorkerScheduler scheduler(nullptr, threadCount);
+    std::vector<std::unique_ptr<CountingWorker>> workers;
+    for (int i = 0; i < deckCount + samplerCount; ++i) {
+        auto pWorker = std::make_unique<CountingWorker>();
+        pWorker->setPriority(i < deckCount
+                        ? EngineWorker::Priority::High
+                        : EngineWorker::Priority::Low);
+        pWorker->setScheduler(&scheduler);
+        workers.push_back(std::move(pWorker));
+    }
+    scheduler.start(QThread::HighPriority);
+
+    int deckIndex = 0;
+    while (state.KeepRunning()) {
+        CountingWorker* pDeck = workers[deckIndex].get();
+        deckIndex = (deckIndex + 1) % deckCount;
+        const int runCount = pDeck->m_runCount.load();
+
+        const auto wakeTime = std::chrono::steady_clock::now();
+        pDeck->workReady();
+        scheduler.runWorkers();
+        if (!waitForRunCount(*pDeck, runCount + 1)) {
+            state.SkipWithError("Worker did not run");
+            return;
+        }
+        state.SetIterationTime(wakeLatencySeconds(pDeck, wakeTime));
+    }
+    state.counters["threads"] = scheduler.threadCount();
+}
+BENCHMARK(BM_EngineWorkerWakeLatency)
+        ->ArgNames({"decks", "samplers", "threads"})
+        ->Apply([](benchmark::internal::Benchmark* pBenchmark) {
+            for (int samplerCount : {0, 64}) {
+                for (int threadCount : {1, 2, 4}) {
+                    pBenchmark->Args({4, samplerCount, threadCount});
+                }
+            }
+        })
+        ->UseManualTime()
+        ->Unit(benchmark::kMicrosecond);
+
+// The same measurement for the scheduling before the thread pool, with a
+// thread for each reader and a dedicated scheduler thread.
+//
+// Arguments: number of decks and samplers
+static void BM_LegacyEngineWorkerWakeLatency(benchmark::State& state) {
+    const int deckCount = static_cast<int>(state.range(0));
+    const int samplerCount = static_cast<int>(state.range(1));
+
+    // The scheduler thread references the workers until it has finished
+    std::vector<std::unique_ptr<LegacyEngineWorker>> workers;
+    LegacyEngineWorkerScheduler scheduler;
+    for (int i = 0; i < deckCount + samplerCount; ++i) {
+        auto pWorker = std::make_unique<LegacyEngineWorker>();
+        scheduler.addWorker(pWorker.get());
+        pWorker->start(QThread::HighPriority);
+        workers.push_back(std::move(pWorker));
+    }
+    scheduler.start(QThread::HighPriority);
+
+    int deckIndex = 0;
+    while (state.KeepRunning()) {
+        LegacyEngineWorker* pDeck = workers[deckIndex].get();
+        deckIndex = (deckIndex + 1) % deckCount;
+        const int runCount = pDeck->m_runCount.load();
+        while (!scheduler.isWaiting()) {
+            QThread::yieldCurrentThread();
+        }
+
+        const auto wakeTime = std::chrono::steady_clock::now();
+        scheduler.workReady(pDeck);
+        scheduler.runWorkers();
+        if (!waitForRunCount(*pDeck, runCount + 1)) {
+            state.SkipWithError("Worker did not run");
+            return;
+        }
+        state.SetIterationTime(wakeLatencySeconds(pDeck, wakeTime));
+    }
+    state.counters["threads"] = deckCount + samplerCount + 1;
+}
+BENCHMARK(BM_LegacyEngineWorkerWakeLatency)
+        ->ArgNames({"decks", "samplers"})
+        ->Args({4, 0})
+        ->Args({4, 64})
+        ->UseManualTime()
+        ->Unit(benchmark::kMicrosecond);
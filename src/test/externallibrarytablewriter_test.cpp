@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "library/externallibrarytablewriter.h"
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+const QString kConnectionName = QStringLiteral("EXTERNAL_LIBRARY_WRITER_TEST");
+
+class ExternalLibraryTableWriterTest : public MixxxDbTest {
+  protected:
+    ExternalLibraryTableWriterTest() {
+        EXPECT_TRUE(MixxxDb::initDatabaseSchema(dbConnection()));
+    }
+
+    int countRows(const QString& tableName) const {
+        QSqlQuery query(dbConnection());
+        EXPECT_TRUE(query.exec(QStringLiteral("SELECT COUNT(*) FROM %1").arg(tableName)));
+        EXPECT_TRUE(query.next());
+        return query.value(0).toInt();
+    }
+
+    static QVariantList playlistTrackRow(int playlistId, int trackId, int position) {
+        return QVariantList{playlistId, trackId, position};
+    }
+};
+
+TEST_F(ExternalLibraryTableWriterTest, replaceTables) {
+    // Stale rows of a previous import
+    {
+        QSqlQuery query(dbConnection());
+        ASSERT_TRUE(query.exec(
+                "INSERT INTO traktor_playlists (id, name) VALUES (1, 'stale')"));
+    }
+
+    // More rows than fit into a single statement and a chunk
+    const int kPlaylistCount = 1000;
+    const int kTracksPerPlaylist = 3;
+    {
+        ExternalLibraryTableWriter writer(dbConnection(), kConnectionName);
+        const int playlistTracksTable = writer.addTable(
+                "traktor_playlist_tracks",
+                QStringList{"playlist_id", "track_id", "position"});
+        const int playlistsTable = writer.addTable(
+                "traktor_playlists",
+                QStringList{"id", "name"});
+        writer.start();
+        for (int playlistId = 1; playlistId <= kPlaylistCount; ++playlistId) {
+            writer.insertRow(playlistsTable,
+                    QVariantList{playlistId, QString("playlist %1").arg(playlistId)});
+            for (int position = 1; position <= kTracksPerPlaylist; ++position) {
+                writer.insertRow(playlistTracksTable,
+                        playlistTrackRow(playlistId, position, position));
+            }
+        }
+        // A duplicate name fails the batch that contains it, but
+        // all other rows of this batch must be inserted.
+        writer.insertRow(playlistsTable,
+                QVariantList{kPlaylistCount + 1, QString("playlist 1")});
+        writer.insertRow(playlistsTable,
+                QVariantList{kPlaylistCount + 2, QString("last")});
+        // Statements are executed after all preceding rows
+        writer.executeStatement(
+                "UPDATE traktor_playlists SET name=? WHERE id=?",
+                QVariantList{"first", 1});
+        EXPECT_TRUE(writer.finish());
+    }
+
+    EXPECT_EQ(kPlaylistCount + 1, countRows("traktor_playlists"));
+    EXPECT_EQ(kPlaylistCount * kTracksPerPlaylist,
+            countRows("traktor_playlist_tracks"));
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec("SELECT name FROM traktor_playlists ORDER BY id"));
+    ASSERT_TRUE(query.first());
+    EXPECT_EQ(QString("first"), query.value(0).toString());
+    ASSERT_TRUE(query.last());
+    EXPECT_EQ(QString("last"), query.value(0).toString());
+}
+
+TEST_F(ExternalLibraryTableWriterTest, digestSourceFiles) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString filePath = tempDir.filePath("collection.xml");
+
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("<collection/>");
+    file.close();
+    const QString digest =
+            ExternalLibraryTableWriter::digestSourceFiles(QStringList{filePath});
+    EXPECT_EQ(digest,
+            ExternalLibraryTableWriter::digestSourceFiles(QStringList{filePath}));
+
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write("\n");
+    file.close();
+    EXPECT_NE(digest,
+            ExternalLibraryTableWriter::digestSourceFiles(QStringList{filePath}));
+}
+
+} // namespace
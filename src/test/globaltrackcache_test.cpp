@@ -1,9 +1,15 @@
 #include "track/globaltrackcache.h"
 
+#include <benchmark/benchmark.h>
+
+#include <QTemporaryDir>
 #include <QThread>
 #include <QtDebug>
 #include <atomic>
+#include <thread>
+#include <vector>
 
+#include "test/benchmarkutil.h"
 #include "test/mixxxtest.h"
 #include "track/track.h"
 
@@ -16,8 +22,9 @@ const TrackFile kTestFile2(kTestDir.absoluteFilePath("cover-test.ogg"));
 
 class TrackTitleThread: public QThread {
   public:
-    explicit TrackTitleThread()
-        : m_stop(false) {
+    explicit TrackTitleThread(bool lockCache)
+        : m_lockCache(lockCache),
+          m_stop(false) {
     }
 
     void stop() {
@@ -32,7 +39,9 @@ class TrackTitleThread: public QThread {
             m_recentTrackPtr.reset();
             // Try to resolve the next track by guessing the id
             const TrackId trackId(loopCount % 2);
-            auto track = GlobalTrackCacheLocker().lookupTrackById(trackId);
+            auto track = m_lockCache
+                    ? GlobalTrackCacheLocker().lookupTrackById(trackId)
+                    : GlobalTrackCache::lookupTrackById(trackId);
             if (track) {
                 ASSERT_EQ(trackId, track->getId());
                 // lp1744550: Accessing the track from multiple threads is
@@ -60,6 +69,8 @@ class TrackTitleThread: public QThread {
     }
 
   private:
+    const bool m_lockCache;
+
     TrackPointer m_recentTrackPtr;
 
     std::atomic<bool> m_stop;
@@ -87,6 +98,8 @@ class GlobalTrackCacheTest: public MixxxTest, public virtual GlobalTrackCacheSav
         GlobalTrackCache::destroyInstance();
     }
 
+    void concurrentDelete(bool lockCache);
+
     TrackPointer m_recentTrackPtr;
 };
 
@@ -140,10 +153,10 @@ TEST_F(GlobalTrackCacheTest, resolveByFileInfo) {
     }
 }
 
-TEST_F(GlobalTrackCacheTest, concurrentDelete) {
+void GlobalTrackCacheTest::concurrentDelete(bool lockCache) {
     ASSERT_TRUE(GlobalTrackCacheLocker().isEmpty());
 
-    TrackTitleThread workerThread;
+    TrackTitleThread workerThread(lockCache);
     workerThread.start();
 
     // lp1744550: A decent number of iterations is needed to reliably
@@ -197,6 +210,15 @@ TEST_F(GlobalTrackCacheTest, concurrentDelete) {
     workerThread.wait();
 }
 
+TEST_F(GlobalTrackCacheTest, concurrentDelete) {
+    concurrentDelete(true);
+}
+
+TEST_F(GlobalTrackCacheTest, concurrentDeleteWithoutLocking) {
+    // The worker thread only locks single shards of the cache
+    concurrentDelete(false);
+}
+
 TEST_F(GlobalTrackCacheTest, evictWhileMoving) {
     ASSERT_TRUE(GlobalTrackCacheLocker().isEmpty());
 
@@ -215,3 +237,46 @@ TEST_F(GlobalTrackCacheTest, evictWhileMoving) {
 
     EXPECT_TRUE(GlobalTrackCacheLocker().isEmpty());
 }
+
+// Multiple threads concurrently look up cached tracks, either by
+// locking the whole cache or by only locking a single shard.
+static void BM_GlobalTrackCacheLookupContention(benchmark::State& state) {
+    const int numThreads = state.range(0);
+    const bool lockCache = state.range(1) != 0;
+    constexpr int kNumTracks = 256;
+    constexpr int kLookupsPerThread = 10000;
+
+    {
+        const mixxxtest::BenchmarkTrackCacheScope trackCacheScope;
+        // The tracks are kept alive during the whole benchmark
+        QTemporaryDir tempDir;
+        QList<TrackPointer> tracks;
+        for (int i = 0; i < kNumTracks; ++i) {
+            GlobalTrackCacheResolver resolver(
+                    TrackFile(QDir(tempDir.path()), QString("track%1.mp3").arg(i)),
+                    TrackId(i + 1));
+            tracks.append(resolver.getTrack());
+        }
+        while (state.KeepRunning()) {
+            std::vector<std::thread> workers;
+            for (int i = 0; i < numThreads; ++i) {
+                workers.emplace_back([i, lockCache] {
+                    for (int j = 0; j < kLookupsPerThread; ++j) {
+                        const TrackId trackId((i * 31 + j) % kNumTracks + 1);
+                        benchmark::DoNotOptimize(lockCache
+                                        ? GlobalTrackCacheLocker().lookupTrackById(trackId)
+                                        : GlobalTrackCache::lookupTrackById(trackId));
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numThreads * kLookupsPerThread);
+}
+BENCHMARK(BM_GlobalTrackCacheLookupContention)
+        ->RangeMultiplier(2)
+        ->Ranges({{1, 8}, {0, 1}})
+        ->UseRealTime();
@@ -0,0 +1,363 @@
+#ifdef __HID__
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "controllers/hid/hidcontroller.h"
+#include "controllers/hid/hiddevicelock.h"
+#include "test/benchmarkutil.h"
+#include "test/mixxxtest.h"
+#include "util/time.h"
+
+namespace {
+
+constexpr int kTimeoutMillis = 5000;
+
+// Simulates a device that sends the reports passed to sendReport(). With a
+// poll interval the reads never wait for a report, like the reads of the
+// timer in ControllerManager that polled the devices before.
+class FakeHidReader : public HidReader {
+  public:
+    explicit FakeHidReader(HidDeviceLock* pDeviceLock, int pollIntervalMillis = 0)
+            : HidReader(nullptr, pDeviceLock),
+              m_pollIntervalMillis(pollIntervalMillis),
+              m_reads(0),
+              m_reading(false) {
+    }
+    ~FakeHidReader() override {
+        stop();
+        wait();
+    }
+
+    void sendReport(const QByteArray& report) {
+        QMutexLocker locked(&m_mutex);
+        m_reports.enqueue(report);
+        m_reportAvailable.wakeAll();
+    }
+
+    int reads() const {
+        return m_reads.load();
+    }
+
+    bool isReading() const {
+        return m_reading.load();
+    }
+
+  protected:
+    int readReport(unsigned char* pData, int maxLength, int timeoutMillis) override {
+        m_reading = true;
+        ++m_reads;
+        if (m_pollIntervalMillis > 0) {
+            QThread::msleep(m_pollIntervalMillis);
+            timeoutMillis = 0;
+        }
+        int size = 0;
+        {
+            QMutexLocker locked(&m_mutex);
+            if (m_reports.isEmpty() && timeoutMillis > 0) {
+                m_reportAvailable.wait(&m_mutex, timeoutMillis);
+            }
+            if (!m_reports.isEmpty()) {
+                const QByteArray report = m_reports.dequeue();
+                size = std::min(report.size(), maxLength);
+                std::memcpy(pData, report.constData(), size);
+            }
+        }
+        m_reading = false;
+        return size;
+    }
+
+  private:
+    const int m_pollIntervalMillis;
+    QMutex m_mutex;
+    QWaitCondition m_reportAvailable;
+    QQueue<QByteArray> m_reports;
+    std::atomic<int> m_reads;
+    std::atomic<bool> m_reading;
+};
+
+class HidReaderTest : public MixxxTest {
+  protected:
+    HidReaderTest()
+            : m_reader(&m_deviceLock) {
+        QObject::connect(&m_reader,
+                &HidReader::incomingData,
+                &m_receiver,
+                [this](QByteArray data, mixxx::Duration timestamp) {
+                    m_receivedData.append(data);
+                    m_timestamps.append(timestamp);
+                });
+    }
+
+    bool waitUntilReceived(int count) {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_receivedData.size() < count) {
+            if (timer.elapsed() > kTimeoutMillis) {
+                return false;
+            }
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        }
+        return true;
+    }
+
+    HidDeviceLock m_deviceLock;
+    FakeHidReader m_reader;
+    // Lives in the test thread, i.e. the reports are received through a
+    // queued connection like in HidController
+    QObject m_receiver;
+    QList<QByteArray> m_receivedData;
+    QList<mixxx::Duration> m_timestamps;
+};
+
+TEST_F(HidReaderTest, ForwardsReportsWithTimestamp) {
+    m_reader.start();
+    const mixxx::Duration sent = mixxx::Time::elapsed();
+    m_reader.sendReport(QByteArray("\x01\x10\x20", 3));
+
+    ASSERT_TRUE(waitUntilReceived(1));
+    EXPECT_EQ(QByteArray("\x01\x10\x20", 3), m_receivedData[0]);
+    // Taken after the report has been read, not when it has been processed
+    EXPECT_GE(m_timestamps[0], sent);
+    EXPECT_LE(m_timestamps[0], mixxx::Time::elapsed());
+}
+
+TEST_F(HidReaderTest, DropsRedundantReports) {
+    m_reader.start();
+    m_reader.sendReport(QByteArray("\x01\x10", 2));
+    m_reader.sendReport(QByteArray("\x01\x10", 2));
+    m_reader.sendReport(QByteArray("\x01\x11", 2));
+    m_reader.sendReport(QByteArray("\x01\x10", 2));
+
+    ASSERT_TRUE(waitUntilReceived(3));
+    const QList<QByteArray> expected = {
+            QByteArray("\x01\x10", 2),
+            QByteArray("\x01\x11", 2),
+            QByteArray("\x01\x10", 2),
+    };
+    EXPECT_EQ(expected, m_receivedData);
+}
+
+TEST_F(HidReaderTest, WritesWaitForAtMostOneRead) {
+    // The reader is idle and waits for reports while holding the lock, like
+    // on backends that need it
+    m_reader.start();
+    QElapsedTimer timer;
+    timer.start();
+    while (m_reader.reads() < 2) {
+        ASSERT_LT(timer.elapsed(), kTimeoutMillis);
+        QThread::msleep(1);
+    }
+
+    qint64 maxWaitMillis = 0;
+    for (int i = 0; i < 50; ++i) {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        {
+            HidDeviceLock::WriteLocker locked(&m_deviceLock);
+            maxWaitMillis = std::max(maxWaitMillis, waitTimer.elapsed());
+            // Reads and writes never overlap
+            EXPECT_FALSE(m_reader.isReading());
+        }
+        QThread::msleep(1);
+    }
+    // Generous for loaded machines, the reads wait for up to 100 ms before
+    // they had a timeout
+    EXPECT_LE(maxWaitMillis, 10 * HidReader::kLockedReadTimeoutMillis);
+}
+
+TEST(HidReaderWithoutLockTest, WritesDontWaitForReads) {
+    HidDeviceLock deviceLock;
+    FakeHidReader reader(nullptr);
+    reader.start();
+    QElapsedTimer timer;
+    timer.start();
+    while (!reader.isReading()) {
+        ASSERT_LT(timer.elapsed(), kTimeoutMillis);
+        QThread::msleep(1);
+    }
+
+    // The reader keeps reading during the write
+    const int reads = reader.reads();
+    HidDeviceLock::WriteLocker locked(&deviceLock);
+    reader.sendReport(QByteArray("\x01\x10", 2));
+    while (reader.reads() == reads) {
+        ASSERT_LT(timer.elapsed(), kTimeoutMillis);
+        QThread::msleep(1);
+    }
+}
+
+TEST(HidReaderWithoutLockTest, StopsAfterReadTimeout) {
+    FakeHidReader reader(nullptr);
+    reader.start();
+    QElapsedTimer timer;
+    timer.start();
+    while (reader.reads() < 2) {
+        ASSERT_LT(timer.elapsed(), kTimeoutMillis);
+        QThread::msleep(1);
+    }
+
+    // The idle reader only wakes up to check if it should stop
+    const int reads = reader.reads();
+    QThread::msleep(HidReader::kReadTimeoutMillis / 2);
+    EXPECT_LE(reader.reads(), reads + 1);
+
+    timer.restart();
+    reader.stop();
+    ASSERT_TRUE(reader.wait(kTimeoutMillis));
+    // Generous for loaded machines
+    EXPECT_LE(timer.elapsed(), 2 * HidReader::kReadTimeoutMillis);
+}
+
+TEST(HidDeviceLockTest, PendingWriterGoesFirst) {
+    HidDeviceLock deviceLock;
+    QMutex orderMutex;
+    QList<QString> order;
+    const auto record = [&](const QString& name) {
+        QMutexLocker locked(&orderMutex);
+        order.append(name);
+    };
+
+    deviceLock.lockForWrite();
+    std::thread reader([&] {
+        HidDeviceLock::ReadLocker locked(&deviceLock);
+        record("read");
+    });
+    // The reader waits for the mutex before the second writer is pending
+    QThread::msleep(20);
+    std::thread writer([&] {
+        HidDeviceLock::WriteLocker locked(&deviceLock);
+        record("write");
+    });
+    QThread::msleep(20);
+    deviceLock.unlockWrite();
+    reader.join();
+    writer.join();
+
+    const QList<QString> expected = {"write", "read"};
+    EXPECT_EQ(expected, order);
+}
+
+TEST(HidDeviceLockTest, ReadsAndWritesAreExclusive) {
+    HidDeviceLock deviceLock;
+    std::atomic<int> holders(0);
+    std::atomic<int> maxHolders(0);
+    const auto hold = [&] {
+        const int current = ++holders;
+        int max = maxHolders.load();
+        while (current > max && !maxHolders.compare_exchange_weak(max, current)) {
+        }
+        std::this_thread::yield();
+        --holders;
+    };
+
+    std::thread reader([&] {
+        for (int i = 0; i < 10000; ++i) {
+            HidDeviceLock::ReadLocker locked(&deviceLock);
+            hold();
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 2; ++i) {
+        writers.emplace_back([&] {
+            for (int j = 0; j < 10000; ++j) {
+                HidDeviceLock::WriteLocker locked(&deviceLock);
+                hold();
+            }
+        });
+    }
+    reader.join();
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    EXPECT_EQ(1, maxHolders.load());
+}
+
+} // anonymous namespace
+
+// Measures the delay from the device sending a report until the controller
+// thread receives it, and the reads per second while the device is idle,
+// i.e. the wake-ups that cost CPU time.
+//
+// Argument: the poll interval in ms of the timer that polled the devices
+// before, or 0 for the blocking reader.
+static void BM_HidReaderInputLatency(benchmark::State& state) {
+    const int pollIntervalMillis = static_cast<int>(state.range(0));
+    mixxxtest::BenchmarkFixture<> fixture;
+
+    HidDeviceLock deviceLock;
+    // Like HidController
+    FakeHidReader reader(HidReader::kReadsNeedDeviceLock ? &deviceLock : nullptr,
+            pollIntervalMillis);
+    QObject receiver;
+    bool received = false;
+    QObject::connect(&reader,
+            &HidReader::incomingData,
+            &receiver,
+            [&received](QByteArray data, mixxx::Duration timestamp) {
+                Q_UNUSED(data);
+                Q_UNUSED(timestamp);
+                received = true;
+            });
+    reader.start(QThread::HighPriority);
+
+    std::vector<mixxx::Duration> latencies;
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        // Send at different phases of the poll interval
+        std::this_thread::sleep_for(std::chrono::microseconds(
+                200 * (iteration % 13) + 1000));
+        received = false;
+        const mixxx::Duration sent = mixxx::Time::elapsed();
+        // Alternating reports, redundant ones are dropped
+        reader.sendReport(QByteArray(1, static_cast<char>(iteration++ % 2)));
+        while (!received) {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        }
+        const mixxx::Duration latency = mixxx::Time::elapsed() - sent;
+        latencies.push_back(latency);
+        state.SetIterationTime(latency.toDoubleSeconds());
+    }
+
+    const int readsBeforeIdle = reader.reads();
+    constexpr int kIdleMillis = 500;
+    QThread::msleep(kIdleMillis);
+    state.counters["idle_reads_per_s"] =
+            (reader.reads() - readsBeforeIdle) * 1000.0 / kIdleMillis;
+
+    if (latencies.empty()) {
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_us"] = mixxxtest::percentileMicros(latencies, 0.5);
+    state.counters["p99_us"] = mixxxtest::percentileMicros(latencies, 0.99);
+    state.counters["max_us"] = latencies.back().toDoubleMicros();
+}
+BENCHMARK(BM_HidReaderInputLatency)
+        ->ArgNames({"poll_ms"})
+        // The blocking reader
+        ->Arg(0)
+        // The timer of ControllerManager on Windows and macOS
+        ->Arg(1)
+        // The timer of ControllerManager on Linux
+        ->Arg(5)
+        ->Iterations(200)
+        ->UseManualTime()
+        ->Unit(benchmark::kMicrosecond);
+
+#endif // __HID__
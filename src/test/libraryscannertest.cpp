@@ -1,9 +1,26 @@
-#include <gtest/gtest.h>
+#include <benchmark/benchmark.h>
 #include <gmock/gmock.h>
+#include <gtest/gtest.h>
 
-#include "test/librarytest.h"
+#include <QEventLoop>
+#include <QTemporaryDir>
+#include <atomic>
+#include <thread>
+#include <vector>
 
+#include "library/scanner/importfilestask.h"
 #include "library/scanner/libraryscanner.h"
+#include "sources/soundsourceproxy.h"
+#include "test/benchmarkutil.h"
+#include "test/librarytest.h"
+#include "track/globaltrackcache.h"
+#include "track/track.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+} // anonymous namespace
 
 class LibraryScannerTest : public LibraryTest {
   protected:
@@ -52,3 +69,163 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+TEST_F(LibraryScannerTest, PreparseTrack) {
+    const TrackFile trackFile(kTestDir.absoluteFilePath("cover-test.flac"));
+
+    TrackPointer pPreparsedTrack =
+            ImportFilesTask::preparseTrack(trackFile, SecurityTokenPointer());
+    ASSERT_TRUE(static_cast<bool>(pPreparsedTrack));
+    EXPECT_FALSE(pPreparsedTrack->getId().isValid());
+    EXPECT_TRUE(pPreparsedTrack->isMetadataSynchronized());
+    EXPECT_FALSE(pPreparsedTrack->getTitle().isEmpty());
+
+    // Files that are referenced by cached tracks are not preparsed
+    GlobalTrackCacheResolver cacheResolver(trackFile);
+    TrackPointer pCachedTrack = cacheResolver.getTrack();
+    ASSERT_TRUE(static_cast<bool>(pCachedTrack));
+    cacheResolver.unlockCache();
+    EXPECT_FALSE(static_cast<bool>(
+            ImportFilesTask::preparseTrack(trackFile, SecurityTokenPointer())));
+}
+
+TEST_F(LibraryScannerTest, AddPreparsedTrackOfExistingLocation) {
+    const TrackFile trackFile(kTestDir.absoluteFilePath("cover-test.flac"));
+    TrackPointer pPreparsedTrack =
+            ImportFilesTask::preparseTrack(trackFile, SecurityTokenPointer());
+    ASSERT_TRUE(static_cast<bool>(pPreparsedTrack));
+
+    TrackDAO& trackDao = internalCollection()->getTrackDAO();
+    trackDao.addTracksPrepare();
+    // The file is added in the meantime and evicted from the cache
+    TrackId trackId;
+    {
+        const TrackPointer pAddedTrack = trackDao.addTracksAddFile(trackFile, false);
+        ASSERT_TRUE(static_cast<bool>(pAddedTrack));
+        trackId = pAddedTrack->getId();
+    }
+    ASSERT_FALSE(static_cast<bool>(
+            GlobalTrackCache::lookupTrackById(trackId)));
+
+    const TrackPointer pTrack =
+            trackDao.addTracksAddPreparsedTrack(pPreparsedTrack, false);
+    trackDao.addTracksFinish();
+    ASSERT_TRUE(static_cast<bool>(pTrack));
+    EXPECT_NE(pPreparsedTrack, pTrack);
+    EXPECT_EQ(trackId, pTrack->getId());
+    EXPECT_FALSE(pTrack->isDirty());
+    EXPECT_EQ(pTrack, GlobalTrackCache::lookupTrackById(trackId));
+}
+
+TEST_F(LibraryScannerTest, PreparseUnsupportedFile) {
+    const TrackFile trackFile(kTestDir.absoluteFilePath("cover_test.jpg"));
+    EXPECT_FALSE(static_cast<bool>(
+            ImportFilesTask::preparseTrack(trackFile, SecurityTokenPointer())));
+}
+
+namespace {
+
+class ScannerBenchmarkFixture : public mixxxtest::BenchmarkFixture<LibraryTest> {
+  public:
+    using LibraryTest::dbConnectionPooler;
+    using LibraryTest::internalCollection;
+};
+
+// Generates a directory tree with copies of the supported test files.
+QStringList generateScannerBenchmarkTree(
+        const QDir& rootDir,
+        int numDirectories) {
+    QStringList testFiles;
+    for (const auto& fileInfo : kTestDir.entryInfoList(QDir::Files)) {
+        if (SoundSourceProxy::isFileSupported(fileInfo) &&
+                fileInfo.size() > 0) {
+            testFiles.append(fileInfo.absoluteFilePath());
+        }
+    }
+    QStringList generatedFiles;
+    for (int i = 0; i < numDirectories; ++i) {
+        const QString dirName = QString("dir%1").arg(i);
+        rootDir.mkpath(dirName);
+        const QDir dir(rootDir.absoluteFilePath(dirName));
+        for (const auto& testFile : qAsConst(testFiles)) {
+            const QString fileName = dir.absoluteFilePath(
+                    QFileInfo(testFile).fileName());
+            if (mixxxtest::copyFile(testFile, fileName)) {
+                generatedFiles.append(fileName);
+            }
+        }
+    }
+    return generatedFiles;
+}
+
+} // anonymous namespace
+
+// Measures the throughput of the parse stage of the import
+// pipeline with a varying number of worker threads.
+static void BM_ScannerPreparseTracks(benchmark::State& state) {
+    const int numThreads = state.range(0);
+    QTemporaryDir tempDir;
+    const QStringList files =
+            generateScannerBenchmarkTree(QDir(tempDir.path()), 16);
+
+    const mixxxtest::BenchmarkTrackCacheScope trackCacheScope;
+    while (state.KeepRunning()) {
+        std::atomic<int> nextIndex(0);
+        std::vector<std::thread> workers;
+        for (int i = 0; i < numThreads; ++i) {
+            workers.emplace_back([&files, &nextIndex] {
+                int index;
+                while ((index = nextIndex.fetch_add(1)) < files.size()) {
+                    benchmark::DoNotOptimize(ImportFilesTask::preparseTrack(
+                            TrackFile(files[index]), SecurityTokenPointer()));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * files.size());
+}
+BENCHMARK(BM_ScannerPreparseTracks)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+// Measures a complete scan of the generated directory tree into an empty
+// library, i.e. hashing the directories, parsing the files and writing the
+// new tracks into the database, with a varying number of worker threads.
+static void BM_ScannerScanLibrary(benchmark::State& state) {
+    const int numThreads = state.range(0);
+    QTemporaryDir tempDir;
+    const QStringList files =
+            generateScannerBenchmarkTree(QDir(tempDir.path()), 16);
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        {
+            // Each scan starts with a new, empty database
+            ScannerBenchmarkFixture fixture;
+            fixture.config()->set(ConfigKey("[Library]", "ScannerThreadPoolSize"),
+                    ConfigValue(numThreads));
+            fixture.internalCollection()->getDirectoryDAO().addDirectory(
+                    tempDir.path());
+            LibraryScanner scanner(fixture.dbConnectionPooler(), fixture.config());
+            scanner.start();
+            QEventLoop loop;
+            QObject::connect(&scanner,
+                    &LibraryScanner::scanFinished,
+                    &loop,
+                    &QEventLoop::quit);
+
+            state.ResumeTiming();
+            scanner.scan();
+            loop.exec();
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * files.size());
+}
+BENCHMARK(BM_ScannerScanLibrary)
+        ->RangeMultiplier(2)
+        ->Range(1, 8)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
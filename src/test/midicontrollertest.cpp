@@ -1,4 +1,6 @@
+#include <QCoreApplication>
 #include <QScopedPointer>
+#include <QThread>
 
 #include <gmock/gmock.h>
 
@@ -38,6 +40,15 @@ class MidiControllerTest : public MixxxTest {
         m_pController->visit(&preset);
     }
 
+    // The native scratch options need the engine like script mappings
+    void startEngine() {
+        static_cast<MidiController*>(m_pController.data())->startEngine();
+    }
+
+    void stopEngine() {
+        static_cast<MidiController*>(m_pController.data())->stopEngine();
+    }
+
     void receive(unsigned char status, unsigned char control,
                  unsigned char value) {
         // TODO(rryan): This test doesn't care about timestamps.
@@ -523,3 +534,170 @@ TEST_F(MidiControllerTest, ReceiveMessage_PotMeterCO_14BitPitchBend) {
     receive(MIDI_PITCH_BEND | channel, 0x01, 0x40);
     EXPECT_LT(kMiddleValue, potmeter.get());
 }
+
+TEST_F(MidiControllerTest, ReceiveMessage_PotMeterCO_14BitPitchBendInvert) {
+    ConfigKey key("[Channel1]", "rate");
+
+    const double kMinValue = -1234.5;
+    const double kMaxValue = 678.9;
+    const double kMiddleValue = (kMinValue + kMaxValue) * 0.5;
+    ControlPotmeter potmeter(key, kMinValue, kMaxValue);
+    unsigned char channel = 0x01;
+
+    MidiOptions options;
+    options.invert = true;
+    addMapping(MidiInputMapping(MidiKey(MIDI_PITCH_BEND | channel, 0xFF),
+                                options, key));
+    loadPreset(m_preset);
+
+    receive(MIDI_PITCH_BEND | channel, 0x00, 0x00);
+    EXPECT_DOUBLE_EQ(kMaxValue, potmeter.get());
+
+    receive(MIDI_PITCH_BEND | channel, 0x7F, 0x7F);
+    EXPECT_DOUBLE_EQ(kMinValue, potmeter.get());
+
+    // Inverting keeps the 14-bit resolution
+    receive(MIDI_PITCH_BEND | channel, 0x00, 0x40);
+    const double middleValue = potmeter.get();
+    receive(MIDI_PITCH_BEND | channel, 0x01, 0x40);
+    EXPECT_GT(middleValue, potmeter.get());
+    EXPECT_NEAR(kMiddleValue, middleValue, (kMaxValue - kMinValue) / 64);
+}
+
+TEST_F(MidiControllerTest, ReceiveMessage_ScratchTouch) {
+    ControlObject scratch2Enable(ConfigKey("[Channel1]", "scratch2_enable"));
+    ControlObject scratch2(ConfigKey("[Channel1]", "scratch2"));
+    ControlObject play(ConfigKey("[Channel1]", "play"));
+
+    unsigned char channel = 0x01;
+    unsigned char control = 0x20;
+
+    MidiOptions options;
+    options.scratch_touch = true;
+    MidiInputMapping mapping(MidiKey(MIDI_NOTE_ON | channel, control),
+            options,
+            ConfigKey("[Channel1]", "scratch2_enable"));
+    mapping.scratch.ramp = false;
+    addMapping(mapping);
+    mapping.key = MidiKey(MIDI_NOTE_OFF | channel, control);
+    addMapping(mapping);
+    loadPreset(m_preset);
+    startEngine();
+
+    // Touching the wheel enables scratching, releasing it disables it
+    receive(MIDI_NOTE_ON | channel, control, 0x7F);
+    EXPECT_DOUBLE_EQ(1.0, scratch2Enable.get());
+    receive(MIDI_NOTE_OFF | channel, control, 0x00);
+    EXPECT_DOUBLE_EQ(0.0, scratch2Enable.get());
+
+    // Also with a note on without velocity for the release
+    receive(MIDI_NOTE_ON | channel, control, 0x7F);
+    EXPECT_DOUBLE_EQ(1.0, scratch2Enable.get());
+    receive(MIDI_NOTE_ON | channel, control, 0x00);
+    EXPECT_DOUBLE_EQ(0.0, scratch2Enable.get());
+
+    stopEngine();
+}
+
+TEST_F(MidiControllerTest, ReceiveMessage_ScratchTick) {
+    ControlObject scratch2Enable(ConfigKey("[Channel1]", "scratch2_enable"));
+    ControlObject scratch2(ConfigKey("[Channel1]", "scratch2"));
+    ControlObject play(ConfigKey("[Channel1]", "play"));
+    ControlObject jog(ConfigKey("[Channel1]", "jog"));
+
+    unsigned char channel = 0x01;
+    unsigned char touchControl = 0x20;
+    unsigned char tickControl = 0x21;
+
+    MidiOptions touchOptions;
+    touchOptions.scratch_touch = true;
+    MidiInputMapping touchMapping(MidiKey(MIDI_NOTE_ON | channel, touchControl),
+            touchOptions,
+            ConfigKey("[Channel1]", "scratch2_enable"));
+    touchMapping.scratch.ramp = false;
+    addMapping(touchMapping);
+    MidiOptions tickOptions;
+    tickOptions.scratch_tick = true;
+    addMapping(MidiInputMapping(MidiKey(MIDI_CC | channel, tickControl),
+            tickOptions,
+            ConfigKey("[Channel1]", "jog")));
+    loadPreset(m_preset);
+    startEngine();
+
+    // Without touching the wheel the ticks nudge the deck, the values are
+    // relative to 0x40
+    receive(MIDI_CC | channel, tickControl, 0x41);
+    EXPECT_DOUBLE_EQ(1.0, jog.get());
+    receive(MIDI_CC | channel, tickControl, 0x3E);
+    EXPECT_DOUBLE_EQ(-1.0, jog.get());
+    EXPECT_DOUBLE_EQ(0.0, scratch2.get());
+
+    // While the wheel is touched the ticks scratch the deck
+    receive(MIDI_NOTE_ON | channel, touchControl, 0x7F);
+    ASSERT_DOUBLE_EQ(1.0, scratch2Enable.get());
+    for (int i = 0; i < 50; ++i) {
+        receive(MIDI_CC | channel, tickControl, 0x42);
+        // The engine applies the ticks with its scratch timer
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    EXPECT_LT(0.0, scratch2.get());
+    EXPECT_DOUBLE_EQ(-1.0, jog.get());
+
+    stopEngine();
+}
+
+TEST_F(MidiControllerTest, ReceiveMessage_ScratchTick_SelectKnobInvert) {
+    ControlObject scratch2Enable(ConfigKey("[Channel1]", "scratch2_enable"));
+    ControlObject jog(ConfigKey("[Channel1]", "jog"));
+
+    unsigned char channel = 0x01;
+    unsigned char control = 0x21;
+
+    // 7-bit two's complement, i.e. 0x7F is one tick backwards
+    MidiOptions options;
+    options.scratch_tick = true;
+    options.selectknob = true;
+    addMapping(MidiInputMapping(MidiKey(MIDI_CC | channel, control),
+            options,
+            ConfigKey("[Channel1]", "jog")));
+    loadPreset(m_preset);
+    startEngine();
+
+    receive(MIDI_CC | channel, control, 0x7F);
+    EXPECT_DOUBLE_EQ(-1.0, jog.get());
+    receive(MIDI_CC | channel, control, 0x03);
+    EXPECT_DOUBLE_EQ(2.0, jog.get());
+
+    // Inverted the same values move the other way
+    options.invert = true;
+    m_preset = MidiControllerPreset();
+    addMapping(MidiInputMapping(MidiKey(MIDI_CC | channel, control),
+            options,
+            ConfigKey("[Channel1]", "jog")));
+    loadPreset(m_preset);
+    receive(MIDI_CC | channel, control, 0x7F);
+    EXPECT_DOUBLE_EQ(3.0, jog.get());
+
+    stopEngine();
+}
+
+TEST_F(MidiControllerTest, ReceiveMessage_ScratchTouch_IgnoresNonDeckGroup) {
+    ControlObject scratch2Enable(ConfigKey("[Sampler1]", "scratch2_enable"));
+
+    unsigned char channel = 0x01;
+    unsigned char control = 0x20;
+
+    MidiOptions options;
+    options.scratch_touch = true;
+    addMapping(MidiInputMapping(MidiKey(MIDI_NOTE_ON | channel, control),
+            options,
+            ConfigKey("[Sampler1]", "scratch2_enable")));
+    loadPreset(m_preset);
+    startEngine();
+
+    receive(MIDI_NOTE_ON | channel, control, 0x7F);
+    EXPECT_DOUBLE_EQ(0.0, scratch2Enable.get());
+
+    stopEngine();
+}
@@ -151,4 +151,8 @@ bool copyFile(const QString& srcFileName, const QString& dstFileName) {
     return true;
 }
 
+QDir sourceTestDir() {
+    return QDir(QDir::current().absoluteFilePath("src/test"));
+}
+
 } // namespace mixxxtest
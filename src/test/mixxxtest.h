@@ -67,6 +67,10 @@ QString createEmptyTemporaryFile(const QString& fileNameTemplate);
 
 bool copyFile(const QString& srcFileName, const QString& dstFileName);
 
+/// Returns the directory with the test files that are shipped with the
+/// sources, i.e. src/test relative to the working directory.
+QDir sourceTestDir();
+
 class FileRemover final {
   public:
     explicit FileRemover(const QString& fileName)
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include "engine/offlinerenderer.h"
+#include "test/mixxxtest.h"
+#include "util/types.h"
+
+namespace {
+
+class OfflineRendererTest : public MixxxTest {
+  protected:
+    static bool parse(QString text,
+            OfflineRenderer::Script* pScript,
+            QString* pErrorMessage) {
+        QTextStream stream(&text);
+        return OfflineRenderer::parseScript(&stream, pScript, pErrorMessage);
+    }
+};
+
+TEST_F(OfflineRendererTest, parseScript) {
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    ASSERT_TRUE(parse(
+            "# Comment\n"
+            "decks 3\n"
+            "samplers 16\n"
+            "buffer 512\n"
+            "\n"
+            "2.5 set [Master] crossfader -0.5\n"
+            "10 end\n"
+            "0 load [Channel1] /path/with spaces/track.mp3\n"
+            "0 bpm [Channel1] 124.5\n"
+            "2.5 set [Channel1] hotcue_1_activate 1\n"
+            "20 set [Channel1] play 0\n",
+            &script,
+            &errorMessage))
+            << errorMessage.toStdString();
+    EXPECT_EQ(3, script.deckCount);
+    EXPECT_EQ(16, script.samplerCount);
+    EXPECT_EQ(44100, script.sampleRate);
+    EXPECT_EQ(512, script.framesPerBuffer);
+
+    // Sorted by time and truncated after the end
+    ASSERT_EQ(5, script.events.size());
+    EXPECT_EQ(OfflineRenderer::Event::Type::Load, script.events[0].type);
+    EXPECT_EQ(QString("[Channel1]"), script.events[0].key.group);
+    EXPECT_EQ(QString("/path/with spaces/track.mp3"), script.events[0].filePath);
+    EXPECT_EQ(OfflineRenderer::Event::Type::Bpm, script.events[1].type);
+    EXPECT_DOUBLE_EQ(124.5, script.events[1].value);
+    EXPECT_EQ(ConfigKey("[Master]", "crossfader"), script.events[2].key);
+    EXPECT_DOUBLE_EQ(-0.5, script.events[2].value);
+    EXPECT_EQ(ConfigKey("[Channel1]", "hotcue_1_activate"), script.events[3].key);
+    EXPECT_EQ(OfflineRenderer::Event::Type::End, script.events[4].type);
+    EXPECT_DOUBLE_EQ(10, script.events[4].time);
+}
+
+TEST_F(OfflineRendererTest, parseInvalidScript) {
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    EXPECT_FALSE(parse("0 set [Channel1] play 1\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("0 set Channel1 play 1\n1 end\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("0 set [Channel1] play on\n1 end\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("-1 end\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("1 end\nbuffer 256\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("decks 0\n1 end\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("samplers 65\n1 end\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("0 bpm [Channel1] 0\n1 end\n", &script, &errorMessage));
+    EXPECT_FALSE(parse("0 eject [Channel1]\n1 end\n", &script, &errorMessage));
+    EXPECT_TRUE(errorMessage.startsWith("Line 1:"));
+}
+
+TEST_F(OfflineRendererTest, render) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString outputFilePath = tempDir.filePath("render.wav");
+
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    ASSERT_TRUE(parse(
+            QString("buffer 1024\n"
+                    "0 load [Channel1] %1\n"
+                    "0 set [Channel1] play 1\n"
+                    "0.5 set [Channel1] rate 0.5\n"
+                    "0.5 load [Channel2] %1\n"
+                    "1 set [Channel2] play 1\n"
+                    "1 set [Master] crossfader 1\n"
+                    "2 end\n")
+                    .arg(mixxxtest::sourceTestDir().absoluteFilePath("sine-30.wav")),
+            &script,
+            &errorMessage))
+            << errorMessage.toStdString();
+
+    OfflineRenderer renderer(config());
+    ASSERT_TRUE(renderer.render(script, outputFilePath, &errorMessage))
+            << errorMessage.toStdString();
+    // The last buffer starts before the end
+    const int expectedBuffers = (2 * 44100 + 1023) / 1024;
+    EXPECT_EQ(expectedBuffers, renderer.processedBuffers());
+    EXPECT_GT(renderer.buffersPerSecond(), 0);
+
+    // 16 bit stereo and a header
+    EXPECT_GT(QFileInfo(outputFilePath).size(),
+            static_cast<qint64>(expectedBuffers) * 1024 * 2 * 2);
+}
+
+TEST_F(OfflineRendererTest, emptySamplersDoNotAllocate) {
+    const QString filePath = mixxxtest::sourceTestDir().absoluteFilePath("sine-30.wav");
+    OfflineRenderer renderer(config());
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    ASSERT_TRUE(parse(
+            QString("samplers 8\n"
+                    "0 load [Channel1] %1\n"
+                    "0.1 end\n")
+                    .arg(filePath),
+            &script,
+            &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_TRUE(renderer.render(script, QString(), &errorMessage))
+            << errorMessage.toStdString();
+    // Only the deck with the track
+    const qint64 playerBytes = renderer.trackBufferBytes();
+    EXPECT_GT(playerBytes, 0);
+
+    ASSERT_TRUE(parse(
+            QString("samplers 8\n"
+                    "0 load [Channel1] %1\n"
+                    "0 load [Sampler3] %1\n"
+                    "0.1 end\n")
+                    .arg(filePath),
+            &script,
+            &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_TRUE(renderer.render(script, QString(), &errorMessage))
+            << errorMessage.toStdString();
+    EXPECT_EQ(2 * playerBytes, renderer.trackBufferBytes());
+}
+
+TEST_F(OfflineRendererTest, residentSamplesAreShared) {
+    const QString filePath = mixxxtest::sourceTestDir().absoluteFilePath("sine-30.wav");
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    OfflineRenderer renderer(config());
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    ASSERT_TRUE(parse(
+            QString("samplers 2\n"
+                    "0 load [Sampler1] %1\n"
+                    "0.1 end\n")
+                    .arg(filePath),
+            &script,
+            &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_TRUE(renderer.render(script, QString(), &errorMessage))
+            << errorMessage.toStdString();
+    const qint64 playerBytes = renderer.trackBufferBytes();
+
+    ASSERT_TRUE(parse(
+            QString("samplers 2\n"
+                    "0 set [Sampler1] resident 1\n"
+                    "0 load [Sampler1] %1\n"
+                    "0.1 end\n")
+                    .arg(filePath),
+            &script,
+            &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_TRUE(renderer.render(script, QString(), &errorMessage))
+            << errorMessage.toStdString();
+    // 30 s of stereo samples that replace the cache of the reader
+    const qint64 residentBytes = 30 * 44100 * 2 * sizeof(CSAMPLE);
+    const qint64 residentPlayerBytes = renderer.trackBufferBytes() - residentBytes;
+    EXPECT_GE(residentPlayerBytes, 0);
+    EXPECT_LT(residentPlayerBytes, playerBytes);
+
+    // The second sampler shares the decoded samples of the first one
+    const QString playBoth = QString(
+            "samplers 2\n"
+            "0 set [Sampler1] resident %2\n"
+            "0 set [Sampler2] resident %2\n"
+            "0 load [Sampler1] %1\n"
+            "0 load [Sampler2] %1\n"
+            "0.1 set [Sampler1] play 1\n"
+            "0.1 set [Sampler2] play 1\n"
+            "0.5 end\n");
+    const QString residentOutputPath = tempDir.filePath("resident.wav");
+    ASSERT_TRUE(parse(playBoth.arg(filePath).arg(1), &script, &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_TRUE(renderer.render(script, residentOutputPath, &errorMessage))
+            << errorMessage.toStdString();
+    EXPECT_EQ(2 * residentPlayerBytes + residentBytes, renderer.trackBufferBytes());
+
+    // Both samplers play the same samples as when reading the file in chunks
+    const QString chunkedOutputPath = tempDir.filePath("chunked.wav");
+    ASSERT_TRUE(parse(playBoth.arg(filePath).arg(0), &script, &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_TRUE(renderer.render(script, chunkedOutputPath, &errorMessage))
+            << errorMessage.toStdString();
+    EXPECT_EQ(2 * playerBytes, renderer.trackBufferBytes());
+    QFile residentOutput(residentOutputPath);
+    QFile chunkedOutput(chunkedOutputPath);
+    ASSERT_TRUE(residentOutput.open(QIODevice::ReadOnly));
+    ASSERT_TRUE(chunkedOutput.open(QIODevice::ReadOnly));
+    const QByteArray residentSamples = residentOutput.readAll();
+    EXPECT_GT(residentSamples.size(), 0);
+    EXPECT_TRUE(residentSamples == chunkedOutput.readAll());
+}
+
+TEST_F(OfflineRendererTest, renderUnknownControl) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+
+    OfflineRenderer::Script script;
+    QString errorMessage;
+    ASSERT_TRUE(parse("0 set [Channel7] play 1\n1 end\n", &script, &errorMessage));
+    OfflineRenderer renderer(config());
+    EXPECT_FALSE(renderer.render(
+            script, tempDir.filePath("render.wav"), &errorMessage));
+    EXPECT_FALSE(errorMessage.isEmpty());
+}
+
+} // namespace
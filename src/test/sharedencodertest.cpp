@@ -0,0 +1,243 @@
+#ifdef __BROADCAST__
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QList>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "encoder/encoderbroadcastsettings.h"
+#include "engine/engine.h"
+#include "engine/sidechain/sharedencoder.h"
+#include "preferences/broadcastprofile.h"
+#include "recording/defs_recording.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kFramesPerChunk = 4096;
+
+class SharedEncoderTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pProfile = BroadcastProfilePtr(new BroadcastProfile("Test"));
+        m_pProfile->setFormat(ENCODING_OGG);
+        m_pProfile->setBitrate(128);
+    }
+
+    std::unique_ptr<SharedEncoder::Subscription> subscribe() {
+        QString errorMessage;
+        auto pSubscription = SharedEncoder::subscribe(
+                std::make_shared<EncoderBroadcastSettings>(m_pProfile),
+                kSampleRate,
+                &errorMessage);
+        EXPECT_TRUE(pSubscription) << errorMessage.toStdString();
+        return pSubscription;
+    }
+
+    // Feeds the chunk with the given index of a sine tone, like a
+    // connection that reads it from its FIFO
+    static void feed(SharedEncoder::Subscription* pSubscription,
+            int chunkIndex,
+            int frameOffset = 0) {
+        std::vector<CSAMPLE> chunk(kFramesPerChunk * mixxx::kEngineChannelCount);
+        const qint64 streamFrame =
+                static_cast<qint64>(chunkIndex) * kFramesPerChunk + frameOffset;
+        for (int frame = 0; frame < kFramesPerChunk; ++frame) {
+            const CSAMPLE value = static_cast<CSAMPLE>(0.5 *
+                    std::sin(2 * M_PI * 440 * (streamFrame + frame) / kSampleRate));
+            chunk[frame * 2] = value;
+            chunk[frame * 2 + 1] = value;
+        }
+        pSubscription->encodeBuffer(
+                chunk.data(), static_cast<int>(chunk.size()), streamFrame);
+    }
+
+    static QList<QByteArray> takePackets(SharedEncoder::Subscription* pSubscription) {
+        QList<QByteArray> packets;
+        QByteArray packet;
+        while (pSubscription->takePacket(&packet)) {
+            packets.append(packet);
+        }
+        return packets;
+    }
+
+    BroadcastProfilePtr m_pProfile;
+};
+
+TEST_F(SharedEncoderTest, ConnectionsShareEncoder) {
+    auto pFirst = subscribe();
+    auto pSecond = subscribe();
+    ASSERT_TRUE(pFirst);
+    ASSERT_TRUE(pSecond);
+    EXPECT_EQ(2, pFirst->subscriberCount());
+
+    // Each chunk is only encoded once
+    for (int i = 0; i < 50; ++i) {
+        feed(pFirst.get(), i);
+        feed(pSecond.get(), i);
+    }
+    EXPECT_EQ(50 * kFramesPerChunk, pFirst->encodedFrames());
+
+    // Both connections receive the same packets
+    const QList<QByteArray> firstPackets = takePackets(pFirst.get());
+    EXPECT_FALSE(firstPackets.isEmpty());
+    EXPECT_EQ(firstPackets, takePackets(pSecond.get()));
+}
+
+TEST_F(SharedEncoderTest, HandoverContinuesWithoutGap) {
+    auto pFirst = subscribe();
+    auto pSecond = subscribe();
+    ASSERT_TRUE(pFirst);
+    ASSERT_TRUE(pSecond);
+
+    // The second connection lags behind
+    for (int i = 0; i < 20; ++i) {
+        feed(pFirst.get(), i);
+    }
+    for (int i = 0; i < 18; ++i) {
+        feed(pSecond.get(), i);
+    }
+    EXPECT_EQ(20 * kFramesPerChunk, pSecond->encodedFrames());
+
+    // The encoding connection stops. The second connection continues
+    // with its buffered samples immediately, without encoding the
+    // samples that are already encoded again.
+    pFirst.reset();
+    takePackets(pSecond.get());
+    for (int i = 18; i < 50; ++i) {
+        feed(pSecond.get(), i);
+    }
+    EXPECT_EQ(50 * kFramesPerChunk, pSecond->encodedFrames());
+    EXPECT_FALSE(takePackets(pSecond.get()).isEmpty());
+}
+
+TEST_F(SharedEncoderTest, HandoverEncodesPartialChunk) {
+    auto pFirst = subscribe();
+    auto pSecond = subscribe();
+    ASSERT_TRUE(pFirst);
+    ASSERT_TRUE(pSecond);
+
+    // The chunks of the connections are not aligned
+    constexpr int kFrameOffset = kFramesPerChunk / 4;
+    for (int i = 0; i < 10; ++i) {
+        feed(pFirst.get(), i);
+        feed(pSecond.get(), i, kFrameOffset);
+    }
+    EXPECT_EQ(10 * kFramesPerChunk + kFrameOffset, pFirst->encodedFrames());
+
+    pSecond.reset();
+    feed(pFirst.get(), 10);
+    feed(pFirst.get(), 11);
+    EXPECT_EQ(12 * kFramesPerChunk, pFirst->encodedFrames());
+}
+
+TEST_F(SharedEncoderTest, LateSubscriptionReceivesOggHeaders) {
+    auto pFirst = subscribe();
+    ASSERT_TRUE(pFirst);
+    for (int i = 0; i < 50; ++i) {
+        feed(pFirst.get(), i);
+    }
+    const QList<QByteArray> firstPackets = takePackets(pFirst.get());
+    ASSERT_GE(firstPackets.size(), 2);
+    // The identification, comment and setup headers
+    QList<QByteArray> headers;
+    for (const auto& packet : firstPackets) {
+        // Header pages have a granule position of 0
+        if (packet.mid(6, 8) != QByteArray(8, '\0')) {
+            break;
+        }
+        headers.append(packet);
+    }
+    ASSERT_FALSE(headers.isEmpty());
+    ASSERT_LT(headers.size(), firstPackets.size());
+
+    // The headers are queued before any audio is fed
+    auto pLate = subscribe();
+    ASSERT_TRUE(pLate);
+    int headerBytes = 0;
+    for (const auto& header : headers) {
+        headerBytes += header.size();
+    }
+    EXPECT_EQ(headerBytes, pLate->queuedBytes());
+
+    feed(pFirst.get(), 50);
+    feed(pLate.get(), 50);
+    const QList<QByteArray> latePackets = takePackets(pLate.get());
+    ASSERT_GE(latePackets.size(), headers.size());
+    EXPECT_EQ(headers, latePackets.mid(0, headers.size()));
+    for (const auto& packet : latePackets) {
+        EXPECT_TRUE(packet.startsWith("OggS"));
+    }
+}
+
+TEST_F(SharedEncoderTest, TakePacketsCoalescesInOrder) {
+    auto pFirst = subscribe();
+    auto pSecond = subscribe();
+    ASSERT_TRUE(pFirst);
+    ASSERT_TRUE(pSecond);
+    for (int i = 0; i < 100; ++i) {
+        feed(pFirst.get(), i);
+    }
+    QByteArray packets;
+    int maxPacketSize = 0;
+    for (const auto& packet : takePackets(pFirst.get())) {
+        packets.append(packet);
+        maxPacketSize = math_max(maxPacketSize, packet.size());
+    }
+    ASSERT_GT(packets.size(), 4 * maxPacketSize);
+
+    // Batches of at least the requested size, except for the last one,
+    // that exceed it by less than a packet
+    const int maxBytes = 2 * maxPacketSize;
+    QByteArray batches;
+    QByteArray batch;
+    int batchCount = 0;
+    while (pSecond->takePackets(&batch, maxBytes)) {
+        ++batchCount;
+        EXPECT_LT(batch.size(), maxBytes + maxPacketSize);
+        if (batches.size() + batch.size() < packets.size()) {
+            EXPECT_GE(batch.size(), maxBytes);
+        }
+        batches.append(batch);
+    }
+    EXPECT_GT(batchCount, 1);
+    EXPECT_EQ(0, pSecond->queuedBytes());
+    EXPECT_EQ(packets, batches);
+}
+
+TEST_F(SharedEncoderTest, DiscardsPacketsOfStalledConnection) {
+    auto pSending = subscribe();
+    auto pStalled = subscribe();
+    ASSERT_TRUE(pSending);
+    ASSERT_TRUE(pStalled);
+    constexpr int kMaxQueuedBytes = 16384;
+    pStalled->setMaxQueuedBytes(kMaxQueuedBytes);
+
+    int sentBytes = 0;
+    int maxStalledBytes = 0;
+    for (int i = 0; i < 200; ++i) {
+        feed(pSending.get(), i);
+        feed(pStalled.get(), i);
+        for (const auto& packet : takePackets(pSending.get())) {
+            sentBytes += packet.size();
+        }
+        maxStalledBytes = math_max(maxStalledBytes, pStalled->queuedBytes());
+    }
+    // The connection that sends its packets is not affected
+    EXPECT_GT(sentBytes, 4 * kMaxQueuedBytes);
+    EXPECT_EQ(0, pSending->queuedBytes());
+    // The queue of the stalled connection is limited to the maximum and
+    // a single page
+    EXPECT_GT(maxStalledBytes, 0);
+    EXPECT_LT(maxStalledBytes, 2 * kMaxQueuedBytes);
+    EXPECT_LT(pStalled->queuedBytes(), sentBytes);
+}
+
+} // namespace
+
+#endif // __BROADCAST__
@@ -0,0 +1,269 @@
+#ifdef __BROADCAST__
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <shout/shout.h>
+#ifdef __WINDOWS__
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+#include "broadcast/defs_broadcast.h"
+#include "control/controlobject.h"
+#include "engine/sidechain/shoutconnection.h"
+#include "mixer/playerinfo.h"
+#include "preferences/broadcastprofile.h"
+#include "recording/defs_recording.h"
+#include "test/mixxxtest.h"
+#include "util/fifo.h"
+#include "util/math.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kFramesPerChunk = 4096;
+constexpr int kTimeoutMillis = 10000;
+constexpr int kStubReadBufferBytes = 4096;
+
+// Accepts a single source connection like an Icecast server and records
+// the received stream
+class IcecastStubServer {
+  public:
+    bool listen() {
+        return m_server.listen(QHostAddress::LocalHost);
+    }
+
+    quint16 port() const {
+        return m_server.serverPort();
+    }
+
+    // Limits the receive window of the connections that are accepted
+    // afterwards, i.e. the data that the client can send before the
+    // server reads it
+    bool setReceiveBufferSize(int bytes) {
+        return setsockopt(m_server.socketDescriptor(),
+                       SOL_SOCKET,
+                       SO_RCVBUF,
+                       reinterpret_cast<const char*>(&bytes),
+                       sizeof(bytes)) == 0;
+    }
+
+    // Reads the request of the source client and confirms it
+    bool acceptSource() {
+        if (!m_server.waitForNewConnection(kTimeoutMillis)) {
+            return false;
+        }
+        m_pSocket.reset(m_server.nextPendingConnection());
+        QByteArray request;
+        while (!request.contains("\r\n\r\n")) {
+            if (!m_pSocket->waitForReadyRead(kTimeoutMillis)) {
+                return false;
+            }
+            request += m_pSocket->readAll();
+        }
+        const int headerLength = request.indexOf("\r\n\r\n") + 4;
+        m_requestHeader = request.left(headerLength);
+        m_stream = request.mid(headerLength);
+        // Do not read ahead of receive() into the buffer of the socket
+        m_pSocket->setReadBufferSize(kStubReadBufferBytes);
+        m_pSocket->write("HTTP/1.0 200 OK\r\n\r\n");
+        return m_pSocket->waitForBytesWritten(kTimeoutMillis);
+    }
+
+    // Receives the stream until it contains at least the given bytes
+    bool receive(int bytes) {
+        while (m_stream.size() < bytes) {
+            if (!m_pSocket->waitForReadyRead(kTimeoutMillis)) {
+                return false;
+            }
+            m_stream += m_pSocket->readAll();
+        }
+        return true;
+    }
+
+    // Appends the data that is available, waits briefly if there is none
+    void receivePending() {
+        m_pSocket->waitForReadyRead(10);
+        m_stream += m_pSocket->readAll();
+    }
+
+    const QByteArray& requestHeader() const {
+        return m_requestHeader;
+    }
+
+    const QByteArray& stream() const {
+        return m_stream;
+    }
+
+  private:
+    QTcpServer m_server;
+    std::unique_ptr<QTcpSocket> m_pSocket;
+    QByteArray m_requestHeader;
+    QByteArray m_stream;
+};
+
+class ShoutConnectionTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        shout_init();
+        PlayerInfo::create();
+        m_pSampleRate = std::make_unique<ControlObject>(
+                ConfigKey("[Master]", "samplerate"));
+        m_pSampleRate->set(kSampleRate);
+        m_pBroadcastEnabled = std::make_unique<ControlObject>(
+                ConfigKey(BROADCAST_PREF_KEY, "enabled"));
+        m_pBroadcastEnabled->set(1);
+
+        ASSERT_TRUE(m_server.listen());
+        m_pProfile = BroadcastProfilePtr(new BroadcastProfile("Test"));
+        m_pProfile->setHost("127.0.0.1");
+        m_pProfile->setPort(m_server.port());
+        m_pProfile->setServertype(BROADCAST_SERVER_ICECAST2);
+        m_pProfile->setMountPoint("/mixxx");
+        m_pProfile->setPassword("hackme");
+        m_pProfile->setFormat(ENCODING_OGG);
+        m_pProfile->setBitrate(128);
+        m_pProfile->setEnabled(true);
+
+        m_pOutputFifo = QSharedPointer<FIFO<CSAMPLE>>(
+                new FIFO<CSAMPLE>(kSampleRate * mixxx::kEngineChannelCount));
+        m_pConnection = std::make_unique<ShoutConnection>(m_pProfile, config());
+        m_pConnection->setOutputFifo(m_pOutputFifo);
+    }
+
+    void TearDown() override {
+        if (m_pConnection) {
+            // Stop the thread of the connection
+            m_pProfile->setEnabled(false);
+            m_pConnection->outputAvailable();
+            m_pConnection->wait(kTimeoutMillis);
+            m_pConnection.reset();
+        }
+        PlayerInfo::destroy();
+        shout_shutdown();
+    }
+
+    template<typename Condition>
+    static bool waitUntil(Condition condition) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!condition()) {
+            if (timer.elapsed() > kTimeoutMillis) {
+                return false;
+            }
+            QThread::msleep(10);
+        }
+        return true;
+    }
+
+    bool waitUntilConnected() {
+        return waitUntil([this] {
+            return m_pProfile->connectionStatus() == BroadcastProfile::STATUS_CONNECTED;
+        });
+    }
+
+    // Feeds a sine tone like SoundDeviceNetwork. Returns false if the
+    // connection did not consume the samples in time.
+    bool feed(double seconds) {
+        std::vector<CSAMPLE> chunk(kFramesPerChunk * mixxx::kEngineChannelCount);
+        const int chunks = static_cast<int>(seconds * kSampleRate / kFramesPerChunk);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < chunks; ++i) {
+            for (int frame = 0; frame < kFramesPerChunk; ++frame) {
+                const CSAMPLE value = static_cast<CSAMPLE>(0.5 *
+                        std::sin(2 * M_PI * 440 * (m_feedFrames + frame) / kSampleRate));
+                chunk[frame * 2] = value;
+                chunk[frame * 2 + 1] = value;
+            }
+            while (m_pOutputFifo->writeAvailable() < static_cast<int>(chunk.size())) {
+                if (timer.elapsed() > kTimeoutMillis) {
+                    return false;
+                }
+                QThread::msleep(1);
+            }
+            m_pOutputFifo->write(chunk.data(), static_cast<int>(chunk.size()));
+            m_pConnection->outputAvailable();
+            m_feedFrames += kFramesPerChunk;
+        }
+        return true;
+    }
+
+    IcecastStubServer m_server;
+    std::unique_ptr<ControlObject> m_pSampleRate;
+    std::unique_ptr<ControlObject> m_pBroadcastEnabled;
+    BroadcastProfilePtr m_pProfile;
+    QSharedPointer<FIFO<CSAMPLE>> m_pOutputFifo;
+    std::unique_ptr<ShoutConnection> m_pConnection;
+    qint64 m_feedFrames = 0;
+};
+
+TEST_F(ShoutConnectionTest, StreamToServer) {
+    ASSERT_TRUE(m_pConnection->serverConnect());
+    ASSERT_TRUE(m_server.acceptSource());
+    EXPECT_TRUE(m_server.requestHeader().startsWith("SOURCE /mixxx HTTP/1.0\r\n"));
+    EXPECT_TRUE(m_server.requestHeader().contains("Content-Type: application/ogg\r\n"));
+    ASSERT_TRUE(waitUntilConnected());
+
+    ASSERT_TRUE(feed(2.0));
+    // The header pages and at least one page of audio
+    ASSERT_TRUE(m_server.receive(8192));
+    EXPECT_TRUE(m_server.stream().startsWith("OggS"));
+}
+
+TEST_F(ShoutConnectionTest, CongestedServerDoesNotStallEncoding) {
+    // The client can only send a few kilobytes before the socket is
+    // congested while the server does not read
+    ASSERT_TRUE(m_server.setReceiveBufferSize(kStubReadBufferBytes));
+    m_pProfile->setBitrate(320);
+    ASSERT_TRUE(m_pConnection->serverConnect());
+    ASSERT_TRUE(m_server.acceptSource());
+    ASSERT_TRUE(waitUntilConnected());
+
+    // Feed until the packets pile up in the queue of the encoder. The
+    // samples are still consumed and encoded much faster than real
+    // time, the connection thread does not wait for the socket.
+    QElapsedTimer timer;
+    timer.start();
+    double fedSeconds = 0;
+    while (m_pConnection->encoderQueuedBytes() <= ShoutConnection::kSendBatchBytes) {
+        ASSERT_LT(fedSeconds, 60.0) << "The socket did not congest";
+        ASSERT_TRUE(feed(1.0));
+        fedSeconds += 1.0;
+        ASSERT_TRUE(waitUntil([this] {
+            return m_pOutputFifo->readAvailable() == 0;
+        }));
+    }
+    EXPECT_LT(timer.elapsed(), fedSeconds * 1000 / 2);
+
+    // Back-pressure: libshout only holds the data up to the high-water
+    // mark and a single batch, the rest stays in the encoder queue
+    EXPECT_GT(m_pConnection->socketQueuedBytes(), 0);
+    EXPECT_LE(m_pConnection->socketQueuedBytes(),
+            ShoutConnection::kSendHighWaterBytes + 2 * ShoutConnection::kSendBatchBytes);
+
+    // The whole backlog is sent when the server reads again
+    const int pendingBytes = m_server.stream().size() +
+            m_pConnection->socketQueuedBytes() +
+            m_pConnection->encoderQueuedBytes();
+    ASSERT_TRUE(waitUntil([this] {
+        m_server.receivePending();
+        return m_pConnection->socketQueuedBytes() == 0 &&
+                m_pConnection->encoderQueuedBytes() == 0;
+    }));
+    EXPECT_GE(m_server.stream().size(), pendingBytes);
+    EXPECT_TRUE(m_server.stream().startsWith("OggS"));
+}
+
+} // namespace
+
+#endif // __BROADCAST__
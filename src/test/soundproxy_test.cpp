@@ -1,8 +1,16 @@
+#include <benchmark/benchmark.h>
+
+#include <QDateTime>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QtDebug>
 
 #include "sources/audiosourcestereoproxy.h"
 #include "sources/soundsourceproxy.h"
+#ifdef __MAD__
+#include "sources/soundsourcemp3.h"
+#endif
+#include "test/benchmarkutil.h"
 #include "test/mixxxtest.h"
 #include "track/track.h"
 #include "track/trackmetadata.h"
@@ -662,3 +670,254 @@ TEST_F(SoundSourceProxyTest, regressionTestCachingReaderChunkJumpForward) {
         }
     }
 }
+
+#ifdef __MAD__
+namespace {
+
+// Opens an MP3 file and decodes the given number of frames near the end
+mixxx::SampleBuffer openMp3AndReadTail(
+        const QString& filePath,
+        SINT frameCount,
+        mixxx::IndexRange* pFrameIndexRange) {
+    auto pSoundSource = std::make_shared<mixxx::SoundSourceMp3>(
+            QUrl::fromLocalFile(filePath));
+    EXPECT_EQ(mixxx::AudioSource::OpenResult::Succeeded,
+            pSoundSource->open(mixxx::AudioSource::OpenMode::Strict));
+    *pFrameIndexRange = pSoundSource->frameIndexRange();
+    mixxx::SampleBuffer readBuffer(
+            pSoundSource->getSignalInfo().frames2samples(frameCount));
+    const auto readRange = mixxx::IndexRange::forward(
+            pSoundSource->frameIndexMax() - 2 * frameCount, frameCount);
+    EXPECT_EQ(readRange,
+            pSoundSource
+                    ->readSampleFrames(mixxx::WritableSampleFrames(
+                            readRange,
+                            mixxx::SampleBuffer::WritableSlice(readBuffer)))
+                    .frameIndexRange());
+    return readBuffer;
+}
+
+QByteArray readFileContent(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+} // anonymous namespace
+
+TEST_F(SoundSourceProxyTest, mp3SeekIndex) {
+    const SINT kReadFrameCount = 4096;
+    const QString filePath = kTestDir.absoluteFilePath("cover-test-vbr.mp3");
+    QTemporaryDir cacheDir;
+    ASSERT_TRUE(cacheDir.isValid());
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+    mixxx::IndexRange expectedRange;
+    const auto expected = openMp3AndReadTail(
+            filePath, kReadFrameCount, &expectedRange);
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(cacheDir.path());
+    // The first invocation scans the file and stores the seek index
+    // that is restored by the second invocation
+    for (int i = 0; i < 2; ++i) {
+        mixxx::IndexRange actualRange;
+        const auto actual = openMp3AndReadTail(
+                filePath, kReadFrameCount, &actualRange);
+        EXPECT_EQ(expectedRange, actualRange);
+        ASSERT_EQ(expected.size(), actual.size());
+        expectDecodedSamplesEqual(
+                expected.size(),
+                expected.data(),
+                actual.data(),
+                "Decoding mismatch with seek index");
+        EXPECT_EQ(1, QDir(cacheDir.path()).entryList(QDir::Files).size());
+    }
+
+    // A corrupt seek index is ignored
+    const QString indexFilePath = QDir(cacheDir.path()).absoluteFilePath(
+            QDir(cacheDir.path()).entryList(QDir::Files).first());
+    {
+        QFile indexFile(indexFilePath);
+        ASSERT_TRUE(indexFile.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(indexFile.resize(indexFile.size() / 2));
+    }
+    mixxx::IndexRange actualRange;
+    openMp3AndReadTail(filePath, kReadFrameCount, &actualRange);
+    EXPECT_EQ(expectedRange, actualRange);
+
+    // A seek index with modified seek frames is ignored. The compressed
+    // seek frames are stored at the end, followed by their checksum.
+    const QByteArray storedIndex = readFileContent(indexFilePath);
+    ASSERT_FALSE(storedIndex.isEmpty());
+    {
+        QFile indexFile(indexFilePath);
+        ASSERT_TRUE(indexFile.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(indexFile.seek(indexFile.size() - 8));
+        const char modifiedByte = static_cast<char>(
+                storedIndex.at(storedIndex.size() - 8) ^ 0x01);
+        ASSERT_EQ(1, indexFile.write(&modifiedByte, 1));
+    }
+    const auto actual = openMp3AndReadTail(
+            filePath, kReadFrameCount, &actualRange);
+    EXPECT_EQ(expectedRange, actualRange);
+    ASSERT_EQ(expected.size(), actual.size());
+    expectDecodedSamplesEqual(
+            expected.size(),
+            expected.data(),
+            actual.data(),
+            "Decoding mismatch with modified seek index");
+    // Replaced after scanning the file again
+    EXPECT_EQ(storedIndex, readFileContent(indexFilePath));
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+}
+
+TEST_F(SoundSourceProxyTest, mp3SeekIndexStaleModificationTime) {
+    const SINT kReadFrameCount = 4096;
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString filePath = tempDir.filePath("track.mp3");
+    ASSERT_TRUE(mixxxtest::copyFile(
+            kTestDir.absoluteFilePath("cover-test-vbr.mp3"), filePath));
+    const QString cacheDir = tempDir.filePath("seekindex");
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(cacheDir);
+
+    mixxx::IndexRange range;
+    openMp3AndReadTail(filePath, kReadFrameCount, &range);
+    const QStringList indexFiles = QDir(cacheDir).entryList(QDir::Files);
+    ASSERT_EQ(1, indexFiles.size());
+    const QString indexFilePath = QDir(cacheDir).absoluteFilePath(indexFiles.first());
+    const QByteArray storedIndex = readFileContent(indexFilePath);
+    ASSERT_FALSE(storedIndex.isEmpty());
+
+    // Only touch the file without modifying its contents
+    {
+        QFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(
+                file.fileTime(QFileDevice::FileModificationTime).addSecs(-3600),
+                QFileDevice::FileModificationTime));
+    }
+
+    // The stale seek index is not restored, but replaced
+    mixxx::IndexRange actualRange;
+    openMp3AndReadTail(filePath, kReadFrameCount, &actualRange);
+    EXPECT_EQ(range, actualRange);
+    const QByteArray replacedIndex = readFileContent(indexFilePath);
+    EXPECT_NE(storedIndex, replacedIndex);
+
+    // The replaced seek index is restored
+    openMp3AndReadTail(filePath, kReadFrameCount, &actualRange);
+    EXPECT_EQ(range, actualRange);
+    EXPECT_EQ(replacedIndex, readFileContent(indexFilePath));
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+}
+
+TEST_F(SoundSourceProxyTest, mp3SeekIndexStaleFileSize) {
+    const SINT kReadFrameCount = 4096;
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString filePath = tempDir.filePath("track.mp3");
+    ASSERT_TRUE(mixxxtest::copyFile(
+            kTestDir.absoluteFilePath("cover-test-vbr.mp3"), filePath));
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(tempDir.filePath("seekindex"));
+
+    mixxx::IndexRange storedRange;
+    openMp3AndReadTail(filePath, kReadFrameCount, &storedRange);
+
+    // Append a copy of the audio data while keeping the time stamp
+    {
+        const QByteArray content = readFileContent(filePath);
+        QFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite | QIODevice::Append));
+        const QDateTime lastModified = file.fileTime(QFileDevice::FileModificationTime);
+        ASSERT_EQ(content.size(), file.write(content));
+        ASSERT_TRUE(file.flush());
+        ASSERT_TRUE(file.setFileTime(lastModified, QFileDevice::FileModificationTime));
+    }
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+    mixxx::IndexRange expectedRange;
+    const auto expected = openMp3AndReadTail(
+            filePath, kReadFrameCount, &expectedRange);
+    EXPECT_LT(storedRange.length(), expectedRange.length());
+
+    // The stale seek index would end at the end of the original file
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(tempDir.filePath("seekindex"));
+    mixxx::IndexRange actualRange;
+    const auto actual = openMp3AndReadTail(
+            filePath, kReadFrameCount, &actualRange);
+    EXPECT_EQ(expectedRange, actualRange);
+    ASSERT_EQ(expected.size(), actual.size());
+    expectDecodedSamplesEqual(
+            expected.size(),
+            expected.data(),
+            actual.data(),
+            "Decoding mismatch with stale seek index");
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+}
+
+TEST_F(SoundSourceProxyTest, mp3SeekIndexPurge) {
+    const SINT kReadFrameCount = 4096;
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString cacheDir = tempDir.filePath("seekindex");
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(cacheDir);
+    for (int i = 0; i < 3; ++i) {
+        const QString filePath = tempDir.filePath(QString("track%1.mp3").arg(i));
+        ASSERT_TRUE(mixxxtest::copyFile(
+                kTestDir.absoluteFilePath("cover-test-vbr.mp3"), filePath));
+        mixxx::IndexRange range;
+        openMp3AndReadTail(filePath, kReadFrameCount, &range);
+    }
+    ASSERT_EQ(3, QDir(cacheDir).entryList(QDir::Files).size());
+
+    EXPECT_EQ(0, mixxx::SoundSourceMp3::purgeSeekIndexCache(1024 * 1024));
+    EXPECT_EQ(3, QDir(cacheDir).entryList(QDir::Files).size());
+    EXPECT_EQ(3, mixxx::SoundSourceMp3::purgeSeekIndexCache(0));
+    EXPECT_TRUE(QDir(cacheDir).entryList(QDir::Files).isEmpty());
+
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+}
+
+// Measures the latency of opening a long MP3 file, i.e. a DJ mix or a
+// podcast, with and without a stored seek index.
+static void BM_OpenLongMp3(benchmark::State& state) {
+    const bool seekIndex = state.range(0) != 0;
+    // Concatenated copies of a short test file
+    constexpr int kCopies = 500;
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    QFile sourceFile(kTestDir.absoluteFilePath("cover-test-vbr.mp3"));
+    if (!sourceFile.open(QIODevice::ReadOnly)) {
+        state.SkipWithError("Failed to read test file");
+        return;
+    }
+    const QByteArray fileData = sourceFile.readAll();
+    QTemporaryDir tempDir;
+    const QString filePath = tempDir.filePath("long.mp3");
+    {
+        // MAD skips the ID3 tags between the concatenated copies
+        QFile longFile(filePath);
+        longFile.open(QIODevice::WriteOnly);
+        for (int i = 0; i < kCopies; ++i) {
+            longFile.write(fileData);
+        }
+    }
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(
+            seekIndex ? tempDir.filePath("seekindex") : QString());
+
+    while (state.KeepRunning()) {
+        auto pSoundSource = std::make_shared<mixxx::SoundSourceMp3>(
+                QUrl::fromLocalFile(filePath));
+        benchmark::DoNotOptimize(
+                pSoundSource->open(mixxx::AudioSource::OpenMode::Strict));
+    }
+    mixxx::SoundSourceMp3::setSeekIndexCacheDir(QString());
+}
+BENCHMARK(BM_OpenLongMp3)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+#endif // __MAD__
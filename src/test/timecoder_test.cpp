@@ -0,0 +1,177 @@
+#ifdef __VINYLCONTROL__
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "timecoder.h"
+
+// Regression test of the timecode decoding of xwax. The decoded pitch,
+// position and scope monitor of a timecode signal are compared with the
+// values that the timecoder gave before its channel split and monitor
+// decay were vectorized.
+//
+// The signal is the side A of a Serato 2nd Ed. vinyl played at 48 kHz,
+// first forwards at the reference speed, then about 10% faster and then
+// backwards. Instead of a recording it is generated with triangle waves
+// and integer arithmetic, i.e. identically on every platform.
+
+namespace {
+
+constexpr unsigned int kSampleRate = 48000;
+constexpr int kFramesPerChunk = 4800;
+constexpr int kMonitorSize = 100;
+constexpr int kFirstCycle = 10000;
+
+// The cycle is the upper, the phase within the cycle the lower 16 bits
+constexpr int kPhaseBits = 16;
+constexpr std::int64_t kPhaseMask = (1 << kPhaseBits) - 1;
+
+struct Segment {
+    int frames;
+    // The phase increment per frame, 1365 is the reference speed of
+    // 1000 cycles per second at 48 kHz
+    int phaseStep;
+};
+
+const Segment kSegments[] = {
+        {48000, 1365},
+        {48000, 1500},
+        {24000, -1365},
+};
+
+struct Reference {
+    std::int64_t cycle; // of the signal after the chunk
+    int position;
+    double pitch;
+};
+
+// The decoded values after each chunk. The position is valid after enough
+// bits have been checked. Forwards it is the last complete cycle, backwards
+// it lags behind by the 20 bits of the timecode.
+const Reference kReferences[] = {
+        {10099, -1, 0.99128002202045495},
+        {10199, 10198, 0.99970291693712587},
+        {10299, 10298, 0.99881657204356589},
+        {10399, 10398, 0.99975187556480993},
+        {10499, 10498, 1.0000304535648243},
+        {10599, 10598, 0.99998795631346793},
+        {10699, 10698, 0.99986415321390121},
+        {10799, 10798, 0.99960784705504468},
+        {10899, 10898, 0.99866910892719307},
+        {10999, 10998, 1.0000238583633891},
+        {11109, 11108, 1.0979734164312127},
+        {11219, 11218, 1.0985163618422464},
+        {11329, 11328, 1.0985935170790788},
+        {11439, 11438, 1.0985855905377024},
+        {11549, 11548, 1.0987296869949144},
+        {11658, 11657, 1.0985997516164852},
+        {11768, 11767, 1.098719443258426},
+        {11878, 11877, 1.0986529658869122},
+        {11988, 11987, 1.0985821835642318},
+        {12098, 12097, 1.0985777959852114},
+        {11998, 12018, -0.98232883968247264},
+        {11898, 11918, -0.99984900983770486},
+        {11798, 11818, -0.99994798071119173},
+        {11698, 11718, -0.99971402992884717},
+        {11598, 11618, -0.99889873421178355},
+};
+
+// FNV-1a hash and the number of lit pixels of the monitor at the end
+constexpr std::uint32_t kMonitorHash = 2868906706u;
+constexpr int kMonitorPixels = 611;
+
+// A triangle wave with the phase of a sine, the phase in [0, 65536) is
+// mapped to [-65536, 65536]
+std::int64_t triangle(std::int64_t phase) {
+    if (phase < 16384) {
+        return 4 * phase;
+    } else if (phase < 49152) {
+        return 131072 - 4 * phase;
+    } else {
+        return 4 * phase - 262144;
+    }
+}
+
+// The timecodes of the cycles like timecoder.c generates them, each cycle
+// carries the most significant bit of its timecode
+std::vector<bits_t> timecodes(const timecode_def& def, int count) {
+    std::vector<bits_t> codes(count);
+    bits_t code = def.seed;
+    for (int i = 0; i < count; ++i) {
+        codes[i] = code;
+        bits_t taken = code & (def.taps | 0x1);
+        bits_t parity = 0;
+        while (taken != 0) {
+            parity ^= taken & 0x1;
+            taken >>= 1;
+        }
+        code = (code >> 1) | (parity << (def.bits - 1));
+    }
+    return codes;
+}
+
+TEST(TimecoderTest, DecodesSerato2aLikeReference) {
+    timecode_def* pDef = timecoder_find_definition("serato_2a");
+    ASSERT_NE(nullptr, pDef);
+    const std::vector<bits_t> codes = timecodes(*pDef, 2 * kFirstCycle);
+
+    timecoder tc;
+    timecoder_init(&tc, pDef, 1.0, kSampleRate, false);
+    ASSERT_EQ(0, timecoder_monitor_init(&tc, kMonitorSize));
+
+    std::vector<signed short> chunk(kFramesPerChunk * TIMECODER_CHANNELS);
+    std::int64_t phase = static_cast<std::int64_t>(kFirstCycle) << kPhaseBits;
+    int frameInChunk = 0;
+    int chunkIndex = 0;
+    for (const auto& segment : kSegments) {
+        for (int frame = 0; frame < segment.frames; ++frame) {
+            const std::int64_t cycle = phase >> kPhaseBits;
+            const std::int64_t cyclePhase = phase & kPhaseMask;
+            const bool bit = (codes[cycle] >> (pDef->bits - 1)) & 0x1;
+            const std::int64_t amplitude = bit ? 24000 : 15000;
+            // Serato reads the bits from the right channel at the zero
+            // crossings of the left one
+            chunk[frameInChunk * 2] = static_cast<signed short>(
+                    amplitude * triangle(cyclePhase) / 65536);
+            chunk[frameInChunk * 2 + 1] = static_cast<signed short>(
+                    amplitude * triangle((cyclePhase + 16384) & kPhaseMask) / 65536);
+            phase += segment.phaseStep;
+            if (++frameInChunk < kFramesPerChunk) {
+                continue;
+            }
+            frameInChunk = 0;
+
+            timecoder_submit(&tc, chunk.data(), kFramesPerChunk);
+            ASSERT_LT(chunkIndex, static_cast<int>(std::size(kReferences)));
+            const Reference& reference = kReferences[chunkIndex++];
+            ASSERT_EQ(reference.cycle, phase >> kPhaseBits);
+            EXPECT_EQ(reference.position, timecoder_get_position(&tc, nullptr))
+                    << "chunk " << chunkIndex;
+            EXPECT_NEAR(reference.pitch, timecoder_get_pitch(&tc), 1e-9)
+                    << "chunk " << chunkIndex;
+        }
+    }
+    EXPECT_EQ(static_cast<int>(std::size(kReferences)), chunkIndex);
+
+    std::uint32_t hash = 2166136261u;
+    int pixels = 0;
+    for (int i = 0; i < kMonitorSize * kMonitorSize; ++i) {
+        hash ^= tc.mon[i];
+        hash *= 16777619u;
+        if (tc.mon[i] != 0) {
+            ++pixels;
+        }
+    }
+    EXPECT_EQ(kMonitorHash, hash);
+    EXPECT_EQ(kMonitorPixels, pixels);
+
+    timecoder_monitor_clear(&tc);
+    timecoder_clear(&tc);
+}
+
+} // anonymous namespace
+
+#endif // __VINYLCONTROL__
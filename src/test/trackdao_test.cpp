@@ -1,6 +1,8 @@
+#include <benchmark/benchmark.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "test/benchmarkutil.h"
 #include "test/librarytest.h"
 #include "track/track.h"
 
@@ -56,3 +58,121 @@ TEST_F(TrackDAOTest, detectMovedTracks) {
     QSet<QString> trackLocations = trackDAO.getAllTrackLocations();
     EXPECT_THAT(trackLocations, UnorderedElementsAre(newFile.location(), otherFile.location()));
 }
+
+TEST_F(TrackDAOTest, getTracksByIds) {
+    QList<TrackId> trackIds;
+    for (int i = 0; i < 3; ++i) {
+        TrackPointer pTrack = Track::newTemporary(
+                TrackFile(QDir(QDir::tempPath()), QStringLiteral("file%1.mp3").arg(i)));
+        pTrack->setTitle(QStringLiteral("Title %1").arg(i));
+        for (int j = 0; j <= i; ++j) {
+            pTrack->createAndAddCue();
+        }
+        trackIds.append(internalCollection()->addTrack(pTrack, false));
+    }
+    // All tracks have been evicted from the cache and need to
+    // be loaded from the database.
+    ASSERT_TRUE(GlobalTrackCacheLocker().isEmpty());
+
+    // Keep one of the tracks cached before loading all tracks
+    const TrackPointer pCachedTrack = internalCollection()->getTrackById(trackIds[1]);
+    ASSERT_TRUE(pCachedTrack);
+
+    const TrackId missingTrackId(trackIds.last().value() + 1);
+    const QList<TrackId> requestedTrackIds = {
+            trackIds[2],
+            missingTrackId,
+            trackIds[0],
+            trackIds[1],
+            TrackId(),
+            trackIds[2],
+    };
+    const auto tracks = internalCollection()->getTracksByIds(requestedTrackIds);
+    ASSERT_EQ(requestedTrackIds.size(), tracks.size());
+    ASSERT_TRUE(tracks[0]);
+    EXPECT_EQ(trackIds[2], tracks[0]->getId());
+    EXPECT_EQ(QStringLiteral("Title 2"), tracks[0]->getTitle());
+    EXPECT_EQ(3, tracks[0]->getCuePoints().size());
+    EXPECT_FALSE(tracks[1]);
+    ASSERT_TRUE(tracks[2]);
+    EXPECT_EQ(trackIds[0], tracks[2]->getId());
+    EXPECT_EQ(QStringLiteral("Title 0"), tracks[2]->getTitle());
+    EXPECT_EQ(1, tracks[2]->getCuePoints().size());
+    EXPECT_EQ(pCachedTrack, tracks[3]);
+    EXPECT_FALSE(tracks[4]);
+    // Duplicate ids resolve to the same track object
+    EXPECT_EQ(tracks[0], tracks[5]);
+    // Loaded tracks are cached
+    EXPECT_EQ(tracks[2], internalCollection()->getTrackById(trackIds[0]));
+}
+
+namespace {
+
+class TrackDAOBenchmarkFixture : public mixxxtest::BenchmarkFixture<LibraryTest> {
+  public:
+    using LibraryTest::internalCollection;
+
+    // Inserts tracks directly into the database that reference
+    // non-existent files.
+    QList<TrackId> insertTracks(int numTracks) const {
+        QSqlDatabase database = dbConnection();
+        database.transaction();
+        QSqlQuery locationQuery(database);
+        locationQuery.prepare(
+                "INSERT INTO track_locations "
+                "(location,filename,directory,filesize,fs_deleted,needs_verification) "
+                "VALUES (:location,:filename,:directory,0,0,0)");
+        QSqlQuery libraryQuery(database);
+        libraryQuery.prepare(
+                "INSERT INTO library "
+                "(location,artist,title,mixxx_deleted,header_parsed) "
+                "VALUES (:location,:artist,:title,0,1)");
+        QList<TrackId> trackIds;
+        trackIds.reserve(numTracks);
+        const QDir dir(QDir::tempPath() + QStringLiteral("/trackdaobenchmark"));
+        for (int i = 0; i < numTracks; ++i) {
+            const QString fileName = QStringLiteral("track%1.mp3").arg(i);
+            locationQuery.bindValue(":location", dir.filePath(fileName));
+            locationQuery.bindValue(":filename", fileName);
+            locationQuery.bindValue(":directory", dir.path());
+            if (!locationQuery.exec()) {
+                break;
+            }
+            libraryQuery.bindValue(":location", locationQuery.lastInsertId());
+            libraryQuery.bindValue(":artist", QStringLiteral("Artist %1").arg(i % 100));
+            libraryQuery.bindValue(":title", QStringLiteral("Title %1").arg(i));
+            if (!libraryQuery.exec()) {
+                break;
+            }
+            trackIds.append(TrackId(libraryQuery.lastInsertId()));
+        }
+        database.commit();
+        return trackIds;
+    }
+};
+
+} // anonymous namespace
+
+// Loads 10k uncached tracks either one by one or with a single batch.
+static void BM_TrackDAOLoadTracks(benchmark::State& state) {
+    const bool batched = state.range(0) != 0;
+    TrackDAOBenchmarkFixture fixture;
+    const auto trackIds = fixture.insertTracks(10000);
+    TrackCollection* pTrackCollection = fixture.internalCollection();
+    while (state.KeepRunning()) {
+        // All tracks are evicted from the cache when the
+        // loaded tracks go out of scope.
+        QList<TrackPointer> tracks;
+        if (batched) {
+            tracks = pTrackCollection->getTracksByIds(trackIds);
+        } else {
+            tracks.reserve(trackIds.size());
+            for (const auto& trackId : trackIds) {
+                tracks.append(pTrackCollection->getTrackById(trackId));
+            }
+        }
+        benchmark::DoNotOptimize(tracks);
+    }
+    state.SetItemsProcessed(state.iterations() * trackIds.size());
+}
+BENCHMARK(BM_TrackDAOLoadTracks)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,212 @@
+#ifdef __VINYLCONTROL__
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "sources/soundsourceproxy.h"
+#include "test/benchmarkutil.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/samplebuffer.h"
+#include "vinylcontrol/defs_vinylcontrol.h"
+#include "vinylcontrol/vinylcontrolxwax.h"
+
+// Benchmarks of the timecode decoding of vinyl control, i.e.
+// VinylControlXwax::analyzeSamples() that each input thread of the
+// VinylControlProcessor runs for its deck.
+//
+// By default the decks decode a synthetic signal like the one of a Serato
+// 2nd Ed. vinyl, i.e. a 1 kHz stereo tone in quadrature whose amplitude
+// carries pseudo-random bits, at a varying speed. A recording of a timecode vinyl can be given
+// with the environment variables MIXXX_VINYL_TIMECODE_FILE and
+// MIXXX_VINYL_TIMECODE_TYPE, e.g.
+//
+//   MIXXX_VINYL_TIMECODE_FILE=traktor_a.wav \
+//   MIXXX_VINYL_TIMECODE_TYPE="Traktor Scratch MK2 Side A" \
+//   mixxx-test --benchmark --benchmark_filter=BM_VinylControl
+//
+// Besides the mean time per buffer each benchmark reports the 50th and
+// 99th percentile and the maximum in microseconds and the realtime factor,
+// i.e. how many times faster than realtime the decks are decoded.
+
+namespace {
+
+constexpr double kSyntheticSeconds = 10.0;
+
+struct TimecodeSignal {
+    mixxx::audio::SampleRate sampleRate;
+    std::vector<CSAMPLE> samples; // stereo
+};
+
+TimecodeSignal syntheticSignal(mixxx::audio::SampleRate sampleRate) {
+    TimecodeSignal signal;
+    signal.sampleRate = sampleRate;
+    const auto frames = static_cast<SINT>(kSyntheticSeconds * sampleRate);
+    signal.samples.resize(frames * 2);
+    double phase = 0.0;
+    unsigned int lfsr = 0x59017;
+    for (SINT i = 0; i < frames; ++i) {
+        // Between 0.7 and 1.3 times the reference speed
+        const double speed = 1.0 + 0.3 * std::sin(i * 2.0 * M_PI / sampleRate / 4.0);
+        const double previousPhase = phase;
+        phase += 2.0 * M_PI * 1000.0 * speed / sampleRate;
+        if (std::floor(phase / (2.0 * M_PI)) != std::floor(previousPhase / (2.0 * M_PI))) {
+            // Next bit of the pseudo-random sequence every cycle
+            lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0x80057u);
+        }
+        const double amplitude = (lfsr & 1u) ? 0.8 : 0.5;
+        signal.samples[i * 2] = static_cast<CSAMPLE>(0.5 * amplitude * std::sin(phase));
+        signal.samples[i * 2 + 1] = static_cast<CSAMPLE>(0.5 * amplitude * std::cos(phase));
+    }
+    return signal;
+}
+
+bool readSignal(const QString& filePath, TimecodeSignal* pSignal) {
+    SoundSourceProxy proxy(Track::newTemporary(filePath));
+    mixxx::AudioSource::OpenParams openParams;
+    openParams.setChannelCount(mixxx::audio::ChannelCount(2));
+    auto pAudioSource = proxy.openAudioSource(openParams);
+    if (!pAudioSource ||
+            pAudioSource->getSignalInfo().getChannelCount() != mixxx::audio::ChannelCount(2)) {
+        return false;
+    }
+    const auto frameRange = pAudioSource->frameIndexRange();
+    mixxx::SampleBuffer buffer(
+            pAudioSource->getSignalInfo().frames2samples(frameRange.length()));
+    const auto readRange = pAudioSource->readSampleFrames(
+            mixxx::WritableSampleFrames(
+                    frameRange,
+                    mixxx::SampleBuffer::WritableSlice(buffer.data(), buffer.size())))
+                                   .frameIndexRange();
+    pSignal->sampleRate = pAudioSource->getSignalInfo().getSampleRate();
+    pSignal->samples.assign(buffer.data(),
+            buffer.data() + pAudioSource->getSignalInfo().frames2samples(readRange.length()));
+    return !pSignal->samples.empty();
+}
+
+// Decodes the signal in buffers of the given size like an input thread
+void decodeSignal(VinylControlXwax* pVinylControl,
+        const TimecodeSignal& signal,
+        int framesPerBuffer,
+        std::vector<mixxx::Duration>* pDurations) {
+    std::vector<CSAMPLE> buffer(framesPerBuffer * 2);
+    PerformanceTimer timer;
+    const SINT frames = signal.samples.size() / 2;
+    for (SINT frame = 0; frame + framesPerBuffer <= frames; frame += framesPerBuffer) {
+        // analyzeSamples() works in place
+        std::copy(signal.samples.begin() + frame * 2,
+                signal.samples.begin() + (frame + framesPerBuffer) * 2,
+                buffer.begin());
+        timer.start();
+        pVinylControl->analyzeSamples(buffer.data(), framesPerBuffer);
+        pDurations->push_back(timer.elapsed());
+    }
+}
+
+} // anonymous namespace
+
+// Arguments: number of decks, frames per buffer, sample rate and whether
+// each deck is decoded by its own thread like VinylControlProcessor does
+static void BM_VinylControlDecode(benchmark::State& state) {
+    const int deckCount = static_cast<int>(state.range(0));
+    const int framesPerBuffer = static_cast<int>(state.range(1));
+    const bool threaded = state.range(3) != 0;
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    TimecodeSignal signal;
+    QString vinylType = MIXXX_VINYL_SERATOCV02VINYLSIDEA;
+    const QString filePath = QString::fromLocal8Bit(qgetenv("MIXXX_VINYL_TIMECODE_FILE"));
+    if (filePath.isEmpty()) {
+        signal = syntheticSignal(
+                mixxx::audio::SampleRate(static_cast<SINT>(state.range(2))));
+    } else {
+        if (!readSignal(filePath, &signal)) {
+            state.SkipWithError("Unable to read the timecode file");
+            return;
+        }
+        const QString type = QString::fromLocal8Bit(qgetenv("MIXXX_VINYL_TIMECODE_TYPE"));
+        if (!type.isEmpty()) {
+            vinylType = type;
+        }
+    }
+    state.SetLabel(QString("%1 %2 Hz")
+                           .arg(filePath.isEmpty() ? "synthetic" : filePath)
+                           .arg(static_cast<int>(signal.sampleRate))
+                           .toStdString());
+
+    fixture.config()->set(ConfigKey("[Soundcard]", "Samplerate"),
+            ConfigValue(static_cast<int>(signal.sampleRate)));
+    std::vector<std::unique_ptr<VinylControlXwax>> decks;
+    for (int i = 0; i < deckCount; ++i) {
+        const QString group = kVCGroup.arg(i + 1);
+        fixture.config()->set(ConfigKey(group, "vinylcontrol_vinyl_type"),
+                ConfigValue(vinylType));
+        decks.push_back(std::make_unique<VinylControlXwax>(fixture.config(), group));
+    }
+
+    std::vector<std::vector<mixxx::Duration>> durations(deckCount);
+    double processingSeconds = 0.0;
+    while (state.KeepRunning()) {
+        PerformanceTimer timer;
+        timer.start();
+        if (threaded) {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < deckCount; ++i) {
+                threads.emplace_back(decodeSignal,
+                        decks[i].get(),
+                        std::cref(signal),
+                        framesPerBuffer,
+                        &durations[i]);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        } else {
+            for (int i = 0; i < deckCount; ++i) {
+                decodeSignal(decks[i].get(), signal, framesPerBuffer, &durations[i]);
+            }
+        }
+        const double seconds = timer.elapsed().toDoubleSeconds();
+        processingSeconds += seconds;
+        state.SetIterationTime(seconds);
+    }
+
+    std::vector<mixxx::Duration> allDurations;
+    for (const auto& deckDurations : durations) {
+        allDurations.insert(allDurations.end(), deckDurations.begin(), deckDurations.end());
+    }
+    if (allDurations.empty() || processingSeconds <= 0.0) {
+        return;
+    }
+    std::sort(allDurations.begin(), allDurations.end());
+    state.counters["p50_us"] = mixxxtest::percentileMicros(allDurations, 0.5);
+    state.counters["p99_us"] = mixxxtest::percentileMicros(allDurations, 0.99);
+    state.counters["max_us"] = allDurations.back().toDoubleMicros();
+    const double signalSeconds =
+            static_cast<double>(signal.samples.size() / 2) / signal.sampleRate;
+    state.counters["realtime_factor"] =
+            signalSeconds * state.iterations() / processingSeconds;
+}
+BENCHMARK(BM_VinylControlDecode)
+        ->ArgNames({"decks", "frames", "rate", "threaded"})
+        ->Args({1, 64, 44100, 0})
+        ->Args({1, 512, 44100, 0})
+        ->Args({1, 64, 96000, 0})
+        ->Args({4, 64, 96000, 0})
+        ->Args({4, 64, 96000, 1})
+        ->Args({4, 512, 96000, 0})
+        ->Args({4, 512, 96000, 1})
+        ->Iterations(1)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+
+#endif // __VINYLCONTROL__
@@ -0,0 +1,235 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDomDocument>
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "skin/skincontext.h"
+#include "test/benchmarkutil.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/performancetimer.h"
+#include "waveform/renderers/waveformrendererfilteredsignal.h"
+#include "waveform/renderers/waveformrendererhsv.h"
+#include "waveform/renderers/waveformrendererrgb.h"
+#include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/waveform.h"
+#include "waveform/waveformwidgetfactory.h"
+
+// Benchmarks of the signal renderers of the software waveforms, i.e.
+// WaveformRendererRGB, WaveformRendererHSV and WaveformRendererFilteredSignal
+// that are used by the QWidget and Qt waveform types on systems without
+// OpenGL. The decks are painted offscreen into a QImage one after the other
+// like the GUI thread paints the waveform widgets of a frame, while the play
+// position moves with 60 frames per second.
+//
+// The last frame of the last deck can be written to a directory for inspection:
+//
+//   MIXXX_WAVEFORM_BENCHMARK_IMAGE_DIR=/tmp \
+//   mixxx-test --benchmark --benchmark_filter=BM_WaveformRender
+//
+// Besides the mean time per iteration each benchmark reports the 50th and
+// 99th percentile and the maximum of the time for painting all decks of a
+// frame in microseconds.
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr double kTrackSeconds = 300.0;
+constexpr int kFramesPerSecond = 60;
+constexpr int kFrameCount = 600;
+
+enum class SignalRenderer {
+    RGB = 0,
+    HSV = 1,
+    Filtered = 2,
+};
+
+// Replaces onPreRender(), which needs the engine and the vsync thread
+class OffscreenWaveformWidgetRenderer : public WaveformWidgetRenderer {
+  public:
+    explicit OffscreenWaveformWidgetRenderer(const QString& group)
+            : WaveformWidgetRenderer(group) {
+    }
+
+    void setPlayPosition(double playPosition,
+            double visualSamplePerPixel,
+            int waveformDataSize) {
+        m_trackSamples = static_cast<int>(m_pTrackSamplesControlObject->get());
+        m_gain = m_pGainControlObject->get() * 2;
+        m_visualSamplePerPixel = visualSamplePerPixel;
+        m_trackPixelCount = waveformDataSize / 2.0 / visualSamplePerPixel;
+        m_playPos = playPosition;
+        const double displayedLength = getLength() / m_trackPixelCount;
+        m_firstDisplayedPosition = m_playPos - displayedLength * m_playMarkerPosition;
+        m_lastDisplayedPosition = m_playPos + displayedLength * (1.0 - m_playMarkerPosition);
+    }
+};
+
+// A beat every half a second with a decaying low band and noisy mids and
+// highs
+WaveformPointer syntheticWaveform() {
+    const int audioSamples = static_cast<int>(kTrackSeconds * kSampleRate) * 2;
+    WaveformPointer pWaveform(new Waveform(kSampleRate, audioSamples, 441, -1));
+    WaveformData* pData = pWaveform->data();
+    const int visualFrames = pWaveform->getDataSize() / 2;
+    unsigned int lfsr = 0x59017;
+    for (int i = 0; i < visualFrames; ++i) {
+        const double beatPhase = std::fmod(i / 220.5, 1.0);
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0x80057u);
+        for (int channel = 0; channel < 2; ++channel) {
+            WaveformData& data = pData[i * 2 + channel];
+            data.filtered.low = static_cast<unsigned char>(200 * std::exp(-6.0 * beatPhase));
+            data.filtered.mid = static_cast<unsigned char>(60 + (lfsr & 0x3f));
+            data.filtered.high = static_cast<unsigned char>(20 + ((lfsr >> 6) & 0x3f));
+            data.filtered.all = std::max({data.filtered.low,
+                    data.filtered.mid,
+                    data.filtered.high});
+        }
+    }
+    pWaveform->setCompletion(visualFrames * 2);
+    return pWaveform;
+}
+
+QDomElement visualNode(QDomDocument* pDocument) {
+    QDomElement visual = pDocument->createElement("Visual");
+    const QList<QPair<QString, QString>> colors = {
+            {"SignalColor", "#2A8FFF"},
+            {"SignalLowColor", "#A0EC7319"},
+            {"SignalMidColor", "#A0FFFFFF"},
+            {"SignalHighColor", "#A0B2E1FF"},
+            {"AxesColor", "#FFFFFF"},
+    };
+    for (const auto& color : colors) {
+        QDomElement element = pDocument->createElement(color.first);
+        element.appendChild(pDocument->createTextNode(color.second));
+        visual.appendChild(element);
+    }
+    return visual;
+}
+
+// Stand-ins for the controls of a deck that the renderers connect to
+void createDeckControls(const QString& group,
+        std::vector<std::unique_ptr<ControlObject>>* pControls) {
+    const QList<QPair<QString, double>> controls = {
+            {"rate_ratio", 1.0},
+            // Unity gain after the compensation in onPreRender()
+            {"total_gain", 0.5},
+            {"track_samples", kTrackSeconds * kSampleRate * 2},
+            {"filterWaveformEnable", 1.0},
+            {"filterLow", 1.0},
+            {"filterMid", 1.0},
+            {"filterHigh", 1.0},
+            {"filterLowKill", 0.0},
+            {"filterMidKill", 0.0},
+            {"filterHighKill", 0.0},
+    };
+    for (const auto& control : controls) {
+        auto pControl = std::make_unique<ControlObject>(ConfigKey(group, control.first));
+        pControl->set(control.second);
+        pControls->push_back(std::move(pControl));
+    }
+}
+
+} // anonymous namespace
+
+// Arguments: signal renderer, number of decks and the size of each waveform
+static void BM_WaveformRender(benchmark::State& state) {
+    const auto signalRenderer = static_cast<SignalRenderer>(state.range(0));
+    const int deckCount = static_cast<int>(state.range(1));
+    const int width = static_cast<int>(state.range(2));
+    const int height = static_cast<int>(state.range(3));
+
+    mixxxtest::BenchmarkFixture<> fixture;
+    WaveformWidgetFactory::createInstance();
+    SkinContext context(fixture.config(), "test");
+    QDomDocument document;
+    const QDomElement node = visualNode(&document);
+
+    const WaveformPointer pWaveform = syntheticWaveform();
+    std::vector<std::unique_ptr<ControlObject>> controls;
+    std::vector<std::unique_ptr<OffscreenWaveformWidgetRenderer>> decks;
+    for (int i = 0; i < deckCount; ++i) {
+        const QString group = QString("[Channel%1]").arg(i + 1);
+        createDeckControls(group, &controls);
+        auto pDeck = std::make_unique<OffscreenWaveformWidgetRenderer>(group);
+        switch (signalRenderer) {
+        case SignalRenderer::RGB:
+            pDeck->addRenderer<WaveformRendererRGB>();
+            break;
+        case SignalRenderer::HSV:
+            pDeck->addRenderer<WaveformRendererHSV>();
+            break;
+        case SignalRenderer::Filtered:
+            pDeck->addRenderer<WaveformRendererFilteredSignal>();
+            break;
+        }
+        pDeck->init();
+        pDeck->setup(node, context);
+        pDeck->resize(width, height, 1.0f);
+        TrackPointer pTrack = Track::newTemporary();
+        pTrack->setWaveform(pWaveform);
+        pDeck->setTrack(std::move(pTrack));
+        decks.push_back(std::move(pDeck));
+    }
+
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    std::vector<mixxx::Duration> durations;
+    const double positionPerFrame = 1.0 / kTrackSeconds / kFramesPerSecond;
+    while (state.KeepRunning()) {
+        PerformanceTimer timer;
+        double iterationSeconds = 0.0;
+        for (int frame = 0; frame < kFrameCount; ++frame) {
+            timer.start();
+            for (int i = 0; i < deckCount; ++i) {
+                // The decks are apart from each other
+                const double playPosition = 0.1 + 0.2 * i + frame * positionPerFrame;
+                decks[i]->setPlayPosition(playPosition, 1.0, pWaveform->getDataSize());
+                image.fill(Qt::black);
+                QPainter painter(&image);
+                decks[i]->draw(&painter, nullptr);
+            }
+            durations.push_back(timer.elapsed());
+            iterationSeconds += durations.back().toDoubleSeconds();
+        }
+        state.SetIterationTime(iterationSeconds);
+    }
+
+    const QString imageDir = QString::fromLocal8Bit(
+            qgetenv("MIXXX_WAVEFORM_BENCHMARK_IMAGE_DIR"));
+    if (!imageDir.isEmpty()) {
+        image.save(QString("%1/waveform_%2_%3x%4.png")
+                           .arg(imageDir)
+                           .arg(state.range(0))
+                           .arg(width)
+                           .arg(height));
+    }
+
+    decks.clear();
+    controls.clear();
+    WaveformWidgetFactory::destroy();
+
+    if (durations.empty()) {
+        return;
+    }
+    std::sort(durations.begin(), durations.end());
+    state.counters["p50_us"] = mixxxtest::percentileMicros(durations, 0.5);
+    state.counters["p99_us"] = mixxxtest::percentileMicros(durations, 0.99);
+    state.counters["max_us"] = durations.back().toDoubleMicros();
+}
+BENCHMARK(BM_WaveformRender)
+        ->ArgNames({"renderer", "decks", "width", "height"})
+        ->Args({static_cast<int>(SignalRenderer::RGB), 1, 1920, 120})
+        ->Args({static_cast<int>(SignalRenderer::RGB), 4, 1920, 120})
+        ->Args({static_cast<int>(SignalRenderer::HSV), 4, 1920, 120})
+        ->Args({static_cast<int>(SignalRenderer::Filtered), 4, 1920, 120})
+        ->Args({static_cast<int>(SignalRenderer::RGB), 4, 3840, 240})
+        ->Iterations(1)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <QImage>
+#include <QLineF>
+#include <QPainter>
+#include <QPen>
+#include <QTransform>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "test/mixxxtest.h"
+#include "waveform/renderers/waveformsignalraster.h"
+
+// Compares the images of WaveformSignalRaster with the lines drawn by
+// QPainter that it replaces in the signal renderers of the software
+// waveforms, i.e. WaveformRendererRGB, WaveformRendererHSV and
+// WaveformRendererFilteredSignal.
+
+namespace {
+
+constexpr int kLength = 96;
+constexpr int kBreadth = 48;
+
+// The raster and the painter round translucent colors differently
+constexpr int kMaxChannelDifference = 2;
+
+struct Column {
+    int x;
+    int y0;
+    int y1;
+    QRgb color;
+};
+
+class WaveformSignalRasterTest : public MixxxTest {
+  protected:
+    WaveformSignalRasterTest()
+            : m_random(0x5eed) {
+    }
+
+    // A band of columns like the renderers draw them, with some columns
+    // left out and some of length 0
+    void addBand(QRgb color) {
+        for (int x = 0; x < kLength; ++x) {
+            if (random(10) == 0) {
+                continue;
+            }
+            const int y0 = random(kBreadth + 1);
+            const int y1 = random(4) == 0 ? y0 : random(kBreadth + 1);
+            m_columns.push_back({x, y0, y1, color});
+        }
+    }
+
+    // Paints the axis and the columns like the renderers, either with a
+    // line for each column or with a single image of the raster
+    QImage paint(double lineWidth, Qt::Orientation orientation, bool raster) const {
+        QImage image(orientation == Qt::Horizontal ? kLength : kBreadth,
+                orientation == Qt::Horizontal ? kBreadth : kLength,
+                QImage::Format_ARGB32_Premultiplied);
+        image.fill(QColor(20, 30, 40));
+        QPainter painter(&image);
+        painter.setRenderHints(QPainter::Antialiasing, false);
+        if (orientation == Qt::Vertical) {
+            painter.setTransform(QTransform(0, 1, 1, 0, 0, 0));
+        }
+        painter.setPen(QColor(Qt::white));
+        painter.drawLine(QLineF(0, kBreadth / 2.0, kLength, kBreadth / 2.0));
+
+        if (raster) {
+            WaveformSignalRaster signalRaster;
+            signalRaster.begin(kLength, kBreadth, lineWidth);
+            for (const auto& column : m_columns) {
+                signalRaster.fillColumn(column.x,
+                        column.y0,
+                        column.y1,
+                        qPremultiply(column.color));
+            }
+            signalRaster.draw(&painter);
+        } else {
+            QPen pen;
+            pen.setCapStyle(Qt::FlatCap);
+            pen.setWidthF(lineWidth);
+            for (const auto& column : m_columns) {
+                pen.setColor(QColor::fromRgba(column.color));
+                painter.setPen(pen);
+                painter.drawLine(column.x, column.y0, column.x, column.y1);
+            }
+        }
+        return image;
+    }
+
+    void expectSameAsPainter(double lineWidth, Qt::Orientation orientation) const {
+        const QImage expected = paint(lineWidth, orientation, false);
+        const QImage actual = paint(lineWidth, orientation, true);
+        ASSERT_EQ(expected.size(), actual.size());
+        int differentPixels = 0;
+        for (int y = 0; y < expected.height(); ++y) {
+            for (int x = 0; x < expected.width(); ++x) {
+                const QRgb expectedPixel = expected.pixel(x, y);
+                const QRgb actualPixel = actual.pixel(x, y);
+                if (channelDifference(expectedPixel, actualPixel) <=
+                        kMaxChannelDifference) {
+                    continue;
+                }
+                // Only the first few are reported
+                if (++differentPixels <= 5) {
+                    ADD_FAILURE() << "line width " << lineWidth
+                                  << ", pixel (" << x << ", " << y << "): expected "
+                                  << QColor(expectedPixel).name().toStdString()
+                                  << ", actual "
+                                  << QColor(actualPixel).name().toStdString();
+                }
+            }
+        }
+        EXPECT_EQ(0, differentPixels) << "line width " << lineWidth;
+    }
+
+    std::vector<Column> m_columns;
+
+  private:
+    // std::uniform_int_distribution differs between the standard libraries
+    int random(int count) {
+        return static_cast<int>(m_random() % static_cast<std::uint32_t>(count));
+    }
+
+    static int channelDifference(QRgb first, QRgb second) {
+        return std::max({std::abs(qRed(first) - qRed(second)),
+                std::abs(qGreen(first) - qGreen(second)),
+                std::abs(qBlue(first) - qBlue(second)),
+                std::abs(qAlpha(first) - qAlpha(second))});
+    }
+
+    std::mt19937 m_random;
+};
+
+// The line widths for zoom factors from 1 to 6, and some in between
+const double kLineWidths[] = {1.0, 1.5, 2.0, 2.5, 3.0, 3.3, 6.0};
+
+TEST_F(WaveformSignalRasterTest, OpaqueColumnsLikeRGB) {
+    // A color per column like WaveformRendererRGB and WaveformRendererHSV
+    for (int i = 0; i < 3; ++i) {
+        addBand(qRgb(40 + 80 * i, 200 - 60 * i, 120));
+    }
+    for (double lineWidth : kLineWidths) {
+        expectSameAsPainter(lineWidth, Qt::Horizontal);
+    }
+}
+
+TEST_F(WaveformSignalRasterTest, TranslucentBandsLikeFilteredSignal) {
+    // The default colors of the low, mid and high band of the skins
+    addBand(qRgba(0xEC, 0x73, 0x19, 0xA0));
+    addBand(qRgba(0xFF, 0xFF, 0xFF, 0xA0));
+    addBand(qRgba(0xB2, 0xE1, 0xFF, 0xA0));
+    for (double lineWidth : kLineWidths) {
+        expectSameAsPainter(lineWidth, Qt::Horizontal);
+    }
+}
+
+TEST_F(WaveformSignalRasterTest, MixedAlphaBands) {
+    addBand(qRgba(0x20, 0x80, 0xFF, 0xFF));
+    addBand(qRgba(0xFF, 0x40, 0x10, 0x80));
+    addBand(qRgba(0x10, 0xFF, 0x40, 0x30));
+    for (double lineWidth : kLineWidths) {
+        expectSameAsPainter(lineWidth, Qt::Horizontal);
+    }
+}
+
+TEST_F(WaveformSignalRasterTest, VerticalOrientation) {
+    addBand(qRgb(0x2A, 0x8F, 0xFF));
+    addBand(qRgba(0xFF, 0xFF, 0xFF, 0xA0));
+    for (double lineWidth : kLineWidths) {
+        expectSameAsPainter(lineWidth, Qt::Vertical);
+    }
+}
+
+TEST_F(WaveformSignalRasterTest, ReusedBetweenFrames) {
+    WaveformSignalRaster raster;
+    raster.begin(kLength, kBreadth, 3.0);
+    raster.fillColumn(10, 0, kBreadth, qRgb(255, 0, 0));
+    const uchar* pFirstFrame = raster.image().constBits();
+
+    // The image is cleared, but not reallocated
+    raster.begin(kLength, kBreadth, 1.0);
+    EXPECT_EQ(pFirstFrame, raster.image().constBits());
+    EXPECT_EQ(0u, raster.image().pixel(10, 0));
+    raster.fillColumn(20, 5, 5, qRgb(0, 255, 0));
+    EXPECT_EQ(qRgb(0, 255, 0), raster.image().pixel(20, 5));
+
+    raster.begin(kLength / 2, kBreadth, 1.0);
+    EXPECT_EQ(QSize(kLength / 2, kBreadth), raster.image().size());
+}
+
+TEST_F(WaveformSignalRasterTest, ClipsColumns) {
+    WaveformSignalRaster raster;
+    raster.begin(kLength, kBreadth, 3.0);
+    raster.fillColumn(-5, 0, kBreadth, qRgb(255, 0, 0));
+    raster.fillColumn(kLength + 5, 0, kBreadth, qRgb(255, 0, 0));
+    raster.fillColumn(kLength / 2, -10, -1, qRgb(255, 0, 0));
+    raster.fillColumn(kLength / 2, kBreadth + 1, kBreadth + 10, qRgb(255, 0, 0));
+    for (int y = 0; y < kBreadth; ++y) {
+        for (int x = 0; x < kLength; ++x) {
+            ASSERT_EQ(0u, raster.image().pixel(x, y));
+        }
+    }
+
+    // Partially inside
+    raster.fillColumn(0, -10, kBreadth + 10, qRgb(0, 0, 255));
+    raster.fillColumn(kLength - 1, -10, kBreadth + 10, qRgb(0, 0, 255));
+    for (int y = 0; y < kBreadth; ++y) {
+        EXPECT_EQ(qRgb(0, 0, 255), raster.image().pixel(0, y));
+        EXPECT_EQ(qRgb(0, 0, 255), raster.image().pixel(1, y));
+        EXPECT_EQ(0u, raster.image().pixel(2, y));
+        EXPECT_EQ(qRgb(0, 0, 255), raster.image().pixel(kLength - 1, y));
+    }
+}
+
+} // anonymous namespace
@@ -0,0 +1,311 @@
+#include <gtest/gtest.h>
+
+#include <QDomDocument>
+#include <QImage>
+#include <QPainter>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "skin/skincontext.h"
+#include "test/mixxxtest.h"
+#include "track/beatfactory.h"
+#include "track/track.h"
+#include "waveform/renderers/waveformrenderbeat.h"
+#include "waveform/renderers/waveformrendererendoftrack.h"
+#include "waveform/renderers/waveformrendererrgb.h"
+#include "waveform/renderers/waveformrendermark.h"
+#include "waveform/renderers/waveformrendermarkrange.h"
+#include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/visualplayposition.h"
+#include "waveform/vsyncthread.h"
+#include "waveform/waveform.h"
+#include "waveform/waveformwidgetfactory.h"
+
+// Tests the dirty tracking of WaveformWidgetRenderer, i.e. which frames
+// WaveformWidgetFactory::render() skips because they look like the last
+// rendered one.
+
+namespace {
+
+const QString kGroup = QStringLiteral("[Channel1]");
+constexpr int kSampleRate = 44100;
+constexpr int kTrackSeconds = 60;
+constexpr double kTrackSamples = kTrackSeconds * kSampleRate * 2.0;
+
+class WaveformWidgetRendererTest : public MixxxTest {
+  protected:
+    WaveformWidgetRendererTest()
+            : m_vsyncThread(nullptr),
+              m_image(400, 100, QImage::Format_ARGB32_Premultiplied) {
+        // Before the VisualPlayPosition is created by init()
+        addControl("[Master]", "audio_buffer_size", 20.0);
+        addControl(kGroup, "rate_ratio", 1.0);
+        // Unity gain after the compensation in onPreRender()
+        m_pTotalGain = addControl(kGroup, "total_gain", 0.5);
+        addControl(kGroup, "track_samples", kTrackSamples);
+        m_pEndOfTrack = addControl(kGroup, "end_of_track", 0.0);
+        addControl(kGroup, "time_remaining", 10.0);
+        addControl(kGroup, "filterWaveformEnable", 1.0);
+        addControl(kGroup, "filterLow", 1.0);
+        addControl(kGroup, "filterMid", 1.0);
+        addControl(kGroup, "filterHigh", 1.0);
+        m_pLowKill = addControl(kGroup, "filterLowKill", 0.0);
+        addControl(kGroup, "filterMidKill", 0.0);
+        addControl(kGroup, "filterHighKill", 0.0);
+        m_pCuePoint = addControl(kGroup, "cue_point", -1.0);
+        m_pLoopStart = addControl(kGroup, "loop_start_position", -1.0);
+        m_pLoopEnd = addControl(kGroup, "loop_end_position", -1.0);
+        m_pLoopEnabled = addControl(kGroup, "loop_enabled", 0.0);
+
+        WaveformWidgetFactory::createInstance();
+        m_pRenderer = std::make_unique<WaveformWidgetRenderer>(kGroup);
+        m_pRenderer->addRenderer<WaveformRendererEndOfTrack>();
+        m_pRenderer->addRenderer<WaveformRenderMarkRange>();
+        m_pRenderer->addRenderer<WaveformRendererRGB>();
+        m_pRenderer->addRenderer<WaveformRenderBeat>();
+        m_pRenderer->addRenderer<WaveformRenderMark>();
+        EXPECT_TRUE(m_pRenderer->init());
+        QDomDocument document;
+        SkinContext context(config(), "test");
+        m_pRenderer->setup(visualNode(&document), context);
+        m_pRenderer->resize(m_image.width(), m_image.height(), 1.0f);
+
+        m_pVisualPlayPosition = VisualPlayPosition::getVisualPlayPosition(kGroup);
+        setPlayPosition(0.5);
+        m_pTrack = newTrack();
+        m_pRenderer->setTrack(m_pTrack);
+    }
+
+    ~WaveformWidgetRendererTest() override {
+        m_pRenderer.reset();
+        WaveformWidgetFactory::destroy();
+    }
+
+    // Prepares the next frame like WaveformWidgetFactory::render() and
+    // draws it if it is dirty. Returns if it has been drawn.
+    bool renderFrame() {
+        m_pRenderer->onPreRender(&m_vsyncThread);
+        if (!m_pRenderer->isFrameDirty()) {
+            return false;
+        }
+        m_image.fill(Qt::black);
+        QPainter painter(&m_image);
+        m_pRenderer->draw(&painter, nullptr);
+        return true;
+    }
+
+    // Renders frames until a clean one, i.e. until the widget shows the
+    // current state. Returns the number of rendered frames.
+    int renderUntilClean() {
+        for (int frames = 0; frames < 10; ++frames) {
+            if (!renderFrame()) {
+                return frames;
+            }
+        }
+        ADD_FAILURE() << "Every frame is rendered";
+        return -1;
+    }
+
+    // A paused deck, the visual play position does not move
+    void setPlayPosition(double playPosition) {
+        m_pVisualPlayPosition->set(playPosition, 0.0, 0.0, playPosition, 30.0);
+    }
+
+    static TrackPointer newTrack() {
+        TrackPointer pTrack = Track::newTemporary();
+        pTrack->setAudioProperties(
+                mixxx::audio::ChannelCount(2),
+                mixxx::audio::SampleRate(kSampleRate),
+                mixxx::audio::Bitrate(),
+                mixxx::Duration::fromSeconds(kTrackSeconds));
+        WaveformPointer pWaveform(new Waveform(
+                kSampleRate, static_cast<int>(kTrackSamples), 441, -1));
+        WaveformData* pData = pWaveform->data();
+        for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+            pData[i].filtered.all = static_cast<unsigned char>(i % 200);
+            pData[i].filtered.low = static_cast<unsigned char>(i % 100);
+            pData[i].filtered.mid = 50;
+            pData[i].filtered.high = 20;
+        }
+        pWaveform->setCompletion(pWaveform->getDataSize());
+        pTrack->setWaveform(pWaveform);
+        pTrack->setBeats(BeatFactory::makeBeatGrid(*pTrack, 120.0, 0.0));
+        return pTrack;
+    }
+
+    ControlObject* m_pTotalGain;
+    ControlObject* m_pEndOfTrack;
+    ControlObject* m_pLowKill;
+    ControlObject* m_pCuePoint;
+    ControlObject* m_pLoopStart;
+    ControlObject* m_pLoopEnd;
+    ControlObject* m_pLoopEnabled;
+    TrackPointer m_pTrack;
+
+  private:
+    ControlObject* addControl(const QString& group, const QString& item, double value) {
+        m_controls.push_back(std::make_unique<ControlObject>(ConfigKey(group, item)));
+        m_controls.back()->set(value);
+        return m_controls.back().get();
+    }
+
+    static QDomElement visualNode(QDomDocument* pDocument) {
+        QDomElement visual = pDocument->createElement("Visual");
+        const QList<QPair<QString, QString>> elements = {
+                {"SignalColor", "#2A8FFF"},
+                {"AxesColor", "#FFFFFF"},
+                {"BeatColor", "#FFFFFF"},
+        };
+        for (const auto& element : elements) {
+            QDomElement child = pDocument->createElement(element.first);
+            child.appendChild(pDocument->createTextNode(element.second));
+            visual.appendChild(child);
+        }
+
+        QDomElement mark = pDocument->createElement("Mark");
+        const QList<QPair<QString, QString>> markElements = {
+                {"Control", "cue_point"},
+                {"Color", "#FF0000"},
+        };
+        for (const auto& element : markElements) {
+            QDomElement child = pDocument->createElement(element.first);
+            child.appendChild(pDocument->createTextNode(element.second));
+            mark.appendChild(child);
+        }
+        visual.appendChild(mark);
+
+        QDomElement markRange = pDocument->createElement("MarkRange");
+        const QList<QPair<QString, QString>> markRangeElements = {
+                {"StartControl", "loop_start_position"},
+                {"EndControl", "loop_end_position"},
+                {"EnabledControl", "loop_enabled"},
+                {"Color", "#00FF00"},
+                {"DisabledColor", "#808080"},
+        };
+        for (const auto& element : markRangeElements) {
+            QDomElement child = pDocument->createElement(element.first);
+            child.appendChild(pDocument->createTextNode(element.second));
+            markRange.appendChild(child);
+        }
+        visual.appendChild(markRange);
+        return visual;
+    }
+
+    std::vector<std::unique_ptr<ControlObject>> m_controls;
+    // Never started, only used for the time until the next frame
+    VSyncThread m_vsyncThread;
+    QSharedPointer<VisualPlayPosition> m_pVisualPlayPosition;
+    std::unique_ptr<WaveformWidgetRenderer> m_pRenderer;
+    QImage m_image;
+};
+
+TEST_F(WaveformWidgetRendererTest, PausedDeckSkipsFrames) {
+    // The new track is rendered once
+    EXPECT_EQ(1, renderUntilClean());
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(renderFrame());
+    }
+
+    // Playing moves the waveform with each frame
+    for (int i = 1; i <= 10; ++i) {
+        setPlayPosition(0.5 + 0.01 * i);
+        EXPECT_TRUE(renderFrame());
+    }
+
+    setPlayPosition(0.7);
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, CueChangeForcesRedraw) {
+    renderUntilClean();
+
+    m_pCuePoint->set(0.4 * kTrackSamples);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pCuePoint->set(0.45 * kTrackSamples);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pCuePoint->set(-1.0);
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, CuePointsUpdateForcesRedraw) {
+    renderUntilClean();
+
+    // Hotcues are added to the track
+    m_pTrack->createAndAddCue();
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, LoopChangeForcesRedraw) {
+    renderUntilClean();
+
+    m_pLoopStart->set(0.4 * kTrackSamples);
+    m_pLoopEnd->set(0.6 * kTrackSamples);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pLoopEnabled->set(1.0);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pLoopEnd->set(0.55 * kTrackSamples);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pLoopEnabled->set(0.0);
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, BeatChangeForcesRedraw) {
+    renderUntilClean();
+
+    m_pTrack->setBeats(BeatFactory::makeBeatGrid(*m_pTrack, 128.0, 0.0));
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, PreviousTrackDoesNotForceRedraw) {
+    const TrackPointer pPreviousTrack = m_pTrack;
+    m_pTrack = newTrack();
+    m_pRenderer->setTrack(m_pTrack);
+    EXPECT_EQ(1, renderUntilClean());
+
+    // The previous track has been disconnected
+    pPreviousTrack->setBeats(BeatFactory::makeBeatGrid(*pPreviousTrack, 128.0, 0.0));
+    pPreviousTrack->createAndAddCue();
+    EXPECT_FALSE(renderFrame());
+
+    m_pTrack->setBeats(BeatFactory::makeBeatGrid(*m_pTrack, 128.0, 0.0));
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, GainChangeForcesRedraw) {
+    renderUntilClean();
+
+    m_pTotalGain->set(0.75);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pLowKill->set(1.0);
+    EXPECT_EQ(1, renderUntilClean());
+    m_pLowKill->set(0.0);
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+TEST_F(WaveformWidgetRendererTest, EndOfTrackClearsAfterWarning) {
+    renderUntilClean();
+
+    // The warning blinks, so every frame is rendered
+    m_pEndOfTrack->set(1.0);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(renderFrame());
+    }
+
+    // Once more to clear it
+    m_pEndOfTrack->set(0.0);
+    EXPECT_EQ(1, renderUntilClean());
+    EXPECT_FALSE(renderFrame());
+}
+
+TEST_F(WaveformWidgetRendererTest, ForcedRedraw) {
+    renderUntilClean();
+
+    // E.g. after the widget has been hidden
+    m_pRenderer->setFrameDirty();
+    EXPECT_EQ(1, renderUntilClean());
+    m_pRenderer->resize(300, 100, 1.0f);
+    EXPECT_EQ(1, renderUntilClean());
+}
+
+} // anonymous namespace
@@ -1,6 +1,7 @@
 #include "track/globaltrackcache.h"
 
 #include <QCoreApplication>
+#include <QMutexLocker>
 
 #include "track/track.h"
 #include "util/assert.h"
@@ -9,8 +10,6 @@
 
 namespace {
 
-constexpr std::size_t kUnorderedCollectionMinCapacity = 1024;
-
 const mixxx::Logger kLogger("GlobalTrackCache");
 
 //static
@@ -89,6 +88,21 @@ class EvictAndSaveFunctor {
     GlobalTrackCacheEntryPointer m_cacheEntryPtr;
 };
 
+// Counts the number of pending evictions while in scope
+class EvictingScope {
+  public:
+    explicit EvictingScope(std::atomic<int>* pEvictingCount)
+        : m_pEvictingCount(pEvictingCount) {
+        m_pEvictingCount->fetch_add(1);
+    }
+    ~EvictingScope() {
+        m_pEvictingCount->fetch_sub(1);
+    }
+
+  private:
+    std::atomic<int>* const m_pEvictingCount;
+};
+
 } // anonymous namespace
 
 GlobalTrackCacheLocker::GlobalTrackCacheLocker()
@@ -127,9 +141,9 @@ void GlobalTrackCacheLocker::unlockCache() {
         if (kLogStats && debugLogEnabled()) {
             kLogger.debug()
                     << "#tracksById ="
-                    << m_pInstance->m_tracksById.size()
+                    << m_pInstance->countTracksById()
                     << "/ #tracksByCanonicalLocation ="
-                    << m_pInstance->m_tracksByCanonicalLocation.size();
+                    << m_pInstance->countTracksByCanonicalLocation();
         }
         m_pInstance->m_mutex.unlock();
         if (traceLogEnabled()) {
@@ -277,6 +291,32 @@ void GlobalTrackCacheEntry::TrackDeleter::operator()(Track* pTrack) const {
     }
 }
 
+//static
+TrackPointer GlobalTrackCache::lookupTrackById(
+        const TrackId& trackId) {
+    DEBUG_ASSERT(s_pInstance);
+    auto trackPtr = s_pInstance->lookupById(trackId);
+    if (!trackPtr && s_pInstance->m_evictingCount.load() > 0) {
+        // The miss might be caused by a track that is currently
+        // evicted and saved. Lock the whole cache to wait until
+        // saving has finished, exactly like an exclusive lookup.
+        trackPtr = GlobalTrackCacheLocker().lookupTrackById(trackId);
+    }
+    return trackPtr;
+}
+
+//static
+TrackPointer GlobalTrackCache::lookupTrackByRef(
+        const TrackRef& trackRef) {
+    DEBUG_ASSERT(s_pInstance);
+    auto trackPtr = s_pInstance->lookupByRef(trackRef);
+    if (!trackPtr && s_pInstance->m_evictingCount.load() > 0) {
+        // See above
+        trackPtr = GlobalTrackCacheLocker().lookupTrackByRef(trackRef);
+    }
+    return trackPtr;
+}
+
 //static
 void GlobalTrackCache::evictAndSaveCachedTrack(GlobalTrackCacheEntryPointer cacheEntryPtr) {
     // Any access to plainPtr before a validity check inside the
@@ -321,7 +361,7 @@ GlobalTrackCache::GlobalTrackCache(
     : m_mutex(QMutex::Recursive),
       m_pSaver(pSaver),
       m_deleteTrackFn(deleteTrackFn),
-      m_tracksById(kUnorderedCollectionMinCapacity, DbId::hash_fun) {
+      m_evictingCount(0) {
     DEBUG_ASSERT(m_pSaver);
     qRegisterMetaType<GlobalTrackCacheEntryPointer>("GlobalTrackCacheEntryPointer");
 }
@@ -336,53 +376,62 @@ void GlobalTrackCache::relocateTracks(
         kLogger.debug()
                 << "Relocating tracks";
     }
-    TracksByCanonicalLocation relocatedTracksByCanonicalLocation;
-    for (auto&&
-            i = m_tracksByCanonicalLocation.begin();
-            i != m_tracksByCanonicalLocation.end();
-            ++i) {
-        const QString oldCanonicalLocation = i->first;
-        Track* plainPtr = i->second->getPlainPtr();
-        auto fileInfo = plainPtr->getFileInfo();
-        TrackRef trackRef = TrackRef::fromFileInfo(
-                fileInfo,
-                plainPtr->getId());
-        if (!trackRef.hasCanonicalLocation() && trackRef.hasId() && pRelocator) {
-            auto relocatedFileInfo = pRelocator->relocateCachedTrack(
-                        trackRef.getId(),
-                        fileInfo);
-            if (fileInfo != relocatedFileInfo) {
-                plainPtr->relocate(relocatedFileInfo);
-                trackRef = TrackRef::fromFileInfo(
-                        relocatedFileInfo,
-                        trackRef.getId());
-                fileInfo = std::move(relocatedFileInfo);
+    // The relocator must be invoked without locking any shards
+    std::array<TracksByCanonicalLocation, kShardCount> relocatedTracksByCanonicalLocation;
+    for (const auto& shard : m_tracksByCanonicalLocation) {
+        for (auto&&
+                i = shard.tracks.begin();
+                i != shard.tracks.end();
+                ++i) {
+            const QString oldCanonicalLocation = i->first;
+            Track* plainPtr = i->second->getPlainPtr();
+            auto fileInfo = plainPtr->getFileInfo();
+            TrackRef trackRef = TrackRef::fromFileInfo(
+                    fileInfo,
+                    plainPtr->getId());
+            if (!trackRef.hasCanonicalLocation() && trackRef.hasId() && pRelocator) {
+                auto relocatedFileInfo = pRelocator->relocateCachedTrack(
+                            trackRef.getId(),
+                            fileInfo);
+                if (fileInfo != relocatedFileInfo) {
+                    plainPtr->relocate(relocatedFileInfo);
+                    trackRef = TrackRef::fromFileInfo(
+                            relocatedFileInfo,
+                            trackRef.getId());
+                    fileInfo = std::move(relocatedFileInfo);
+                }
             }
+            if (!trackRef.hasCanonicalLocation()) {
+                kLogger.warning()
+                        << "Failed to relocate track"
+                        << oldCanonicalLocation
+                        << trackRef;
+                continue;
+            }
+            QString newCanonicalLocation = trackRef.getCanonicalLocation();
+            auto& relocatedTracks = relocatedTracksByCanonicalLocation[
+                    qHash(newCanonicalLocation) % kShardCount];
+            if (oldCanonicalLocation == newCanonicalLocation) {
+                // Copy the entry unmodified into the new map
+                relocatedTracks.insert(*i);
+                continue;
+            }
+            if (debugLogEnabled()) {
+                kLogger.debug()
+                        << "Relocating track"
+                        << "from" << oldCanonicalLocation
+                        << "to" << newCanonicalLocation;
+            }
+            relocatedTracks.insert(std::make_pair(
+                    std::move(newCanonicalLocation),
+                    i->second));
         }
-        if (!trackRef.hasCanonicalLocation()) {
-            kLogger.warning()
-                    << "Failed to relocate track"
-                    << oldCanonicalLocation
-                    << trackRef;
-            continue;
-        }
-        QString newCanonicalLocation = trackRef.getCanonicalLocation();
-        if (oldCanonicalLocation == newCanonicalLocation) {
-            // Copy the entry unmodified into the new map
-            relocatedTracksByCanonicalLocation.insert(*i);
-            continue;
-        }
-        if (debugLogEnabled()) {
-            kLogger.debug()
-                    << "Relocating track"
-                    << "from" << oldCanonicalLocation
-                    << "to" << newCanonicalLocation;
-        }
-        relocatedTracksByCanonicalLocation.insert(std::make_pair(
-                std::move(newCanonicalLocation),
-                i->second));
     }
-    m_tracksByCanonicalLocation = std::move(relocatedTracksByCanonicalLocation);
+    for (std::size_t i = 0; i < kShardCount; ++i) {
+        auto& shard = m_tracksByCanonicalLocation[i];
+        QMutexLocker shardLocker(&shard.mutex);
+        shard.tracks = std::move(relocatedTracksByCanonicalLocation[i]);
+    }
 }
 
 void GlobalTrackCache::saveEvictedTrack(Track* pEvictedTrack) const {
@@ -413,29 +462,42 @@ void GlobalTrackCache::deactivate() {
     // exiting the application.
     kLogger.warning()
             << "Evicting all remaining"
-            << m_tracksById.size()
+            << countTracksById()
             << '/'
-            << m_tracksByCanonicalLocation.size()
+            << countTracksByCanonicalLocation()
             << "tracks from cache";
 
-    while (!m_tracksById.empty()) {
-        auto i = m_tracksById.begin();
-        Track* plainPtr= i->second->getPlainPtr();
-        saveEvictedTrack(plainPtr);
-        m_tracksByCanonicalLocation.erase(plainPtr->getCanonicalLocation());
-        m_tracksById.erase(i);
+    // Tracks are saved before removing them from the cache. The
+    // shards must not be locked while saving a track.
+    const EvictingScope evictingScope(&m_evictingCount);
+    for (auto& shard : m_tracksById) {
+        while (!shard.tracks.empty()) {
+            auto i = shard.tracks.begin();
+            Track* plainPtr= i->second->getPlainPtr();
+            saveEvictedTrack(plainPtr);
+            const auto canonicalLocation = plainPtr->getCanonicalLocation();
+            {
+                auto& locationShard = tracksByCanonicalLocationShard(canonicalLocation);
+                QMutexLocker shardLocker(&locationShard.mutex);
+                locationShard.tracks.erase(canonicalLocation);
+            }
+            QMutexLocker shardLocker(&shard.mutex);
+            shard.tracks.erase(i);
+        }
     }
 
-    while (!m_tracksByCanonicalLocation.empty()) {
-        auto i = m_tracksByCanonicalLocation.begin();
-        Track* plainPtr= i->second->getPlainPtr();
-        saveEvictedTrack(plainPtr);
-        m_tracksByCanonicalLocation.erase(i);
+    for (auto& shard : m_tracksByCanonicalLocation) {
+        while (!shard.tracks.empty()) {
+            auto i = shard.tracks.begin();
+            Track* plainPtr= i->second->getPlainPtr();
+            saveEvictedTrack(plainPtr);
+            QMutexLocker shardLocker(&shard.mutex);
+            shard.tracks.erase(i);
+        }
     }
 
     // Verify that all cached tracks have been evicted
-    DEBUG_ASSERT(m_tracksById.empty());
-    DEBUG_ASSERT(m_tracksByCanonicalLocation.empty());
+    DEBUG_ASSERT(isEmpty());
 
     // The singular cache instance is already unavailable and
     // all allocated tracks will simply be deleted when their
@@ -445,24 +507,53 @@ void GlobalTrackCache::deactivate() {
 }
 
 bool GlobalTrackCache::isEmpty() const {
-    return m_tracksById.empty() && m_tracksByCanonicalLocation.empty();
+    return countTracksById() == 0 && countTracksByCanonicalLocation() == 0;
+}
+
+std::size_t GlobalTrackCache::countTracksById() const {
+    std::size_t count = 0;
+    for (const auto& shard : m_tracksById) {
+        QMutexLocker shardLocker(&shard.mutex);
+        count += shard.tracks.size();
+    }
+    return count;
+}
+
+std::size_t GlobalTrackCache::countTracksByCanonicalLocation() const {
+    std::size_t count = 0;
+    for (const auto& shard : m_tracksByCanonicalLocation) {
+        QMutexLocker shardLocker(&shard.mutex);
+        count += shard.tracks.size();
+    }
+    return count;
 }
 
 TrackPointer GlobalTrackCache::lookupById(
         const TrackId& trackId) {
+    GlobalTrackCacheEntryPointer entryPtr;
+    {
+        auto& shard = tracksByIdShard(trackId);
+        QMutexLocker shardLocker(&shard.mutex);
+        const auto trackById(shard.tracks.find(trackId));
+        if (shard.tracks.end() != trackById) {
+            entryPtr = trackById->second;
+        }
+    }
     TrackPointer trackPtr;
-    const auto trackById(m_tracksById.find(trackId));
-    if (m_tracksById.end() != trackById) {
+    if (entryPtr) {
         // Cache hit
         if (traceLogEnabled()) {
             kLogger.trace()
                     << "Cache hit for"
                     << trackId
-                    << trackById->second->getPlainPtr();
+                    << entryPtr->getPlainPtr();
         }
-        trackPtr = revive(trackById->second);
-        DEBUG_ASSERT(trackPtr);
-    } else {
+        // The shard is not locked while reviving the track, because
+        // releasing the last reference to a track might require to
+        // lock the whole cache.
+        trackPtr = revive(std::move(entryPtr));
+    }
+    if (!trackPtr) {
         // Cache miss
         if (traceLogEnabled()) {
             kLogger.trace()
@@ -498,20 +589,28 @@ TrackPointer GlobalTrackCache::lookupByRef(
 
 TrackPointer GlobalTrackCache::lookupByCanonicalLocation(
         const QString& canonicalLocation) {
+    GlobalTrackCacheEntryPointer entryPtr;
+    {
+        auto& shard = tracksByCanonicalLocationShard(canonicalLocation);
+        QMutexLocker shardLocker(&shard.mutex);
+        const auto trackByCanonicalLocation(
+                shard.tracks.find(canonicalLocation));
+        if (shard.tracks.end() != trackByCanonicalLocation) {
+            entryPtr = trackByCanonicalLocation->second;
+        }
+    }
     TrackPointer trackPtr;
-    const auto trackByCanonicalLocation(
-            m_tracksByCanonicalLocation.find(canonicalLocation));
-    if (m_tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
+    if (entryPtr) {
         // Cache hit
         if (traceLogEnabled()) {
             kLogger.trace()
                     << "Cache hit for"
                     << canonicalLocation
-                    << trackByCanonicalLocation->second->getPlainPtr();
+                    << entryPtr->getPlainPtr();
         }
-        trackPtr = revive(trackByCanonicalLocation->second);
-        DEBUG_ASSERT(trackPtr);
-    } else {
+        trackPtr = revive(std::move(entryPtr));
+    }
+    if (!trackPtr) {
         // Cache miss
         if (traceLogEnabled()) {
             kLogger.trace()
@@ -524,14 +623,18 @@ TrackPointer GlobalTrackCache::lookupByCanonicalLocation(
 
 QSet<TrackId> GlobalTrackCache::getCachedTrackIds() const {
     QSet<TrackId> trackIds;
-    for (const auto& entry : m_tracksById) {
-        trackIds << entry.first;
+    for (const auto& shard : m_tracksById) {
+        QMutexLocker shardLocker(&shard.mutex);
+        for (const auto& entry : shard.tracks) {
+            trackIds << entry.first;
+        }
     }
     return trackIds;
 }
 
 TrackPointer GlobalTrackCache::revive(
         GlobalTrackCacheEntryPointer entryPtr) {
+    QMutexLocker reviveLocker(&entryPtr->m_reviveMutex);
 
     TrackPointer savingPtr = entryPtr->lock();
     if (savingPtr) {
@@ -544,6 +647,18 @@ TrackPointer GlobalTrackCache::revive(
         return savingPtr;
     }
 
+    if (entryPtr->m_evicted) {
+        // The track is about to be evicted and saved. This can only
+        // happen for lookups that don't lock the whole cache while
+        // the entry has not been removed from all shards yet.
+        if (debugLogEnabled()) {
+            kLogger.debug()
+                    << "Skip reviving an evicted track"
+                    << entryPtr->getPlainPtr();
+        }
+        return savingPtr;
+    }
+
     // We are here if another thread is preempted during the
     // destructor of the last savingPtr referencing this
     // track, after the reference counter drops to zero and
@@ -667,17 +782,21 @@ void GlobalTrackCache::resolve(
 
     if (trackRef.hasId()) {
         // Insert item by id
-        DEBUG_ASSERT(m_tracksById.find(
-                trackRef.getId()) == m_tracksById.end());
-        m_tracksById.insert(std::make_pair(
+        auto& shard = tracksByIdShard(trackRef.getId());
+        QMutexLocker shardLocker(&shard.mutex);
+        DEBUG_ASSERT(shard.tracks.find(
+                trackRef.getId()) == shard.tracks.end());
+        shard.tracks.insert(std::make_pair(
                 trackRef.getId(),
                 cacheEntryPtr));
     }
     if (trackRef.hasCanonicalLocation()) {
         // Insert item by track location
-        DEBUG_ASSERT(m_tracksByCanonicalLocation.find(
-                trackRef.getCanonicalLocation()) == m_tracksByCanonicalLocation.end());
-        m_tracksByCanonicalLocation.insert(std::make_pair(
+        auto& shard = tracksByCanonicalLocationShard(trackRef.getCanonicalLocation());
+        QMutexLocker shardLocker(&shard.mutex);
+        DEBUG_ASSERT(shard.tracks.find(
+                trackRef.getCanonicalLocation()) == shard.tracks.end());
+        shard.tracks.insert(std::make_pair(
                 trackRef.getCanonicalLocation(),
                 cacheEntryPtr));
     }
@@ -708,27 +827,35 @@ TrackRef GlobalTrackCache::initTrackId(
     EvictAndSaveFunctor* pDel = std::get_deleter<EvictAndSaveFunctor>(strongPtr);
     DEBUG_ASSERT(pDel);
 
+    // The id of the track must be initialized before it becomes
+    // visible for lookups that only lock the shard.
+    strongPtr->initId(trackId);
+    DEBUG_ASSERT(createTrackRef(*strongPtr) == trackRefWithId);
+
     // Insert item by id
-    DEBUG_ASSERT(m_tracksById.find(trackId) == m_tracksById.end());
-    m_tracksById.insert(std::make_pair(
+    auto& shard = tracksByIdShard(trackId);
+    QMutexLocker shardLocker(&shard.mutex);
+    DEBUG_ASSERT(shard.tracks.find(trackId) == shard.tracks.end());
+    shard.tracks.insert(std::make_pair(
             trackId,
             pDel->getCacheEntryPointer()));
 
-    strongPtr->initId(trackId);
-    DEBUG_ASSERT(createTrackRef(*strongPtr) == trackRefWithId);
-    DEBUG_ASSERT(m_tracksById.find(trackId) != m_tracksById.end());
-
     return trackRefWithId;
 }
 
 void GlobalTrackCache::purgeTrackId(TrackId trackId) {
     DEBUG_ASSERT(trackId.isValid());
 
-    const auto trackById(m_tracksById.find(trackId));
-    if (m_tracksById.end() != trackById) {
+    auto& shard = tracksByIdShard(trackId);
+    QMutexLocker shardLocker(&shard.mutex);
+    const auto trackById(shard.tracks.find(trackId));
+    if (shard.tracks.end() != trackById) {
         Track* track = trackById->second->getPlainPtr();
+        // Remove the entry before resetting the id that is
+        // used as the key for lookups
+        shard.tracks.erase(trackById);
+        shardLocker.unlock();
         track->resetId();
-        m_tracksById.erase(trackById);
     }
 }
 
@@ -742,15 +869,24 @@ void GlobalTrackCache::slotEvictAndSave(
     // whole invocation!
     GlobalTrackCacheLocker cacheLocker;
 
-    if (!cacheEntryPtr->expired()) {
-        // We have handed out (revived) this track again after our reference count
-        // drops to zero and before acquiring the lock at the beginning of this function
-        if (debugLogEnabled()) {
-            kLogger.debug()
-                    << "Skip to evict and save a revived or reallocated track"
-                    << cacheEntryPtr->getPlainPtr();
+    // Lookups that only lock a single shard need to wait until
+    // the track has been saved if they don't find it.
+    const EvictingScope evictingScope(&m_evictingCount);
+    {
+        // Lookups that only lock a single shard might still revive
+        // the track until it has been marked as evicted
+        QMutexLocker reviveLocker(&cacheEntryPtr->m_reviveMutex);
+        if (!cacheEntryPtr->expired()) {
+            // We have handed out (revived) this track again after our reference count
+            // drops to zero and before acquiring the lock at the beginning of this function
+            if (debugLogEnabled()) {
+                kLogger.debug()
+                        << "Skip to evict and save a revived or reallocated track"
+                        << cacheEntryPtr->getPlainPtr();
+            }
+            return;
         }
-        return;
+        cacheEntryPtr->m_evicted = true;
     }
 
     if (!tryEvict(cacheEntryPtr->getPlainPtr())) {
@@ -795,10 +931,12 @@ bool GlobalTrackCache::tryEvict(Track* plainPtr) {
                 << plainPtr;
     }
     if (trackRef.hasId()) {
-        const auto trackById = m_tracksById.find(trackRef.getId());
-        if (trackById != m_tracksById.end()) {
+        auto& shard = tracksByIdShard(trackRef.getId());
+        QMutexLocker shardLocker(&shard.mutex);
+        const auto trackById = shard.tracks.find(trackRef.getId());
+        if (trackById != shard.tracks.end()) {
             if (trackById->second->getPlainPtr() == plainPtr) {
-                m_tracksById.erase(trackById);
+                shard.tracks.erase(trackById);
                 evicted = true;
             } else {
                 notEvicted = true;
@@ -806,11 +944,13 @@ bool GlobalTrackCache::tryEvict(Track* plainPtr) {
         }
     }
     if (trackRef.hasCanonicalLocation()) {
+        auto& shard = tracksByCanonicalLocationShard(trackRef.getCanonicalLocation());
+        QMutexLocker shardLocker(&shard.mutex);
         const auto trackByCanonicalLocation(
-                m_tracksByCanonicalLocation.find(trackRef.getCanonicalLocation()));
-        if (m_tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
+                shard.tracks.find(trackRef.getCanonicalLocation()));
+        if (shard.tracks.end() != trackByCanonicalLocation) {
             if (trackByCanonicalLocation->second->getPlainPtr() == plainPtr) {
-                m_tracksByCanonicalLocation.erase(
+                shard.tracks.erase(
                         trackByCanonicalLocation);
                 evicted = true;
             } else {
@@ -825,14 +965,20 @@ bool GlobalTrackCache::tryEvict(Track* plainPtr) {
 }
 
 bool GlobalTrackCache::isCached(Track* plainPtr) const {
-    for (auto&& entry: m_tracksById) {
-        if (entry.second->getPlainPtr() == plainPtr) {
-            return true;
+    for (const auto& shard : m_tracksById) {
+        QMutexLocker shardLocker(&shard.mutex);
+        for (auto&& entry: shard.tracks) {
+            if (entry.second->getPlainPtr() == plainPtr) {
+                return true;
+            }
         }
     }
-    for (auto&& entry: m_tracksByCanonicalLocation) {
-        if (entry.second->getPlainPtr() == plainPtr) {
-              return true;
+    for (const auto& shard : m_tracksByCanonicalLocation) {
+        QMutexLocker shardLocker(&shard.mutex);
+        for (auto&& entry: shard.tracks) {
+            if (entry.second->getPlainPtr() == plainPtr) {
+                  return true;
+            }
         }
     }
     return false;
@@ -1,6 +1,8 @@
 #pragma once
 
-
+#include <QMutex>
+#include <array>
+#include <atomic>
 #include <map>
 #include <unordered_map>
 
@@ -56,10 +58,11 @@ class GlobalTrackCacheEntry final {
 
     explicit GlobalTrackCacheEntry(
             std::unique_ptr<Track, TrackDeleter> deletingPtr)
-        : m_deletingPtr(std::move(deletingPtr)) {
+        : m_deletingPtr(std::move(deletingPtr)),
+          m_evicted(false) {
     }
     GlobalTrackCacheEntry(const GlobalTrackCacheEntry& other) = delete;
-    GlobalTrackCacheEntry(GlobalTrackCacheEntry&&) = default;
+    GlobalTrackCacheEntry(GlobalTrackCacheEntry&&) = delete;
 
     void init(TrackWeakPointer savingWeakPtr) {
         // Uninitialized or expired
@@ -79,8 +82,16 @@ class GlobalTrackCacheEntry final {
     }
 
   private:
+    friend class GlobalTrackCache;
+
     std::unique_ptr<Track, TrackDeleter> m_deletingPtr;
     TrackWeakPointer m_savingWeakPtr;
+
+    // Serializes reviving the entry with the decision to evict it.
+    // Entries can be revived concurrently by lookups that only lock
+    // a single shard of the cache.
+    QMutex m_reviveMutex;
+    bool m_evicted;
 };
 
 typedef std::shared_ptr<GlobalTrackCacheEntry> GlobalTrackCacheEntryPointer;
@@ -221,6 +232,15 @@ class GlobalTrackCache : public QObject {
     // See also: GlobalTrackCacheLocker::deactivateCache()
     static void destroyInstance();
 
+    /// Lookup an existing Track object in the cache without
+    /// locking the whole cache. Only the shard that contains the
+    /// track is locked temporarily. Use these functions instead of
+    /// GlobalTrackCacheLocker if no exclusive access is needed.
+    static TrackPointer lookupTrackById(
+            const TrackId& trackId);
+    static TrackPointer lookupTrackByRef(
+            const TrackRef& trackRef);
+
     // Deleter callbacks for the smart-pointer
     static void evictAndSaveCachedTrack(GlobalTrackCacheEntryPointer cacheEntryPtr);
 
@@ -277,18 +297,54 @@ class GlobalTrackCache : public QObject {
 
     void saveEvictedTrack(Track* pEvictedTrack) const;
 
+    std::size_t countTracksById() const;
+    std::size_t countTracksByCanonicalLocation() const;
+
     // Managed by GlobalTrackCacheLocker
+    //
+    // All modifications of the cache require this exclusive lock.
+    // Additionally the affected shard(s) must be locked while
+    // inserting or removing entries. Lookups only need to lock
+    // a single shard. Lock order: m_mutex -> shard mutex
     mutable QMutex m_mutex;
 
     GlobalTrackCacheSaver* m_pSaver;
 
     deleteTrackFn_t m_deleteTrackFn;
 
+    // The number of evictions that are currently in progress. Lookups
+    // that only lock a single shard fall back to locking the whole
+    // cache after a miss while tracks are evicted and saved.
+    std::atomic<int> m_evictingCount;
+
+    static constexpr std::size_t kShardCount = 16;
+    static constexpr std::size_t kShardMinCapacity = 64;
+
     // This caches the unsaved Tracks by ID
     typedef std::unordered_map<TrackId, GlobalTrackCacheEntryPointer, TrackId::hash_fun_t> TracksById;
-    TracksById m_tracksById;
+    struct TracksByIdShard {
+        TracksByIdShard()
+                : tracks(kShardMinCapacity, DbId::hash_fun) {
+        }
+        mutable QMutex mutex;
+        TracksById tracks;
+    };
+    std::array<TracksByIdShard, kShardCount> m_tracksById;
+
+    TracksByIdShard& tracksByIdShard(const TrackId& trackId) {
+        return m_tracksById[DbId::hash_fun(trackId) % kShardCount];
+    }
 
     // This caches the unsaved Tracks by location
     typedef std::map<QString, GlobalTrackCacheEntryPointer> TracksByCanonicalLocation;
-    TracksByCanonicalLocation m_tracksByCanonicalLocation;
+    struct TracksByCanonicalLocationShard {
+        mutable QMutex mutex;
+        TracksByCanonicalLocation tracks;
+    };
+    std::array<TracksByCanonicalLocationShard, kShardCount> m_tracksByCanonicalLocation;
+
+    TracksByCanonicalLocationShard& tracksByCanonicalLocationShard(
+            const QString& canonicalLocation) {
+        return m_tracksByCanonicalLocation[qHash(canonicalLocation) % kShardCount];
+    }
 };
@@ -79,6 +79,12 @@ bool CmdlineArgs::Parse(int &argc, char **argv) {
         } else if (argv[i] == QString("--timelinePath") && i+1 < argc) {
             m_timelinePath = QString::fromLocal8Bit(argv[i+1]);
             i++;
+        } else if (argv[i] == QString("--renderScript") && i+1 < argc) {
+            m_renderScriptPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--renderOutput") && i+1 < argc) {
+            m_renderOutputPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
         } else if (argv[i] == QString("--logLevel") && i+1 < argc) {
             logLevelSet = true;
             auto level = QLatin1String(argv[i+1]);
@@ -108,6 +114,12 @@ when a critical error occurs unless this is set properly.\n", stdout);
         }
     }
 
+    // An offline render needs both the script and the output file
+    if (m_renderScriptPath.isEmpty() != m_renderOutputPath.isEmpty()) {
+        fputs("\n--renderScript and --renderOutput must be used together\n", stdout);
+        return false;
+    }
+
     // If --logLevel was unspecified and --developer is enabled then set
     // logLevel to debug.
     if (m_developer && !logLevelSet) {
@@ -157,6 +169,19 @@ void CmdlineArgs::printUsage() {
 \n\
 -f, --fullScreen        Starts Mixxx in full-screen mode\n\
 \n\
+--renderScript FILE     Renders the master output offline as fast as\n\
+                        possible without a GUI or sound devices. The\n\
+                        script contains timed control events, e.g.\n\
+                          0.0 load [Channel1] /path/to/track.mp3\n\
+                          0.0 set [Channel1] play 1\n\
+                          60.0 end\n\
+                        Use together with -platform offscreen on\n\
+                        systems without a display.\n\
+\n\
+--renderOutput FILE     The file for --renderScript. The format is\n\
+                        selected by the extension (wav, aiff, flac,\n\
+                        ogg, mp3, opus).\n\
+\n\
 --logLevel LEVEL        Sets the verbosity of command line logging\n\
                         critical - Critical/Fatal only\n\
                         warning  - Above + Warnings\n\
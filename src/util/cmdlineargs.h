@@ -41,6 +41,9 @@ class CmdlineArgs final {
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getPluginPath() const { return m_pluginPath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    bool getOfflineRender() const { return !m_renderScriptPath.isEmpty(); }
+    const QString& getRenderScriptPath() const { return m_renderScriptPath; }
+    const QString& getRenderOutputPath() const { return m_renderOutputPath; }
 
   private:
     QList<QString> m_musicFiles;    // List of files to load into players at startup
@@ -57,4 +60,6 @@ class CmdlineArgs final {
     QString m_resourcePath;
     QString m_pluginPath;
     QString m_timelinePath;
+    QString m_renderScriptPath;
+    QString m_renderOutputPath;
 };
@@ -1,5 +1,8 @@
 #include "util/file.h"
 
+#include <algorithm>
+#include <vector>
+
 MDir::MDir() {
 }
 
@@ -28,3 +31,43 @@ MDir& MDir::operator=(const MDir& other) {
 bool MDir::canAccess() {
     return Sandbox::canAccessFile(m_dir);
 }
+
+namespace mixxx {
+
+int purgeLeastRecentlyModifiedFiles(
+        const QDir& dir,
+        const QStringList& nameFilters,
+        qint64 maxTotalBytes,
+        QDirIterator::IteratorFlags flags) {
+    std::vector<QFileInfo> entries;
+    qint64 totalBytes = 0;
+    QDirIterator it(
+            dir.absolutePath(),
+            nameFilters,
+            QDir::Files,
+            flags);
+    while (it.hasNext()) {
+        it.next();
+        entries.push_back(it.fileInfo());
+        totalBytes += entries.back().size();
+    }
+    if (totalBytes <= maxTotalBytes) {
+        return 0;
+    }
+    std::sort(entries.begin(), entries.end(), [](const QFileInfo& lhs, const QFileInfo& rhs) {
+        return lhs.lastModified() < rhs.lastModified();
+    });
+    int numDeleted = 0;
+    for (const auto& entry : entries) {
+        if (totalBytes <= maxTotalBytes) {
+            break;
+        }
+        if (QFile::remove(entry.absoluteFilePath())) {
+            totalBytes -= entry.size();
+            ++numDeleted;
+        }
+    }
+    return numDeleted;
+}
+
+} // namespace mixxx
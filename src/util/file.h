@@ -3,6 +3,8 @@
 
 #include <QFile>
 #include <QDir>
+#include <QDirIterator>
+#include <QStringList>
 
 #include "util/sandbox.h"
 
@@ -35,4 +37,18 @@ class MDir {
     SecurityTokenPointer m_pSecurityToken;
 };
 
+namespace mixxx {
+
+// Deletes the least recently modified files in a directory that match
+// the name filters until the total size of the matching files does not
+// exceed maxTotalBytes. Files in subdirectories are only included with
+// QDirIterator::Subdirectories. Returns the number of deleted files.
+int purgeLeastRecentlyModifiedFiles(
+        const QDir& dir,
+        const QStringList& nameFilters,
+        qint64 maxTotalBytes,
+        QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
+
+} // namespace mixxx
+
 #endif /* FILE_H */
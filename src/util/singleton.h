@@ -2,19 +2,21 @@
 #define SINGLETON_H
 
 #include <QtDebug>
+#include <utility>
 
 #include "util/assert.h"
 
 template<class T>
 class Singleton {
   public:
-    static T* createInstance() {
+    template<typename... Args>
+    static T* createInstance(Args&&... args) {
         VERIFY_OR_DEBUG_ASSERT(!m_instance) {
             qWarning() << "Singleton class has already been created!";
             return m_instance;
         }
 
-        m_instance = new T();
+        m_instance = new T(std::forward<Args>(args)...);
         return m_instance;
     }
 
@@ -1,4 +1,6 @@
 #include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
 
 #include "vinylcontrol/vinylcontrolprocessor.h"
 
@@ -14,17 +16,141 @@
 #define SIGNAL_QUALITY_FIFO_SIZE 256
 #define SAMPLE_PIPE_FIFO_SIZE 65536
 
+class VinylControlProcessor::InputThread : public QThread {
+  public:
+    InputThread(VinylControlProcessor* pProcessor, int index)
+            : m_pProcessor(pProcessor),
+              m_index(index),
+              m_samplePipe(SAMPLE_PIPE_FIFO_SIZE),
+              m_pWorkBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
+              m_bStop(false),
+              m_bReloadConfig(false) {
+        start(QThread::HighPriority);
+    }
+
+    ~InputThread() override {
+        stop();
+        wait();
+        SampleUtil::free(m_pWorkBuffer);
+    }
+
+    void stop() {
+        QMutexLocker locker(&m_waitLock);
+        m_bStop = true;
+        m_samplesAvailableSignal.wakeAll();
+    }
+
+    void requestReloadConfig() {
+        QMutexLocker locker(&m_waitLock);
+        m_bReloadConfig = true;
+        m_samplesAvailableSignal.wakeAll();
+    }
+
+    // Called from the engine callback, lock-free
+    int writeSamples(const CSAMPLE* pBuffer, int iSamples) {
+        int samplesWritten = m_samplePipe.write(pBuffer, iSamples);
+        // Waking up without holding m_waitLock may be missed if the thread
+        // is about to wait. It then processes these samples together with
+        // the next buffer.
+        m_samplesAvailableSignal.wakeAll();
+        return samplesWritten;
+    }
+
+    // Locked while the thread analyzes samples, i.e. while it uses the
+    // VinylControl of its input
+    QMutex* analysisLock() {
+        return &m_analysisLock;
+    }
+
+  private:
+    void run() override {
+        QThread::currentThread()->setObjectName(
+                QString("VinylControlProcessor %1").arg(m_index + 1));
+
+        while (true) {
+            m_waitLock.lock();
+            if (!m_bStop && !m_bReloadConfig && m_samplePipe.readAvailable() == 0) {
+                // Wait for a signal from the main thread or engine thread that
+                // we should wake up and process input.
+                m_samplesAvailableSignal.wait(&m_waitLock);
+            }
+            const bool stop = m_bStop;
+            const bool reloadConfig = m_bReloadConfig;
+            m_bReloadConfig = false;
+            m_waitLock.unlock();
+
+            if (stop) {
+                return;
+            }
+            if (reloadConfig) {
+                reloadProcessorConfig();
+            }
+            processSamples();
+        }
+    }
+
+    void reloadProcessorConfig() {
+        if (!m_pProcessor->processor(m_index)) {
+            return;
+        }
+        m_pProcessor->replaceProcessor(m_index,
+                new VinylControlXwax(m_pProcessor->m_pConfig, kVCGroup.arg(m_index + 1)));
+    }
+
+    void processSamples() {
+        QMutexLocker locker(&m_analysisLock);
+        VinylControl* pProcessor = m_pProcessor->processor(m_index);
+
+        int samplesRead;
+        while ((samplesRead = m_samplePipe.read(m_pWorkBuffer, MAX_BUFFER_LEN)) > 0) {
+            if (samplesRead % 2 != 0) {
+                qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
+                samplesRead--;
+            }
+            int framesRead = samplesRead / 2;
+
+            if (pProcessor) {
+                pProcessor->analyzeSamples(m_pWorkBuffer, framesRead);
+            } else {
+                // Samples are being written to a non-existent processor. Warning?
+                qWarning() << "Samples written to non-existent VinylControl processor:" << m_index;
+            }
+        }
+
+        // TODO(rryan) define a time-based update rate. This will update way
+        // too quickly.
+        if (pProcessor && m_pProcessor->m_bReportSignalQuality) {
+            VinylSignalQualityReport report;
+            if (pProcessor->writeQualityReport(&report)) {
+                report.processor = m_index;
+                m_pProcessor->writeQualityReport(report);
+            }
+        }
+    }
+
+    VinylControlProcessor* const m_pProcessor;
+    const int m_index;
+
+    FIFO<CSAMPLE> m_samplePipe;
+    CSAMPLE* const m_pWorkBuffer;
+
+    QMutex m_analysisLock;
+    // Provides thread safety around the wait condition below.
+    QMutex m_waitLock;
+    QWaitCondition m_samplesAvailableSignal;
+    // Guarded by m_waitLock
+    bool m_bStop;
+    bool m_bReloadConfig;
+};
+
 VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPointer pConfig)
-        : QThread(pParent),
+        : QObject(pParent),
           m_pConfig(pConfig),
           m_pToggle(new ControlPushButton(ConfigKey(VINYL_PREF_KEY, "Toggle"))),
-          m_pWorkBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_processorsLock(QMutex::Recursive),
           m_processors(kMaximumVinylControlInputs, NULL),
           m_signalQualityFifo(SIGNAL_QUALITY_FIFO_SIZE),
-          m_bReportSignalQuality(false),
-          m_bQuit(false),
-          m_bReloadConfig(false) {
+          m_bReportSignalQuality(false) {
     connect(m_pToggle,
             &ControlPushButton::valueChanged,
             this,
@@ -32,19 +158,17 @@ VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPoint
             Qt::DirectConnection);
 
     for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
-        m_samplePipes[i] = new FIFO<CSAMPLE>(SAMPLE_PIPE_FIFO_SIZE);
+        m_inputThreads[i] = new InputThread(this, i);
     }
-
-    start(QThread::HighPriority);
 }
 
 VinylControlProcessor::~VinylControlProcessor() {
-    m_bQuit = true;
-    m_samplesAvailableSignal.wakeAll();
-    wait();
+    for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
+        delete m_inputThreads[i];
+        m_inputThreads[i] = NULL;
+    }
 
     delete m_pToggle;
-    SampleUtil::free(m_pWorkBuffer);
 
     {
         QMutexLocker locker(&m_processorsLock);
@@ -52,9 +176,6 @@ VinylControlProcessor::~VinylControlProcessor() {
             VinylControl* pProcessor = m_processors.at(i);
             m_processors[i] = NULL;
             delete pProcessor;
-
-            delete m_samplePipes[i];
-            m_samplePipes[i] = NULL;
         }
     }
 
@@ -68,88 +189,45 @@ void VinylControlProcessor::setSignalQualityReporting(bool enable) {
 }
 
 void VinylControlProcessor::shutdown() {
-    m_bQuit = true;
-    m_samplesAvailableSignal.wakeAll();
+    for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
+        m_inputThreads[i]->stop();
+    }
 }
 
 void VinylControlProcessor::requestReloadConfig() {
-    m_bReloadConfig = true;
-    m_samplesAvailableSignal.wakeAll();
+    for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
+        m_inputThreads[i]->requestReloadConfig();
+    }
 }
 
-void VinylControlProcessor::run() {
-    unsigned static id = 0; //the id of this thread, for debugging purposes //XXX copypasta (should factor this out somehow), -kousu 2/2009
-    QThread::currentThread()->setObjectName(QString("VinylControlProcessor %1").arg(++id));
-
-    while (!m_bQuit) {
-        if (m_bReloadConfig) {
-            reloadConfig();
-            m_bReloadConfig = false;
-        }
-
-        for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
-            QMutexLocker locker(&m_processorsLock);
-            VinylControl* pProcessor = m_processors[i];
-            locker.unlock();
-            FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[i];
-
-            if (pSamplePipe->readAvailable() > 0) {
-                int samplesRead = pSamplePipe->read(m_pWorkBuffer, MAX_BUFFER_LEN);
-
-                if (samplesRead % 2 != 0) {
-                    qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
-                    samplesRead--;
-                }
-                int framesRead = samplesRead / 2;
-
-                if (pProcessor) {
-                    pProcessor->analyzeSamples(m_pWorkBuffer, framesRead);
-                } else {
-                    // Samples are being written to a non-existent processor. Warning?
-                    qWarning() << "Samples written to non-existent VinylControl processor:" << i;
-                }
-            }
-
-            // TODO(rryan) define a time-based update rate. This will update way
-            // too quickly.
-            if (pProcessor && m_bReportSignalQuality) {
-                VinylSignalQualityReport report;
-                if (pProcessor->writeQualityReport(&report)) {
-                    report.processor = i;
-                    if (m_signalQualityFifo.write(&report, 1) != 1) {
-                        qWarning() << "VinylControlProcessor could not write signal quality report for VC index:" << i;
-                    }
-                }
-            }
-        }
-
-        if (m_bQuit) {
-            break;
-        }
+VinylControl* VinylControlProcessor::processor(int index) const {
+    QMutexLocker locker(&m_processorsLock);
+    return m_processors.at(index);
+}
 
-        // Wait for a signal from the main thread or engine thread that we
-        // should wake up and process input.
-        m_waitForSampleMutex.lock();
-        m_samplesAvailableSignal.wait(&m_waitForSampleMutex);
-        m_waitForSampleMutex.unlock();
+void VinylControlProcessor::replaceProcessor(int index, VinylControl* pNew) {
+    QMutexLocker locker(&m_processorsLock);
+    VinylControl* pCurrent = m_processors.at(index);
+    m_processors.replace(index, pNew);
+    locker.unlock();
+    if (pCurrent == NULL) {
+        return;
+    }
+    if (QThread::currentThread() != m_inputThreads[index]) {
+        // Wait until the input thread has finished analyzing with the
+        // current processor. It picks up the new one for the next samples.
+        QMutexLocker analysisLocker(m_inputThreads[index]->analysisLock());
     }
+    // Delete outside of the critical section to avoid deadlocks.
+    delete pCurrent;
 }
 
-void VinylControlProcessor::reloadConfig() {
-    for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
-        QMutexLocker locker(&m_processorsLock);
-        VinylControl* pCurrent = m_processors[i];
-
-        if (pCurrent == NULL) {
-            continue;
-        }
-
-        VinylControl *pNew = new VinylControlXwax(
-            m_pConfig, kVCGroup.arg(i + 1));
-        m_processors.replace(i, pNew);
-        locker.unlock();
-        // Delete outside of the critical section to avoid deadlocks.
-        delete pCurrent;
+void VinylControlProcessor::writeQualityReport(const VinylSignalQualityReport& report) {
+    // The FIFO has a single writer, but every input thread reports
+    QMutexLocker locker(&m_signalQualityLock);
+    if (m_signalQualityFifo.write(&report, 1) != 1) {
+        qWarning() << "VinylControlProcessor could not write signal quality report for VC index:"
+                   << report.processor;
     }
 }
 
@@ -166,15 +244,7 @@ void VinylControlProcessor::onInputConfigured(AudioInput input) {
         return;
     }
 
-    VinylControl *pNew = new VinylControlXwax(
-        m_pConfig, kVCGroup.arg(index + 1));
-
-    QMutexLocker locker(&m_processorsLock);
-    VinylControl* pCurrent = m_processors.at(index);
-    m_processors.replace(index, pNew);
-    locker.unlock();
-    // Delete outside of the critical section to avoid deadlocks.
-    delete pCurrent;
+    replaceProcessor(index, new VinylControlXwax(m_pConfig, kVCGroup.arg(index + 1)));
 }
 
 void VinylControlProcessor::onInputUnconfigured(AudioInput input) {
@@ -191,12 +261,7 @@ void VinylControlProcessor::onInputUnconfigured(AudioInput input) {
         return;
     }
 
-    QMutexLocker locker(&m_processorsLock);
-    VinylControl* pVC = m_processors.at(index);
-    m_processors.replace(index, NULL);
-    locker.unlock();
-    // Delete outside of the critical section to avoid deadlocks.
-    delete pVC;
+    replaceProcessor(index, NULL);
 }
 
 bool VinylControlProcessor::deckConfigured(int index) const {
@@ -219,23 +284,21 @@ void VinylControlProcessor::receiveBuffer(AudioInput input,
         return;
     }
 
-    FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[vcIndex];
+    InputThread* pInputThread = m_inputThreads[vcIndex];
 
-    if (pSamplePipe == NULL) {
+    if (pInputThread == NULL) {
         // Should not be possible.
         return;
     }
 
     const int kChannels = 2;
     const int nSamples = nFrames * kChannels;
-    int samplesWritten = pSamplePipe->write(pBuffer, nSamples);
+    int samplesWritten = pInputThread->writeSamples(pBuffer, nSamples);
 
     if (samplesWritten < nSamples) {
         qWarning() << "ERROR: Buffer overflow in VinylControlProcessor. Dropping samples on the floor."
                    << "VCIndex:" << vcIndex;
     }
-
-    m_samplesAvailableSignal.wakeAll();
 }
 
 void VinylControlProcessor::toggleDeck(double value) {
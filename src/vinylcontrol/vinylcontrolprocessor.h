@@ -2,10 +2,8 @@
 #define VINYLCONTROLPROCESSOR_H
 
 #include <QObject>
-#include <QThread>
 #include <QVector>
 #include <QMutex>
-#include <QWaitCondition>
 
 #include "preferences/usersettings.h"
 #include "util/fifo.h"
@@ -15,11 +13,13 @@
 class VinylControl;
 class ControlPushButton;
 
-// VinylControlProcessor is a thread that is in charge of receiving samples from
-// the engine callback and feeding those samples to the VinylControl
-// classes. The most important thing is that the connection between the engine
-// callback and VinylControlProcessor (the receiveBuffer method) is lock-free.
-class VinylControlProcessor : public QThread, public AudioDestination {
+// VinylControlProcessor is in charge of receiving samples from the engine
+// callback and feeding those samples to the VinylControl classes. Each vinyl
+// control input is processed by its own thread, so that the decks do not
+// delay each other. The most important thing is that the connection between
+// the engine callback and these threads (the receiveBuffer method) is
+// lock-free.
+class VinylControlProcessor : public QObject, public AudioDestination {
     Q_OBJECT
   public:
     VinylControlProcessor(QObject* pParent, UserSettingsPointer pConfig);
@@ -28,10 +28,11 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     // Called from main thread. Must only touch m_bReportSignalQuality.
     void setSignalQualityReporting(bool enable);
 
-    // Called from the main thread. Must only touch m_bQuit;
+    // Called from the main thread. Stops the input threads.
     void shutdown();
 
-    // Called from the main thread. Must only touch m_bReload;
+    // Called from the main thread. The input threads reload the config
+    // before they process the next samples.
     void requestReloadConfig();
 
     bool deckConfigured(int index) const;
@@ -45,7 +46,8 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     virtual void onInputUnconfigured(AudioInput input);
 
     // Called by the engine callback. Must not touch any state in
-    // VinylControlProcessor except for m_samplePipes. NOTE:
+    // VinylControlProcessor except for the sample pipes of the input
+    // threads. NOTE:
 
     // This is called by SoundManager whenever there are new samples from the
     // configured input to be processed. This is run in the callback thread of
@@ -56,30 +58,30 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     void receiveBuffer(AudioInput input, const CSAMPLE* pBuffer,
                        unsigned int iNumFrames);
 
-  protected:
-    void run();
-
   private slots:
     void toggleDeck(double value);
 
   private:
-    void reloadConfig();
+    class InputThread;
+
+    // Replaces the VinylControl of an input and deletes the previous one
+    // once its input thread does not use it anymore.
+    void replaceProcessor(int index, VinylControl* pNew);
+    VinylControl* processor(int index) const;
+    void writeQualityReport(const VinylSignalQualityReport& report);
 
     UserSettingsPointer m_pConfig;
     ControlPushButton* m_pToggle;
-    // A pre-allocated array of FIFOs for writing samples from the engine
-    // callback to the processor thread. There is a maximum of
-    // kMaximumVinylControlInputs pipes.
-    FIFO<CSAMPLE>* m_samplePipes[kMaximumVinylControlInputs];
-    CSAMPLE* m_pWorkBuffer;
-    QWaitCondition m_samplesAvailableSignal;
-    QMutex m_waitForSampleMutex;
-    QMutex m_processorsLock;
+    // A pre-allocated thread with a FIFO for each possible input. The
+    // engine callback writes the samples to the FIFO and wakes up the
+    // thread. There is a maximum of kMaximumVinylControlInputs threads.
+    InputThread* m_inputThreads[kMaximumVinylControlInputs];
+    mutable QMutex m_processorsLock;
     QVector<VinylControl*> m_processors;
+    // The input threads write the reports, the main thread reads them
+    QMutex m_signalQualityLock;
     FIFO<VinylSignalQualityReport> m_signalQualityFifo;
     volatile bool m_bReportSignalQuality;
-    volatile bool m_bQuit;
-    volatile bool m_bReloadConfig;
 };
 
 
@@ -68,6 +68,7 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
           m_iPitchRingSize(0),
           m_iPitchRingPos(0),
           m_iPitchRingFilled(0),
+          m_dPitchRingSum(0.0),
           m_dDisplayPitch(0.0),
           m_pSteadySubtle(NULL),
           m_pSteadyGross(NULL),
@@ -126,12 +127,16 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
     }
 
 
+    // Finding the definition builds its lookup table, which is shared by
+    // the VinylControlXwax instances of all input threads.
+    s_xwaxLUTMutex.lock();
     timecode_def* tc_def = timecoder_find_definition(timecode);
     if (tc_def == NULL) {
         qDebug() << "Error finding timecode definition for " << timecode << ", defaulting to serato_2a";
         timecode = (char*)"serato_2a";
         tc_def = timecoder_find_definition(timecode);
     }
+    s_xwaxLUTMutex.unlock();
 
     double speed = 1.0;
     double rpm = 100.0 / 3.0;
@@ -191,6 +196,12 @@ VinylControlXwax::~VinylControlXwax() {
     m_pVCRate->set(0.0);
 }
 
+void VinylControlXwax::resetPitchRing() {
+    m_iPitchRingPos = 0;
+    m_iPitchRingFilled = 0;
+    m_dPitchRingSum = 0.0;
+}
+
 //static
 void VinylControlXwax::freeLUTs() {
     s_xwaxLUTMutex.lock(); //Static mutex! We don't want two threads doing this!
@@ -231,16 +242,13 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
     }
 
     // Convert CSAMPLE samples to shorts, preventing overflow.
+    const CSAMPLE factor = gain * SAMPLE_MAX;
+    // note: LOOP VECTORIZED only with "int i" and without branches
     for (int i = 0; i < static_cast<int>(samplesSize); ++i) {
-        CSAMPLE sample = pSamples[i] * gain * SAMPLE_MAX;
-
-        if (sample > SAMPLE_MAX) {
-            m_pWorkBuffer[i] = SAMPLE_MAX;
-        } else if (sample < SAMPLE_MIN) {
-            m_pWorkBuffer[i] = SAMPLE_MIN;
-        } else {
-            m_pWorkBuffer[i] = static_cast<short>(sample);
-        }
+        m_pWorkBuffer[i] = static_cast<short>(math_clamp(
+                pSamples[i] * factor,
+                static_cast<CSAMPLE>(SAMPLE_MIN),
+                static_cast<CSAMPLE>(SAMPLE_MAX)));
     }
 
     // Submit the samples to the xwax timecode processor. The size argument is
@@ -519,8 +527,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
                 togglePlayButton(false);
                 resetSteadyPitch(0.0, 0.0);
                 m_pVCRate->set(0.0);
-                m_iPitchRingPos = 0;
-                m_iPitchRingFilled = 0;
+                resetPitchRing();
                 return;
             } else {
                 togglePlayButton(checkSteadyPitch(dVinylPitch, filePosition) > 0.5);
@@ -546,8 +553,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
                 togglePlayButton(false);
                 resetSteadyPitch(0.0, 0.0);
                 m_pVCRate->set(0.0);
-                m_iPitchRingPos = 0;
-                m_iPitchRingFilled = 0;
+                resetPitchRing();
                 return;
             }
 
@@ -570,24 +576,31 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
 
         if (reportedPlayButton) {
             // Only add to the ring if pitch is stable
-            m_pPitchRing[m_iPitchRingPos] = dVinylPitch;
             if (m_iPitchRingFilled < m_iPitchRingSize) {
                 m_iPitchRingFilled++;
+            } else {
+                m_dPitchRingSum -= m_pPitchRing[m_iPitchRingPos];
             }
+            m_pPitchRing[m_iPitchRingPos] = dVinylPitch;
+            m_dPitchRingSum += dVinylPitch;
             m_iPitchRingPos = (m_iPitchRingPos + 1) % m_iPitchRingSize;
+            if (m_iPitchRingPos == 0) {
+                // Once per revolution of the ring, to not accumulate
+                // rounding errors in the running sum
+                m_dPitchRingSum = 0.0;
+                for (int i = 0; i < m_iPitchRingFilled; ++i) {
+                    m_dPitchRingSum += m_pPitchRing[i];
+                }
+            }
         } else {
             // Reset ring if pitch isn't steady
-            m_iPitchRingPos = 0;
-            m_iPitchRingFilled = 0;
+            resetPitchRing();
         }
 
         //only smooth when we have good position (no smoothing for scratching)
         double averagePitch = 0.0;
         if (m_iPosition != -1 && reportedPlayButton) {
-            for (int i = 0; i < m_iPitchRingFilled; ++i) {
-                averagePitch += m_pPitchRing[i];
-            }
-            averagePitch /= m_iPitchRingFilled;
+            averagePitch = m_dPitchRingSum / m_iPitchRingFilled;
             // Round out some of the noise
             averagePitch = round(averagePitch * 10000.0);
             averagePitch /= 10000.0;
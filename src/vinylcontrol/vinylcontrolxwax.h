@@ -46,6 +46,7 @@ class VinylControlXwax : public VinylControl {
     void enableConstantMode(double rate);
     bool uiUpdateTime(double time);
     void establishQuality(bool quality_sample);
+    void resetPitchRing();
 
     // Cache the position of the end of record
     unsigned int m_uiSafeZone;
@@ -100,6 +101,8 @@ class VinylControlXwax : public VinylControl {
     // How much of the pitch ring buffer is "filled" versus empty (used before
     // it fills up completely).
     int m_iPitchRingFilled;
+    // The sum of the filled part of the pitch ring buffer
+    double m_dPitchRingSum;
     // A smoothed pitch value to show to the user.
     double m_dDisplayPitch;
 
@@ -12,6 +12,9 @@ GuiTick::GuiTick() {
 // this is called from WaveformWidgetFactory::render in the main thread with the
 // configured waveform frame rate
 void GuiTick::process() {
+    // Deliver the changes that the engine has made since the last frame
+    ControlDoublePrivate::drainCoalescedValueChanges();
+
     m_cpuTimeLastTick += m_cpuTimer.restart();
     double cpuTimeLastTickSeconds = m_cpuTimeLastTick.toDoubleSeconds();
     m_pCOGuiTickTime->set(cpuTimeLastTickSeconds);
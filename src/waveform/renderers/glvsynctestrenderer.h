@@ -16,6 +16,10 @@ public:
 
     virtual void onSetup(const QDomNode &node);
     virtual void draw(QPainter* painter, QPaintEvent* event);
+    // Measures the frame rate, so every frame is rendered
+    bool needsRender() override {
+        return true;
+    }
 private:
     int m_drawcount;
 };
@@ -12,7 +12,8 @@
 #include "util/painterscope.h"
 
 WaveformRenderBeat::WaveformRenderBeat(WaveformWidgetRenderer* waveformWidgetRenderer)
-        : WaveformRendererAbstract(waveformWidgetRenderer) {
+        : WaveformRendererAbstract(waveformWidgetRenderer),
+          m_beatsUpdated(false) {
     m_beats.resize(128);
 }
 
@@ -24,6 +25,35 @@ void WaveformRenderBeat::setup(const QDomNode& node, const SkinContext& context)
     m_beatColor = WSkinColor::getCorrectColor(m_beatColor).toRgb();
 }
 
+void WaveformRenderBeat::onSetTrack() {
+    if (m_loadedTrack) {
+        disconnect(m_loadedTrack.get(),
+                &Track::beatsUpdated,
+                this,
+                &WaveformRenderBeat::slotBeatsUpdated);
+    }
+
+    m_loadedTrack = m_waveformRenderer->getTrackInfo();
+    if (!m_loadedTrack) {
+        return;
+    }
+    connect(m_loadedTrack.get(),
+            &Track::beatsUpdated,
+            this,
+            &WaveformRenderBeat::slotBeatsUpdated);
+}
+
+void WaveformRenderBeat::slotBeatsUpdated() {
+    m_beatsUpdated = true;
+}
+
+bool WaveformRenderBeat::needsRender() {
+    // The beats are edited in place
+    const bool beatsUpdated = m_beatsUpdated;
+    m_beatsUpdated = false;
+    return beatsUpdated;
+}
+
 void WaveformRenderBeat::draw(QPainter* painter, QPaintEvent* /*event*/) {
     TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
 
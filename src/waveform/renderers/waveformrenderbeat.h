@@ -2,12 +2,15 @@
 #define WAVEFORMRENDERBEAT_H
 
 #include <QColor>
+#include <QObject>
 
 #include "skin/skincontext.h"
+#include "track/track_decl.h"
 #include "util/class.h"
 #include "waveform/renderers/waveformrendererabstract.h"
 
-class WaveformRenderBeat : public WaveformRendererAbstract {
+class WaveformRenderBeat : public QObject, public WaveformRendererAbstract {
+    Q_OBJECT
   public:
     explicit WaveformRenderBeat(WaveformWidgetRenderer* waveformWidgetRenderer);
     virtual ~WaveformRenderBeat();
@@ -15,7 +18,16 @@ class WaveformRenderBeat : public WaveformRendererAbstract {
     virtual void setup(const QDomNode& node, const SkinContext& context);
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
+    void onSetTrack() override;
+    bool needsRender() override;
+
+  private slots:
+    void slotBeatsUpdated();
+
   private:
+    // The track whose beats are connected
+    TrackPointer m_loadedTrack;
+    bool m_beatsUpdated;
     QColor m_beatColor;
     QVector<QLineF> m_beats;
 
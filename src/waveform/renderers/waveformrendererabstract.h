@@ -22,6 +22,14 @@ class WaveformRendererAbstract {
     virtual void onResize() {}
     virtual void onSetTrack() {}
 
+    // Called once per frame after the WaveformWidgetRenderer has updated the
+    // play position. Returns true if the next frame differs from the last
+    // one for a reason that the WaveformWidgetRenderer does not track itself,
+    // i.e. anything but the displayed range, size, gain, track and skin.
+    virtual bool needsRender() {
+        return false;
+    }
+
   protected:
     bool isDirty() const {
         return m_dirty;
@@ -24,7 +24,8 @@ WaveformRendererEndOfTrack::WaveformRendererEndOfTrack(
         WaveformWidgetRenderer* waveformWidgetRenderer)
     : WaveformRendererAbstract(waveformWidgetRenderer),
       m_pEndOfTrackControl(nullptr),
-      m_pTimeRemainingControl(nullptr) {
+      m_pTimeRemainingControl(nullptr),
+      m_lastFrameEndOfTrack(false) {
 }
 
 WaveformRendererEndOfTrack::~WaveformRendererEndOfTrack() {
@@ -57,6 +58,14 @@ void WaveformRendererEndOfTrack::onResize() {
     generateBackRects();
 }
 
+bool WaveformRendererEndOfTrack::needsRender() {
+    const bool endOfTrack = m_pEndOfTrackControl->toBool();
+    // Once more after the warning is gone to clear it
+    const bool needsRender = endOfTrack || endOfTrack != m_lastFrameEndOfTrack;
+    m_lastFrameEndOfTrack = endOfTrack;
+    return needsRender;
+}
+
 void WaveformRendererEndOfTrack::draw(QPainter* painter,
                                       QPaintEvent* /*event*/) {
     if (!m_pEndOfTrackControl->toBool()) {
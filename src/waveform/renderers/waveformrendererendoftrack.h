@@ -25,12 +25,15 @@ class WaveformRendererEndOfTrack : public WaveformRendererAbstract {
     virtual void setup(const QDomNode& node, const SkinContext& context);
     virtual void onResize();
     virtual void draw(QPainter* painter, QPaintEvent* event);
+    // The warning blinks, so every frame is rendered while it is shown
+    bool needsRender() override;
 
   private:
     void generateBackRects();
 
     ControlProxy* m_pEndOfTrackControl;
     ControlProxy* m_pTimeRemainingControl;
+    bool m_lastFrameEndOfTrack;
 
     QColor m_color;
     PerformanceTimer m_timer;
@@ -222,18 +222,34 @@ void WaveformRendererFilteredSignal::draw(QPainter* painter,
         }
     }
 
-    double lineThickness = math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel());
+    m_raster.begin(m_waveformRenderer->getLength(),
+            m_waveformRenderer->getBreadth(),
+            math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
 
-    painter->setPen(QPen(QBrush(m_pColors->getLowColor()), lineThickness, Qt::SolidLine, Qt::FlatCap));
+    // Band by band like the lines would be drawn, so the higher bands are
+    // on top of the lower bands of the neighbor columns as well
     if (m_pLowKillControlObject && m_pLowKillControlObject->get() == 0.0) {
-       painter->drawLines(&m_lowLines[0], actualLowLineNumber);
+        fillLines(m_lowLines, actualLowLineNumber, m_pColors->getLowColor());
     }
-    painter->setPen(QPen(QBrush(m_pColors->getMidColor()), lineThickness, Qt::SolidLine, Qt::FlatCap));
     if (m_pMidKillControlObject && m_pMidKillControlObject->get() == 0.0) {
-        painter->drawLines(&m_midLines[0], actualMidLineNumber);
+        fillLines(m_midLines, actualMidLineNumber, m_pColors->getMidColor());
     }
-    painter->setPen(QPen(QBrush(m_pColors->getHighColor()), lineThickness, Qt::SolidLine, Qt::FlatCap));
     if (m_pHighKillControlObject && m_pHighKillControlObject->get() == 0.0) {
-        painter->drawLines(&m_highLines[0], actualHighLineNumber);
+        fillLines(m_highLines, actualHighLineNumber, m_pColors->getHighColor());
+    }
+
+    m_raster.draw(painter);
+}
+
+void WaveformRendererFilteredSignal::fillLines(
+        const std::vector<QLineF>& lines, int lineCount, const QColor& color) {
+    // The skin colors may be translucent
+    const QRgb rgb = qPremultiply(color.rgba());
+    for (int i = 0; i < lineCount; ++i) {
+        const QLineF& line = lines[i];
+        m_raster.fillColumn(static_cast<int>(line.x1()),
+                static_cast<int>(line.y1()),
+                static_cast<int>(line.y2()),
+                rgb);
     }
 }
@@ -6,6 +6,7 @@
 
 #include "util/class.h"
 #include "waveform/renderers/waveformrenderersignalbase.h"
+#include "waveform/renderers/waveformsignalraster.h"
 
 class WaveformRendererFilteredSignal : public WaveformRendererSignalBase {
   public:
@@ -20,6 +21,9 @@ class WaveformRendererFilteredSignal : public WaveformRendererSignalBase {
     virtual void onResize();
 
   private:
+    void fillLines(const std::vector<QLineF>& lines, int lineCount, const QColor& color);
+
+    WaveformSignalRaster m_raster;
     std::vector<QLineF> m_lowLines;
     std::vector<QLineF> m_midLines;
     std::vector<QLineF> m_highLines;
@@ -78,10 +78,6 @@ void WaveformRendererHSV::draw(QPainter* painter,
     QColor color;
     float lo, hi, total;
 
-    QPen pen;
-    pen.setCapStyle(Qt::FlatCap);
-    pen.setWidthF(math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
-
     const int breadth = m_waveformRenderer->getBreadth();
     const float halfBreadth = static_cast<float>(breadth) / 2.0f;
 
@@ -91,6 +87,10 @@ void WaveformRendererHSV::draw(QPainter* painter,
     painter->setPen(m_pColors->getAxesColor());
     painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
 
+    m_raster.begin(m_waveformRenderer->getLength(),
+            breadth,
+            math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
+
     for (int x = 0; x < m_waveformRenderer->getLength(); ++x) {
         // Width of the x position in visual indices.
         const double xSampleWidth = gain * x;
@@ -161,27 +161,31 @@ void WaveformRendererHSV::draw(QPainter* painter,
             // Set color
             color.setHsvF(h, 1.0-hi, 1.0-lo);
 
-            pen.setColor(color);
+            const QRgb rgb = color.rgb();
 
-            painter->setPen(pen);
             switch (m_alignment) {
                 case Qt::AlignBottom :
                 case Qt::AlignRight :
-                    painter->drawLine(
-                        x, breadth,
-                        x, breadth - (int)(heightFactor * (float)math_max(maxAll[0],maxAll[1])));
+                    m_raster.fillColumn(x,
+                            breadth,
+                            breadth - (int)(heightFactor * (float)math_max(maxAll[0], maxAll[1])),
+                            rgb);
                     break;
                 case Qt::AlignTop :
                 case Qt::AlignLeft :
-                    painter->drawLine(
-                        x, 0,
-                        x, (int)(heightFactor * (float)math_max(maxAll[0],maxAll[1])));
+                    m_raster.fillColumn(x,
+                            0,
+                            (int)(heightFactor * (float)math_max(maxAll[0], maxAll[1])),
+                            rgb);
                     break;
                 default :
-                    painter->drawLine(
-                        x, (int)(halfBreadth - heightFactor * (float)maxAll[0]),
-                        x, (int)(halfBreadth + heightFactor * (float)maxAll[1]));
+                    m_raster.fillColumn(x,
+                            (int)(halfBreadth - heightFactor * (float)maxAll[0]),
+                            (int)(halfBreadth + heightFactor * (float)maxAll[1]),
+                            rgb);
             }
         }
     }
+
+    m_raster.draw(painter);
 }
@@ -3,6 +3,7 @@
 
 #include "util/class.h"
 #include "waveformrenderersignalbase.h"
+#include "waveformsignalraster.h"
 
 class WaveformRendererHSV : public WaveformRendererSignalBase {
   public:
@@ -15,6 +16,8 @@ class WaveformRendererHSV : public WaveformRendererSignalBase {
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
   private:
+    WaveformSignalRaster m_raster;
+
     DISALLOW_COPY_AND_ASSIGN(WaveformRendererHSV);
 };
 
@@ -69,10 +69,6 @@ void WaveformRendererRGB::draw(QPainter* painter,
 
     QColor color;
 
-    QPen pen;
-    pen.setCapStyle(Qt::FlatCap);
-    pen.setWidthF(math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
-
     const int breadth = m_waveformRenderer->getBreadth();
     const float halfBreadth = static_cast<float>(breadth) / 2.0f;
 
@@ -82,6 +78,10 @@ void WaveformRendererRGB::draw(QPainter* painter,
     painter->setPen(m_pColors->getAxesColor());
     painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
 
+    m_raster.begin(m_waveformRenderer->getLength(),
+            breadth,
+            math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
+
     for (int x = 0; x < m_waveformRenderer->getLength(); ++x) {
         // Width of the x position in visual indices.
         const double xSampleWidth = gain * x;
@@ -153,27 +153,31 @@ void WaveformRendererRGB::draw(QPainter* painter,
             // Set color
             color.setRgbF(red / max, green / max, blue / max);
 
-            pen.setColor(color);
+            const QRgb rgb = color.rgb();
 
-            painter->setPen(pen);
             switch (m_alignment) {
                 case Qt::AlignBottom:
                 case Qt::AlignRight:
-                    painter->drawLine(
-                        x, breadth,
-                        x, breadth - (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
+                    m_raster.fillColumn(x,
+                            breadth,
+                            breadth - (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))),
+                            rgb);
                     break;
                 case Qt::AlignTop:
                 case Qt::AlignLeft:
-                    painter->drawLine(
-                        x, 0,
-                        x, (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
+                    m_raster.fillColumn(x,
+                            0,
+                            (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))),
+                            rgb);
                     break;
                 default:
-                    painter->drawLine(
-                        x, (int)(halfBreadth - heightFactor * sqrtf(maxAll)),
-                        x, (int)(halfBreadth + heightFactor * sqrtf(maxAllNext)));
+                    m_raster.fillColumn(x,
+                            (int)(halfBreadth - heightFactor * sqrtf(maxAll)),
+                            (int)(halfBreadth + heightFactor * sqrtf(maxAllNext)),
+                            rgb);
             }
         }
     }
+
+    m_raster.draw(painter);
 }
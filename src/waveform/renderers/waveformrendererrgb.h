@@ -3,6 +3,7 @@
 
 #include "util/class.h"
 #include "waveformrenderersignalbase.h"
+#include "waveformsignalraster.h"
 
 class WaveformRendererRGB : public WaveformRendererSignalBase {
   public:
@@ -14,6 +15,8 @@ class WaveformRendererRGB : public WaveformRendererSignalBase {
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
   private:
+    WaveformSignalRaster m_raster;
+
     DISALLOW_COPY_AND_ASSIGN(WaveformRendererRGB);
 };
 
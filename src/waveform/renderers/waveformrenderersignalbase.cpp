@@ -46,7 +46,8 @@ WaveformRendererSignalBase::WaveformRendererSignalBase(
       m_rgbMidColor_b(0),
       m_rgbHighColor_r(0),
       m_rgbHighColor_g(0),
-      m_rgbHighColor_b(0) {
+      m_rgbHighColor_b(0),
+      m_lastFrameControls{} {
 }
 
 WaveformRendererSignalBase::~WaveformRendererSignalBase() {
@@ -150,6 +151,23 @@ void WaveformRendererSignalBase::setup(const QDomNode& node,
     onSetup(node);
 }
 
+bool WaveformRendererSignalBase::needsRender() {
+    float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
+    getGains(&allGain, &lowGain, &midGain, &highGain);
+    const std::array<double, 7> frameControls = {
+            allGain,
+            lowGain,
+            midGain,
+            highGain,
+            m_pLowKillControlObject ? m_pLowKillControlObject->get() : 0.0,
+            m_pMidKillControlObject ? m_pMidKillControlObject->get() : 0.0,
+            m_pHighKillControlObject ? m_pHighKillControlObject->get() : 0.0,
+    };
+    const bool changed = frameControls != m_lastFrameControls;
+    m_lastFrameControls = frameControls;
+    return changed;
+}
+
 void WaveformRendererSignalBase::getGains(float* pAllGain, float* pLowGain,
                                           float* pMidGain, float* pHighGain) {
     WaveformWidgetFactory* factory = WaveformWidgetFactory::instance();
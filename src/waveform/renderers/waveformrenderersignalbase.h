@@ -1,6 +1,8 @@
 #ifndef WAVEFORMRENDERERSIGNALBASE_H
 #define WAVEFORMRENDERERSIGNALBASE_H
 
+#include <array>
+
 #include "waveformrendererabstract.h"
 #include "waveformsignalcolors.h"
 #include "skin/skincontext.h"
@@ -15,6 +17,7 @@ public:
 
     virtual bool init();
     virtual void setup(const QDomNode& node, const SkinContext& context);
+    bool needsRender() override;
 
     virtual bool onInit() {return true;}
     virtual void onSetup(const QDomNode &node) = 0;
@@ -46,6 +49,10 @@ public:
     qreal m_rgbLowColor_r, m_rgbLowColor_g, m_rgbLowColor_b;
     qreal m_rgbMidColor_r, m_rgbMidColor_g, m_rgbMidColor_b;
     qreal m_rgbHighColor_r, m_rgbHighColor_g, m_rgbHighColor_b;
+
+  private:
+    // The gains and kill switches of the last frame
+    std::array<double, 7> m_lastFrameControls;
 };
 
 #endif // WAVEFORMRENDERERSIGNALBASE_H
@@ -21,7 +21,8 @@ namespace {
 
 WaveformRenderMark::WaveformRenderMark(
         WaveformWidgetRenderer* waveformWidgetRenderer) :
-    WaveformRendererAbstract(waveformWidgetRenderer) {
+    WaveformRendererAbstract(waveformWidgetRenderer),
+    m_cuesUpdated(false) {
 }
 
 void WaveformRenderMark::setup(const QDomNode& node, const SkinContext& context) {
@@ -154,6 +155,23 @@ void WaveformRenderMark::draw(QPainter* painter, QPaintEvent* /*event*/) {
     m_waveformRenderer->setMarkPositions(marksOnScreen);
 }
 
+bool WaveformRenderMark::needsRender() {
+    QVector<double> frameMarks;
+    frameMarks.reserve(m_lastFrameMarks.size());
+    for (const auto& pMark : m_marks) {
+        if (!pMark->isValid()) {
+            continue;
+        }
+        frameMarks.append(pMark->isVisible() ? 1.0 : 0.0);
+        frameMarks.append(pMark->getSamplePosition());
+        frameMarks.append(pMark->getSampleEndPosition());
+    }
+    const bool changed = m_cuesUpdated || frameMarks != m_lastFrameMarks;
+    m_cuesUpdated = false;
+    m_lastFrameMarks = frameMarks;
+    return changed;
+}
+
 void WaveformRenderMark::onResize() {
     // Delete all marks' images. New images will be created on next paint.
     for (const auto& pMark : m_marks) {
@@ -162,13 +180,20 @@ void WaveformRenderMark::onResize() {
 }
 
 void WaveformRenderMark::onSetTrack() {
+    if (m_loadedTrack) {
+        disconnect(m_loadedTrack.get(),
+                &Track::cuesUpdated,
+                this,
+                &WaveformRenderMark::slotCuesUpdated);
+    }
+
     slotCuesUpdated();
 
-    TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
-    if (!trackInfo) {
+    m_loadedTrack = m_waveformRenderer->getTrackInfo();
+    if (!m_loadedTrack) {
         return;
     }
-    connect(trackInfo.get(),
+    connect(m_loadedTrack.get(),
             &Track::cuesUpdated,
             this,
             &WaveformRenderMark::slotCuesUpdated);
@@ -179,6 +204,7 @@ void WaveformRenderMark::slotCuesUpdated() {
     if (!trackInfo) {
         return;
     }
+    m_cuesUpdated = true;
 
     QList<CuePointer> loadedCues = trackInfo->getCuePoints();
     for (const CuePointer& pCue : loadedCues) {
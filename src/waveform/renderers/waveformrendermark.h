@@ -2,6 +2,7 @@
 #define WAVEFORMRENDERMARK_H
 
 #include <QObject>
+#include <QVector>
 
 #include "skin/skincontext.h"
 #include "util/class.h"
@@ -9,6 +10,7 @@
 #include "waveform/renderers/waveformmarkset.h"
 #include "waveform/renderers/waveformrendererabstract.h"
 #include "track/cue.h"
+#include "track/track_decl.h"
 #include "preferences/configobject.h"
 
 class WaveformRenderMark : public QObject, public WaveformRendererAbstract {
@@ -25,6 +27,9 @@ class WaveformRenderMark : public QObject, public WaveformRendererAbstract {
     // Called when a new track is loaded.
     void onSetTrack() override;
 
+    // True if a mark has been moved, shown, hidden or relabeled
+    bool needsRender() override;
+
   public slots:
     // Called when the loaded track's cues are added, deleted or modified and
     // when a new track is loaded.
@@ -36,6 +41,11 @@ class WaveformRenderMark : public QObject, public WaveformRendererAbstract {
     void generateMarkImage(WaveformMarkPointer pMark);
 
     WaveformMarkSet m_marks;
+    // The track whose cues are connected
+    TrackPointer m_loadedTrack;
+    bool m_cuesUpdated;
+    // The positions and visibility of the marks in the last frame
+    QVector<double> m_lastFrameMarks;
     DISALLOW_COPY_AND_ASSIGN(WaveformRenderMark);
 };
 
@@ -37,6 +37,21 @@ void WaveformRenderMarkRange::setup(const QDomNode& node, const SkinContext& con
     }
 }
 
+bool WaveformRenderMarkRange::needsRender() {
+    QVector<double> frameRanges;
+    frameRanges.reserve(static_cast<int>(m_markRanges.size()) * 4);
+    for (const auto& markRange : m_markRanges) {
+        const bool active = markRange.active() && markRange.visible();
+        frameRanges.append(active ? 1.0 : 0.0);
+        frameRanges.append(markRange.enabled() ? 1.0 : 0.0);
+        frameRanges.append(active ? markRange.start() : 0.0);
+        frameRanges.append(active ? markRange.end() : 0.0);
+    }
+    const bool changed = frameRanges != m_lastFrameRanges;
+    m_lastFrameRanges = frameRanges;
+    return changed;
+}
+
 void WaveformRenderMarkRange::draw(QPainter *painter, QPaintEvent * /*event*/) {
     PainterScope PainterScope(painter);
 
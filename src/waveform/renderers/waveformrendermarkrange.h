@@ -6,6 +6,7 @@
 #include <QDomNode>
 #include <QPainter>
 #include <QPaintEvent>
+#include <QVector>
 
 #include <vector>
 
@@ -25,9 +26,15 @@ class WaveformRenderMarkRange : public WaveformRendererAbstract {
     void setup(const QDomNode& node, const SkinContext& context) override;
     void draw(QPainter* painter, QPaintEvent* event) override;
 
+    // True if a range has been moved, enabled or disabled
+    bool needsRender() override;
+
   private:
     void generateImages();
 
+    // The state of the ranges in the last frame
+    QVector<double> m_lastFrameRanges;
+
     std::vector<WaveformMarkRange> m_markRanges;
 };
 
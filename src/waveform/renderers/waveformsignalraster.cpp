@@ -0,0 +1,86 @@
+#include "waveform/renderers/waveformsignalraster.h"
+
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+
+#include "util/math.h"
+
+namespace {
+
+// Premultiplied source over destination for all 4 channels at once
+inline QRgb blendOver(QRgb source, QRgb destination) {
+    const uint inverseAlpha = 255 - qAlpha(source);
+    // Red and blue, then alpha and green in the upper and lower byte of
+    // each 16 bit half. Approximates division by 255.
+    uint rb = (destination & 0x00ff00ff) * inverseAlpha;
+    rb = ((rb + ((rb >> 8) & 0x00ff00ff) + 0x00800080) >> 8) & 0x00ff00ff;
+    uint ag = ((destination >> 8) & 0x00ff00ff) * inverseAlpha;
+    ag = (ag + ((ag >> 8) & 0x00ff00ff) + 0x00800080) & 0xff00ff00;
+    return source + (rb | ag);
+}
+
+} // anonymous namespace
+
+WaveformSignalRaster::WaveformSignalRaster()
+        : m_pBits(nullptr),
+          m_bytesPerLine(0),
+          m_columnLeft(0),
+          m_columnRight(1),
+          m_thinColumns(true) {
+}
+
+void WaveformSignalRaster::begin(int length, int breadth, double lineWidth) {
+    if (m_image.width() != length || m_image.height() != breadth) {
+        m_image = QImage(math_max(length, 0),
+                math_max(breadth, 0),
+                QImage::Format_ARGB32_Premultiplied);
+    }
+    m_image.fill(Qt::transparent);
+    // bits() detaches, so it is fetched once per frame
+    m_pBits = m_image.bits();
+    m_bytesPerLine = m_image.bytesPerLine();
+    // The raster engine fills the pixels with their center inside of the
+    // line, including the right edge and excluding the left one
+    m_columnLeft = static_cast<int>(std::floor(-lineWidth / 2 - 0.5)) + 1;
+    m_columnRight = static_cast<int>(std::floor(lineWidth / 2 - 0.5)) + 1;
+    m_thinColumns = lineWidth <= 1.0;
+}
+
+void WaveformSignalRaster::fillColumn(int x, int y0, int y1, QRgb color) {
+    if (m_pBits == nullptr || qAlpha(color) == 0) {
+        return;
+    }
+    int top = math_min(y0, y1);
+    int bottom = math_max(y0, y1);
+    if (top == bottom && m_thinColumns) {
+        // A thin line of length 0 is a point
+        ++bottom;
+    }
+    top = math_max(top, 0);
+    bottom = math_min(bottom, m_image.height());
+    const int left = math_max(x + m_columnLeft, 0);
+    const int right = math_min(x + m_columnRight, m_image.width());
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    uchar* pLine = m_pBits + top * m_bytesPerLine;
+    if (qAlpha(color) == 255) {
+        for (int y = top; y < bottom; ++y, pLine += m_bytesPerLine) {
+            QRgb* pPixels = reinterpret_cast<QRgb*>(pLine);
+            std::fill(pPixels + left, pPixels + right, color);
+        }
+    } else {
+        for (int y = top; y < bottom; ++y, pLine += m_bytesPerLine) {
+            QRgb* pPixels = reinterpret_cast<QRgb*>(pLine);
+            for (int i = left; i < right; ++i) {
+                pPixels[i] = blendOver(color, pPixels[i]);
+            }
+        }
+    }
+}
+
+void WaveformSignalRaster::draw(QPainter* pPainter) const {
+    pPainter->drawImage(0, 0, m_image);
+}
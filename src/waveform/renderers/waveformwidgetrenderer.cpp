@@ -49,7 +49,9 @@ WaveformWidgetRenderer::WaveformWidgetRenderer(const QString& group)
           m_pTrackSamplesControlObject(NULL),
           m_trackSamples(0.0),
           m_scaleFactor(1.0),
-          m_playMarkerPosition(s_defaultPlayMarkerPosition) {
+          m_playMarkerPosition(s_defaultPlayMarkerPosition),
+          m_waveformCompletion(-1),
+          m_frameDirty(true) {
     //qDebug() << "WaveformWidgetRenderer";
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
@@ -102,9 +104,19 @@ bool WaveformWidgetRenderer::init() {
 }
 
 void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
+    // The state of the last frame. If nothing has changed since then the
+    // frame does not need to be rendered again.
+    const int lastTrackSamples = m_trackSamples;
+    const double lastPlayPos = m_playPos;
+    const double lastTrackPixelCount = m_trackPixelCount;
+    const double lastGain = m_gain;
+
     // For a valid track to render we need
     m_trackSamples = static_cast<int>(m_pTrackSamplesControlObject->get());
     if (m_trackSamples <= 0) {
+        if (m_trackSamples != lastTrackSamples) {
+            m_frameDirty = true;
+        }
         return;
     }
 
@@ -162,6 +174,27 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
         m_playPos = -1; // disable renderers
     }
 
+    // The waveform grows while the track is analyzed
+    const int waveformCompletion = pWaveform ? pWaveform->getCompletion() : -1;
+    if (m_trackSamples != lastTrackSamples ||
+            m_playPos != lastPlayPos ||
+            m_trackPixelCount != lastTrackPixelCount ||
+            m_gain != lastGain ||
+            waveformCompletion != m_waveformCompletion) {
+        m_frameDirty = true;
+    }
+    m_waveformCompletion = waveformCompletion;
+
+    if (m_playPos != -1) {
+        // All renderers are asked, so they can update the state they
+        // compare against
+        for (WaveformRendererAbstract* pRenderer : qAsConst(m_rendererStack)) {
+            if (pRenderer->needsRender()) {
+                m_frameDirty = true;
+            }
+        }
+    }
+
     //qDebug() << "WaveformWidgetRenderer::onPreRender" <<
     //        "m_group" << m_group <<
     //        "m_trackSamples" << m_trackSamples <<
@@ -178,6 +211,8 @@ void WaveformWidgetRenderer::draw(QPainter* painter, QPaintEvent* event) {
     //PerformanceTimer timer;
     //timer.start();
 
+    m_frameDirty = false;
+
     // not ready to display need to wait until track initialization is done
     // draw only first is stack (background)
     int stackSize = m_rendererStack.size();
@@ -307,6 +342,7 @@ void WaveformWidgetRenderer::resize(int width, int height, float devicePixelRati
     m_width = width;
     m_height = height;
     m_devicePixelRatio = devicePixelRatio;
+    m_frameDirty = true;
     for (int i = 0; i < m_rendererStack.size(); ++i) {
         m_rendererStack[i]->setDirty(true);
         m_rendererStack[i]->onResize();
@@ -330,6 +366,7 @@ void WaveformWidgetRenderer::setup(
     }
 
     m_colors.setup(node, context);
+    m_frameDirty = true;
     for (int i = 0; i < m_rendererStack.size(); ++i) {
         m_rendererStack[i]->setScaleFactor(m_scaleFactor);
         m_rendererStack[i]->setup(node, context);
@@ -343,12 +380,14 @@ void WaveformWidgetRenderer::setZoom(double zoom) {
 
 void WaveformWidgetRenderer::setDisplayBeatGridAlpha(int alpha) {
     m_alphaBeatGrid = alpha;
+    m_frameDirty = true;
 }
 
 void WaveformWidgetRenderer::setTrack(TrackPointer track) {
     m_pTrack = track;
     //used to postpone first display until track sample is actually available
     m_trackSamples = -1.0;
+    m_frameDirty = true;
 
     for (int i = 0; i < m_rendererStack.size(); ++i) {
         m_rendererStack[i]->onSetTrack();
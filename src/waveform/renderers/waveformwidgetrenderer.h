@@ -37,6 +37,17 @@ class WaveformWidgetRenderer {
     void onPreRender(VSyncThread* vsyncThread);
     void draw(QPainter* painter, QPaintEvent* event);
 
+    // Whether the frame prepared by onPreRender() differs from the last
+    // drawn one. Clean frames don't need to be rendered again.
+    bool isFrameDirty() const {
+        return m_frameDirty;
+    }
+    // Forces a redraw of the next frame, e.g. after the widget has been
+    // hidden or its content was lost.
+    void setFrameDirty() {
+        m_frameDirty = true;
+    }
+
     const QString& getGroup() const {
         return m_group;
     }
@@ -152,6 +163,7 @@ class WaveformWidgetRenderer {
             newPos = math_clamp(newPos, 0.0, 1.0);
         }
         m_playMarkerPosition = newPos;
+        m_frameDirty = true;
     }
 
   protected:
@@ -189,6 +201,8 @@ class WaveformWidgetRenderer {
     int m_trackSamples;
     double m_scaleFactor;
     double m_playMarkerPosition;   // 0.0 - left, 0.5 - center, 1.0 - right
+    int m_waveformCompletion;
+    bool m_frameDirty;
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     PerformanceTimer* m_timer;
@@ -32,6 +32,7 @@
 #include "waveform/visualsmanager.h"
 #include "waveform/vsyncthread.h"
 #include "util/cmdlineargs.h"
+#include "util/counter.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/math.h"
@@ -78,7 +79,8 @@ WaveformWidgetAbstractHandle::WaveformWidgetAbstractHandle()
 WaveformWidgetHolder::WaveformWidgetHolder()
     : m_waveformWidget(NULL),
       m_waveformViewer(NULL),
-      m_skinContextCache(UserSettingsPointer(), QString()) {
+      m_skinContextCache(UserSettingsPointer(), QString()),
+      m_swapPending(false) {
 }
 
 WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidget,
@@ -88,7 +90,11 @@ WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidge
     : m_waveformWidget(waveformWidget),
       m_waveformViewer(waveformViewer),
       m_skinNodeCache(node.cloneNode()),
-      m_skinContextCache(&parentContext) {
+      m_skinContextCache(&parentContext),
+      m_skippedFramesCounterKey(
+              QStringLiteral("WaveformWidgetFactory::render() %1 skipped frames")
+                      .arg(waveformWidget ? waveformWidget->getGroup() : QString())),
+      m_swapPending(false) {
 }
 
 ///////////////////////////////////////////
@@ -523,6 +529,7 @@ bool WaveformWidgetFactory::setWidgetTypeFromHandle(int handleIndex, bool force)
         WWaveformViewer* viewer = holder.m_waveformViewer;
         WaveformWidgetAbstract* widget = createWaveformWidget(m_type, holder.m_waveformViewer);
         holder.m_waveformWidget = widget;
+        holder.m_swapPending = false;
         viewer->setWaveformWidget(widget);
         viewer->setup(holder.m_skinNodeCache, holder.m_skinContextCache);
         viewer->setZoom(previousZoom);
@@ -638,16 +645,27 @@ void WaveformWidgetFactory::render() {
             // next rendered frame is displayed after next buffer swap and than after VSync
             QVarLengthArray<bool, 10> shouldRenderWaveforms(m_waveformWidgetHolders.size());
             for (std::size_t i = 0; i < m_waveformWidgetHolders.size(); i++) {
-                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
+                WaveformWidgetHolder& holder = m_waveformWidgetHolders[i];
+                WaveformWidgetAbstract* pWaveformWidget = holder.m_waveformWidget;
                 // Don't bother doing the pre-render work if we aren't going to
                 // render this widget.
                 bool shouldRender = shouldRenderWaveform(pWaveformWidget);
                 shouldRenderWaveforms[i] = shouldRender;
                 if (!shouldRender) {
+                    if (pWaveformWidget) {
+                        // The content is gone once the widget is shown again
+                        pWaveformWidget->setFrameDirty();
+                    }
                     continue;
                 }
                 // Calculate play position for the new Frame in following run
                 pWaveformWidget->preRender(m_vsyncThread);
+                // Paused decks and decks without a track look the same as in
+                // the last frame, which is still on the screen
+                if (!pWaveformWidget->isFrameDirty()) {
+                    shouldRenderWaveforms[i] = false;
+                    Counter(holder.m_skippedFramesCounterKey).increment();
+                }
             }
             //qDebug() << "prerender" << m_vsyncThread->elapsed();
 
@@ -655,11 +673,15 @@ void WaveformWidgetFactory::render() {
             // anti tearing driver settings
             // all render commands are delayed until the swap from the previous run is executed
             for (std::size_t i = 0; i < m_waveformWidgetHolders.size(); i++) {
-                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
+                WaveformWidgetHolder& holder = m_waveformWidgetHolders[i];
+                WaveformWidgetAbstract* pWaveformWidget = holder.m_waveformWidget;
                 if (!shouldRenderWaveforms[i]) {
                     continue;
                 }
+                ScopedTimer t("WaveformWidgetFactory::render() %1",
+                        pWaveformWidget->getGroup());
                 pWaveformWidget->render();
+                holder.m_swapPending = true;
                 //qDebug() << "render" << i << m_vsyncThread->elapsed();
             }
         }
@@ -699,9 +721,16 @@ void WaveformWidgetFactory::swap() {
         if (m_type) {   // no regular updates for an empty waveform
             // Show rendered buffer from last render() run
             //qDebug() << "swap() start" << m_vsyncThread->elapsed();
-            for (const auto& holder : m_waveformWidgetHolders) {
+            for (auto& holder : m_waveformWidgetHolders) {
                 WaveformWidgetAbstract* pWaveformWidget = holder.m_waveformWidget;
 
+                // Only swap if a new frame has been rendered. Otherwise the
+                // back buffer holds an older frame than the one on the screen.
+                if (!holder.m_swapPending) {
+                    continue;
+                }
+                holder.m_swapPending = false;
+
                 // Don't swap invalid / invisible widgets or widgets with an
                 // unexposed window. Prevents continuous log spew of
                 // "QOpenGLContext::swapBuffers() called with non-exposed
@@ -47,6 +47,10 @@ class WaveformWidgetHolder {
     WWaveformViewer* m_waveformViewer;
     QDomNode m_skinNodeCache;
     SkinContext m_skinContextCache;
+    // Counts the frames that are not rendered because nothing has changed
+    QString m_skippedFramesCounterKey;
+    // True if a frame has been rendered that is not yet swapped
+    bool m_swapPending;
 
     friend class WaveformWidgetFactory;
 };
@@ -50,6 +50,9 @@ void GLRGBWaveformWidget::castToQWidget() {
 
 void GLRGBWaveformWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration GLRGBWaveformWidget::render() {
@@ -70,6 +70,9 @@ void GLSLWaveformWidget::castToQWidget() {
 
 void GLSLWaveformWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration GLSLWaveformWidget::render() {
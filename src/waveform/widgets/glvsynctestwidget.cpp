@@ -55,6 +55,9 @@ void GLVSyncTestWidget::castToQWidget() {
 
 void GLVSyncTestWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration GLVSyncTestWidget::render() {
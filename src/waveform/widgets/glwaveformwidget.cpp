@@ -52,6 +52,9 @@ void GLWaveformWidget::castToQWidget() {
 
 void GLWaveformWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration GLWaveformWidget::render() {
@@ -42,6 +42,9 @@ void QtHSVWaveformWidget::castToQWidget() {
 
 void QtHSVWaveformWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration QtHSVWaveformWidget::render() {
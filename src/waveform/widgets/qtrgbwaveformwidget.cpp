@@ -49,6 +49,9 @@ void QtRGBWaveformWidget::castToQWidget() {
 
 void QtRGBWaveformWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration QtRGBWaveformWidget::render() {
@@ -53,6 +53,9 @@ void QtSimpleWaveformWidget::castToQWidget() {
 void QtSimpleWaveformWidget::paintEvent(QPaintEvent* event) {
     //qDebug() << "paintEvent()";
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration QtSimpleWaveformWidget::render() {
@@ -45,6 +45,9 @@ void QtVSyncTestWidget::castToQWidget() {
 
 void QtVSyncTestWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration QtVSyncTestWidget::render() {
@@ -51,6 +51,9 @@ void QtWaveformWidget::castToQWidget() {
 
 void QtWaveformWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    // The content is rendered by the vsync thread. Redraw it with the
+    // next frame, it may have been lost.
+    setFrameDirty();
 }
 
 mixxx::Duration QtWaveformWidget::render() {
@@ -13,8 +13,10 @@
 #include "library/coverartutils.h"
 #include "track/track.h"
 #include "util/compatibility.h"
+#include "util/counter.h"
 #include "util/dnd.h"
 #include "util/math.h"
+#include "util/timer.h"
 #include "vinylcontrol/vinylcontrol.h"
 #include "vinylcontrol/vinylcontrolmanager.h"
 #include "waveform/sharedglcontext.h"
@@ -63,6 +65,10 @@ WSpinny::WSpinny(
           m_dRotationsPerSecond(MIXXX_VINYL_SPEED_33_NUM / 60),
           m_bClampFailedWarning(false),
           m_bGhostPlayback(false),
+          m_bDirty(true),
+          m_bSwapPending(false),
+          m_skippedFramesCounterKey(
+                  QStringLiteral("WSpinny::render() %1 skipped frames").arg(group)),
           m_pPlayer(pPlayer),
           m_pDlgCoverArt(new DlgCoverArtFullSize(parent, pPlayer)),
           m_pCoverMenu(new WCoverArtMenu(this)) {
@@ -144,6 +150,7 @@ void WSpinny::onVinylSignalQualityUpdate(const VinylSignalQualityReport& report)
             line++;
         }
     }
+    m_bDirty = true;
 #endif
 }
 
@@ -178,6 +185,7 @@ void WSpinny::setup(const QDomNode& node, const SkinContext& context) {
     }
 
     m_bShowCover = context.selectBool(node, "ShowCover", false);
+    m_bDirty = true;
 
 #ifdef __VINYLCONTROL__
     // Find the vinyl input we should listen to reports about.
@@ -248,6 +256,7 @@ void WSpinny::slotLoadTrack(TrackPointer pTrack) {
         connect(m_loadedTrack.get(), SIGNAL(coverArtUpdated()),
                 this, SLOT(slotTrackCoverArtUpdated()));
     }
+    m_bDirty = true;
 
     slotTrackCoverArtUpdated();
 }
@@ -262,6 +271,7 @@ void WSpinny::slotLoadingTrack(TrackPointer pNewTrack, TrackPointer pOldTrack) {
     m_lastRequestedCover = CoverInfo();
     m_loadedCover = QPixmap();
     m_loadedCoverScaled = QPixmap();
+    m_bDirty = true;
     update();
 }
 
@@ -284,6 +294,7 @@ void WSpinny::slotCoverFound(
             m_loadedTrack->getLocation() == coverInfo.trackLocation) {
         m_loadedCover = pixmap;
         m_loadedCoverScaled = scaledCoverArt(pixmap);
+        m_bDirty = true;
         update();
     }
 }
@@ -304,15 +315,21 @@ void WSpinny::slotReloadCoverArt() {
 
 void WSpinny::paintEvent(QPaintEvent *e) {
     Q_UNUSED(e);
+    // The content is rendered by the vsync thread. Redraw it with the next
+    // frame, it may have been lost.
+    m_bDirty = true;
 }
 
 void WSpinny::render(VSyncThread* vSyncThread) {
+    m_bSwapPending = false;
     if (!isValid() || !isVisible()) {
+        m_bDirty = true;
         return;
     }
 
     auto window = windowHandle();
     if (window == nullptr || !window->isExposed()) {
+        m_bDirty = true;
         return;
     }
 
@@ -323,6 +340,28 @@ void WSpinny::render(VSyncThread* vSyncThread) {
                 &m_dGhostAngleCurrentPlaypos);
     }
 
+    if (m_dAngleCurrentPlaypos != m_dAngleLastPlaypos) {
+        m_fAngle = static_cast<float>(calculateAngle(m_dAngleCurrentPlaypos));
+        m_dAngleLastPlaypos = m_dAngleCurrentPlaypos;
+        m_bDirty = true;
+    }
+
+    if (m_dGhostAngleCurrentPlaypos != m_dGhostAngleLastPlaypos) {
+        m_fGhostAngle = static_cast<float>(calculateAngle(m_dGhostAngleCurrentPlaypos));
+        m_dGhostAngleLastPlaypos = m_dGhostAngleCurrentPlaypos;
+        m_bDirty = true;
+    }
+
+    // A stopped deck looks the same as in the last frame, which is still on
+    // the screen
+    if (!m_bDirty) {
+        Counter(m_skippedFramesCounterKey).increment();
+        return;
+    }
+    ScopedTimer t("WSpinny::render() %1", m_group);
+    m_bDirty = false;
+    m_bSwapPending = true;
+
     double scaleFactor = getDevicePixelRatioF(this);
 
     QPainter p(this);
@@ -361,21 +400,6 @@ void WSpinny::render(VSyncThread* vSyncThread) {
     bool paintGhost = m_bGhostPlayback && m_pGhostImage && !m_pGhostImage->isNull();
     if (paintGhost) {
         p.save();
-    }
-
-    if (m_dAngleCurrentPlaypos != m_dAngleLastPlaypos) {
-        m_fAngle = static_cast<float>(calculateAngle(m_dAngleCurrentPlaypos));
-        m_dAngleLastPlaypos = m_dAngleCurrentPlaypos;
-    }
-
-    if (m_dGhostAngleCurrentPlaypos != m_dGhostAngleLastPlaypos) {
-        m_fGhostAngle = static_cast<float>(calculateAngle(m_dGhostAngleCurrentPlaypos));
-        m_dGhostAngleLastPlaypos = m_dGhostAngleCurrentPlaypos;
-    }
-
-    if (paintGhost) {
-        p.restore();
-        p.save();
         p.rotate(m_fGhostAngle);
         p.drawImage(-(m_ghostImageScaled.width() / 2),
                     -(m_ghostImageScaled.height() / 2), m_ghostImageScaled);
@@ -394,6 +418,12 @@ void WSpinny::render(VSyncThread* vSyncThread) {
 }
 
 void WSpinny::swap() {
+    // Only swap if a new frame has been rendered. Otherwise the back buffer
+    // holds an older frame than the one on the screen.
+    if (!m_bSwapPending) {
+        return;
+    }
+    m_bSwapPending = false;
     if (!isValid() || !isVisible()) {
         return;
     }
@@ -416,6 +446,7 @@ QPixmap WSpinny::scaledCoverArt(const QPixmap& normal) {
 }
 
 void WSpinny::resizeEvent(QResizeEvent* /*unused*/) {
+    m_bDirty = true;
     m_loadedCoverScaled = scaledCoverArt(m_loadedCover);
     if (m_pFgImage && !m_pFgImage->isNull()) {
         m_fgImageScaled = m_pFgImage->scaled(
@@ -535,15 +566,18 @@ void WSpinny::updateVinylControlSignalEnabled(double enabled) {
         // fill with transparent black
         m_qImage.fill(qRgba(0,0,0,0));
     }
+    m_bDirty = true;
 #endif
 }
 
 void WSpinny::updateVinylControlEnabled(double enabled) {
     m_bVinylActive = enabled != 0;
+    m_bDirty = true;
 }
 
 void WSpinny::updateSlipEnabled(double enabled) {
     m_bGhostPlayback = static_cast<bool>(enabled);
+    m_bDirty = true;
 }
 
 void WSpinny::mouseMoveEvent(QMouseEvent * e) {
@@ -656,6 +690,7 @@ void WSpinny::mouseReleaseEvent(QMouseEvent * e)
 
 void WSpinny::showEvent(QShowEvent* event) {
     Q_UNUSED(event);
+    m_bDirty = true;
 #ifdef __VINYLCONTROL__
     // If we want to draw the VC signal on this widget then register for
     // updates.
@@ -132,6 +132,11 @@ class WSpinny : public QGLWidget, public WBaseWidget, public VinylSignalQualityL
     double m_dRotationsPerSecond;
     bool m_bClampFailedWarning;
     bool m_bGhostPlayback;
+    // The spinny is only rendered if something has changed since the last
+    // frame and only swapped if a new frame has been rendered
+    bool m_bDirty;
+    bool m_bSwapPending;
+    const QString m_skippedFramesCounterKey;
 
     BaseTrackPlayer* m_pPlayer;
     DlgCoverArtFullSize* m_pDlgCoverArt;